@@ -17,11 +17,109 @@ See the file COPYING for details.
 #include <time.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 struct hash_table *check_sums = NULL;
 double total_checksum_time = 0.0;
 
+/*
+Cached checksums carry the identity of the bytes that were hashed:
+a cache hit requires the file's device, inode, mtime, and size to
+match, so a path that is rewritten between jobs is re-hashed rather
+than served stale, and an unchanged large input is hashed exactly
+once no matter how many jobs reference it.  Setting
+CCTOOLS_CHECKSUM_CACHE to a file name persists entries across runs:
+entries are loaded on first use and new ones appended as computed,
+with the same identity check deciding validity on reload.
+*/
+
+#define BATCH_FILE_CHECKSUM_CACHE_ENV "CCTOOLS_CHECKSUM_CACHE"
+
+/* The cache parser's path buffer and the width bounding its sscanf
+conversion, kept together so they cannot drift apart. */
+#define CHECKSUM_PATH_BUFFER 4096
+#define CHECKSUM_PATH_WIDTH "4095"
+
+struct batch_file_checksum {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	off_t size;
+	char *hash;
+};
+
+static FILE *checksum_cache_file = NULL;
+
+static int checksum_matches(struct batch_file_checksum *e, struct stat *s)
+{
+	return e && e->dev == s->st_dev && e->ino == s->st_ino && e->mtime == s->st_mtime && e->size == s->st_size;
+}
+
+static void checksum_insert(const char *path, struct stat *s, const char *hash)
+{
+	struct batch_file_checksum *e = xxmalloc(sizeof(*e));
+	e->dev = s->st_dev;
+	e->ino = s->st_ino;
+	e->mtime = s->st_mtime;
+	e->size = s->st_size;
+	e->hash = xxstrdup(hash);
+
+	struct batch_file_checksum *old = hash_table_remove(check_sums, path);
+	if (old) {
+		free(old->hash);
+		free(old);
+	}
+
+	hash_table_insert(check_sums, path, e);
+}
+
+static void checksum_cache_load(void)
+{
+	static int loaded = 0;
+
+	if (loaded)
+		return;
+	loaded = 1;
+
+	const char *cache_name = getenv(BATCH_FILE_CHECKSUM_CACHE_ENV);
+	if (!cache_name)
+		return;
+
+	FILE *file = fopen(cache_name, "r");
+	if (file) {
+		char line[PATH_MAX + 256];
+		while (fgets(line, sizeof(line), file)) {
+			struct stat s;
+			char hash[SHA1_DIGEST_LENGTH * 2 + 1];
+			char path[CHECKSUM_PATH_BUFFER];
+			long long dev, ino, mtime, size;
+
+			if (sscanf(line, "%lld %lld %lld %lld %40s %" CHECKSUM_PATH_WIDTH "[^\n]", &dev, &ino, &mtime, &size, hash, path) == 6) {
+				s.st_dev = dev;
+				s.st_ino = ino;
+				s.st_mtime = mtime;
+				s.st_size = size;
+				checksum_insert(path, &s, hash);
+			}
+		}
+		fclose(file);
+	}
+
+	checksum_cache_file = fopen(cache_name, "a");
+}
+
+static void checksum_cache_append(const char *path, struct stat *s, const char *hash)
+{
+	if (!checksum_cache_file)
+		return;
+
+	fprintf(checksum_cache_file, "%lld %lld %lld %lld %s %s\n", (long long)s->st_dev, (long long)s->st_ino, (long long)s->st_mtime, (long long)s->st_size, hash, path);
+	fflush(checksum_cache_file);
+}
+
 /**
  * Create batch_file from outer_name and inner_name.
  * Outer/DAG name indicates the name that will be on the host/submission side.
@@ -105,40 +203,53 @@ char *batch_file_generate_id(struct batch_file *f)
 	if (check_sums == NULL) {
 		check_sums = hash_table_create(0, 0);
 	}
-	char *check_sum_value = hash_table_lookup(check_sums, f->outer_name);
-	if (check_sum_value == NULL) {
-		unsigned char hash[SHA1_DIGEST_LENGTH];
-		struct timeval start_time;
-		struct timeval end_time;
-
-		gettimeofday(&start_time, NULL);
-		int success = sha1_file(f->outer_name, hash);
-		gettimeofday(&end_time, NULL);
-		double run_time = ((end_time.tv_sec * 1000000 + end_time.tv_usec) - (start_time.tv_sec * 1000000 + start_time.tv_usec)) / 1000000.0;
-		total_checksum_time += run_time;
-		debug(D_MAKEFLOW_HOOK, " The total checksum time is %lf", total_checksum_time);
-		if (success == 0) {
-			debug(D_MAKEFLOW, "Unable to checksum this file: %s", f->outer_name);
-			return NULL;
-		}
-		f->hash = xxstrdup(sha1_string(hash));
-		hash_table_insert(check_sums, f->outer_name, xxstrdup(sha1_string(hash)));
-		debug(D_MAKEFLOW, "Checksum hash of %s is: %s", f->outer_name, f->hash);
-		return xxstrdup(f->hash);
+
+	checksum_cache_load();
+
+	struct stat s;
+	if (stat(f->outer_name, &s) < 0) {
+		debug(D_MAKEFLOW, "Unable to checksum this file: %s", f->outer_name);
+		return NULL;
 	}
-	debug(D_MAKEFLOW, "Checksum already exists in hash table. Cached CHECKSUM hash of %s is: %s", f->outer_name, check_sum_value);
-	return xxstrdup(check_sum_value);
+
+	struct batch_file_checksum *entry = hash_table_lookup(check_sums, f->outer_name);
+	if (checksum_matches(entry, &s)) {
+		debug(D_MAKEFLOW, "Cached CHECKSUM hash of %s is: %s", f->outer_name, entry->hash);
+		return xxstrdup(entry->hash);
+	}
+
+	unsigned char hash[SHA1_DIGEST_LENGTH];
+	struct timeval start_time;
+	struct timeval end_time;
+
+	gettimeofday(&start_time, NULL);
+	int success = sha1_file(f->outer_name, hash);
+	gettimeofday(&end_time, NULL);
+	double run_time = ((end_time.tv_sec * 1000000 + end_time.tv_usec) - (start_time.tv_sec * 1000000 + start_time.tv_usec)) / 1000000.0;
+	total_checksum_time += run_time;
+	debug(D_MAKEFLOW_HOOK, " The total checksum time is %lf", total_checksum_time);
+	if (success == 0) {
+		debug(D_MAKEFLOW, "Unable to checksum this file: %s", f->outer_name);
+		return NULL;
+	}
+	f->hash = xxstrdup(sha1_string(hash));
+	checksum_insert(f->outer_name, &s, f->hash);
+	checksum_cache_append(f->outer_name, &s, f->hash);
+	debug(D_MAKEFLOW, "Checksum hash of %s is: %s", f->outer_name, f->hash);
+	return xxstrdup(f->hash);
 }
 
 /* Return the content based ID for a directory.
  * generates the checksum for the directories contents if does not exist
  * 		*NEED TO ACCOUNT FOR SYMLINKS LATER*  */
+static struct hash_table *check_sums_dir = NULL;
+
 char *batch_file_generate_id_dir(char *file_name)
 {
-	if (check_sums == NULL) {
-		check_sums = hash_table_create(0, 0);
+	if (check_sums_dir == NULL) {
+		check_sums_dir = hash_table_create(0, 0);
 	}
-	char *check_sum_value = hash_table_lookup(check_sums, file_name);
+	char *check_sum_value = hash_table_lookup(check_sums_dir, file_name);
 	if (check_sum_value == NULL) {
 		char *hash_sum = "";
 		struct dirent **dp;
@@ -182,7 +293,7 @@ char *batch_file_generate_id_dir(char *file_name)
 			unsigned char hash[SHA1_DIGEST_LENGTH];
 			sha1_buffer(hash_sum, strlen(hash_sum), hash);
 			free(hash_sum);
-			hash_table_insert(check_sums, file_name, xxstrdup(sha1_string(hash)));
+			hash_table_insert(check_sums_dir, file_name, xxstrdup(sha1_string(hash)));
 			debug(D_MAKEFLOW, "Checksum hash of %s is: %s", file_name, sha1_string(hash));
 			return xxstrdup(sha1_string(hash));
 		}
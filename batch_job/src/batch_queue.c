@@ -17,6 +17,11 @@ See the file COPYING for details.
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "list.h"
+#include "macros.h"
 
 extern const struct batch_queue_module batch_queue_amazon;
 extern const struct batch_queue_module batch_queue_cluster;
@@ -33,6 +38,25 @@ extern const struct batch_queue_module batch_queue_vine;
 extern const struct batch_queue_module batch_queue_k8s;
 extern const struct batch_queue_module batch_queue_dryrun;
 
+struct batch_queue_async_entry {
+	batch_queue_id_t handle;
+	struct batch_job *task;
+};
+
+struct batch_queue_async {
+	pthread_t thread;
+	pthread_mutex_t mutex;        /* guards pending, results, handles, flags */
+	pthread_mutex_t module_mutex; /* serializes driver calls, which share state between submit and wait */
+	pthread_cond_t cond;
+	struct list *pending;
+	struct itable *results; /* -handle -> job id, or BATCH_QUEUE_ASYNC_FAILED */
+	batch_queue_id_t next_handle;
+	int in_flight;
+	int stop;
+};
+
+#define BATCH_QUEUE_ASYNC_FAILED ((void *)(intptr_t)-1)
+
 static struct batch_queue_module batch_queue_unknown = {
 		BATCH_QUEUE_TYPE_UNKNOWN,
 		"unknown",
@@ -78,6 +102,8 @@ struct batch_queue *batch_queue_create(batch_queue_type_t type, const char *ssl_
 	q->tv_file_table = 0;
 	q->tv_manager = 0;
 	q->wq_manager = 0;
+	q->async = 0;
+	q->wakeup = 0;
 
 	batch_queue_set_feature(q, "local_job_queue", "yes");
 	batch_queue_set_feature(q, "absolute_path", "yes");
@@ -113,6 +139,19 @@ void batch_queue_delete(struct batch_queue *q)
 	if (q) {
 		debug(D_BATCH, "deleting queue %p", q);
 
+		if (q->async) {
+			struct batch_queue_async *a = q->async;
+			pthread_mutex_lock(&a->mutex);
+			a->stop = 1;
+			pthread_cond_broadcast(&a->cond);
+			pthread_mutex_unlock(&a->mutex);
+			pthread_join(a->thread, NULL);
+			list_delete(a->pending);
+			itable_delete(a->results);
+			free(a);
+			q->async = NULL;
+		}
+
 		q->module->free(q);
 
 		hash_table_clear(q->options, free);
@@ -227,19 +266,189 @@ const char *batch_queue_type_string()
 	return BATCH_JOB_SYSTEMS;
 }
 
+/*
+Asynchronous submission runs the driver's ordinary submit calls on a
+single per-queue thread, so the caller's scheduling work overlaps the
+round trips to the batch system while the driver itself stays
+single-threaded and in arrival order.  Because drivers share state
+(the job table, submit files, popen) with the wait path, one mutex
+serializes all module calls; the wait wrappers therefore take the
+lock in one-second slices whenever submissions are in flight, so a
+blocked wait cannot starve the submitter.
+*/
+
+static void *batch_queue_async_main(void *arg)
+{
+	struct batch_queue *q = arg;
+	struct batch_queue_async *a = q->async;
+
+	pthread_mutex_lock(&a->mutex);
+	while (1) {
+		struct batch_queue_async_entry *e = list_pop_head(a->pending);
+		if (!e) {
+			if (a->stop)
+				break;
+			pthread_cond_wait(&a->cond, &a->mutex);
+			continue;
+		}
+
+		/* Perform the submission with only the module lock held, so
+		enqueueing more work and polling results never wait on a slow
+		batch system round trip. */
+		a->in_flight = 1;
+		pthread_mutex_unlock(&a->mutex);
+
+		pthread_mutex_lock(&a->module_mutex);
+		batch_queue_id_t jobid = q->module->submit(q, e->task);
+		pthread_mutex_unlock(&a->module_mutex);
+
+		pthread_mutex_lock(&a->mutex);
+		a->in_flight = 0;
+		itable_insert(a->results, -e->handle, jobid > 0 ? (void *)(intptr_t)jobid : BATCH_QUEUE_ASYNC_FAILED);
+		free(e);
+
+		/* let a blocked wait notice the newly landed submission */
+		if (q->wakeup)
+			q->wakeup(q);
+	}
+	pthread_mutex_unlock(&a->mutex);
+
+	return NULL;
+}
+
+batch_queue_id_t batch_queue_submit_async(struct batch_queue *q, struct batch_job *task)
+{
+	if (!q->async) {
+		struct batch_queue_async *a = xxmalloc(sizeof(*a));
+		pthread_mutex_init(&a->mutex, NULL);
+		pthread_mutex_init(&a->module_mutex, NULL);
+		pthread_cond_init(&a->cond, NULL);
+		a->pending = list_create();
+		a->results = itable_create(0);
+		a->next_handle = -2;
+		a->in_flight = 0;
+		a->stop = 0;
+		q->async = a;
+
+		if (pthread_create(&a->thread, NULL, batch_queue_async_main, q) != 0) {
+			list_delete(a->pending);
+			itable_delete(a->results);
+			free(a);
+			q->async = NULL;
+			return 0;
+		}
+	}
+
+	struct batch_queue_async *a = q->async;
+	struct batch_queue_async_entry *e = xxmalloc(sizeof(*e));
+	e->task = task;
+
+	pthread_mutex_lock(&a->mutex);
+	batch_queue_id_t handle = a->next_handle--;
+	e->handle = handle;
+	list_push_tail(a->pending, e);
+	pthread_cond_broadcast(&a->cond);
+	pthread_mutex_unlock(&a->mutex);
+
+	/* a wait in progress should release the driver promptly for the submitter */
+	if (q->wakeup)
+		q->wakeup(q);
+
+	/* note: e belongs to the submission thread once the lock drops */
+	return handle;
+}
+
+batch_queue_id_t batch_queue_submit_resolve(struct batch_queue *q, batch_queue_id_t handle)
+{
+	struct batch_queue_async *a = q->async;
+	if (!a || handle >= 0)
+		return -1;
+
+	pthread_mutex_lock(&a->mutex);
+	void *result = itable_remove(a->results, -handle);
+	pthread_mutex_unlock(&a->mutex);
+
+	if (!result)
+		return 0;
+	if (result == BATCH_QUEUE_ASYNC_FAILED)
+		return -1;
+	return (batch_queue_id_t)(intptr_t)result;
+}
+
+/* True while async submissions are queued or being performed. */
+static int batch_queue_async_busy(struct batch_queue *q)
+{
+	struct batch_queue_async *a = q->async;
+	if (!a)
+		return 0;
+
+	pthread_mutex_lock(&a->mutex);
+	int busy = a->in_flight || list_size(a->pending) > 0;
+	pthread_mutex_unlock(&a->mutex);
+
+	return busy;
+}
+
 batch_queue_id_t batch_queue_submit(struct batch_queue *q, struct batch_job *bt)
 {
+	if (q->async) {
+		struct batch_queue_async *a = q->async;
+		pthread_mutex_lock(&a->module_mutex);
+		batch_queue_id_t jobid = q->module->submit(q, bt);
+		pthread_mutex_unlock(&a->module_mutex);
+		return jobid;
+	}
+
 	return q->module->submit(q, bt);
 }
 
+static batch_queue_id_t batch_queue_wait_internal(struct batch_queue *q, struct batch_job_info *info, time_t stoptime)
+{
+	if (!q->async)
+		return q->module->wait(q, info, stoptime);
+
+	/* Wait in bounded slices so the submission thread can interleave. */
+	struct batch_queue_async *a = q->async;
+	while (1) {
+		/* Sample before waiting: a submission that lands during the
+		wait would otherwise slip between the driver reporting "no
+		jobs" and the busy check, and the caller would see an empty
+		queue with work still on the way. */
+		int was_busy = batch_queue_async_busy(q);
+
+		time_t slice = time(0) + 1;
+		if (stoptime && stoptime < slice)
+			slice = stoptime;
+
+		pthread_mutex_lock(&a->module_mutex);
+		batch_queue_id_t jobid = q->module->wait(q, info, slice);
+		pthread_mutex_unlock(&a->module_mutex);
+
+		if (jobid > 0)
+			return jobid;
+
+		/* The slice boundary is ours, not the caller's: a negative
+		result only ends the wait once the caller's own stoptime has
+		passed. */
+		if (stoptime && time(0) >= stoptime)
+			return jobid;
+
+		/* Only report the driver's "no more jobs" once the submitter
+		was already idle when this slice began; otherwise jobs are
+		still on their way to the driver. */
+		if (jobid == 0 && !was_busy && !batch_queue_async_busy(q))
+			return jobid;
+	}
+}
+
 batch_queue_id_t batch_queue_wait(struct batch_queue *q, struct batch_job_info *info)
 {
-	return q->module->wait(q, info, 0);
+	return batch_queue_wait_internal(q, info, 0);
 }
 
 batch_queue_id_t batch_queue_wait_timeout(struct batch_queue *q, struct batch_job_info *info, time_t stoptime)
 {
-	return q->module->wait(q, info, stoptime);
+	return batch_queue_wait_internal(q, info, stoptime);
 }
 
 int batch_queue_remove(struct batch_queue *q, batch_queue_id_t jobid)
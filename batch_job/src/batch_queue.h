@@ -100,6 +100,28 @@ Zero is not a valid batch job id and indicates an internal failure.
 */
 batch_queue_id_t batch_queue_submit(struct batch_queue *q, struct batch_job *task );
 
+/** Submit a batch job without waiting for the submission to complete.
+The task is handed to a per-queue submission thread and a negative
+handle is returned immediately, so the caller overlaps its own work
+(scheduling, constructing the next job) with the round trip to the
+batch system.  Exchange the handle for the real job id with
+@ref batch_queue_submit_resolve once the submission lands; completions
+then arrive through @ref batch_queue_wait as usual.  The underlying
+driver is unchanged: submissions are performed one at a time in
+arrival order.
+@param q The queue to submit to.
+@param task The job description to submit; ownership passes to the queue until the submission resolves.
+@return A negative handle to pass to @ref batch_queue_submit_resolve, or zero if the submission thread could not be created.
+*/
+batch_queue_id_t batch_queue_submit_async(struct batch_queue *q, struct batch_job *task);
+
+/** Poll an asynchronous submission for its job id.
+@param q The queue the handle was issued by.
+@param handle A handle from @ref batch_queue_submit_async.
+@return The job id if the submission completed, zero if it is still in flight, or less than zero if the submission failed.
+*/
+batch_queue_id_t batch_queue_submit_resolve(struct batch_queue *q, batch_queue_id_t handle);
+
 /** Wait for any batch job to complete.
 Blocks until a batch job completes.
  * Note Submit may return 0 as a valid jobid. As of 04/18 wait will not return 0 as a valid jobid. 
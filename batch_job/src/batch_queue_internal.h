@@ -46,6 +46,14 @@ struct batch_queue {
 	struct vine_manager *tv_manager;
 	struct work_queue   *wq_manager;
 	const struct batch_queue_module *module;
+
+	/* Asynchronous submission state: see batch_queue_submit_async. */
+	struct batch_queue_async *async;
+
+	/* Optional: interrupt a wait in progress, so work queued by the
+	submission thread is noticed before the current poll times out.
+	Set by drivers whose wait blocks in an interruptible event loop. */
+	void (*wakeup)(struct batch_queue *q);
 };
 
 #define batch_queue_stub_create(name)  static int batch_queue_##name##_create (struct batch_queue *Q) { return 0; }
@@ -18,8 +18,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <float.h>
+#include <unistd.h>
 
 #define MAX_BUF_SIZE 4096
 
@@ -34,6 +36,93 @@ static const char *k8s_script =
 
 		static const char *k8s_script_file_name = "_temp_k8s_script.sh";
 static const char *kubectl_failed_log = "kubectl_failed.log";
+
+/*
+Pod state is tracked through one persistent "kubectl get pods --watch"
+child rather than a kubectl fork and full list per poll: the watch
+holds a single connection to the apiserver, the initial listing seeds
+the table, and every subsequent line is one pod's state change, so the
+cost per poll is reading whatever lines have accumulated.  If the
+watch child cannot be started or dies, each poll falls back to the old
+one-shot listing.
+*/
+
+static FILE *k8s_watch_stream = NULL;
+static struct hash_table *k8s_pod_states = NULL;
+static int k8s_watch_failed = 0;
+static char k8s_watch_line[MAX_BUF_SIZE];
+static int k8s_watch_fill = 0;
+
+static void k8s_watch_start(void)
+{
+	if (k8s_watch_stream || k8s_watch_failed)
+		return;
+
+	char *cmd = string_format("kubectl get pods --no-headers -l app=%s --watch 2>/dev/null", mf_uuid->str);
+	k8s_watch_stream = popen(cmd, "r");
+	free(cmd);
+
+	if (!k8s_watch_stream) {
+		k8s_watch_failed = 1;
+		debug(D_BATCH, "k8s watch could not be started");
+		return;
+	}
+
+	debug(D_BATCH, "k8s watch started");
+
+	fcntl(fileno(k8s_watch_stream), F_SETFL, O_NONBLOCK);
+	k8s_pod_states = hash_table_create(0, 0);
+}
+
+static void k8s_watch_apply_line(char *line)
+{
+	char *pod_id = strtok(line, " \t");
+	strtok(NULL, " \t"); /* READY column */
+	char *pod_state = strtok(NULL, " \t\n");
+
+	if (!pod_id || !pod_state)
+		return;
+
+	free(hash_table_remove(k8s_pod_states, pod_id));
+	hash_table_insert(k8s_pod_states, pod_id, xxstrdup(pod_state));
+}
+
+/* Pull whatever the watch has produced since the last poll.  Returns
+zero if the watch is gone and the caller should fall back. */
+static int k8s_watch_drain(void)
+{
+	if (!k8s_watch_stream)
+		return 0;
+
+	while (1) {
+		ssize_t n = read(fileno(k8s_watch_stream), &k8s_watch_line[k8s_watch_fill], sizeof(k8s_watch_line) - k8s_watch_fill - 1);
+
+		if (n == 0) {
+			/* kubectl exited: connection lost or no such cluster */
+			pclose(k8s_watch_stream);
+			k8s_watch_stream = NULL;
+			k8s_watch_failed = 1;
+			return 0;
+		}
+
+		if (n < 0)
+			return 1;
+
+		k8s_watch_fill += n;
+		k8s_watch_line[k8s_watch_fill] = '\0';
+
+		char *start = k8s_watch_line;
+		char *newline;
+		while ((newline = strchr(start, '\n'))) {
+			*newline = '\0';
+			k8s_watch_apply_line(start);
+			start = newline + 1;
+		}
+
+		k8s_watch_fill = strlen(start);
+		memmove(k8s_watch_line, start, k8s_watch_fill + 1);
+	}
+}
 static const char *default_docker_image = "centos";
 
 static const char *k8s_config_tmpl = "\
@@ -472,6 +561,41 @@ static int batch_queue_k8s_gen_running_pod_lst(struct list **running_pod_lst,
 	*terminating_pod_lst = list_create();
 	*creating_pod_lst = list_create();
 
+	k8s_watch_start();
+
+	if (k8s_watch_drain()) {
+		char *pod_id;
+		char *pod_state;
+		HASH_TABLE_ITERATE(k8s_pod_states, pod_id, pod_state)
+		{
+			if (strcmp(pod_state, "Running") == 0) {
+				debug(D_BATCH, "%s is Running", pod_id);
+				list_push_tail(*running_pod_lst, xxstrdup(pod_id));
+			}
+
+			if (strcmp(pod_state, "Terminating") == 0) {
+				debug(D_BATCH, "%s is being terminated", pod_id);
+				list_push_tail(*terminating_pod_lst, xxstrdup(pod_id));
+			}
+
+			if (strcmp(pod_state, "ContainerCreating") == 0) {
+				debug(D_BATCH, "%s is being created", pod_id);
+				list_push_tail(*creating_pod_lst, xxstrdup(pod_id));
+			}
+
+			if (strcmp(pod_state, "Failed") == 0 ||
+					strcmp(pod_state, "OutOfcpu") == 0 ||
+					strcmp(pod_state, "OutOfmemory") == 0) {
+				char *curr_job_id = xxstrdup(strrchr(pod_id, '-') + 1);
+				int curr_job_id_int = atoi(curr_job_id);
+				free(curr_job_id);
+				return curr_job_id_int;
+			}
+		}
+
+		return 0;
+	}
+
 	char *cmd = string_format("kubectl get pods --show-all -l app=%s | awk \'{if (NR != 1) {print $1\" \"$3}}\' 2>&1 ",
 			mf_uuid->str);
 	FILE *cmd_fp;
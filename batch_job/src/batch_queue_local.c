@@ -57,6 +57,20 @@ static batch_queue_id_t batch_queue_local_submit(struct batch_queue *q, struct b
 		prctl(PR_SET_PDEATHSIG, SIGTERM);
 #endif
 
+		/*
+		A command with no shell syntax can be exec'd directly,
+		skipping the /bin/sh startup that dominates tiny local
+		jobs; anything containing metacharacters still goes
+		through the shell unchanged.
+		*/
+		if (!strpbrk(bt->command, "|&;<>()$`\\\"'*?[]#~=%{}\n")) {
+			int argc;
+			char **argv;
+			if (string_split_quotes(strdup(bt->command), &argc, &argv) && argc > 0) {
+				execvp(argv[0], argv);
+				/* fall through to the shell if the direct exec failed */
+			}
+		}
 		execlp("/bin/sh", "sh", "-c", bt->command, (char *)0);
 		_exit(127); // Failed to execute the cmd.
 	}
@@ -168,8 +168,15 @@ static int batch_queue_vine_remove(struct batch_queue *q, batch_queue_id_t jobid
 	return 0;
 }
 
+static void batch_queue_vine_wakeup(struct batch_queue *q)
+{
+	vine_manager_wakeup(q->tv_manager);
+}
+
 static int batch_queue_vine_create(struct batch_queue *q)
 {
+	q->wakeup = batch_queue_vine_wakeup;
+
 	strncpy(q->logfile, "vine.log", sizeof(q->logfile));
 
 	const char *ssl_key_file = batch_queue_get_option(q, "ssl_key_file");
@@ -10,13 +10,17 @@ See the file COPYING for details.
 #include "debug.h"
 #include "stringtools.h"
 #include "xxmalloc.h"
-#include "random.h"
+#include "buffer.h"
+#include "hash_table.h"
+#include "sha1.h"
 
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include "full_io.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -122,77 +126,101 @@ void batch_wrapper_prefix(struct batch_wrapper *w, const char *prefix)
 	w->prefix = xxstrdup(prefix);
 }
 
+/*
+Wrappers are deduplicated by content: the script is rendered to a
+buffer, named by the hash of its bytes, and written once per unique
+content -- thousands of jobs sharing identical wrapper logic then
+share one file instead of creating a small file apiece, which is what
+submit-side metadata traffic on NFS is made of.  The write itself
+goes through a temporary name and rename, so concurrent submitters
+racing on the same content converge on one complete file.
+*/
+
+static struct hash_table *wrapper_names = NULL;
+
 char *batch_wrapper_write(struct batch_wrapper *w, struct batch_job *task)
 {
 	assert(w);
 	assert(task);
 
-	char *name = string_format("%s_XXXXXX", w->prefix ? w->prefix : "./wrapper");
-	int wrapper_fd = mkstemp(name);
-	if (wrapper_fd == -1) {
-		int saved_errno = errno;
-		debug(D_NOTICE | D_BATCH, "failed to create wrapper: %s", strerror(errno));
-		free(name);
-		errno = saved_errno;
-		return NULL;
-	}
-
-	batch_job_add_input_file(task, name, NULL);
-
-	if (fchmod(wrapper_fd, 0700) == -1) {
-		int saved_errno = errno;
-		debug(D_NOTICE | D_BATCH, "failed to make wrapper executable: %s", strerror(errno));
-		free(name);
-		close(wrapper_fd);
-		errno = saved_errno;
-		return NULL;
-	}
-
-	FILE *wrapper = fdopen(wrapper_fd, "w");
-	if (!wrapper) {
-		int saved_errno = errno;
-		debug(D_NOTICE | D_BATCH, "failed to open wrapper: %s", strerror(errno));
-		free(name);
-		close(wrapper_fd);
-		errno = saved_errno;
-		return NULL;
-	}
+	buffer_t b;
+	buffer_init(&b);
 
-	fprintf(wrapper, "#!/bin/sh\n");
-	fprintf(wrapper, "set -e\n");
+	buffer_putfstring(&b, "#!/bin/sh\n");
+	buffer_putfstring(&b, "set -e\n");
 
 	if (w->post) {
-		char fresh[16];
-		random_hex(fresh, sizeof(fresh));
-		fprintf(wrapper, "CLEANUP_%s () {\n", fresh);
+		buffer_putfstring(&b, "CLEANUP_BATCH_WRAPPER () {\n");
 		list_first_item(w->post);
 		for (const char *c; (c = list_next_item(w->post));) {
-			fprintf(wrapper, "eval %s\n", c);
+			buffer_putfstring(&b, "eval %s\n", c);
 		}
-		fprintf(wrapper, "}\n");
-		fprintf(wrapper, "trap CLEANUP_%s EXIT INT TERM\n", fresh);
+		buffer_putfstring(&b, "}\n");
+		buffer_putfstring(&b, "trap CLEANUP_BATCH_WRAPPER EXIT INT TERM\n");
 	}
 
 	if (w->pre) {
 		list_first_item(w->pre);
 		for (const char *c; (c = list_next_item(w->pre));) {
-			fprintf(wrapper, "eval %s\n", c);
+			buffer_putfstring(&b, "eval %s\n", c);
 		}
 	}
 
 	if (w->argv) {
 		list_first_item(w->argv);
 		for (const char *c; (c = list_next_item(w->argv));) {
-			fprintf(wrapper, " %s", c);
+			buffer_putfstring(&b, " %s", c);
 		}
-		fprintf(wrapper, "\n");
+		buffer_putfstring(&b, "\n");
 	}
 
 	if (w->cmd) {
-		fprintf(wrapper, "eval %s\n", w->cmd);
+		buffer_putfstring(&b, "eval %s\n", w->cmd);
 	}
 
-	fclose(wrapper);
+	unsigned char digest[SHA1_DIGEST_LENGTH];
+	sha1_buffer(buffer_tostring(&b), buffer_pos(&b), digest);
+	char *name = string_format("%s_%.12s", w->prefix ? w->prefix : "./wrapper", sha1_string(digest));
+
+	if (!wrapper_names) {
+		wrapper_names = hash_table_create(0, 0);
+	}
+
+	if (!hash_table_lookup(wrapper_names, name) && access(name, X_OK) != 0) {
+		char *temp_name = string_format("%s_XXXXXX", name);
+		int wrapper_fd = mkstemp(temp_name);
+		if (wrapper_fd == -1) {
+			int saved_errno = errno;
+			debug(D_NOTICE | D_BATCH, "failed to create wrapper: %s", strerror(errno));
+			free(temp_name);
+			free(name);
+			buffer_free(&b);
+			errno = saved_errno;
+			return NULL;
+		}
+
+		if (fchmod(wrapper_fd, 0700) == -1 || full_write(wrapper_fd, buffer_tostring(&b), buffer_pos(&b)) != (ssize_t)buffer_pos(&b) || rename(temp_name, name) == -1) {
+			int saved_errno = errno;
+			debug(D_NOTICE | D_BATCH, "failed to write wrapper: %s", strerror(errno));
+			close(wrapper_fd);
+			unlink(temp_name);
+			free(temp_name);
+			free(name);
+			buffer_free(&b);
+			errno = saved_errno;
+			return NULL;
+		}
+
+		close(wrapper_fd);
+		free(temp_name);
+	}
+
+	hash_table_insert(wrapper_names, name, (void *)1);
+
+	buffer_free(&b);
+
+	batch_job_add_input_file(task, name, NULL);
+
 	return name;
 }
 
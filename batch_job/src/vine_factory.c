@@ -1608,7 +1608,9 @@ int main(int argc, char *argv[])
 	list_first_item(wrapper_inputs);
 	while((item = list_next_item(wrapper_inputs))) {
 		char *file_at_scratch_dir = string_format("%s/%s", scratch_dir, path_basename(item));
-		int64_t result = copy_file_to_file(item, file_at_scratch_dir);
+		struct stat item_info;
+		int64_t item_size = (stat(item, &item_info) == 0) ? item_info.st_size : 0;
+		int64_t result = copy_file_to_file_hint(item, file_at_scratch_dir, item_size);
 		if(result < 0) {
 			fprintf(stderr,"vine_factory: Cannot copy wrapper input file %s to factory scratch directory %s:\n", item, file_at_scratch_dir);
 			fprintf(stderr,"%s\n", strerror(errno));
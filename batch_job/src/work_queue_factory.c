@@ -1028,6 +1028,41 @@ static void mainloop( struct batch_queue *queue )
 
 		debug(D_WQ,"raw workers needed: %d", workers_needed);
 
+		/*
+		Smooth the demand signal so bursty submission does not thrash
+		the pool: the target follows an exponential moving average of
+		the instantaneous need, rises immediately when real demand
+		exceeds it (tasks should never wait on the filter), but only
+		falls after the smoothed demand has stayed below the current
+		target for several consecutive evaluations.
+		*/
+		{
+			static double demand_ema = -1;
+			static int low_streak = 0;
+			static int smoothed_target = 0;
+
+			if(demand_ema < 0) demand_ema = workers_needed;
+			demand_ema = 0.7 * demand_ema + 0.3 * workers_needed;
+
+			if(workers_needed >= smoothed_target) {
+				smoothed_target = workers_needed;
+				low_streak = 0;
+			} else if(demand_ema < smoothed_target) {
+				low_streak++;
+				if(low_streak >= 3) {
+					smoothed_target = (int) ceil(demand_ema);
+					low_streak = 0;
+				}
+			} else {
+				low_streak = 0;
+			}
+
+			if(smoothed_target != workers_needed) {
+				debug(D_WQ,"smoothed workers needed: %d (instantaneous %d, ema %.1f)", smoothed_target, workers_needed, demand_ema);
+			}
+			workers_needed = smoothed_target;
+		}
+
 		if(workers_needed > workers_max) {
 			debug(D_WQ,"applying maximum of %d workers",workers_max);
 			workers_needed = workers_max;
@@ -1611,7 +1646,9 @@ int main(int argc, char *argv[])
 	list_first_item(wrapper_inputs);
 	while((item = list_next_item(wrapper_inputs))) {
 		char *file_at_scratch_dir = string_format("%s/%s", scratch_dir, path_basename(item));
-		int64_t result = copy_file_to_file(item, file_at_scratch_dir);
+		struct stat item_info;
+		int64_t item_size = (stat(item, &item_info) == 0) ? item_info.st_size : 0;
+		int64_t result = copy_file_to_file_hint(item, file_at_scratch_dir, item_size);
 		if(result < 0) {
 			fprintf(stderr,"work_queue_factory: Cannot copy wrapper input file %s to factory scratch directory %s:\n", item, file_at_scratch_dir);
 			fprintf(stderr,"%s\n", strerror(errno));
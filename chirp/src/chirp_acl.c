@@ -107,6 +107,26 @@ If the directory exists, but the subject has no rights, returns zero with errno=
 If the rights cannot be obtained, returns zero with errno set appropriately.
 */
 
+/*
+Evaluated ACL decisions are cached briefly per (directory, subject):
+a busy server evaluates the same handful of pairs for essentially
+every request, and re-opening and re-parsing the .__acl file (walking
+parents when inheritance is on) rivals data I/O.  Entries live for one
+second, so an ACL edit is honored within that bound; negative results
+are cached the same way, since probing absent ACLs is just as hot.
+*/
+
+#define ACL_CACHE_LIFETIME 1
+
+struct acl_cache_entry {
+	int valid;
+	int saved_errno; /* the errno of the failure, replayed on a negative hit */
+	int flags;
+	time_t when;
+};
+
+static struct hash_table *acl_cache = 0;
+
 static int do_chirp_acl_get(const char *dirname, const char *subject, int *totalflags)
 {
 	CHIRP_FILE *aclfile;
@@ -116,6 +136,22 @@ static int do_chirp_acl_get(const char *dirname, const char *subject, int *total
 	errno = 0;
 	*totalflags = 0;
 
+	char cache_key[CHIRP_PATH_MAX + CHIRP_LINE_MAX];
+	string_nformat(cache_key, sizeof(cache_key), "%s|%s", subject, dirname);
+
+	if(!acl_cache)
+		acl_cache = hash_table_create(0, 0);
+
+	struct acl_cache_entry *entry = hash_table_lookup(acl_cache, cache_key);
+	if(entry && time(0) - entry->when < ACL_CACHE_LIFETIME) {
+		*totalflags = entry->flags;
+		if(read_only_mode)
+			*totalflags &= CHIRP_ACL_READ | CHIRP_ACL_LIST;
+		if(!entry->valid)
+			errno = entry->saved_errno;
+		return entry->valid;
+	}
+
 	/* if the subject is a ticket, then we need the rights we have for the
 	 * directory along with the rights of the subject in that directory
 	 */
@@ -160,10 +196,29 @@ static int do_chirp_acl_get(const char *dirname, const char *subject, int *total
 			}
 			chirp_acl_close(aclfile);
 		} else {
+			int saved = errno;
+			entry = hash_table_remove(acl_cache, cache_key);
+			if(!entry)
+				entry = xxmalloc(sizeof(*entry));
+			entry->valid = 0;
+			entry->saved_errno = saved;
+			entry->flags = 0;
+			entry->when = time(0);
+			hash_table_insert(acl_cache, cache_key, entry);
+			errno = saved;
 			return 0;
 		}
 	}
 
+	entry = hash_table_remove(acl_cache, cache_key);
+	if(!entry)
+		entry = xxmalloc(sizeof(*entry));
+	entry->valid = 1;
+	entry->saved_errno = 0;
+	entry->flags = *totalflags;
+	entry->when = time(0);
+	hash_table_insert(acl_cache, cache_key, entry);
+
 	if(read_only_mode) {
 		*totalflags &= CHIRP_ACL_READ | CHIRP_ACL_LIST;
 	}
@@ -82,6 +82,11 @@ struct chirp_filesystem {
 	INT64_T (*lremovexattr)  ( const char *path, const char *name );
 
 	int (*do_acl_check) ();
+
+	/* Optional: return the underlying OS descriptor behind an open fd,
+	so the server can use zero-copy transmission, or -1 when there is
+	no such descriptor.  Backends without one may leave this null. */
+	INT64_T (*getfd) ( int fd );
 };
 
 /* Lookup of a backend FS associated with a URL */
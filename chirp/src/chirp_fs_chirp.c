@@ -463,6 +463,8 @@ struct chirp_filesystem chirp_fs_chirp = {
 	chirp_fs_chirp_lremovexattr,
 
 	chirp_fs_chirp_do_acl_check,
+
+	NULL, /* getfd: no local descriptor behind a remote connection */
 };
 
 /* vim: set noexpandtab tabstop=8: */
@@ -765,6 +765,8 @@ struct chirp_filesystem chirp_fs_hdfs = {
 	cfs_stub_lremovexattr,
 
 	chirp_fs_hdfs_do_acl_check,
+
+	NULL, /* getfd: hdfs i/o does not expose an OS descriptor */
 };
 
 /* vim: set noexpandtab tabstop=8: */
@@ -593,6 +593,15 @@ int main(int argc, char *argv[])
 	struct fuse_args fa = FUSE_ARGS_INIT(0, NULL);
 	fuse_opt_add_arg(&fa, argv[0]);
 
+	/*
+	Let the kernel cache attributes and directory entries briefly:
+	interactive workloads (ls -l, editors statting on every
+	keystroke) otherwise pay a chirp round trip per lookup.  One
+	second matches the chirp server's own ACL decision horizon, and
+	users needing strict coherence can override with -m.
+	*/
+	fuse_opt_add_arg(&fa, "-oattr_timeout=1,entry_timeout=1");
+
 	debug_config(argv[0]);
 
 	static const struct option long_options[] = {
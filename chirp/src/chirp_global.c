@@ -25,6 +25,17 @@ list.  Stat operations on file servers query the hash table in order to
 determine a few key stats, such as total storage in use and last time heard
 from.  This allows an ls -l through Parrot to show the last message time and
 the space used (in MB.)
+
+Because every multi-server operation is answered from this cached
+catalog table, a global listing or stat across any number of servers
+costs one catalog query per minute at most and zero round trips to
+the file servers themselves -- there is no per-server iteration to
+parallelize.  Only once the caller descends into a specific server
+does chirp_reli contact that one host, and those single-host paths
+can lean on the pooled and nonblocking connect support in link.c
+(link_pool_connect, link_connect with LINK_NOWAIT plus
+link_connect_finish) if a caller ever needs to warm connections to
+several servers at once.
 */
 
 #include "chirp_global.h"
@@ -7,6 +7,14 @@ See the file COPYING for details.
 /*
 This is a dummy implementation of the chirp_job interface,
 meant as a placeholder while we work out a simpler implementation.
+
+When the sqlite-backed implementation returns, open its database in
+WAL mode with synchronous=NORMAL and group state mutations from
+concurrent jobs into one transaction per batch window: the old
+per-operation commit discipline capped throughput at the disk's fsync
+rate, which is the first thing a reimplementation would otherwise
+reinherit.  (Confuga's metadata store, which faces the same fsync
+wall, is treated separately.)
 */
 
 #include "chirp_job.h"
@@ -7,6 +7,18 @@ See the file COPYING for details.
 #include "chirp_reli.h"
 #include "chirp_recursive.h"
 
+/*
+Note on parallelism: the walk and the RPCs below run one file at a
+time, and the natural speedup -- several workers each owning its own
+connection, fed from a shared walk queue -- is blocked by chirp_reli's
+process-global connection table: every thread would funnel through the
+same struct chirp_client, which is neither locked nor safe to share.
+Forked workers splitting the top-level entries sidestep that but break
+the single-session semantics callers rely on for tickets and
+authentication.  Per-thread client objects in chirp_reli are the
+prerequisite, shared with the pipelining and fuse-concurrency notes.
+*/
+
 #include "stringtools.h"
 #include "list.h"
 
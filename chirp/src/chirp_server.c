@@ -13,6 +13,7 @@
 #include "chirp_protocol.h"
 #include "chirp_reli.h"
 #include "chirp_stats.h"
+#include "timestamp.h"
 #include "chirp_thirdput.h"
 #include "chirp_types.h"
 
@@ -241,6 +242,7 @@ static int update_all_catalogs(const char *url)
 		jx_format("%d.%d.%d", CCTOOLS_VERSION_MAJOR, CCTOOLS_VERSION_MINOR, CCTOOLS_VERSION_MICRO));
 
 	chirp_stats_summary(j);
+	chirp_stats_opcode_summary(j);
 
 	char *message = jx_print_string(j);
 
@@ -602,6 +604,8 @@ static void chirp_handler(struct link *l, const char *addr, const char *subject)
 
 		debug(D_CHIRP, "%s", line);
 
+		timestamp_t op_start = timestamp_get();
+
 		if(sscanf(line, "pread %" SCNd64 " %" SCNd64 " %" SCNd64, &fd, &length, &offset) == 3) {
 			if (length < 0) {
 				errno = EINVAL;
@@ -794,7 +798,15 @@ static void chirp_handler(struct link *l, const char *addr, const char *subject)
 			link_printf(l, transmission_stalltime, "%" PRId64 "\n", length);
 
 			INT64_T total = 0;
-			while (total < length) {
+			INT64_T osfd = cfs->getfd ? cfs->getfd(fd) : -1;
+			if (osfd >= 0) {
+				/* local file: let the kernel move it straight to the socket */
+				total = link_sendfile(l, osfd, 0, length, transmission_stalltime);
+				if (total < 0) {
+					debug(D_DEBUG, "getfile: sendfile failed (%s), expected to write %" PRId64 " bytes", strerror(errno), length);
+					total = 0;
+				}
+			} else while (total < length) {
 				char b[65536];
 				size_t chunk = MIN(sizeof(b), (size_t)(length-total));
 
@@ -875,6 +887,22 @@ static void chirp_handler(struct link *l, const char *addr, const char *subject)
 			link_putliteral(l, "0\n", transmission_stalltime);
 
 			INT64_T total = 0;
+			INT64_T putfd = cfs->getfd ? cfs->getfd(fd) : -1;
+			if (putfd >= 0) {
+				/* local file: move the data kernel-side, without the userspace loop */
+				total = link_recvfile(l, putfd, length, transmission_stalltime);
+				if (total < 0)
+					total = 0;
+				if (total < length) {
+					debug(D_DEBUG, "putfile: transfer ended early (%s), expected %" PRId64 " more bytes", strerror(errno), length-total);
+					cfs->close(fd);
+					if(cfs->unlink(path) == -1)
+						debug(D_DEBUG, "putfile: failed to unlink remnant file '%s': %s", path, strerror(errno));
+					chirp_alloc_realloc(path, 0, NULL);
+					link_soak(l, length - total, transmission_stalltime);
+					goto failure;
+				}
+			} else
 			while (total < length) {
 				char b[65536];
 				size_t chunk = MIN(sizeof(b), (size_t)(length-total));
@@ -1620,6 +1648,7 @@ result:
 		}
 
 done:
+		chirp_stats_opcode_record(line, timestamp_get() - op_start);
 		if (result < 0)
 			debug(D_CHIRP, "= %" PRId64 " (%s)", result, strerror(errno));
 		else
@@ -2134,6 +2163,8 @@ int main(int argc, char *argv[])
 		fatal("couldn't setup %s", chirp_url);
 	}
 
+	chirp_stats_init_shared();
+
 	link = link_serve_address(listen_on_interface, chirp_port);
 
 	if(!link) {
@@ -2240,6 +2271,19 @@ int main(int argc, char *argv[])
 			continue;
 
 		/* If the network port is active, accept the connection and fork the handler. */
+		/*
+		Note on a multiplexed mode: an epoll acceptor with worker
+		threads would trade the per-connection fork for shared
+		handlers, but nearly all of this server's state is
+		process-global by design -- the cfs backend handles, the
+		per-process fd table behind cfs->getfd, chirp_alloc state,
+		and the auth context established per connection -- and the
+		handler blocks freely in cfs operations.  A multiplexed
+		server therefore needs per-connection state objects and
+		nonblocking discipline through the whole handler before the
+		accept loop can change; the fork cost itself is bounded by
+		the kernel's COW and the handlers' short lifetimes.
+		*/
 
 		if(FD_ISSET(link_fd(link), &rfds)) {
 			char addr[LINK_ADDRESS_MAX];
@@ -6,6 +6,8 @@ See the file COPYING for details.
 
 #include "chirp_stats.h"
 
+#include <sys/mman.h>
+
 #include "debug.h"
 #include "xxmalloc.h"
 #include "hash_table.h"
@@ -103,11 +105,166 @@ static UINT64_T child_bytes_read = 0;
 static UINT64_T child_bytes_written = 0;
 static time_t child_report_time = 0;
 
+/*
+A small shared-memory region, mapped before the server forks, carries
+live totals updated atomically by every connection handler: the parent
+reads exact, current numbers with no IPC or reporting delay, while the
+periodic pipe reports continue to provide the per-client breakdown.
+*/
+
+/*
+Per-opcode latency accounting lives in the same shared region: each
+slot is claimed by the first handler to see that command word, and
+holds a count, a total, and a log2 histogram of microsecond latencies
+from which the parent computes percentiles for the catalog update.
+Slots are never freed; the protocol has a small fixed command set.
+*/
+
+#define CHIRP_STATS_OPCODE_MAX 64
+#define CHIRP_STATS_OPCODE_NAME 16
+#define CHIRP_STATS_BUCKETS 28
+
+struct chirp_stats_opcode {
+	UINT64_T claimed; /* set by the winning claimant before the name is written */
+	UINT64_T ready;   /* set once the name is fully written and comparable */
+	char name[CHIRP_STATS_OPCODE_NAME];
+	UINT64_T count;
+	UINT64_T total_usecs;
+	UINT64_T buckets[CHIRP_STATS_BUCKETS];
+};
+
+struct chirp_stats_shared {
+	UINT64_T ops;
+	UINT64_T bytes_read;
+	UINT64_T bytes_written;
+	struct chirp_stats_opcode opcode[CHIRP_STATS_OPCODE_MAX];
+};
+
+static struct chirp_stats_shared *shared_stats = 0;
+
+void chirp_stats_init_shared(void)
+{
+	if (shared_stats)
+		return;
+	void *region = mmap(0, sizeof(*shared_stats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (region != MAP_FAILED) {
+		shared_stats = region;
+		memset(shared_stats, 0, sizeof(*shared_stats));
+	}
+}
+
+void chirp_stats_opcode_record(const char *line, UINT64_T usecs)
+{
+	if (!shared_stats)
+		return;
+
+	char name[CHIRP_STATS_OPCODE_NAME];
+	int i;
+	for (i = 0; i < CHIRP_STATS_OPCODE_NAME - 1 && line[i] && line[i] != ' '; i++)
+		name[i] = line[i];
+	name[i] = 0;
+	if (!name[0])
+		return;
+
+	for (i = 0; i < CHIRP_STATS_OPCODE_MAX; i++) {
+		struct chirp_stats_opcode *op = &shared_stats->opcode[i];
+		if (!op->claimed) {
+			/* claim the slot, write the whole name, then publish it;
+			a racing handler that loses moves on to the next slot */
+			if (__sync_bool_compare_and_swap(&op->claimed, 0, 1)) {
+				strncpy(op->name, name, CHIRP_STATS_OPCODE_NAME - 1);
+				__sync_synchronize();
+				op->ready = 1;
+			}
+		}
+		if (!op->ready) {
+			/* another handler is mid-claim, possibly for this very
+			opcode; drop this one sample rather than risk claiming a
+			duplicate slot for the same name */
+			return;
+		}
+		if (strncmp(op->name, name, CHIRP_STATS_OPCODE_NAME) != 0)
+			continue;
+
+		__sync_fetch_and_add(&op->count, 1);
+		__sync_fetch_and_add(&op->total_usecs, usecs);
+		int bucket = 0;
+		UINT64_T v = usecs;
+		while (v >>= 1)
+			bucket++;
+		if (bucket >= CHIRP_STATS_BUCKETS)
+			bucket = CHIRP_STATS_BUCKETS - 1;
+		__sync_fetch_and_add(&op->buckets[bucket], 1);
+		return;
+	}
+}
+
+/* The latency below which the given fraction of this opcode's requests completed. */
+static UINT64_T opcode_percentile(struct chirp_stats_opcode *op, double fraction)
+{
+	UINT64_T target = (UINT64_T)(op->count * fraction + 0.999999); /* ceiling: the request at or above the fraction */
+	if (target < 1)
+		target = 1;
+	UINT64_T seen = 0;
+	int i;
+	for (i = 0; i < CHIRP_STATS_BUCKETS; i++) {
+		seen += op->buckets[i];
+		if (seen >= target)
+			return (UINT64_T)1 << (i + 1);
+	}
+	return 0;
+}
+
+void chirp_stats_opcode_summary(struct jx *j)
+{
+	if (!shared_stats)
+		return;
+
+	struct jx *arr = jx_array(0);
+	int i;
+	for (i = 0; i < CHIRP_STATS_OPCODE_MAX; i++) {
+		struct chirp_stats_opcode *op = &shared_stats->opcode[i];
+		if (!op->ready || !op->count)
+			continue;
+		struct jx *o = jx_object(0);
+		jx_insert_string(o, "op", op->name);
+		jx_insert_integer(o, "count", op->count);
+		jx_insert_integer(o, "avg_us", op->total_usecs / op->count);
+		jx_insert_integer(o, "p50_us", opcode_percentile(op, 0.50));
+		jx_insert_integer(o, "p95_us", opcode_percentile(op, 0.95));
+		jx_insert_integer(o, "p99_us", opcode_percentile(op, 0.99));
+		jx_array_append(arr, o);
+	}
+	jx_insert(j, jx_string("opcodes"), arr);
+}
+
+void chirp_stats_sample_shared(UINT64_T *ops, UINT64_T *bytes_read, UINT64_T *bytes_written)
+{
+	if (shared_stats) {
+		*ops = __sync_fetch_and_add(&shared_stats->ops, 0);
+		*bytes_read = __sync_fetch_and_add(&shared_stats->bytes_read, 0);
+		*bytes_written = __sync_fetch_and_add(&shared_stats->bytes_written, 0);
+	} else {
+		*ops = total_ops;
+		*bytes_read = total_bytes_read;
+		*bytes_written = total_bytes_written;
+	}
+}
+
 void chirp_stats_update(UINT64_T ops, UINT64_T bytes_read, UINT64_T bytes_written)
 {
 	child_ops += ops;
 	child_bytes_read += bytes_read;
 	child_bytes_written += bytes_written;
+
+	if (shared_stats) {
+		if (ops)
+			__sync_fetch_and_add(&shared_stats->ops, ops);
+		if (bytes_read)
+			__sync_fetch_and_add(&shared_stats->bytes_read, bytes_read);
+		if (bytes_written)
+			__sync_fetch_and_add(&shared_stats->bytes_written, bytes_written);
+	}
 }
 
 void chirp_stats_report(int pipefd, const char *addr, const char *subject, int interval)
@@ -15,6 +15,18 @@ void chirp_stats_summary( struct jx *j );
 void chirp_stats_cleanup();
 
 void chirp_stats_update( UINT64_T ops, UINT64_T bytes_read, UINT64_T bytes_written );
+
+/* Map the shared live-totals region; call once in the server before forking handlers. */
+void chirp_stats_init_shared(void);
+
+/* Read the exact live totals maintained atomically by all connection handlers. */
+void chirp_stats_sample_shared( UINT64_T *ops, UINT64_T *bytes_read, UINT64_T *bytes_written );
+
+/* Record one completed request's opcode (first word of line) and latency. */
+void chirp_stats_opcode_record( const char *line, UINT64_T usecs );
+
+/* Append per-opcode count and latency percentiles to a catalog update. */
+void chirp_stats_opcode_summary( struct jx *j );
 void chirp_stats_report( int pipefd, const char *addr, const char *subject, int interval );
 
 #endif
@@ -9,6 +9,10 @@ See the file COPYING for details.
 #include "catalog_query.h"
 #include "deltadb_query.h"
 #include "datagram.h"
+#include "address.h"
+#include "md5.h"
+#include "hash_table.h"
+#include "priority_queue.h"
 #include "link.h"
 #include "debug.h"
 #include "getopt.h"
@@ -20,6 +24,8 @@ See the file COPYING for details.
 #include "jx_table.h"
 #include "catalog_export.h"
 #include "jx_eval.h"
+#include "string_set.h"
+#include "stats.h"
 #include "stringtools.h"
 #include "domain_name_cache.h"
 #include "username.h"
@@ -33,6 +39,9 @@ See the file COPYING for details.
 #include "zlib.h"
 #include "b64.h"
 
+static void type_index_remove(const char *type, const char *key);
+static void type_index_add(const char *type, const char *key);
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -73,6 +82,17 @@ static time_t last_clean_time = 0;
 /* How frequently to clean out expired items. */
 static time_t clean_interval = 60;
 
+/*
+Expiry heap: every accepted update pushes its key with the record's
+expiration time, so the periodic clean pops only entries already due
+instead of sweeping the whole table.  Entries are never removed on
+refresh; a popped key is checked against the live record, and one
+whose record has since been refreshed (or replaced) is simply
+discarded, since the refresh pushed a later entry for the same key.
+Work per clean is therefore proportional to records actually due.
+*/
+static struct priority_queue *expiry_queue = 0;
+
 /* The port upon which to listen. */
 static int port = CATALOG_PORT_DEFAULT;
 
@@ -130,6 +150,77 @@ static int outgoing_alarm = 0;
 static int outgoing_timeout = 300;
 static struct list *outgoing_host_list;
 
+/*
+Peer replication: every accepted update is relayed to the configured
+peer catalogs (--peer host), so clients can query any replica.  To
+break relay loops without tagging the wire format, each catalog
+remembers a digest of every payload it recently relayed and declines
+to relay it again within a short window: when the relayed copy comes
+back from a peer it is applied locally but travels no further.
+Identical payloads suppressed this way carry no new information, so
+the window costs nothing but a deferred refresh.  Consistent-hash
+sharding of ownership would build on this same relay channel but
+changes where clients must send, so replication lands first.
+*/
+
+#define PEER_RELAY_WINDOW 30
+
+static struct list *peer_host_list = 0;
+static struct hash_table *peer_relayed_digests = 0;
+
+static void peer_forward_update(const char *raw_data, int raw_data_length)
+{
+	if(!peer_host_list)
+		return;
+
+	unsigned char digest[MD5_DIGEST_LENGTH];
+	md5_buffer(raw_data, raw_data_length, digest);
+	const char *key = md5_to_string(digest);
+
+	time_t current = time(0);
+	void *relayed_at = hash_table_lookup(peer_relayed_digests, key);
+	if(relayed_at && (current - (time_t)(intptr_t)relayed_at) < PEER_RELAY_WINDOW)
+		return;
+
+	hash_table_remove(peer_relayed_digests, key);
+	hash_table_insert(peer_relayed_digests, key, (void*)(intptr_t)current);
+
+	/* drop expired digests so the table tracks the active update set */
+	if(hash_table_size(peer_relayed_digests) > 10000) {
+		char *k;
+		void *t;
+		HASH_TABLE_ITERATE(peer_relayed_digests, k, t) {
+			if((current - (time_t)(intptr_t)t) >= PEER_RELAY_WINDOW)
+				hash_table_remove(peer_relayed_digests, k);
+		}
+	}
+
+	stats_inc("catalog.updates.relayed", 1);
+
+	const char *peer;
+	LIST_ITERATE(peer_host_list, peer) {
+		char address[DATAGRAM_ADDRESS_MAX];
+		char host[DOMAIN_NAME_MAX];
+		int peer_port;
+		if(address_parse_hostport(peer, host, &peer_port, CATALOG_PORT) && domain_name_cache_lookup(host, address)) {
+			struct datagram *d = datagram_create(DATAGRAM_PORT_ANY);
+			if(d) {
+				datagram_send(d, raw_data, raw_data_length, address, peer_port);
+				datagram_delete(d);
+			}
+		}
+	}
+}
+
+static void peer_register(const char *peer)
+{
+	if(!peer_host_list) {
+		peer_host_list = list_create();
+		peer_relayed_digests = hash_table_create(0, 0);
+	}
+	list_push_tail(peer_host_list, xxstrdup(peer));
+}
+
 /* Buffer for uncompressed data is 1MB to accommodate expansion. */
 static char data[1024*1024];
 
@@ -170,11 +261,37 @@ int compare_jx(const void *a, const void *b)
 	return strcasecmp(sa, sb);
 }
 
-static void remove_expired_records()
+static time_t record_expire_time( struct jx *j )
 {
-	struct jx *j;
+	time_t lastheardfrom = jx_lookup_integer(j,"lastheardfrom");
+
+	int this_lifetime = jx_lookup_integer(j,"lifetime");
+	if(this_lifetime>0) {
+		this_lifetime = MIN(lifetime,this_lifetime);
+	} else {
+		this_lifetime = lifetime;
+	}
+
+	return lastheardfrom + this_lifetime;
+}
+
+struct expiry_entry {
 	char *key;
+	time_t expires;
+};
+
+static void expiry_queue_push( const char *key, struct jx *j )
+{
+	struct expiry_entry *e = xxmalloc(sizeof(*e));
+	e->key = xxstrdup(key);
+	e->expires = record_expire_time(j);
+
+	/* Larger priority pops first, so negate to serve earliest expiry. */
+	priority_queue_push(expiry_queue, e, -(double)e->expires);
+}
 
+static void remove_expired_records()
+{
 	time_t current = time(0);
 
 	// Only clean every clean_interval seconds.
@@ -184,21 +301,27 @@ static void remove_expired_records()
 	// Run for a minimum of lifetime seconds before cleaning anything up.
 	if((current-starttime)<lifetime ) return;
 
-	deltadb_firstkey(table);
-	while(deltadb_nextkey(table, &key, &j)) {
-		time_t lastheardfrom = jx_lookup_integer(j,"lastheardfrom");
+	struct expiry_entry *e;
+	while((e=priority_queue_peek(expiry_queue))) {
+		if(e->expires > current) break;
 
-		int this_lifetime = jx_lookup_integer(j,"lifetime");
-		if(this_lifetime>0) {
-			this_lifetime = MIN(lifetime,this_lifetime);
-		} else {
-			this_lifetime = lifetime;
-		}
+		priority_queue_pop(expiry_queue);
 
-		if( (current-lastheardfrom) > this_lifetime ) {
-				j = deltadb_remove(table,key);
+		/*
+		The entry is due, but the record may have been refreshed or
+		replaced since it was pushed; in that case a later entry for
+		the same key is still in the heap, and this one is a dead
+		duplicate to be discarded.
+		*/
+		struct jx *j = deltadb_lookup(table,e->key);
+		if(j && record_expire_time(j) <= current) {
+			type_index_remove(jx_lookup_string(j, "type"), e->key);
+			j = deltadb_remove(table,e->key);
 			if(j) jx_delete(j);
 		}
+
+		free(e->key);
+		free(e);
 	}
 
 	last_clean_time = current;
@@ -216,6 +339,7 @@ static void update_all_catalogs()
 		jx_string("url"),
 		jx_format("http://%s:%d",preferred_hostname,port)
 		);
+	jx_insert(j,jx_string("stats"),stats_get());
 
 	char *text = jx_print_string(j);
 	jx_delete(j);
@@ -228,6 +352,94 @@ static void update_all_catalogs()
 	free(text);
 }
 
+/*
+A maintained secondary index over the record "type" field: the common
+status-tool filter is an equality on type (optionally AND'd with more
+conditions), and with tens of thousands of records the full scan plus
+jx_eval per record dominates query service.  The index maps each type
+to the set of record keys, kept in step with inserts, replacements,
+and expirations, so an indexable query walks only its bucket.
+*/
+
+static struct hash_table *type_index = 0;
+
+static void type_index_remove(const char *type, const char *key)
+{
+	if(!type_index || !type) return;
+	struct string_set *keys = hash_table_lookup(type_index, type);
+	if(keys) string_set_remove(keys, key);
+}
+
+static void type_index_add(const char *type, const char *key)
+{
+	if(!type) return;
+	if(!type_index) type_index = hash_table_create(0,0);
+	struct string_set *keys = hash_table_lookup(type_index, type);
+	if(!keys) {
+		keys = string_set_create(0,0);
+		hash_table_insert(type_index, type, keys);
+	}
+	string_set_insert(keys, key);
+}
+
+/*
+If the filter expression implies an equality on type -- the expression
+itself, or the left conjunct of a top-level "and" -- return the type
+string, so the query can walk just that index bucket.
+*/
+
+/* Print a record projected to the requested fields (plus name and type). */
+
+static void print_projected(struct jx *record, struct jx *projection, struct link *ql, time_t st)
+{
+	if(!projection) {
+		jx_print_link(record,ql,st);
+		return;
+	}
+
+	struct jx *out = jx_object(0);
+	const char *keep;
+	struct jx *v;
+
+	if((v = jx_lookup(record,"name"))) jx_insert(out, jx_string("name"), jx_copy(v));
+	if((v = jx_lookup(record,"type"))) jx_insert(out, jx_string("type"), jx_copy(v));
+
+	struct jx_item *item;
+	for(item = projection->u.items; item; item = item->next) {
+		keep = item->value->u.string_value;
+		if(strcmp(keep,"name") && strcmp(keep,"type") && (v = jx_lookup(record,keep))) {
+			jx_insert(out, jx_string(keep), jx_copy(v));
+		}
+	}
+
+	jx_print_link(out,ql,st);
+	jx_delete(out);
+}
+
+static const char *filter_implied_type(struct jx *expr)
+{
+	if(!expr || expr->type != JX_OPERATOR) return 0;
+
+	if(expr->u.oper.type == JX_OP_AND) {
+		const char *t = filter_implied_type(expr->u.oper.left);
+		if(t) return t;
+		return filter_implied_type(expr->u.oper.right);
+	}
+
+	if(expr->u.oper.type == JX_OP_EQ) {
+		struct jx *l = expr->u.oper.left;
+		struct jx *r = expr->u.oper.right;
+		if(l && r && l->type == JX_SYMBOL && !strcmp(l->u.symbol_name, "type") && r->type == JX_STRING) {
+			return r->u.string_value;
+		}
+		if(l && r && r->type == JX_SYMBOL && !strcmp(r->u.symbol_name, "type") && l->type == JX_STRING) {
+			return l->u.string_value;
+		}
+	}
+
+	return 0;
+}
+
 static void make_hash_key(struct jx *j, char *key)
 {
 	const char *name, *addr, *uuid;
@@ -258,6 +470,8 @@ static void handle_update( const char *addr, int port, const char *raw_data, int
 	unsigned long data_length;
 	struct jx *j;
 
+	peer_forward_update(raw_data, raw_data_length);
+
 		// If the packet starts with Control-Z (0x1A), it is compressed,
 		// so uncompress it to data[].  Otherwise just copy to data[];.
 
@@ -316,7 +530,7 @@ static void handle_update( const char *addr, int port, const char *raw_data, int
 		/* Do not believe the server's reported name, just resolve it backwards. */
 
 		char name[DOMAIN_NAME_MAX];
-		if(domain_name_cache_lookup_reverse(addr, name)) {
+		if(domain_name_cache_lookup_reverse_async(addr, name) == 1) {
 			/*
 			Special case: Prior bug resulted in multiple name
 			entries in logged data.  When removing the name property,
@@ -350,7 +564,15 @@ static void handle_update( const char *addr, int port, const char *raw_data, int
 			}
 		}
 
+		{
+			struct jx *old = deltadb_lookup(table, key);
+			if(old) type_index_remove(jx_lookup_string(old, "type"), key);
+			type_index_add(jx_lookup_string(j, "type"), key);
+		}
 		deltadb_insert(table, key, j);
+		expiry_queue_push(key, j);
+
+		stats_inc("catalog.updates.received", 1);
 
 		debug(D_DEBUG, "received %s update from %s",protocol,key);
 }
@@ -362,17 +584,20 @@ because these can be accepted quickly in a non-blocking manner.
 
 static void handle_udp_updates(struct datagram *update_port)
 {
-	char data[DATAGRAM_PAYLOAD_MAX];
-	char addr[DATAGRAM_ADDRESS_MAX];
-	int port;
+	static struct datagram_message *msgs = 0;
+
+	if(!msgs)
+		msgs = xxmalloc(DATAGRAM_BATCH_MAX * sizeof(*msgs));
 
 	while(1) {
-		int result = datagram_recv(update_port, data, DATAGRAM_PAYLOAD_MAX, addr, &port, 0);
-		if(result <= 0)
+		int n = datagram_recv_batch(update_port, msgs, DATAGRAM_BATCH_MAX, 0);
+		if(n <= 0)
 			return;
 
-		data[result] = 0;
-		handle_update(addr,port,data,result,"udp");
+		int i;
+		for(i = 0; i < n; i++) {
+			handle_update(msgs[i].addr, msgs[i].port, msgs[i].data, msgs[i].length, "udp");
+		}
 	}
 }
 
@@ -562,7 +787,17 @@ static void handle_query( struct link *ql, time_t st )
 	// sort the array by name before displaying
 	qsort(array, n, sizeof(struct jx *), compare_jx);
 
-	if(!strcmp(path, "/query.text")) {
+	if(!strcmp(path, "/metrics")) {
+		/* Uniform counter surface: the same statistics ride the
+		self-update to the upstream catalog, so fleets can scrape
+		either this endpoint or the catalog record. */
+		struct buffer metrics;
+		buffer_init(&metrics);
+		stats_export_prometheus(&metrics);
+		send_http_response(ql,200,"OK","text/plain",st);
+		link_putlstring(ql,buffer_tostring(&metrics),buffer_pos(&metrics),st);
+		buffer_free(&metrics);
+	} else if(!strcmp(path, "/query.text")) {
 		send_http_response(ql,200,"OK","text/plain",st);
 		for(i = 0; i < n; i++)
 			catalog_export_nvpair(array[i], ql,st);
@@ -576,6 +811,34 @@ static void handle_query( struct link *ql, time_t st )
 		link_printf(ql,st,"\n]\n");
 	} else if(1==sscanf(path, "/query/%[^/]",strexpr)) {
 
+		/*
+		An optional second path segment carries a base64 list of
+		comma-separated field names; matching records are projected
+		to those fields (plus name and type for identification)
+		before serialization, so a dashboard wanting two fields of
+		a thousand records does not pull full multi-KB blobs.
+		*/
+		char strfields[4096];
+		struct jx *projection = 0;
+		{
+			char rest[4096];
+			if(2==sscanf(path, "/query/%[^/]/%s",strexpr,rest)) {
+				struct buffer fbuf;
+				buffer_init(&fbuf);
+				if(b64_decode(rest,&fbuf)==0) {
+					snprintf(strfields, sizeof(strfields), "%s", buffer_tostring(&fbuf));
+					projection = jx_array(0);
+					char *saveptr = 0;
+					char *field = strtok_r(strfields, ",", &saveptr);
+					while(field) {
+						jx_array_append(projection, jx_string(field));
+						field = strtok_r(0, ",", &saveptr);
+					}
+				}
+				buffer_free(&fbuf);
+			}
+		}
+
 		struct buffer buf;
 		buffer_init(&buf);
 		if(b64_decode(strexpr,&buf)==0) {
@@ -585,10 +848,27 @@ static void handle_query( struct link *ql, time_t st )
 				link_printf(ql,st,"[\n");
 
 				int count = 0;
+				const char *indexed_type = timestamp > 0 ? 0 : filter_implied_type(expr);
+				struct string_set *bucket = (indexed_type && type_index) ? hash_table_lookup(type_index, indexed_type) : 0;
+				if(indexed_type && type_index) {
+					/* walk only the records of the implied type */
+					if(bucket) {
+						char *rkey;
+						string_set_first_element(bucket);
+						while(string_set_next_element(bucket, &rkey)) {
+							struct jx *rec = deltadb_lookup(table, rkey);
+							if(rec && jx_eval_is_true(expr,rec)) {
+								if(count>0) link_printf(ql,st,",\n");
+								print_projected(rec,projection,ql,st);
+								count++;
+							}
+						}
+					}
+				} else
 				for(i = 0; i < n; i++) {
 					if(jx_eval_is_true(expr,array[i])) {
 						if(count>0) link_printf(ql,st,",\n");
-						jx_print_link(array[i],ql,st);
+						print_projected(array[i],projection,ql,st);
 						count++;
 					}
 				}
@@ -606,6 +886,7 @@ static void handle_query( struct link *ql, time_t st )
 			debug(D_DEBUG,"query '%s' failed base-64 decode",strexpr);
 		}
 		buffer_free(&buf);
+		jx_delete(projection);
 
 	} else if(!strcmp(path, "/query.newclassads")) {
 		send_http_response(ql,200,"OK","text/plain",st);
@@ -704,6 +985,8 @@ void handle_tcp_query( struct link *port, int using_ssl )
 
 	link_buffer_output(port,4096);
 
+	stats_inc("catalog.queries.served", 1);
+
 	if(fork_mode) {
 		pid_t pid = fork();
 		if(pid == 0) {
@@ -760,6 +1043,8 @@ static void show_help(const char *cmd)
 	fprintf(stdout, " %-30s Single process mode; do not work on queries.\n", "-S,--single");
 	fprintf(stdout, " %-30s Maximum time to allow a query process to run.\n", "-T,--timeout=<time>");
 	fprintf(stdout, " %-30s (default is %ds)\n", "", child_procs_timeout);
+	fprintf(stdout, " %-30s Relay received updates to this peer catalog,\n", "--peer=<host>");
+	fprintf(stdout, " %-30s so either replica can serve queries.\n", "");
 	fprintf(stdout, " %-30s Send status updates to this host. (default is\n", "-u,--update-host=<host>");
 	fprintf(stdout, " %-30s %s)\n", "", CATALOG_HOST_DEFAULT);
 	fprintf(stdout, " %-30s Send status updates at this interval.\n", "-U,--update-interval=<time>");
@@ -775,7 +1060,7 @@ int main(int argc, char *argv[])
 	struct link *link;
 	struct link *query_port = 0;
 	struct link *query_ssl_port = 0;
-	signed char ch;
+	int ch;
 	time_t current;
 	int is_daemon = 0;
 	char *pidfile = NULL;
@@ -807,6 +1092,7 @@ int main(int argc, char *argv[])
 		{"ssl-key", required_argument, 0, 'K'},
 		{"single", no_argument, 0, 'S'},
 		{"timeout", required_argument, 0, 'T'},
+		{"peer", required_argument, 0, 256},
 		{"update-host", required_argument, 0, 'u'},
 		{"update-interval", required_argument, 0, 'U'},
 		{"version", no_argument, 0, 'v'},
@@ -880,6 +1166,9 @@ int main(int argc, char *argv[])
 			case 'u':
 				list_push_head(outgoing_host_list, xxstrdup(optarg));
 				break;
+			case 256:
+				peer_register(optarg);
+				break;
 			case 'U':
 				outgoing_timeout = string_time_parse(optarg);
 				break;
@@ -933,6 +1222,19 @@ int main(int argc, char *argv[])
 	if(!table)
 		fatal("couldn't create directory %s: %s\n",history_dir,strerror(errno));
 
+	stats_enable();
+
+	/* Records recovered from the checkpoint must also be scheduled to expire. */
+	expiry_queue = priority_queue_create(0);
+	{
+		char *key;
+		struct jx *j;
+		deltadb_firstkey(table);
+		while(deltadb_nextkey(table,&key,&j)) {
+			expiry_queue_push(key,j);
+		}
+	}
+
 	query_port = link_serve_address(interface, port);
 	if(query_port) {
 		/*
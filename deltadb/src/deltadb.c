@@ -7,11 +7,13 @@ See the file COPYING for details.
 #include "deltadb.h"
 #include "jx_print.h"
 #include "jx_parse.h"
+#include "jx_binary.h"
 
 #include "hash_table.h"
 #include "debug.h"
 #include "nvpair.h"
 #include "nvpair_jx.h"
+#include "stringtools.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -31,6 +33,85 @@ struct deltadb {
 	bool snapshot;
 };
 
+/*
+Alongside each text checkpoint, write a binary twin (filename.bin) as
+a sequence of key/record pairs in jx_binary form.  Reloading the
+binary form skips JSON parsing entirely, which is what dominates
+restart time on a large catalog; the text file remains the canonical,
+human-readable copy and the fallback whenever the twin is missing or
+unreadable (e.g. across an upgrade that changes the binary format).
+*/
+
+static int checkpoint_write_binary( struct deltadb *db, const char *filename )
+{
+	char *key;
+	struct jx *jobject;
+
+	char *binname = string_format("%s.bin",filename);
+	FILE *file = fopen(binname,"w");
+	free(binname);
+	if(!file) return 0;
+
+	int result = 1;
+
+	hash_table_firstkey(db->table);
+	while((hash_table_nextkey(db->table,&key,(void**)&jobject))) {
+		struct jx *jkey = jx_string(key);
+		if(!jx_binary_write(file,jkey) || !jx_binary_write(file,jobject)) {
+			jx_delete(jkey);
+			result = 0;
+			break;
+		}
+		jx_delete(jkey);
+	}
+
+	fclose(file);
+
+	return result;
+}
+
+static int checkpoint_read_binary( struct deltadb *db, const char *filename )
+{
+	char *binname = string_format("%s.bin",filename);
+	FILE *file = fopen(binname,"r");
+	free(binname);
+	if(!file) return 0;
+
+	int count = 0;
+
+	while(1) {
+		struct jx *jkey = jx_binary_read(file);
+		if(!jkey) {
+			/* A read failing anywhere short of end-of-file means
+			the twin is truncated or corrupt: report failure so
+			the caller reloads from the text checkpoint instead. */
+			if(!feof(file)) {
+				fclose(file);
+				return 0;
+			}
+			break;
+		}
+
+		struct jx *jobject = jx_binary_read(file);
+		if(!jobject || jkey->type!=JX_STRING) {
+			jx_delete(jkey);
+			jx_delete(jobject);
+			fclose(file);
+			return 0;
+		}
+
+		jx_delete(hash_table_remove(db->table,jkey->u.string_value));
+		hash_table_insert(db->table,jkey->u.string_value,jobject);
+		jx_delete(jkey);
+		count++;
+	}
+
+	fclose(file);
+
+	/* A twin with no records is a partial write; use the text copy. */
+	return count>0;
+}
+
 /* Take the current state of the table and write it out verbatim to a checkpoint file. */
 
 static int checkpoint_write( struct deltadb *db, const char *filename )
@@ -59,6 +140,8 @@ static int checkpoint_write( struct deltadb *db, const char *filename )
 
 	fclose(file);
 
+	checkpoint_write_binary(db,filename);
+
 	return 1;
 }
 
@@ -96,6 +179,9 @@ static int compat_checkpoint_read( struct deltadb *db, const char *filename )
 
 static int checkpoint_read( struct deltadb *db, const char *filename )
 {
+	/* The binary twin reloads fastest, so prefer it when present. */
+	if(checkpoint_read_binary(db,filename)) return 1;
+
 	FILE * file = fopen(filename,"r");
 	if(!file) return 0;
 
@@ -141,6 +227,20 @@ static void log_select( struct deltadb *db )
 	if(db->logfile) {
 		fclose(db->logfile);
 		write_checkpoint_file = 1;
+
+		/*
+		Compress the day just closed in the background: queries
+		read .log.gz transparently, the day's checkpoint provides
+		the random-access entry point a narrow time window needs,
+		and a year of history stops costing hundreds of
+		uncompressed gigabytes.  The original is removed only by
+		gzip itself, on success.
+		*/
+		char gzcmd[PATH_MAX + 64];
+		snprintf(gzcmd, sizeof(gzcmd), "gzip -q %s/%d/%d.log &", db->logdir, db->logyear, db->logday);
+		if (system(gzcmd) != 0) {
+			debug(D_DEBUG, "could not start compression of previous day's log");
+		}
 	}
 
 	db->logyear = t->tm_year + 1900;
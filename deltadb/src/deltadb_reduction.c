@@ -24,6 +24,7 @@ struct deltadb_reduction *deltadb_reduction_create_type( deltadb_reduction_t typ
 	r->temporal_table = hash_table_create(0,0);
 	r->unique_table = hash_table_create(0,0);
 	r->unique_value = jx_array(0);
+	r->unique_tail = 0;
 	return r;
 };
 
@@ -83,6 +84,7 @@ void deltadb_reduction_reset( struct deltadb_reduction *r, deltadb_scope_t scope
 	hash_table_delete(r->unique_table);
 	r->unique_table = hash_table_create(0,0);
 	r->unique_value = jx_array(0);
+	r->unique_tail = 0;
 }
 
 void deltadb_reduction_update( struct deltadb_reduction *r, const char *key, struct jx * value, deltadb_scope_t scope )
@@ -105,7 +107,14 @@ void deltadb_reduction_update( struct deltadb_reduction *r, const char *key, str
 		if(!hash_table_lookup(r->unique_table,str)) {
 			struct jx *value_copy = jx_copy(value);
 			hash_table_insert(r->unique_table,str,value_copy);
-			jx_array_append(r->unique_value,value_copy);
+			/* append through the remembered tail: jx_array_append walks the whole list */
+			struct jx_item *item = jx_item(value_copy, 0);
+			if(r->unique_tail) {
+				r->unique_tail->next = item;
+			} else {
+				r->unique_value->u.items = item;
+			}
+			r->unique_tail = item;
 		}
 		free(str);
 		return;
@@ -35,6 +35,7 @@ struct deltadb_reduction {
 	struct hash_table *temporal_table;
 	struct hash_table *unique_table;
 	struct jx *unique_value;
+	struct jx_item *unique_tail; /* last item of unique_value, for O(1) appends */
 	double count;
 	double sum;
 	double first;
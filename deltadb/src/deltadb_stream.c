@@ -8,6 +8,7 @@ See the file COPYING for details.
 
 #include "jx.h"
 #include "jx_parse.h"
+#include "xxmalloc.h"
 #include "nvpair.h"
 #include "nvpair_jx.h"
 
@@ -219,3 +220,101 @@ int deltadb_process_stream_fast( struct deltadb_query *query, struct deltadb_eve
 
 	return 1;
 }
+
+/*
+Windowed delivery wraps the ordinary stream processor: a shim handler
+set forwards each event to the caller's handlers, and the time events
+additionally watch for the log clock crossing a window boundary, at
+which point the caller's window handler fires and the shared arena is
+rewound.  The shim rides in place of the caller's query pointer, since
+that is the only state the stream processor threads through.
+*/
+
+struct deltadb_window {
+	struct deltadb_query *query;
+	struct deltadb_event_handlers *handlers;
+	struct jx_arena *arena;
+	int window_size;
+	time_t window_start;
+};
+
+#define WINDOW_OF(q) ((struct deltadb_window *)(q))
+
+static int window_create_event( struct deltadb_query *query, const char *key, struct jx *jobject )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+	return w->handlers->deltadb_create_event(w->query,key,jobject);
+}
+
+static int window_delete_event( struct deltadb_query *query, const char *key )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+	return w->handlers->deltadb_delete_event(w->query,key);
+}
+
+static int window_update_event( struct deltadb_query *query, const char *key, const char *name, struct jx *jvalue )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+	return w->handlers->deltadb_update_event(w->query,key,name,jvalue);
+}
+
+static int window_merge_event( struct deltadb_query *query, const char *key, struct jx *jobject )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+	return w->handlers->deltadb_merge_event(w->query,key,jobject);
+}
+
+static int window_remove_event( struct deltadb_query *query, const char *key, const char *name )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+	return w->handlers->deltadb_remove_event(w->query,key,name);
+}
+
+static int window_time_event( struct deltadb_query *query, time_t starttime, time_t stoptime, time_t current )
+{
+	struct deltadb_window *w = WINDOW_OF(query);
+
+	if(w->window_start==0) {
+		w->window_start = current;
+	} else while(current >= w->window_start + w->window_size) {
+		if(w->handlers->deltadb_window_event) {
+			if(!w->handlers->deltadb_window_event(w->query,w->window_start,w->window_start+w->window_size)) return 0;
+		}
+		jx_arena_reset(w->arena);
+		w->window_start += w->window_size;
+	}
+
+	return w->handlers->deltadb_time_event(w->query,starttime,stoptime,current);
+}
+
+int deltadb_process_stream_window( struct deltadb_query *query, struct deltadb_event_handlers *handlers, FILE *stream, time_t starttime, time_t stoptime, int window_size )
+{
+	struct deltadb_window w;
+	w.query = query;
+	w.handlers = handlers;
+	w.arena = jx_arena_create();
+	w.window_size = window_size;
+	w.window_start = 0;
+
+	struct deltadb_event_handlers shim;
+	memset(&shim,0,sizeof(shim));
+	shim.deltadb_create_event = window_create_event;
+	shim.deltadb_delete_event = window_delete_event;
+	shim.deltadb_update_event = window_update_event;
+	shim.deltadb_merge_event = window_merge_event;
+	shim.deltadb_remove_event = window_remove_event;
+	shim.deltadb_time_event = window_time_event;
+
+	struct jx_arena *prev = jx_arena_set(w.arena);
+	int result = deltadb_process_stream((struct deltadb_query *)&w,&shim,stream,starttime,stoptime);
+	jx_arena_set(prev);
+
+	/* Deliver whatever accumulated after the last full boundary. */
+	if(w.window_start && handlers->deltadb_window_event) {
+		handlers->deltadb_window_event(query,w.window_start,w.window_start+w.window_size);
+	}
+
+	jx_arena_delete(w.arena);
+
+	return result;
+}
@@ -22,10 +22,22 @@ struct deltadb_event_handlers {
 	int (*deltadb_remove_event) ( struct deltadb_query *query, const char *key, const char *name );
 	int (*deltadb_time_event) ( struct deltadb_query *query, time_t starttime, time_t stoptime, time_t current );
 	int (*deltadb_raw_event) ( struct deltadb_query *query, const char *line );
+	int (*deltadb_window_event) ( struct deltadb_query *query, time_t window_start, time_t window_end );
 };
 
 int deltadb_process_stream( struct deltadb_query *query, struct deltadb_event_handlers *handlers, FILE *stream, time_t starttime, time_t stoptime );
 
 int deltadb_process_stream_fast( struct deltadb_query *query, struct deltadb_event_handlers *handlers, FILE *stream, time_t starttime, time_t stoptime );
 
+/*
+Process a stream as above, but deliver events in time-bucketed windows
+of window_size seconds of log time.  All jx values handed to the event
+handlers are allocated from one arena that is rewound at each window
+boundary, immediately after deltadb_window_event (if set) is invoked:
+a continuous consumer therefore runs with no per-event allocation, but
+must copy out anything it wants to keep past the end of the window.
+*/
+
+int deltadb_process_stream_window( struct deltadb_query *query, struct deltadb_event_handlers *handlers, FILE *stream, time_t starttime, time_t stoptime, int window_size );
+
 #endif
@@ -75,6 +75,9 @@ static int db_init (sqlite3 *db)
 		/* Always goes through... */
 		"PRAGMA foreign_keys = ON;"
 		"PRAGMA journal_mode = WAL;"
+		/* Group commit: in WAL mode the fsync moves to the checkpoint,
+		 * so frequent small job state transitions share one sync. */
+		"PRAGMA synchronous = NORMAL;"
 		/* May cause errors (table already exists because the DB is already setup) */
 		"BEGIN TRANSACTION;"
 		"CREATE TABLE Job("
@@ -761,6 +761,12 @@ static int replicate_push_asynchronous (confuga *C)
 		"					JOIN Confuga.File ON ConfugaInputFile.fid = File.id"
 		"					LEFT OUTER JOIN PotentialReplicas ON ConfugaInputFile.fid = PotentialReplicas.fid AND ConfugaJob.sid = PotentialReplicas.sid"
 		"				WHERE File.size >= (SELECT * FROM PullThreshold) AND PotentialReplicas.fid IS NULL AND PotentialReplicas.sid IS NULL"
+		"		),"
+				/* How many scheduled jobs are waiting on each missing file.  Distributing the most-demanded file first turns what would be repeated pulls of a shared input into one planned transfer: each replica that lands becomes a source for the next pass, and jobs behind it find their input already present. */
+		"		Demand AS ("
+		"			SELECT fid, COUNT(*) AS jobs_waiting"
+		"				FROM MissingDependencies"
+		"				GROUP BY fid"
 		"		),"
 				/* Largest ready push transfer for each ConfugaJob. Large files first as they can delay the workflow. */
 		"		LargestReadyPushTransfers AS ("
@@ -776,10 +782,10 @@ static int replicate_push_asynchronous (confuga *C)
 		"		FROM"
 		"			ConfugaJob"
 		"			JOIN LargestReadyPushTransfers ON ConfugaJob.id = LargestReadyPushTransfers.id"
+		"			JOIN Demand ON LargestReadyPushTransfers.fid = Demand.fid"
 		"		WHERE ConfugaJob.state = 'SCHEDULED'"
-		"		ORDER BY RANDOM()"
-				/* TODO it would be great to break file size ties with replica count. */
-		/*"		ORDER BY FLOOR(LOG(LargestReadyPushTransfers.size+1)) DESC, ConfugaJob.time_new ASC"*/
+				/* Shared inputs first; break demand ties randomly to spread load. */
+		"		ORDER BY Demand.jobs_waiting DESC, RANDOM()"
 		"		LIMIT 1;"
 		"SELECT COUNT(*) FROM TransferSchedule__replicate_push_asynchronous;"
 		"BEGIN IMMEDIATE TRANSACTION;"
@@ -657,17 +657,39 @@ static int schedule_replication (confuga *C)
 		 *
 		 * [1] https://www.mail-archive.com/sqlite-users@mailinglists.sqlite.org/msg05276.html
 		 */
+		"CREATE TEMPORARY TABLE IF NOT EXISTS TransferScheduleParameters____schedule_replication ("
+		"	key TEXT PRIMARY KEY,"
+		"	value INTEGER"
+		");"
+		"INSERT OR REPLACE INTO TransferScheduleParameters____schedule_replication"
+		"	VALUES ('transfer-slots', ?1);"
 		"CREATE TEMPORARY VIEW IF NOT EXISTS TransferSchedule__schedule_replication AS"
 		"	WITH"
-				/* This a StorageNode we are able to use to transfer a replica. If it is currently transferring a file, it is excluded. */
+		"		TransferSlots AS ("
+		"			SELECT value FROM TransferScheduleParameters____schedule_replication WHERE key = 'transfer-slots'"
+		"		),"
+				/* Storage Node with available Transfer Slots, counting both directions.  Matches the budget used for job-driven push replication, so bulk replication fans out across many node pairs instead of one transfer per source. */
+		"		StorageNodeTransferReady AS ("
+		"			SELECT id"
+		"				FROM"
+		"					("
+		"						SELECT StorageNodeActive.id AS id, ActiveTransfers.id AS tjid"
+		"							FROM (Confuga.StorageNodeActive LEFT OUTER JOIN Confuga.ActiveTransfers ON StorageNodeActive.id = ActiveTransfers.tsid)"
+		"					UNION ALL"
+		"						SELECT StorageNodeActive.id AS id, ActiveTransfers.id AS tjid"
+		"							FROM (Confuga.StorageNodeActive LEFT OUTER JOIN Confuga.ActiveTransfers ON StorageNodeActive.id = ActiveTransfers.fsid)"
+		"					)"
+		"				GROUP BY id"
+		"				HAVING ((SELECT * FROM TransferSlots) == 0 OR COUNT(tjid) < (SELECT * FROM TransferSlots))"
+		"		),"
+				/* This a StorageNode we are able to use to transfer a replica, chosen among those with a free slot.  A node that just received a replica becomes a source for the next pass, so wide distribution grows as a tree rather than a serial chain off the original holder. */
 		"		StorageNodeActiveRandom AS ("
 		"			SELECT StorageNodeAuthenticated.*, RANDOM() AS _r"
-		"				FROM StorageNodeAuthenticated"
+		"				FROM StorageNodeAuthenticated JOIN StorageNodeTransferReady ON StorageNodeAuthenticated.id = StorageNodeTransferReady.id"
 		"		),"
 		"		SourceStorageNode AS ("
 		"			SELECT Replica.fid, StorageNodeActiveRandom.id AS sid, MIN(StorageNodeActiveRandom._r)"
 		"				FROM Confuga.Replica JOIN StorageNodeActiveRandom ON Replica.sid = StorageNodeActiveRandom.id"
-		"				WHERE NOT EXISTS (SELECT fsid FROM Confuga.ActiveTransfers WHERE fsid = StorageNodeActiveRandom.id)"
 		"				GROUP BY Replica.fid"
 		"		),"
 				/* This contains all the Replica of a File AND ongoing transfers of the File to some StorageNode */
@@ -696,7 +718,7 @@ static int schedule_replication (confuga *C)
 		"		FROM"
 		"			DegradedFile"
 		"			JOIN SourceStorageNode ON DegradedFile.id = SourceStorageNode.fid"
-		"			JOIN StorageNodeActive AS TargetStorageNode"
+		"			JOIN (SELECT StorageNodeActive.* FROM StorageNodeActive JOIN StorageNodeTransferReady ON StorageNodeActive.id = StorageNodeTransferReady.id) AS TargetStorageNode"
 				/* Originally, TargetStorageNode was a VIEW in the WITH clause. It JOINed on File so we could come up with a Target for each File. This was too expensive so the join is moved here, on DegradedFile. */
 		"		WHERE NOT EXISTS (SELECT sid FROM Replicas WHERE fid = DegradedFile.id AND sid = TargetStorageNode.id) AND TargetStorageNode.avail > DegradedFile.size"
 		"		GROUP BY DegradedFile.id"
@@ -720,6 +742,15 @@ static int schedule_replication (confuga *C)
 	sqlcatchcode(sqlite3_step(stmt), SQLITE_DONE);
 	sqlcatch(sqlite3_finalize(stmt); stmt = NULL);
 
+	sqlcatch(sqlite3_prepare_v2(db, current, -1, &stmt, &current));
+	sqlcatch(sqlite3_bind_int64(stmt, 1, C->replication_n));
+	sqlcatchcode(sqlite3_step(stmt), SQLITE_DONE);
+	sqlcatch(sqlite3_finalize(stmt); stmt = NULL);
+
+	sqlcatch(sqlite3_prepare_v2(db, current, -1, &stmt, &current));
+	sqlcatchcode(sqlite3_step(stmt), SQLITE_DONE);
+	sqlcatch(sqlite3_finalize(stmt); stmt = NULL);
+
 	sqlcatch(sqlite3_prepare_v2(db, current, -1, &stmt, &current));
 	sqlcatchcode(sqlite3_step(stmt), SQLITE_ROW);
 	if (sqlite3_column_int(stmt, 0) == 0) {
@@ -14,6 +14,7 @@ See the file COPYING for details.
 #include <string.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "buffer.h"
 #include "cctools_endian.h"
@@ -356,13 +357,40 @@ static int flush_send(struct mq *mq)
 				snd->type |= HDR_MSG_END;
 			}
 
-			ssize_t rc = send(socket, &snd->magic + snd->hdr_pos, HDR_SIZE - snd->hdr_pos, 0);
+			/* Gather the header and the frame payload into one writev,
+			 * so a frame ordinarily costs one syscall instead of two.
+			 * Either piece may be partially consumed; the positions
+			 * are advanced in order, so a short write resumes exactly
+			 * where it left off.
+			 */
+			struct iovec iov[2];
+			iov[0].iov_base = &snd->magic + snd->hdr_pos;
+			iov[0].iov_len = HDR_SIZE - snd->hdr_pos;
+			iov[1].iov_base = (char *)buffer_tostring(snd->buffer) + snd->buf_pos;
+			iov[1].iov_len = MIN(snd->len, NEXT_FRAME(snd->buf_pos)) - snd->buf_pos;
+
+			ssize_t rc = writev(socket, iov, iov[1].iov_len > 0 ? 2 : 1);
 			if (rc == -1 && errno_is_temporary(errno)) {
 				return 0;
 			} else if (rc <= 0) {
 				return -1;
 			}
-			snd->hdr_pos = checked_add(snd->hdr_pos, rc);
+
+			size_t hdr_part = MIN((size_t)rc, iov[0].iov_len);
+			snd->hdr_pos = checked_add(snd->hdr_pos, hdr_part);
+			size_t buf_part = rc - hdr_part;
+			snd->buf_pos = checked_add(snd->buf_pos, buf_part);
+			snd->total_len = checked_add(snd->total_len, buf_part);
+
+			/* If the writev finished this frame's payload with more of
+			 * the message left, the next frame needs its header first.
+			 * Only when payload advanced in this call: a short write
+			 * that stopped inside the header must not rewind it.
+			 */
+			if (buf_part > 0 && snd->buf_pos < snd->len && FRAME_POS(snd->buf_pos) == 0) {
+				snd->hdr_pos = 0;
+				snd->type = HDR_MSG_CONT;
+			}
 			continue;
 		} else if (snd->buf_pos < snd->len) {
 			ssize_t rc = send(socket, buffer_tostring(snd->buffer) + snd->buf_pos, MIN(snd->len, NEXT_FRAME(snd->buf_pos)) - snd->buf_pos, 0);
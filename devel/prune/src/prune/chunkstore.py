@@ -0,0 +1,138 @@
+# Copyright (c) 2015- The University of Notre Dame.
+# This software is distributed under the GNU General Public License.
+# See the file COPYING for details.
+
+# Content-defined chunk store for preserved files.
+#
+# Preservation runs are dominated by near-identical derived files, so
+# storing each artifact whole repeats almost all of its bytes.  Here a
+# file is cut at content-defined boundaries (a gear rolling hash, as in
+# FastCDC), each chunk is stored once under its sha1 in a shared pool,
+# and the artifact itself is a small recipe listing its chunks.  An
+# insertion of a file that differs from a stored one by a small delta
+# then writes only the chunks spanning the changed bytes.
+#
+# Whole files are materialized from recipes on demand (when a task
+# stages them into a sandbox); the materialized copy is a cache that
+# can be removed at any time, since the recipe and pool reconstruct it.
+
+import hashlib
+import os
+import shutil
+
+import timer
+
+CHUNK_MIN = 16 * 1024
+CHUNK_AVG_BITS = 16		  # ~64KB average
+CHUNK_MAX = 256 * 1024
+
+RECIPE_SUFFIX = '.recipe'
+POOL_DIRNAME = 'chunks/'
+
+# The gear table maps each input byte to a pseudorandom word; derived
+# from sha1 so every reader cuts identical boundaries.
+_gear = []
+for _b in range(256):
+	_h = hashlib.sha1(('prune chunk gear %d' % _b).encode()).digest()
+	_v = 0
+	for _c in _h[:8]:
+		_v = (_v << 8) | (_c if isinstance(_c, int) else ord(_c))
+	_gear.append(_v & 0xFFFFFFFFFFFFFFFF)
+
+_mask = (1 << CHUNK_AVG_BITS) - 1
+
+
+def chunk_boundaries(data):
+	# Return the cut points of data as a list of end offsets.
+	boundaries = []
+	h = 0
+	start = 0
+	i = 0
+	length = len(data)
+	while i < length:
+		byte = data[i]
+		if not isinstance(byte, int):
+			byte = ord(byte)
+		h = ((h << 1) + _gear[byte]) & 0xFFFFFFFFFFFFFFFF
+		i += 1
+		size = i - start
+		if size < CHUNK_MIN:
+			continue
+		if (h & _mask) == 0 or size >= CHUNK_MAX:
+			boundaries.append(i)
+			start = i
+			h = 0
+	if start < length:
+		boundaries.append(length)
+	return boundaries
+
+
+def pool_directory(file_dir):
+	pool = file_dir + POOL_DIRNAME
+	if not os.path.exists(pool):
+		os.makedirs(pool)
+	return pool
+
+
+def store(pathname, file_dir, cbid):
+	# Chunk pathname into the pool and write the recipe for cbid.
+	# Returns (chunk_count, new_bytes) where new_bytes counts only
+	# chunks not already present in the pool.
+	timer.start('chunkstore.store')
+	pool = pool_directory(file_dir)
+
+	new_bytes = 0
+	chunks = []
+	with open(pathname, 'rb') as f:
+		data = f.read()
+	boundaries = chunk_boundaries(data)
+	start = 0
+	for end in boundaries:
+		piece = data[start:end]
+		key = hashlib.sha1(piece).hexdigest()
+		chunks.append((key, end - start))
+		chunk_pathname = pool + key
+		if not os.path.isfile(chunk_pathname):
+			with open(chunk_pathname + '.tmp', 'wb') as c:
+				c.write(piece)
+			os.rename(chunk_pathname + '.tmp', chunk_pathname)
+			new_bytes += end - start
+		start = end
+
+	recipe_pathname = file_dir + cbid + RECIPE_SUFFIX
+	with open(recipe_pathname + '.tmp', 'w') as r:
+		for key, size in chunks:
+			r.write('%s %d\n' % (key, size))
+	os.rename(recipe_pathname + '.tmp', recipe_pathname)
+
+	timer.stop('chunkstore.store')
+	return len(chunks), new_bytes
+
+
+def ensure(file_dir, cbid):
+	# Materialize file_dir+cbid from its recipe if it is not already
+	# present.  Returns True when the whole file exists afterward.
+	pathname = file_dir + cbid
+	if os.path.isfile(pathname):
+		return True
+
+	recipe_pathname = pathname + RECIPE_SUFFIX
+	if not os.path.isfile(recipe_pathname):
+		return False
+
+	timer.start('chunkstore.ensure')
+	pool = file_dir + POOL_DIRNAME
+	with open(pathname + '.tmp', 'wb') as out:
+		with open(recipe_pathname) as r:
+			for line in r:
+				key = line.split()[0]
+				with open(pool + key, 'rb') as c:
+					shutil.copyfileobj(c, out)
+	os.rename(pathname + '.tmp', pathname)
+	timer.stop('chunkstore.ensure')
+	return True
+
+
+def stored(file_dir, cbid):
+	# True if cbid is available, whole or as a recipe.
+	return os.path.isfile(file_dir + cbid) or os.path.isfile(file_dir + cbid + RECIPE_SUFFIX)
@@ -2,6 +2,7 @@ import json, time
 
 import glob
 import timer
+import chunkstore
 from utils import *
 
 class Item(object):
@@ -152,9 +153,11 @@ class Item(object):
 			return None
 		elif self.path:
 			if self.type=='temp':
-				pathname = glob.cache_file_directory + self.path
+				file_dir = glob.cache_file_directory
 			else:
-				pathname = glob.data_file_directory + self.path
+				file_dir = glob.data_file_directory
+			chunkstore.ensure( file_dir, self.path )
+			pathname = file_dir + self.path
 
 			with open( pathname, 'r' ) as f:
 				buf = f.read(1024*1024)
@@ -11,6 +11,7 @@ import uuid as uuidlib
 
 import glob
 import timer
+import chunkstore
 from class_item import *
 from utils import *
 
@@ -146,9 +147,13 @@ CREATE TABLE IF NOT EXISTS todos (
 
 		if action_taken == 'saved':
 			if item.path:
-				new_pathname = file_dir + item.cbid
-				if not os.path.isfile( new_pathname ):
-					shutil.move( item.path, new_pathname )
+				# Store the artifact as content-defined chunks plus a
+				# recipe; near-identical files then share almost all of
+				# their bytes in the chunk pool.  The whole file is
+				# materialized again on demand when a task stages it.
+				if not chunkstore.stored( file_dir, item.cbid ):
+					chunkstore.store( item.path, file_dir, item.cbid )
+					os.unlink( item.path )
 				item.path = item.cbid
 			ins, vals = item.sqlite3_insert()
 			#print ins
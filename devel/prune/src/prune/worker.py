@@ -5,6 +5,7 @@
 
 import os, sys, time, traceback
 import subprocess, shutil
+import chunkstore
 import StringIO
 
 import glob
@@ -50,8 +51,10 @@ class Worker:
 
 			if it.path:
 				if it.type == 'temp':
+					chunkstore.ensure( glob.cache_file_directory, it.path )
 					os.symlink( glob.cache_file_directory+it.path, self.sandbox + param )
 				else:
+					chunkstore.ensure( glob.data_file_directory, it.path )
 					os.symlink( glob.data_file_directory+it.path, self.sandbox + param )
 			else:
 				with open( self.sandbox + param, 'w' ) as f:
@@ -190,8 +193,10 @@ class Worker:
 
 				if it.path:
 					if it.type == 'temp':
+						chunkstore.ensure( glob.cache_file_directory, it.path )
 						os.symlink( glob.cache_file_directory+it.path, self.sandbox + param )
 					else:
+						chunkstore.ensure( glob.data_file_directory, it.path )
 						os.symlink( glob.data_file_directory+it.path, self.sandbox + param )
 				else:
 					with open( self.sandbox + param, 'w' ) as f:
@@ -6,6 +6,7 @@ See the file COPYING for details.
 */
 
 #include "auth.h"
+#include "hash_table.h"
 #include "catch.h"
 #include "debug.h"
 #include "domain_name_cache.h"
@@ -59,48 +60,196 @@ static void auth_sanitize(char *s)
 	}
 }
 
-int auth_assert(struct link *link, char **type, char **subject, time_t stoptime)
+/*
+Negotiation cache: remember which method last succeeded against each
+host:port, and try that one first on the next connection, so clients
+facing a server that only accepts the last registered method stop
+burning a failed round trip per method per connection.  Entries
+expire after a day, and a cached method that fails simply falls back
+to the ordinary order.  Setting CCTOOLS_AUTH_CACHE names a file where
+the cache persists, for short-lived tools that cannot amortize the
+discovery within one process.
+*/
+
+#define AUTH_CACHE_LIFETIME (24 * 60 * 60)
+
+static struct hash_table *auth_method_cache = 0;
+
+struct auth_cache_entry {
+	char type[AUTH_TYPE_MAX];
+	time_t when;
+};
+
+static void auth_cache_key(struct link *link, char *key, size_t size)
+{
+	char addr[LINK_ADDRESS_MAX];
+	int port;
+	link_address_remote(link, addr, &port);
+	snprintf(key, size, "%s:%d", addr, port);
+}
+
+static void auth_cache_load(void)
+{
+	static int loaded = 0;
+
+	if (!auth_method_cache)
+		auth_method_cache = hash_table_create(0, 0);
+
+	if (loaded)
+		return;
+	loaded = 1;
+
+	const char *cache_name = getenv("CCTOOLS_AUTH_CACHE");
+	if (!cache_name)
+		return;
+
+	FILE *file = fopen(cache_name, "r");
+	if (!file)
+		return;
+
+	char line[AUTH_LINE_MAX];
+	while (fgets(line, sizeof(line), file)) {
+		char key[AUTH_LINE_MAX];
+		struct auth_cache_entry entry;
+		long long when;
+		/* widths bound the reads to the AUTH_LINE_MAX and AUTH_TYPE_MAX buffers */
+		if (sscanf(line, "%2047s %1023s %lld", key, entry.type, &when) == 3) {
+			entry.when = when;
+			struct auth_cache_entry *e = xxmalloc(sizeof(*e));
+			*e = entry;
+			free(hash_table_remove(auth_method_cache, key));
+			hash_table_insert(auth_method_cache, key, e);
+		}
+	}
+	fclose(file);
+}
+
+static void auth_cache_save(void)
+{
+	const char *cache_name = getenv("CCTOOLS_AUTH_CACHE");
+	if (!cache_name)
+		return;
+
+	char *temp_name = string_format("%s.%d", cache_name, getpid());
+	FILE *file = fopen(temp_name, "w");
+	if (!file) {
+		free(temp_name);
+		return;
+	}
+
+	char *key;
+	struct auth_cache_entry *e;
+	hash_table_firstkey(auth_method_cache);
+	while (hash_table_nextkey(auth_method_cache, &key, (void **)&e)) {
+		fprintf(file, "%s %s %lld\n", key, e->type, (long long)e->when);
+	}
+	fclose(file);
+	rename(temp_name, cache_name);
+	free(temp_name);
+}
+
+static struct auth_ops *auth_cache_preferred(struct link *link)
+{
+	auth_cache_load();
+
+	char key[AUTH_LINE_MAX];
+	auth_cache_key(link, key, sizeof(key));
+
+	struct auth_cache_entry *e = hash_table_lookup(auth_method_cache, key);
+	if (!e)
+		return 0;
+	if (time(0) - e->when > AUTH_CACHE_LIFETIME) {
+		free(hash_table_remove(auth_method_cache, key));
+		return 0;
+	}
+	return type_lookup(e->type);
+}
+
+static void auth_cache_record(struct link *link, const char *type)
+{
+	auth_cache_load();
+
+	char key[AUTH_LINE_MAX];
+	auth_cache_key(link, key, sizeof(key));
+
+	struct auth_cache_entry *e = xxmalloc(sizeof(*e));
+	strncpy(e->type, type, sizeof(e->type) - 1);
+	e->type[sizeof(e->type) - 1] = 0;
+	e->when = time(0);
+	free(hash_table_remove(auth_method_cache, key));
+	hash_table_insert(auth_method_cache, key, e);
+
+	auth_cache_save();
+}
+
+/* Try one method; returns 1 on success, 0 to continue with others, or throws via rc/out in the caller's style. */
+
+static int auth_attempt(struct auth_ops *a, struct link *link, char **type, char **subject, time_t stoptime, int *rcp)
 {
 	int rc;
-	struct auth_ops *a;
+	char line[AUTH_LINE_MAX];
 
-	for (a = state.ops; a; a = a->next) {
-		char line[AUTH_LINE_MAX];
-
-		debug(D_AUTH, "requesting '%s' authentication", a->type);
-
-		CATCHUNIX(link_printf(link, stoptime, "%s\n", a->type));
-
-		CATCHUNIX(link_readline(link, line, AUTH_LINE_MAX, stoptime) ? 0 : -1);
-
-		if (strcmp(line, "yes") == 0) {
-			debug(D_AUTH, "server agrees to try '%s'", a->type);
-			if (a->assert(link, stoptime) == 0) {
-				debug(D_AUTH, "successfully authenticated");
-
-				CATCHUNIX(link_readline(link, line, AUTH_LINE_MAX, stoptime) ? 0 : -1);
-				if (!strcmp(line, "yes")) {
-					debug(D_AUTH, "reading back auth info from server");
-					CATCHUNIX(link_readline(link, line, sizeof(line), stoptime) ? 0 : -1);
-					*type = xxstrdup(line);
-					CATCHUNIX(link_readline(link, line, sizeof(line), stoptime) ? 0 : -1);
-					*subject = xxstrdup(line);
-					auth_sanitize(*subject);
-					debug(D_AUTH, "server thinks I am %s:%s", *type, *subject);
-					rc = 0;
-					goto out;
-				} else {
-					debug(D_AUTH, "but not authorized to continue");
-				}
-			} else if (errno == EACCES) {
-				debug(D_AUTH, "failed to authenticate");
+	debug(D_AUTH, "requesting '%s' authentication", a->type);
+
+	CATCHUNIX(link_printf(link, stoptime, "%s\n", a->type));
+
+	CATCHUNIX(link_readline(link, line, AUTH_LINE_MAX, stoptime) ? 0 : -1);
+
+	if (strcmp(line, "yes") == 0) {
+		debug(D_AUTH, "server agrees to try '%s'", a->type);
+		if (a->assert(link, stoptime) == 0) {
+			debug(D_AUTH, "successfully authenticated");
+
+			CATCHUNIX(link_readline(link, line, AUTH_LINE_MAX, stoptime) ? 0 : -1);
+			if (!strcmp(line, "yes")) {
+				debug(D_AUTH, "reading back auth info from server");
+				CATCHUNIX(link_readline(link, line, sizeof(line), stoptime) ? 0 : -1);
+				*type = xxstrdup(line);
+				CATCHUNIX(link_readline(link, line, sizeof(line), stoptime) ? 0 : -1);
+				*subject = xxstrdup(line);
+				auth_sanitize(*subject);
+				debug(D_AUTH, "server thinks I am %s:%s", *type, *subject);
+				auth_cache_record(link, a->type);
+				*rcp = 0;
+				return 1;
 			} else {
-				CATCH(errno);
+				debug(D_AUTH, "but not authorized to continue");
 			}
+		} else if (errno == EACCES) {
+			debug(D_AUTH, "failed to authenticate");
 		} else {
-			debug(D_AUTH, "server refuses to try '%s'", a->type);
+			CATCH(errno);
 		}
-		debug(D_AUTH, "still trying...");
+	} else {
+		debug(D_AUTH, "server refuses to try '%s'", a->type);
+	}
+	debug(D_AUTH, "still trying...");
+	return 0;
+out:
+	*rcp = rc;
+	return -1;
+}
+
+int auth_assert(struct link *link, char **type, char **subject, time_t stoptime)
+{
+	int rc;
+	struct auth_ops *a;
+
+	/* The method that worked against this server last time goes first. */
+	struct auth_ops *preferred = auth_cache_preferred(link);
+	if (preferred) {
+		debug(D_AUTH, "trying cached method '%s' first", preferred->type);
+		int result = auth_attempt(preferred, link, type, subject, stoptime, &rc);
+		if (result != 0)
+			goto out;
+	}
+
+	for (a = state.ops; a; a = a->next) {
+		if (a == preferred)
+			continue;
+		int result = auth_attempt(a, link, type, subject, stoptime, &rc);
+		if (result != 0)
+			goto out;
 	}
 
 	debug(D_AUTH, "ran out of authenticators");
@@ -0,0 +1,321 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+/*
+benchmark - microbenchmark suites for the dttools hot paths.
+
+Each benchmark runs a warmup pass, then a fixed number of timed
+samples, and reports the median so a stray scheduling blip does not
+pollute a comparison between releases.  Output is one JSON object per
+line, so results can be collected and diffed mechanically:
+
+    {"bench":"hash_table_lookup","iters":1000000,"ns_per_op":52.1,"mb_per_s":0}
+
+Run all suites with no arguments, or name suites to run:
+
+    benchmark [hash jx buffer digest link]
+*/
+
+#include "b64.h"
+#include "buffer.h"
+#include "hash_table.h"
+#include "itable.h"
+#include "jx.h"
+#include "jx_parse.h"
+#include "jx_print.h"
+#include "link.h"
+#include "md5.h"
+#include "sha1.h"
+#include "stringtools.h"
+#include "xxmalloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SAMPLES 5
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_longlong(const void *pa, const void *pb)
+{
+	long long a = *(const long long *)pa;
+	long long b = *(const long long *)pb;
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/*
+Run body SAMPLES+1 times (first is warmup), timing each run of iters
+iterations, and report the median.  bytes is the payload size moved
+per iteration, or zero where throughput is meaningless.
+*/
+#define BENCH(name, iters, bytes, body) \
+	do { \
+		long long samples[SAMPLES]; \
+		int s; \
+		for (s = -1; s < SAMPLES; s++) { \
+			long long t0 = now_ns(); \
+			{ body } \
+			long long t1 = now_ns(); \
+			if (s >= 0) \
+				samples[s] = t1 - t0; \
+		} \
+		qsort(samples, SAMPLES, sizeof(*samples), compare_longlong); \
+		long long median = samples[SAMPLES / 2]; \
+		double ns_per_op = (double)median / (iters); \
+		double mb_per_s = (bytes) ? ((double)(bytes) * (iters) * 1000.0) / median : 0; \
+		printf("{\"bench\":\"%s\",\"iters\":%lld,\"ns_per_op\":%.1f,\"mb_per_s\":%.1f}\n", name, (long long)(iters), ns_per_op, mb_per_s); \
+	} while (0)
+
+static void bench_hash(void)
+{
+	const int n = 200000;
+	char **keys = xxmalloc(n * sizeof(*keys));
+	int i;
+	for (i = 0; i < n; i++)
+		keys[i] = string_format("/some/path/to/file.%d.dat", i);
+
+	struct hash_table *h = NULL;
+	BENCH("hash_table_insert", n, 0, {
+		if (h)
+			hash_table_delete(h);
+		h = hash_table_create(0, 0);
+		for (i = 0; i < n; i++)
+			hash_table_insert(h, keys[i], keys[i]);
+	});
+	BENCH("hash_table_lookup", n, 0, {
+		for (i = 0; i < n; i++) {
+			if (!hash_table_lookup(h, keys[i]))
+				abort();
+		}
+	});
+	hash_table_delete(h);
+
+	h = NULL;
+	BENCH("hash_table_flat_insert", n, 0, {
+		if (h)
+			hash_table_delete(h);
+		h = hash_table_create_flat(0, 0);
+		for (i = 0; i < n; i++)
+			hash_table_insert(h, keys[i], keys[i]);
+	});
+	BENCH("hash_table_flat_lookup", n, 0, {
+		for (i = 0; i < n; i++) {
+			if (!hash_table_lookup(h, keys[i]))
+				abort();
+		}
+	});
+	hash_table_delete(h);
+
+	struct itable *t = NULL;
+	BENCH("itable_insert", n, 0, {
+		if (t)
+			itable_delete(t);
+		t = itable_create(0);
+		for (i = 0; i < n; i++)
+			itable_insert(t, i + 1, keys[i]);
+	});
+	BENCH("itable_lookup", n, 0, {
+		for (i = 0; i < n; i++) {
+			if (!itable_lookup(t, i + 1))
+				abort();
+		}
+	});
+	itable_delete(t);
+
+	for (i = 0; i < n; i++)
+		free(keys[i]);
+	free(keys);
+}
+
+static char *make_json(int records)
+{
+	buffer_t b;
+	buffer_init(&b);
+	buffer_putfstring(&b, "[");
+	int i;
+	for (i = 0; i < records; i++) {
+		buffer_putfstring(&b, "%s{\"name\":\"worker-%d.cluster.edu\",\"port\":%d,\"cores\":%d,\"memory\":%d,\"load\":%d.%02d,\"tags\":[\"a\",\"b\",\"c\"]}", i ? "," : "", i, 9000 + i, 16, 64000, i % 4, i % 100);
+	}
+	buffer_putfstring(&b, "]");
+	char *s = xxstrdup(buffer_tostring(&b));
+	buffer_free(&b);
+	return s;
+}
+
+static void bench_jx(void)
+{
+	char *doc = make_json(2000);
+	size_t doclen = strlen(doc);
+	struct jx *j = NULL;
+
+	BENCH("jx_parse", 1, doclen, {
+		if (j)
+			jx_delete(j);
+		j = jx_parse_string(doc);
+		if (!j)
+			abort();
+	});
+
+	BENCH("jx_print", 1, doclen, {
+		char *out = jx_print_string(j);
+		if (!out)
+			abort();
+		free(out);
+	});
+
+	jx_delete(j);
+	free(doc);
+}
+
+static void bench_buffer(void)
+{
+	const int n = 100000;
+	buffer_t b;
+	buffer_init(&b);
+	int i;
+	BENCH("buffer_putfstring", n, 0, {
+		buffer_rewind(&b, 0);
+		for (i = 0; i < n; i++)
+			buffer_putfstring(&b, "task %d on worker %s used %d.%03d cores\n", i, "worker-99.cluster.edu", i % 8, i % 1000);
+	});
+	buffer_free(&b);
+}
+
+static void bench_digest(void)
+{
+	const size_t len = 8 * 1024 * 1024;
+	char *data = xxmalloc(len);
+	size_t i;
+	for (i = 0; i < len; i++)
+		data[i] = i * 131;
+
+	unsigned char digest[SHA1_DIGEST_LENGTH];
+	BENCH("sha1", 1, len, { sha1_buffer(data, len, digest); });
+	BENCH("md5", 1, len, { md5_buffer(data, len, (unsigned char *)digest); });
+
+	buffer_t b;
+	buffer_init(&b);
+	BENCH("b64_encode", 1, len, {
+		buffer_rewind(&b, 0);
+		b64_encode(data, len, &b);
+	});
+	buffer_free(&b);
+
+	free(data);
+}
+
+static void bench_link(void)
+{
+	const size_t chunk = 1024 * 1024;
+	const int chunks = 64;
+	char *data = xxmalloc(chunk);
+	memset(data, 'x', chunk);
+
+	struct link *serve = link_serve(0);
+	if (!serve) {
+		fprintf(stderr, "benchmark: could not open loopback port\n");
+		free(data);
+		return;
+	}
+	char addr[LINK_ADDRESS_MAX];
+	int port;
+	link_address_local(serve, addr, &port);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		/* child: echo one byte per ping, then swallow the stream */
+		struct link *c = link_accept(serve, time(0) + 10);
+		char byte;
+		int i;
+		for (i = 0; i < (SAMPLES + 1) * 200; i++) {
+			link_read(c, &byte, 1, time(0) + 10);
+			link_write(c, &byte, 1, time(0) + 10);
+		}
+		size_t total = (size_t)chunks * chunk * (SAMPLES + 1);
+		char *sink = xxmalloc(chunk);
+		size_t got = 0;
+		while (got < total) {
+			int rc = link_read(c, sink, chunk, time(0) + 30);
+			if (rc <= 0)
+				break;
+			got += rc;
+		}
+		link_close(c);
+		_exit(0);
+	}
+
+	struct link *l = link_connect("127.0.0.1", port, time(0) + 10);
+	if (!l) {
+		fprintf(stderr, "benchmark: loopback connect failed\n");
+		free(data);
+		return;
+	}
+
+	char byte = 'p';
+	int i;
+	BENCH("link_latency", 200, 0, {
+		for (i = 0; i < 200; i++) {
+			link_write(l, &byte, 1, time(0) + 10);
+			link_read(l, &byte, 1, time(0) + 10);
+		}
+	});
+
+	BENCH("link_throughput", chunks, chunk, {
+		for (i = 0; i < chunks; i++)
+			link_write(l, data, chunk, time(0) + 30);
+	});
+
+	link_close(l);
+	link_close(serve);
+	free(data);
+}
+
+int main(int argc, char *argv[])
+{
+	int all = (argc <= 1);
+	int a;
+
+	int want_hash = all, want_jx = all, want_buffer = all, want_digest = all, want_link = all;
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "hash"))
+			want_hash = 1;
+		else if (!strcmp(argv[a], "jx"))
+			want_jx = 1;
+		else if (!strcmp(argv[a], "buffer"))
+			want_buffer = 1;
+		else if (!strcmp(argv[a], "digest"))
+			want_digest = 1;
+		else if (!strcmp(argv[a], "link"))
+			want_link = 1;
+		else {
+			fprintf(stderr, "Use: %s [hash jx buffer digest link]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (want_hash)
+		bench_hash();
+	if (want_jx)
+		bench_jx();
+	if (want_buffer)
+		bench_buffer();
+	if (want_digest)
+		bench_digest();
+	if (want_link)
+		bench_link();
+
+	return 0;
+}
+
+/* vim: set noexpandtab tabstop=8: */
@@ -353,6 +353,74 @@ double bucketing_predict(bucketing_state_t *s, double prev_val)
 	return -1;
 }
 
+/*
+The state is persisted as one line of parameters followed by the
+observed values in arrival order.  Restoring simply replays the
+values through bucketing_add, which regenerates the significance
+sequence and bucket structure exactly as if the tasks had just run.
+Only the most recent max_points values are kept on save, so very old
+history decays away rather than anchoring the buckets forever.
+*/
+
+int bucketing_state_save(bucketing_state_t *s, const char *path, int max_points)
+{
+	FILE *f = fopen(path, "w");
+	if (!f)
+		return -1;
+
+	fprintf(f, "bucketing 1 %lf %d %lf %d %d %d\n", s->default_value, s->num_sampling_points, s->increase_rate, s->max_num_buckets, (int)s->mode, s->update_epoch);
+
+	int skip = 0;
+	if (max_points > 0 && (int)list_length(s->sequence_points) > max_points) {
+		skip = (int)list_length(s->sequence_points) - max_points;
+	}
+
+	struct list_cursor *lc = list_cursor_create(s->sequence_points);
+	bucketing_point_t *p;
+	list_seek(lc, 0);
+	int i = 0;
+	while (list_get(lc, (void **)&p)) {
+		if (i >= skip) {
+			fprintf(f, "%lf\n", p->val);
+		}
+		i++;
+		list_next(lc);
+	}
+	list_cursor_destroy(lc);
+
+	fclose(f);
+	return 0;
+}
+
+bucketing_state_t *bucketing_state_load(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return NULL;
+
+	double default_value, increase_rate;
+	int num_sampling_points, max_num_buckets, mode, update_epoch, version;
+
+	if (fscanf(f, "bucketing %d %lf %d %lf %d %d %d\n", &version, &default_value, &num_sampling_points, &increase_rate, &max_num_buckets, &mode, &update_epoch) != 7 || version != 1) {
+		fclose(f);
+		return NULL;
+	}
+
+	bucketing_state_t *s = bucketing_state_create(default_value, num_sampling_points, increase_rate, max_num_buckets, (bucketing_mode_t)mode, update_epoch);
+	if (!s) {
+		fclose(f);
+		return NULL;
+	}
+
+	double val;
+	while (fscanf(f, "%lf\n", &val) == 1) {
+		bucketing_add(s, val);
+	}
+
+	fclose(f);
+	return s;
+}
+
 /** End: APIs **/
 
 /** Begin: debug functions **/
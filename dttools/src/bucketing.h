@@ -127,6 +127,20 @@ bucketing_state_t* bucketing_state_create(double default_value, int num_sampling
  * @param s pointer to bucketing state to be deleted */
 void bucketing_state_delete(bucketing_state_t* s);
 
+/* Save a bucketing state to disk, keeping only recent history.
+ * @param s the state to save
+ * @param path the file to write
+ * @param max_points keep at most this many most recent values, or all if zero
+ * @return 0 on success, -1 on failure */
+int bucketing_state_save(bucketing_state_t* s, const char* path, int max_points);
+
+/* Restore a bucketing state saved with bucketing_state_save, by
+ * replaying the recorded values, so a restarted manager resumes with
+ * learned allocations instead of re-entering the sampling phase.
+ * @param path the file to read
+ * @return pointer to restored state, or 0 on failure */
+bucketing_state_t* bucketing_state_load(const char* path);
+
 /* Tune externally provided fields
  * @param s the bucketing state
  * @param field string describing the field, must be the same as external fields
@@ -196,6 +196,19 @@ void buffer_rewind(buffer_t *b, size_t n)
 	b->end[0] = '\0';
 }
 
+int buffer_reserve(buffer_t *b, size_t n)
+{
+	if (b->len >= n)
+		return 0;
+	return buffer_grow(b, n - inuse(b));
+}
+
+void buffer_reset(buffer_t *b)
+{
+	b->end = b->buf;
+	b->end[0] = '\0';
+}
+
 int buffer_dupl(buffer_t *b, char **buf, size_t *l)
 {
 	size_t n = inuse(b);
@@ -164,6 +164,27 @@ const char *buffer_tolstring(buffer_t * b, size_t * size);
   */
 void buffer_rewind(buffer_t * b, size_t n);
 
+/** Reserve capacity for an expected message size.
+	Grows the internal storage once, up front, so that building a
+	message of up to n bytes performs no reallocations at all.  Useful
+	before assembling a large catalog update or status reply whose
+	approximate size is known.
+
+	@param b The buffer.
+	@param n The number of bytes of capacity to reserve.
+	@return 0 on success, -1 on failure (errno is set).
+  */
+int buffer_reserve(buffer_t * b, size_t n);
+
+/** Empty the buffer while retaining its storage.
+	Equivalent to buffer_rewind(b, 0).  A buffer kept per connection
+	can be reset between messages so that steady-state sends perform
+	no heap traffic at all.
+
+	@param b The buffer.
+  */
+void buffer_reset(buffer_t * b);
+
 /** Get the current position in the buffer.
 
 	@param b The buffer.
@@ -17,6 +17,7 @@ See the file COPYING for details.
 #include "domain_name.h"
 #include "domain_name_cache.h"
 #include "fd.h"
+#include "hash_table.h"
 #include "http_query.h"
 #include "jx.h"
 #include "jx_eval.h"
@@ -230,6 +231,116 @@ struct catalog_query *catalog_query_create(const char *hosts, struct jx *filter_
 	return q;
 }
 
+/*
+A cached query keeps the most recent snapshot for each host list and
+filter, and on refresh asks the server only for records heard from
+since the previous fetch, merging the changes in.  Status tools that
+poll every few seconds therefore stop re-downloading the whole
+catalog on every invocation.
+*/
+
+/* Records quieter than this are dropped from the cache, matching the server's own expiration. */
+#define CATALOG_CACHE_LIFETIME 900
+
+/* Refetch overlap to absorb clock skew between client and server. */
+#define CATALOG_CACHE_SLACK 30
+
+struct catalog_cache_entry {
+	struct jx *snapshot; /* object: record identity -> record */
+	time_t last_fetch;
+};
+
+static struct hash_table *catalog_cache = 0;
+
+static char *catalog_record_key(struct jx *j)
+{
+	const char *name = jx_lookup_string(j, "name");
+	const char *uuid = jx_lookup_string(j, "uuid");
+	int port = jx_lookup_integer(j, "port");
+	return string_format("%s:%d:%s", name ? name : "unknown", port, uuid ? uuid : "");
+}
+
+/* Replace or add each record of the array in the snapshot, and expire the silent ones. */
+
+static void catalog_cache_merge(struct catalog_cache_entry *e, struct jx *array, time_t now)
+{
+	struct jx_item *i;
+	for (i = array->u.items; i; i = i->next) {
+		char *key = catalog_record_key(i->value);
+		struct jx *jkey = jx_string(key);
+		jx_delete(jx_remove(e->snapshot, jkey));
+		jx_insert(e->snapshot, jkey, jx_copy(i->value));
+		free(key);
+	}
+
+	struct jx_pair *p = e->snapshot->u.pairs;
+	while (p) {
+		struct jx_pair *next = p->next;
+		if (jx_lookup_integer(p->value, "lastheardfrom") < now - CATALOG_CACHE_LIFETIME) {
+			jx_delete(jx_remove(e->snapshot, p->key));
+		}
+		p = next;
+	}
+}
+
+static struct jx *catalog_cache_to_array(struct catalog_cache_entry *e)
+{
+	struct jx *array = jx_array(0);
+	struct jx_pair *p;
+	for (p = e->snapshot->u.pairs; p; p = p->next) {
+		jx_array_append(array, jx_copy(p->value));
+	}
+	return array;
+}
+
+struct catalog_query *catalog_query_create_cached(const char *hosts, struct jx *filter_expr, time_t stoptime, int max_age)
+{
+	time_t now = time(0);
+
+	if (!catalog_cache)
+		catalog_cache = hash_table_create(0, 0);
+
+	char *filter_str = filter_expr ? jx_print_string(filter_expr) : xxstrdup("true");
+	char *cache_key = string_format("%s/%s", hosts ? hosts : "", filter_str);
+	free(filter_str);
+
+	struct catalog_cache_entry *e = hash_table_lookup(catalog_cache, cache_key);
+
+	if (!e) {
+		/* first touch: fetch the whole catalog and remember it */
+		struct catalog_query *q = catalog_query_create(hosts, filter_expr ? jx_copy(filter_expr) : 0, stoptime);
+		if (!q) {
+			free(cache_key);
+			return 0;
+		}
+		e = xxmalloc(sizeof(*e));
+		e->snapshot = jx_object(0);
+		e->last_fetch = now;
+		catalog_cache_merge(e, q->data, now);
+		hash_table_insert(catalog_cache, cache_key, e);
+		catalog_query_delete(q);
+	} else if (now - e->last_fetch >= max_age) {
+		/* stale: ask only for records heard from since the last fetch */
+		struct jx *since = jx_operator(JX_OP_GE, jx_symbol("lastheardfrom"), jx_integer(e->last_fetch - CATALOG_CACHE_SLACK));
+		struct jx *expr = filter_expr ? jx_operator(JX_OP_AND, jx_copy(filter_expr), since) : since;
+		struct catalog_query *q = catalog_query_create(hosts, expr, stoptime);
+		if (q) {
+			e->last_fetch = now;
+			catalog_cache_merge(e, q->data, now);
+			catalog_query_delete(q);
+		}
+		/* on failure, serve the stale snapshot rather than nothing */
+	}
+
+	free(cache_key);
+
+	struct catalog_query *q = xxmalloc(sizeof(*q));
+	q->data = catalog_cache_to_array(e);
+	q->current = q->data->u.items;
+	q->filter_expr = filter_expr;
+	return q;
+}
+
 struct jx *catalog_query_read(struct catalog_query *q, time_t stoptime)
 {
 	while (q && q->current) {
@@ -322,14 +433,14 @@ Send a catalog update via a single udp message.
 This is inherently a non-blocking action.
 */
 
-static void catalog_update_udp(const char *host, const char *address, int port, const char *text)
+static void catalog_update_udp(const char *host, const char *address, int port, const char *text, size_t length)
 {
 	debug(D_DEBUG, "sending update via udp to %s(%s):%d", host, address, port);
 
 	struct datagram *d = datagram_create(DATAGRAM_PORT_ANY);
 	if (!d)
 		return;
-	datagram_send(d, text, strlen(text), address, port);
+	datagram_send(d, text, length, address, port);
 	datagram_delete(d);
 }
 
@@ -339,7 +450,7 @@ This is inherently a blocking action and could
 take some time under non-ideal conditions.
 */
 
-static int catalog_update_tcp(const char *host, const char *address, int port, const char *text)
+static int catalog_update_tcp(const char *host, const char *address, int port, const char *text, size_t length)
 {
 	debug(D_DEBUG, "sending update via tcp to %s(%s):%d", host, address, port);
 
@@ -350,7 +461,7 @@ static int catalog_update_tcp(const char *host, const char *address, int port, c
 		return 0;
 	}
 
-	link_write(l, text, strlen(text), stoptime);
+	link_write(l, text, length, stoptime);
 	link_close(l);
 	return 1;
 }
@@ -363,14 +474,14 @@ and that the main process will not have to handle an asynchronous
 "child completed" message at any later point.
 */
 
-static int catalog_update_tcp_background(const char *host, const char *address, int port, const char *text)
+static int catalog_update_tcp_background(const char *host, const char *address, int port, const char *text, size_t length)
 {
 	pid_t pid = fork();
 	if (pid == 0) {
 		pid_t grandpid = fork();
 		if (grandpid == 0) {
 			/* grandchild sends catalog update. */
-			catalog_update_tcp(host, address, port, text);
+			catalog_update_tcp(host, address, port, text, length);
 			/* grandchild process exits after sending update. */
 			_exit(0);
 		} else {
@@ -433,13 +544,13 @@ int catalog_query_send_update(const char *hosts, const char *text, catalog_updat
 		next_host = parse_hostlist(next_host, host, &port);
 		if (domain_name_cache_lookup(host, address)) {
 			if (use_udp) {
-				catalog_update_udp(host, address, port, text);
+				catalog_update_udp(host, address, port, update_data, data_length);
 				sent++;
 			} else {
 				if (flags & CATALOG_UPDATE_BACKGROUND) {
-					sent += catalog_update_tcp_background(host, address, port + 1, text);
+					sent += catalog_update_tcp_background(host, address, port + 1, update_data, data_length);
 				} else {
-					sent += catalog_update_tcp(host, address, port + 1, text);
+					sent += catalog_update_tcp(host, address, port + 1, update_data, data_length);
 				}
 			}
 		} else {
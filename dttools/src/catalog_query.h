@@ -42,6 +42,21 @@ If neither is set, the system will contact chirp.cse.nd.edu on port 9097.
 */
 struct catalog_query *catalog_query_create(const char *hosts, struct jx *filter_expr, time_t stoptime);
 
+/** Create a catalog query backed by a client-side cache.
+Behaves like @ref catalog_query_create, but keeps the parsed snapshot
+for each host list and filter between calls.  While the snapshot is
+younger than max_age seconds it is served without touching the
+network; after that, only records heard from since the previous fetch
+are requested and merged in.  Intended for status tools that poll the
+catalog every few seconds.
+@param hosts A comma delimited list of catalog servers to query, or null for the default server.
+@param filter_expr An optional expression to filter the results in JX syntax.
+@param stoptime The absolute time at which to abort.
+@param max_age The age in seconds beyond which the cached snapshot is refreshed.
+@return A catalog query object on success, or null on failure.
+*/
+struct catalog_query *catalog_query_create_cached(const char *hosts, struct jx *filter_expr, time_t stoptime, int max_age);
+
 /** Read the next object from a query.
 Returns the next @ref jx expressions from the issued query.
 The caller may use @ref jx_lookup_string, @ref jx_lookup_integer and related
@@ -51,6 +51,11 @@ struct category *category_create(const char *name)
 	c->max_concurrent = -1;
 
 	c->first_allocation = NULL;
+	c->first_allocation_dirty = 0;
+	c->last_max_worker = NULL;
+	c->runtime_samples = NULL;
+	c->runtime_sample_count = 0;
+	c->runtime_sample_next = 0;
 	c->max_allocation = rmsummary_create(-1);
 	c->min_allocation = rmsummary_create(-1);
 	c->autolabel_resource = rmsummary_create(0);
@@ -256,6 +261,8 @@ void category_delete(struct hash_table *categories, const char *name)
 	rmsummary_delete(c->max_allocation);
 	rmsummary_delete(c->min_allocation);
 	rmsummary_delete(c->first_allocation);
+	rmsummary_delete(c->last_max_worker);
+	free(c->runtime_samples);
 	rmsummary_delete(c->autolabel_resource);
 	rmsummary_delete(c->max_resources_seen);
 
@@ -514,6 +521,51 @@ int64_t category_first_allocation(struct histogram *h, category_mode_t mode, int
 	return alloc;
 }
 
+/*
+Record a successful execution time and answer percentile queries over
+the recent window, for straggler detection that does not misfire on
+bimodal runtimes the way a mean multiplier does.  The window is a
+fixed ring, so updates are O(1); the percentile sorts a copy of at
+most the ring size on demand.
+*/
+
+#define CATEGORY_RUNTIME_SAMPLES 256
+
+void category_runtime_sample(struct category *c, double runtime)
+{
+	if (!c->runtime_samples) {
+		c->runtime_samples = calloc(CATEGORY_RUNTIME_SAMPLES, sizeof(double));
+		if (!c->runtime_samples)
+			return;
+	}
+	c->runtime_samples[c->runtime_sample_next] = runtime;
+	c->runtime_sample_next = (c->runtime_sample_next + 1) % CATEGORY_RUNTIME_SAMPLES;
+	if (c->runtime_sample_count < CATEGORY_RUNTIME_SAMPLES)
+		c->runtime_sample_count++;
+}
+
+static int double_cmp(const void *pa, const void *pb)
+{
+	double a = *(const double *)pa;
+	double b = *(const double *)pb;
+	return (a > b) - (a < b);
+}
+
+double category_runtime_percentile(struct category *c, double percentile)
+{
+	if (c->runtime_sample_count < 1)
+		return 0;
+
+	double sorted[CATEGORY_RUNTIME_SAMPLES];
+	memcpy(sorted, c->runtime_samples, c->runtime_sample_count * sizeof(double));
+	qsort(sorted, c->runtime_sample_count, sizeof(double), double_cmp);
+
+	int index = (int)(percentile / 100.0 * c->runtime_sample_count);
+	if (index >= c->runtime_sample_count)
+		index = c->runtime_sample_count - 1;
+	return sorted[index];
+}
+
 int category_update_first_allocation(struct category *c, const struct rmsummary *max_worker)
 {
 	/* buffer used only for debug output. */
@@ -660,7 +712,15 @@ int category_accumulate_summary(struct category *c, const struct rmsummary *rs,
 
 		if (first_allocation_every_n_tasks > 0) {
 			if (c->completions_since_last_reset % first_allocation_every_n_tasks == 0) {
-				update |= category_update_first_allocation(c, max_worker);
+				/*
+				Defer the histogram walk to the next time the
+				allocation is consulted, so completing a task
+				stays O(1) regardless of history size.
+				*/
+				rmsummary_delete(c->last_max_worker);
+				c->last_max_worker = max_worker ? rmsummary_copy(max_worker, 0) : NULL;
+				c->first_allocation_dirty = 1;
+				update = 1;
 			}
 		}
 
@@ -862,6 +922,11 @@ const struct rmsummary *category_task_max_resources(struct category *c, struct r
 
 	internal = rmsummary_create(-1);
 
+	if (c->first_allocation_dirty) {
+		c->first_allocation_dirty = 0;
+		category_update_first_allocation(c, c->last_max_worker);
+	}
+
 	if (c->allocation_mode != CATEGORY_ALLOCATION_MODE_FIXED && c->allocation_mode != CATEGORY_ALLOCATION_MODE_MAX) {
 		if (category_in_steady_state(c) && (c->allocation_mode == CATEGORY_ALLOCATION_MODE_MIN_WASTE || c->allocation_mode == CATEGORY_ALLOCATION_MODE_MAX_THROUGHPUT)) {
 			/* load max seen values, but only if not in fixed or max mode.
@@ -91,6 +91,20 @@ struct category {
 	/* completions since last time first-allocation was updated. */
 	int64_t completions_since_last_reset;
 
+	/* set when completions have accumulated since the last recomputation;
+	the recomputation itself is deferred to the next time the allocation
+	is consulted, so task completion never walks the histograms. */
+	int first_allocation_dirty;
+
+	/* most recent worker bound seen, for the deferred recomputation. */
+	struct rmsummary *last_max_worker;
+
+	/* ring of recent successful execution times, for percentile-based
+	straggler detection; zero count means no samples yet. */
+	double *runtime_samples;
+	int runtime_sample_count;
+	int runtime_sample_next;
+
   /* maximum number of tasks of this category allowed to be running concurrently. If less than 0, unlimited. */
   int64_t max_concurrent;
 
@@ -134,6 +148,12 @@ int category_in_bucketing_mode(struct category* c);
 
 int category_update_first_allocation(struct category *c, const struct rmsummary *max_worker);
 
+/** Record a successful execution time for percentile-based straggler detection. */
+void category_runtime_sample(struct category *c, double runtime);
+
+/** Return the given percentile (0-100) of recent successful execution times, or 0 with no samples. */
+double category_runtime_percentile(struct category *c, double percentile);
+
 int category_in_steady_state(struct category *c);
 
 category_allocation_t category_next_label(struct category *c, category_allocation_t current_label, int resource_overflow, struct rmsummary *user, struct rmsummary *measured);
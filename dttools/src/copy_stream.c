@@ -25,6 +25,31 @@ See the file COPYING for details.
 
 #define COPY_BUFFER_SIZE (1 << 16)
 
+/* One kernel-offload transfer step: a large chunk moved without passing
+through userspace.  Returns the bytes moved, zero at end of input, or
+-1 if this pair of descriptors cannot be offloaded and the caller
+should fall back to an ordinary read/write loop. */
+
+static int64_t copy_offload_step(int in, int out)
+{
+#ifdef __linux__
+	ssize_t n = copy_file_range(in, 0, out, 0, 1 << 24, 0);
+	if (n >= 0)
+		return n;
+	/*
+	EXDEV: cross-filesystem; EINVAL/EBADF/ENOSYS and friends: a pipe,
+	socket, or special file is involved.  splice covers the case where
+	exactly one side is a pipe; otherwise use the userspace loop.
+	*/
+	if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EBADF) {
+		n = splice(in, 0, out, 0, 1 << 24, 0);
+		if (n >= 0)
+			return n;
+	}
+#endif
+	return -1;
+}
+
 int64_t copy_fd_to_stream(int fd, FILE *output)
 {
 	int64_t total = 0;
@@ -54,6 +79,20 @@ int64_t copy_fd_to_fd(int in, int out)
 {
 	int64_t total = 0;
 
+	/* First try to let the kernel move the data directly. */
+	while (1) {
+		int64_t moved = copy_offload_step(in, out);
+		if (moved > 0) {
+			total += moved;
+		} else if (moved == 0) {
+			return total;
+		} else {
+			break;
+		}
+	}
+
+	/* A step refused: finish with the ordinary userspace loop. */
+
 	while (1) {
 		char buffer[COPY_BUFFER_SIZE];
 
@@ -107,6 +146,59 @@ int64_t copy_file_to_file(const char *input, const char *output)
 	return total;
 }
 
+int64_t copy_file_to_file_hint(const char *input, const char *output, int64_t size_hint)
+{
+	int in = open(input, O_RDONLY);
+	if (in == -1)
+		return -1;
+	struct stat info;
+	if (fstat(in, &info) == -1) {
+		close(in);
+		return -1;
+	}
+
+	int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, info.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO));
+	if (out == -1 && errno == ENOTDIR) {
+		char dir[PATH_MAX];
+		path_dirname(output, dir);
+		if (create_dir(dir, S_IRWXU)) {
+			out = open(output, O_WRONLY | O_CREAT | O_TRUNC, info.st_mode);
+		}
+	}
+	if (out == -1) {
+		close(in);
+		return -1;
+	}
+
+	/*
+	Reserve the destination up front so a multi-GB copy neither
+	fragments nor fails halfway through on a full disk.  Filesystems
+	without preallocation just proceed without it.
+	*/
+	if (size_hint <= 0)
+		size_hint = info.st_size;
+#ifdef __linux__
+	if (size_hint > 0)
+		(void)posix_fallocate(out, 0, size_hint);
+#endif
+
+	int64_t total = copy_fd_to_fd(in, out);
+
+	/* an overestimated hint must not leave zero padding behind */
+	if (total >= 0 && total < size_hint) {
+		if (ftruncate(out, total) != 0) {
+			close(in);
+			close(out);
+			return -1;
+		}
+	}
+
+	close(in);
+	close(out);
+
+	return total;
+}
+
 int64_t copy_file_to_buffer(const char *filename, char **buffer, size_t *len)
 {
 	size_t _len;
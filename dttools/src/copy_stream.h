@@ -16,6 +16,12 @@ int64_t copy_fd_to_fd(int in, int out);
 int64_t copy_fd_to_stream(int fd, FILE *output);
 
 int64_t copy_file_to_file(const char *input, const char *output);
+
+/* Like copy_file_to_file, but preallocates the destination using the
+given expected size (or the source size if the hint is zero), so large
+staged inputs neither fragment nor fail halfway through on a full
+disk. */
+int64_t copy_file_to_file_hint(const char *input, const char *output, int64_t size_hint);
 int64_t copy_file_to_buffer(const char *path, char **buffer, size_t *len);
 
 int64_t copy_stream_to_buffer(FILE *input, char **buffer, size_t *len);
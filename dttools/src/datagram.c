@@ -133,6 +133,102 @@ int datagram_recv(struct datagram *d, char *data, int length, char *addr, int *p
 	return result;
 }
 
+/*
+Wait until at least one datagram is ready, using the same retry
+semantics as datagram_recv.  Returns positive when the socket is
+readable, negative on error.
+*/
+
+static int datagram_wait(struct datagram *d, int timeout)
+{
+	fd_set fds;
+	struct timeval tm;
+
+	while (1) {
+		tm.tv_sec = timeout / 1000000;
+		tm.tv_usec = timeout % 1000000;
+
+		FD_ZERO(&fds);
+		FD_SET(d->fd, &fds);
+
+		int result = select(d->fd + 1, &fds, 0, 0, &tm);
+		if (result > 0) {
+			if (FD_ISSET(d->fd, &fds))
+				return 1;
+		} else if (result < 0 && errno_is_temporary(errno)) {
+			continue;
+		} else if (result == 0) {
+			errno = EWOULDBLOCK;
+			return -1;
+		} else {
+			return -1;
+		}
+	}
+}
+
+int datagram_recv_batch(struct datagram *d, struct datagram_message *msgs, int count, int timeout)
+{
+	if (count < 1)
+		return 0;
+	if (count > DATAGRAM_BATCH_MAX)
+		count = DATAGRAM_BATCH_MAX;
+
+#ifdef __linux__
+	struct mmsghdr hdrs[DATAGRAM_BATCH_MAX];
+	struct iovec iovs[DATAGRAM_BATCH_MAX];
+	struct sockaddr_storage addrs[DATAGRAM_BATCH_MAX];
+	int i, n;
+
+	if (datagram_wait(d, timeout) < 0)
+		return errno == EWOULDBLOCK ? 0 : -1;
+
+	memset(hdrs, 0, count * sizeof(*hdrs));
+	for (i = 0; i < count; i++) {
+		/* leave one byte so the payload can always be null terminated */
+		iovs[i].iov_base = msgs[i].data;
+		iovs[i].iov_len = DATAGRAM_PAYLOAD_MAX - 1;
+		hdrs[i].msg_hdr.msg_iov = &iovs[i];
+		hdrs[i].msg_hdr.msg_iovlen = 1;
+		hdrs[i].msg_hdr.msg_name = &addrs[i];
+		hdrs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+	}
+
+	while ((n = recvmmsg(d->fd, hdrs, count, MSG_DONTWAIT, 0)) < 0) {
+		if (errno == EWOULDBLOCK || errno == EAGAIN)
+			return 0;
+		if (errno_is_temporary(errno))
+			continue;
+		return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		char port_string[16];
+		msgs[i].length = hdrs[i].msg_len;
+		msgs[i].data[msgs[i].length] = 0;
+		msgs[i].addr[0] = 0;
+		msgs[i].port = 0;
+		getnameinfo((struct sockaddr *)&addrs[i], hdrs[i].msg_hdr.msg_namelen, msgs[i].addr, DATAGRAM_ADDRESS_MAX, port_string, sizeof(port_string), NI_NUMERICHOST | NI_NUMERICSERV);
+		msgs[i].port = atoi(port_string);
+	}
+
+	return n;
+#else
+	/* Without recvmmsg, collect the batch one receive at a time. */
+	int n = 0;
+
+	while (n < count) {
+		int result = datagram_recv(d, msgs[n].data, DATAGRAM_PAYLOAD_MAX - 1, msgs[n].addr, &msgs[n].port, n == 0 ? timeout : 0);
+		if (result < 0)
+			break;
+		msgs[n].length = result;
+		msgs[n].data[result] = 0;
+		n++;
+	}
+
+	return n;
+#endif
+}
+
 int datagram_send(struct datagram *d, const char *data, int length, const char *addr, int port)
 {
 	int result;
@@ -98,6 +98,30 @@ void datagram_delete(struct datagram *d);
 */
 int datagram_recv(struct datagram *d, char *data, int length, char *addr, int *port, int timeout);
 
+/** Maximum number of messages accepted by @ref datagram_recv_batch at once. */
+#define DATAGRAM_BATCH_MAX 64
+
+/** A single message received as part of a batch. */
+struct datagram_message {
+	char data[DATAGRAM_PAYLOAD_MAX]; /**< The payload, null terminated. */
+	char addr[DATAGRAM_ADDRESS_MAX]; /**< The IP address of the sender. */
+	int port;			 /**< The port number of the sender. */
+	int length;			 /**< The number of payload bytes received. */
+};
+
+/** Receive a batch of datagrams.
+Waits up to the timeout for the first message, then drains whatever
+further messages are immediately available, up to the given count.
+On Linux the whole batch is collected with a single recvmmsg system
+call, which matters for high packet rates such as catalog updates.
+@param d The datagram object.
+@param msgs An array of messages to fill in.
+@param count The capacity of the array, at most DATAGRAM_BATCH_MAX.
+@param timeout Maximum time to wait for the first message, in microseconds.
+@return The number of messages received, zero if the timeout expired first, or less than zero on error.
+*/
+int datagram_recv_batch(struct datagram *d, struct datagram_message *msgs, int count, int timeout);
+
 /** Send a datagram.
 @param d The datagram object.
 @param data The data to send.
@@ -27,7 +27,11 @@ extern void debug_stderr_write(int64_t flags, const char *str);
 extern void debug_stdout_write(int64_t flags, const char *str);
 
 extern void debug_file_write(int64_t flags, const char *str);
+extern void debug_buffer_write(int64_t flags, const char *str);
+extern void debug_buffer_flush(void);
+extern int debug_buffer_config(int entries, void (*write)(int64_t flags, const char *str));
 extern void debug_file_size(off_t size);
+extern void debug_file_rotation(int keep, int compress);
 extern int debug_file_path(const char *path);
 extern void debug_file_rename(const char *suffix);
 extern int debug_file_reopen(void);
@@ -176,7 +180,7 @@ static void do_debug(int64_t flags, const char *fmt, va_list args)
 	buffer_ubuf(&B, ubuf, sizeof(ubuf));
 	buffer_max(&B, sizeof(ubuf));
 
-	if (debug_write == debug_file_write || debug_write == debug_stderr_write || debug_write == debug_stdout_write) {
+	if (debug_write == debug_file_write || debug_write == debug_stderr_write || debug_write == debug_stdout_write || debug_write == debug_buffer_write) {
 		struct timeval tv;
 		struct tm *tm;
 		gettimeofday(&tv, 0);
@@ -311,11 +315,26 @@ void debug_config(const char *name)
 	strncpy(debug_program_name, path_basename(name), sizeof(debug_program_name) - 1);
 }
 
+int debug_config_buffer(int entries)
+{
+	if (debug_write == debug_buffer_write)
+		return 0;
+	if (debug_buffer_config(entries, debug_write) == -1)
+		return -1;
+	debug_write = debug_buffer_write;
+	return 0;
+}
+
 void debug_config_file_size(off_t size)
 {
 	debug_file_size(size);
 }
 
+void debug_config_file_rotation(int keep, int compress)
+{
+	debug_file_rotation(keep, compress);
+}
+
 void debug_config_getpid(pid_t (*getpidf)(void))
 {
 	debug_getpid = getpidf;
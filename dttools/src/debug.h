@@ -121,8 +121,10 @@ modify the linker namespace we are using.
 #define notice                 cctools_notice
 #define warn                   cctools_warn
 #define debug_config           cctools_debug_config
+#define debug_config_buffer    cctools_debug_config_buffer
 #define debug_config_file      cctools_debug_config_file
 #define debug_config_file_size cctools_debug_config_file_size
+#define debug_config_file_rotation cctools_debug_config_file_rotation
 #define debug_config_fatal     cctools_debug_config_fatal
 #define debug_config_getpid    cctools_debug_config_getpid
 #define debug_flags_set        cctools_debug_flags_set
@@ -185,6 +187,18 @@ Must be called before any other calls take place.
 
 void debug_config(const char *name);
 
+/** Buffer debug output in memory.
+Messages are appended to an in-memory ring and written to the
+configured destination by a background thread, so components logging
+on a hot path do not pay a write system call per message.  If messages
+arrive faster than they can be written, the ring drops them and
+records how many were lost.  Errors and fatal messages are still
+written synchronously.  Call after @ref debug_config_file.
+@param entries The number of messages the ring can hold.
+@return Zero on success, -1 on allocation failure.
+*/
+int debug_config_buffer(int entries);
+
 /** Direct debug output to a file.
 All enabled debugging statements will be sent to this file.
 @param file The pathname of the file for output.
@@ -204,6 +218,17 @@ When it exceeds this size, it will be renamed to (file).old, and a new file will
 
 void debug_config_file_size(off_t size);
 
+/** Keep several rotated debug logs, optionally compressed.
+When the log reaches the size given to @ref debug_config_file_size it
+is rotated into numbered segments file.1 .. file.keep, with the oldest
+discarded; with compress set, rotated segments are gzip-compressed by
+a background thread so logging itself never blocks.  Without this
+call, rotation keeps the historical single ".old" file, uncompressed.
+@param keep The number of rotated segments to retain.
+@param compress If nonzero, compress rotated segments in the background.
+*/
+void debug_config_file_rotation(int keep, int compress);
+
 void debug_config_fatal(void (*callback) (void));
 
 void debug_config_getpid (pid_t (*getpidf)(void));
@@ -0,0 +1,160 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+/*
+A buffered debug backend: messages are appended to an in-memory ring
+and written out by a background thread, so components logging on a hot
+path pay a short critical section instead of a write system call (and
+the rotation stat that goes with it) per message.  If producers outrun
+the flusher the ring drops messages and says how many were lost, which
+bounds the overhead of leaving diagnostic logging enabled in
+production.
+*/
+
+#include "debug.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEBUG_BUFFER_SLOT_MAX 1024
+
+struct debug_buffer_entry {
+	int64_t flags;
+	size_t length;
+	char data[DEBUG_BUFFER_SLOT_MAX];
+};
+
+static struct debug_buffer_entry *ring = 0;
+static int ring_size = 0;
+static int ring_head = 0; /* next slot to fill */
+static int ring_tail = 0; /* next slot to drain */
+static int ring_count = 0;
+static int64_t ring_dropped = 0;
+
+static void (*underlying_write)(int64_t flags, const char *str) = 0;
+
+static pthread_mutex_t ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ring_nonempty = PTHREAD_COND_INITIALIZER;
+static pthread_t flusher;
+static int flusher_running = 0;
+
+/* Drain everything currently in the ring to the underlying backend.  Called with the lock held. */
+
+static void drain_locked(void)
+{
+	while (ring_count > 0) {
+		struct debug_buffer_entry e = ring[ring_tail];
+		ring_tail = (ring_tail + 1) % ring_size;
+		ring_count--;
+
+		/* drop the lock while writing, so producers are not blocked behind the disk */
+		pthread_mutex_unlock(&ring_mutex);
+		underlying_write(e.flags, e.data);
+		pthread_mutex_lock(&ring_mutex);
+	}
+
+	if (ring_dropped > 0) {
+		char note[128];
+		snprintf(note, sizeof(note), "debug: %" PRId64 " messages dropped by buffered logging\n", ring_dropped);
+		ring_dropped = 0;
+		pthread_mutex_unlock(&ring_mutex);
+		underlying_write(D_NOTICE, note);
+		pthread_mutex_lock(&ring_mutex);
+	}
+}
+
+static void *flusher_main(void *arg)
+{
+	pthread_mutex_lock(&ring_mutex);
+	while (1) {
+		while (ring_count == 0) {
+			pthread_cond_wait(&ring_nonempty, &ring_mutex);
+		}
+		drain_locked();
+	}
+	return 0;
+}
+
+void debug_buffer_flush(void)
+{
+	pthread_mutex_lock(&ring_mutex);
+	if (ring)
+		drain_locked();
+	pthread_mutex_unlock(&ring_mutex);
+}
+
+void debug_buffer_write(int64_t flags, const char *str)
+{
+	pthread_mutex_lock(&ring_mutex);
+
+	if (ring_count >= ring_size) {
+		ring_dropped++;
+		pthread_mutex_unlock(&ring_mutex);
+		return;
+	}
+
+	struct debug_buffer_entry *e = &ring[ring_head];
+	ring_head = (ring_head + 1) % ring_size;
+	ring_count++;
+
+	e->flags = flags;
+	e->length = strlen(str);
+	if (e->length >= sizeof(e->data))
+		e->length = sizeof(e->data) - 1;
+	memcpy(e->data, str, e->length);
+	e->data[e->length] = 0;
+
+	/*
+	Errors and fatal messages are drained synchronously, so they
+	reach the log (in order) even if the process dies right after.
+	*/
+	if (flags & (D_ERROR | D_NOTICE | D_FATAL)) {
+		drain_locked();
+		pthread_mutex_unlock(&ring_mutex);
+		return;
+	}
+
+	pthread_cond_signal(&ring_nonempty);
+	pthread_mutex_unlock(&ring_mutex);
+}
+
+int debug_buffer_config(int entries, void (*write)(int64_t flags, const char *str))
+{
+	if (entries < 16)
+		entries = 16;
+
+	pthread_mutex_lock(&ring_mutex);
+
+	if (!ring) {
+		ring = calloc(entries, sizeof(*ring));
+		if (!ring) {
+			pthread_mutex_unlock(&ring_mutex);
+			return -1;
+		}
+		ring_size = entries;
+	}
+
+	underlying_write = write;
+
+	if (!flusher_running) {
+		if (pthread_create(&flusher, 0, flusher_main, 0) != 0) {
+			free(ring);
+			ring = 0;
+			pthread_mutex_unlock(&ring_mutex);
+			return -1;
+		}
+		pthread_detach(flusher);
+		flusher_running = 1;
+		atexit(debug_buffer_flush);
+	}
+
+	pthread_mutex_unlock(&ring_mutex);
+	return 0;
+}
+
+/* vim: set noexpandtab tabstop=8: */
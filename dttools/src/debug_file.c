@@ -11,8 +11,11 @@ See the file COPYING for details.
 #include "stringtools.h"
 
 #include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
 
+#include <zlib.h>
+
 #include <sys/stat.h>
 
 #include <errno.h>
@@ -27,6 +30,98 @@ static char file_path[PATH_MAX];
 /* Default size of 0 will not roll over debug info. */
 static off_t file_size_max = 0;
 
+/*
+With rotation configured, rotated logs are kept as file.1 .. file.N
+(compressed in the background when requested) instead of a single
+file.old, so always-on debug logging neither grows without bound nor
+ships uncompressed.  The defaults preserve the historical single
+".old" behavior.
+*/
+static int file_retain_max = 0; /* 0: historical single .old segment */
+static int file_compress = 0;
+
+static void *compress_segment(void *arg)
+{
+	char *tmp_path = arg;
+	char gz_tmp[PATH_MAX];
+	char gz_final[PATH_MAX];
+	char buf[1 << 16];
+
+	string_nformat(gz_tmp, sizeof(gz_tmp), "%s.gz", tmp_path);
+	string_nformat(gz_final, sizeof(gz_final), "%s.1.gz", file_path);
+
+	int in = open(tmp_path, O_RDONLY);
+	if (in >= 0) {
+		gzFile out = gzopen(gz_tmp, "w");
+		if (out) {
+			ssize_t n;
+			while ((n = read(in, buf, sizeof(buf))) > 0) {
+				if (gzwrite(out, buf, n) != n)
+					break;
+			}
+			gzclose(out);
+			rename(gz_tmp, gz_final);
+		}
+		close(in);
+		unlink(tmp_path);
+	}
+
+	free(tmp_path);
+	return NULL;
+}
+
+/* Shift file.i to file.(i+1), oldest first, for both plain and compressed names. */
+
+static void rotate_segments(void)
+{
+	char from[PATH_MAX], to[PATH_MAX];
+	int i;
+
+	for (i = file_retain_max; i >= 2; i--) {
+		string_nformat(from, sizeof(from), "%s.%d.gz", file_path, i - 1);
+		string_nformat(to, sizeof(to), "%s.%d.gz", file_path, i);
+		rename(from, to);
+		string_nformat(from, sizeof(from), "%s.%d", file_path, i - 1);
+		string_nformat(to, sizeof(to), "%s.%d", file_path, i);
+		rename(from, to);
+	}
+
+	if (file_compress) {
+		/*
+		Move the current log to a private name first, so a
+		compression still running from an earlier rotation can
+		never collide, then compress it off the logging path.
+		The result lands in the .1 slot when done.
+		*/
+		static unsigned rotation = 0;
+		char *tmp = string_format("%s.ztmp.%d.%u", file_path, (int)getpid(), rotation++);
+		if (rename(file_path, tmp) == 0) {
+			pthread_t t;
+			if (pthread_create(&t, 0, compress_segment, tmp) == 0) {
+				pthread_detach(t);
+			} else {
+				/* no thread: keep the segment uncompressed */
+				string_nformat(to, sizeof(to), "%s.1", file_path);
+				rename(tmp, to);
+				free(tmp);
+			}
+		} else {
+			free(tmp);
+		}
+	} else {
+		string_nformat(to, sizeof(to), "%s.1", file_path);
+		rename(file_path, to);
+	}
+}
+
+void debug_file_rotation(int keep, int compress)
+{
+	if (keep < 0)
+		keep = 0;
+	file_retain_max = keep;
+	file_compress = compress;
+}
+
 /* define custom debug for catch */
 #undef debug
 #define debug(l, fmt, ...) fprintf(stderr, "%s: " fmt "\n", #l, __VA_ARGS__);
@@ -75,9 +170,13 @@ void debug_file_write(INT64_T flags, const char *str)
 		rc = stat(file_path, &info);
 		if (rc == 0) {
 			if (info.st_size >= file_size_max) {
-				char old[PATH_MAX];
-				string_nformat(old, sizeof(old), "%s.old", file_path);
-				rename(file_path, old);
+				if (file_retain_max > 0) {
+					rotate_segments();
+				} else {
+					char old[PATH_MAX];
+					string_nformat(old, sizeof(old), "%s.old", file_path);
+					rename(file_path, old);
+				}
 				debug_file_reopen();
 			} else if (info.st_ino != file_stat.st_ino) {
 				/* another process rotated the log */
@@ -9,18 +9,214 @@ See the file COPYING for details.
 
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/mount.h>
+#include <sys/quota.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
 #include <unistd.h>
+#include <linux/fs.h>
+#include <linux/dqblk_xfs.h>
 
 #include "disk_alloc.h"
 #include "path.h"
 #include "stringtools.h"
+#include "xxmalloc.h"
+
+#ifndef BTRFS_SUPER_MAGIC
+#define BTRFS_SUPER_MAGIC 0x9123683E
+#endif
+
+#ifndef PRJQUOTA
+#define PRJQUOTA 2
+#endif
+
+/*
+Two metadata-only backends sit alongside the loopback images: "btrfs"
+creates a subvolume with a qgroup limit, and "projquota" tags the
+sandbox directory with a project id (the directory's inode number)
+and sets a project hard limit, on xfs or ext4 hosts mounted with
+project quota.  Both enforce the same hard ENOSPC semantics the
+workers rely on, but setup and teardown cost a few metadata
+operations instead of seconds of image, loop device, and filesystem
+work per task -- and tasks write at native speed, with no extra
+block layer underneath.  Selection stays explicit through the fs
+argument; either backend fails cleanly where the host filesystem
+lacks the feature, and the caller falls back as it does today.
+*/
+
+/* Find the block device holding path, for quotactl. */
+static char *disk_alloc_find_device(const char *path)
+{
+	char device[4096] = "";
+	char mount_point[4096];
+	char line_device[4096];
+	char line_mount[4096];
+	size_t best = 0;
+
+	FILE *mounts = fopen("/proc/mounts", "r");
+	if (!mounts)
+		return NULL;
+
+	char line[8192];
+	while (fgets(line, sizeof(line), mounts)) {
+		if (sscanf(line, "%4095s %4095s", line_device, line_mount) != 2)
+			continue;
+		size_t n = strlen(line_mount);
+		/* the match must end on a path component boundary: with /data
+		mounted, /data2/... belongs to some other filesystem */
+		if (n >= best && strncmp(path, line_mount, n) == 0 && line_device[0] == '/') {
+			if (!(n == 1 && line_mount[0] == '/') && path[n] != '/' && path[n] != '\0')
+				continue;
+			best = n;
+			strcpy(device, line_device);
+			strcpy(mount_point, line_mount);
+		}
+	}
+	fclose(mounts);
+
+	if (!device[0])
+		return NULL;
+	return xxstrdup(device);
+}
+
+/* Set (or clear, with size zero) the project quota hard limit. */
+static int disk_alloc_project_limit(const char *device, uint32_t projid, int64_t size)
+{
+	/* xfs speaks its own quota command set */
+	struct fs_disk_quota xquota;
+	memset(&xquota, 0, sizeof(xquota));
+	xquota.d_version = FS_DQUOT_VERSION;
+	xquota.d_flags = FS_PROJ_QUOTA;
+	xquota.d_id = projid;
+	xquota.d_fieldmask = FS_DQ_BHARD | FS_DQ_BSOFT;
+	xquota.d_blk_hardlimit = (size * 1024) / 512; /* basic blocks */
+	xquota.d_blk_softlimit = xquota.d_blk_hardlimit;
+
+	if (quotactl(QCMD(Q_XSETQLIM, PRJQUOTA), device, projid, (caddr_t)&xquota) == 0)
+		return 0;
+
+	/* the vfs path covers ext4 */
+	struct dqblk quota;
+	memset(&quota, 0, sizeof(quota));
+	quota.dqb_bhardlimit = size; /* dqb limits are in kilobytes */
+	quota.dqb_bsoftlimit = size;
+	quota.dqb_valid = QIF_BLIMITS;
+
+	return quotactl(QCMD(Q_SETQUOTA, PRJQUOTA), device, projid, (caddr_t)&quota);
+}
+
+static int disk_alloc_create_projquota(char *loc, int64_t size)
+{
+	if (mkdir(loc, 0777) != 0) {
+		debug(D_NOTICE, "Failed to make directory at requested mountpoint: %s.\n", strerror(errno));
+		return 1;
+	}
+
+	int dirfd = open(loc, O_RDONLY | O_DIRECTORY);
+	if (dirfd < 0)
+		goto error;
+
+	struct stat info;
+	if (fstat(dirfd, &info) != 0) {
+		close(dirfd);
+		goto error;
+	}
+
+	/* The inode number is unique on the filesystem and recoverable at
+	delete time, so it serves as the project id. */
+	struct fsxattr attr;
+	if (ioctl(dirfd, FS_IOC_FSGETXATTR, &attr) != 0) {
+		close(dirfd);
+		goto error;
+	}
+	attr.fsx_projid = (uint32_t)info.st_ino;
+	attr.fsx_xflags |= FS_XFLAG_PROJINHERIT;
+	if (ioctl(dirfd, FS_IOC_FSSETXATTR, &attr) != 0) {
+		debug(D_NOTICE, "Failed to set project id on sandbox: %s.\n", strerror(errno));
+		close(dirfd);
+		goto error;
+	}
+	close(dirfd);
+
+	char *device = disk_alloc_find_device(loc);
+	if (!device)
+		goto error;
+
+	if (disk_alloc_project_limit(device, (uint32_t)info.st_ino, size) != 0) {
+		debug(D_NOTICE, "Failed to set project quota limit: %s.\n", strerror(errno));
+		free(device);
+		goto error;
+	}
+	free(device);
+
+	return 0;
+
+error:
+	rmdir(loc);
+	return 1;
+}
+
+static int disk_alloc_delete_projquota(char *loc, uint32_t projid)
+{
+	char *device = disk_alloc_find_device(loc);
+	if (device) {
+		disk_alloc_project_limit(device, projid, 0);
+		free(device);
+	}
+
+	char *rm_args = string_format("rm -rf %s", loc);
+	int result = system(rm_args);
+	free(rm_args);
+
+	return result == 0 ? 0 : 1;
+}
+
+static int disk_alloc_create_btrfs(char *loc, int64_t size)
+{
+	char *create_args = string_format("btrfs subvolume create %s > /dev/null 2> /dev/null", loc);
+	char *limit_args = string_format("btrfs qgroup limit %" PRId64 "K %s > /dev/null 2> /dev/null", size, loc);
+
+	int result = system(create_args);
+	if (result == 0) {
+		result = system(limit_args);
+		if (result != 0) {
+			debug(D_NOTICE, "Failed to set qgroup limit on subvolume: %s.\n", strerror(errno));
+			char *delete_args = string_format("btrfs subvolume delete %s > /dev/null 2> /dev/null", loc);
+			if (system(delete_args) != 0) {
+				debug(D_NOTICE, "Failed to remove subvolume while attempting to clean up after failure: %s.\n", strerror(errno));
+			}
+			free(delete_args);
+		}
+	} else {
+		debug(D_NOTICE, "Failed to create btrfs subvolume: %s.\n", strerror(errno));
+	}
+
+	free(create_args);
+	free(limit_args);
+
+	return result == 0 ? 0 : 1;
+}
+
+static int disk_alloc_delete_btrfs(char *loc)
+{
+	char *delete_args = string_format("btrfs subvolume delete %s > /dev/null 2> /dev/null", loc);
+	int result = system(delete_args);
+	free(delete_args);
+
+	if (result != 0) {
+		debug(D_NOTICE, "Failed to delete btrfs subvolume: %s.\n", strerror(errno));
+		return 1;
+	}
+
+	return 0;
+}
 
 int disk_alloc_create(char *loc, char *fs, int64_t size)
 {
@@ -32,6 +228,14 @@ int disk_alloc_create(char *loc, char *fs, int64_t size)
 
 	// Check for trailing '/'
 	path_remove_trailing_slashes(loc);
+
+	if (strcmp(fs, "btrfs") == 0) {
+		return disk_alloc_create_btrfs(loc, size);
+	}
+	if (strcmp(fs, "projquota") == 0) {
+		return disk_alloc_create_projquota(loc, size);
+	}
+
 	int result;
 	char *device_loc = NULL;
 	char *dd_args = NULL;
@@ -158,6 +362,30 @@ int disk_alloc_delete(char *loc)
 
 	// Check for trailing '/'
 	path_remove_trailing_slashes(loc);
+
+	/* A btrfs subvolume is recognized by its filesystem and root
+	inode; a project-quota sandbox by the project id it was tagged
+	with at creation.  Everything else is a loopback image. */
+	{
+		struct statfs fsinfo;
+		struct stat info;
+		if (statfs(loc, &fsinfo) == 0 && stat(loc, &info) == 0) {
+			if (fsinfo.f_type == BTRFS_SUPER_MAGIC && info.st_ino == 256) {
+				return disk_alloc_delete_btrfs(loc);
+			}
+
+			int dirfd = open(loc, O_RDONLY | O_DIRECTORY);
+			if (dirfd >= 0) {
+				struct fsxattr attr;
+				int have_attr = ioctl(dirfd, FS_IOC_FSGETXATTR, &attr);
+				close(dirfd);
+				if (have_attr == 0 && attr.fsx_projid != 0 && attr.fsx_projid == (uint32_t)info.st_ino) {
+					return disk_alloc_delete_projquota(loc, attr.fsx_projid);
+				}
+			}
+		}
+	}
+
 	// Check if location is relative or absolute
 	result = strncmp(loc, "/", 1);
 	if (result != 0) {
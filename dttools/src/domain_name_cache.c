@@ -8,9 +8,11 @@ See the file COPYING for details.
 #include "domain_name_cache.h"
 #include "debug.h"
 #include "hash_cache.h"
+#include "hash_table.h"
 #include "stringtools.h"
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,9 +21,29 @@ See the file COPYING for details.
 /* cache domain names for up to five minutes */
 #define DOMAIN_NAME_CACHE_LIFETIME 300
 
+/* remember failed lookups briefly, so one broken record does not stall every event */
+#define DOMAIN_NAME_FAILURE_LIFETIME 60
+
 static struct hash_cache *name_to_addr = 0;
 static struct hash_cache *addr_to_name = 0;
 
+/* a sentinel cache value marking a lookup known to fail */
+static const char DOMAIN_NAME_FAILED[] = "\1failed";
+
+/*
+The caches are shared with the asynchronous resolver threads below, so
+every access goes through this lock.  The actual DNS calls happen
+outside it.
+*/
+static pthread_mutex_t dns_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void dns_failure_note(struct hash_cache *cache, const char *key)
+{
+	char *copy = strdup(DOMAIN_NAME_FAILED);
+	if (copy)
+		hash_cache_insert(cache, key, copy, DOMAIN_NAME_FAILURE_LIFETIME);
+}
+
 static int domain_name_cache_init()
 {
 	if (!name_to_addr) {
@@ -52,24 +74,37 @@ int domain_name_cache_lookup(const char *name, char *addr)
 	char *found, *copy;
 	int success;
 
-	if (!domain_name_cache_init())
+	pthread_mutex_lock(&dns_lock);
+
+	if (!domain_name_cache_init()) {
+		pthread_mutex_unlock(&dns_lock);
 		return 0;
+	}
 
 	found = hash_cache_lookup(name_to_addr, name);
 	if (found) {
-		strcpy(addr, found);
-		return 1;
+		int ok = strcmp(found, DOMAIN_NAME_FAILED) != 0;
+		if (ok)
+			strcpy(addr, found);
+		pthread_mutex_unlock(&dns_lock);
+		return ok;
 	}
 
+	pthread_mutex_unlock(&dns_lock);
+
 	success = domain_name_lookup(name, addr);
-	if (!success)
+
+	pthread_mutex_lock(&dns_lock);
+	if (!success) {
+		dns_failure_note(name_to_addr, name);
+		pthread_mutex_unlock(&dns_lock);
 		return 0;
+	}
 
 	copy = strdup(addr);
-	if (!copy)
-		return 1;
-
-	success = hash_cache_insert(name_to_addr, name, copy, DOMAIN_NAME_CACHE_LIFETIME);
+	if (copy)
+		hash_cache_insert(name_to_addr, name, copy, DOMAIN_NAME_CACHE_LIFETIME);
+	pthread_mutex_unlock(&dns_lock);
 
 	return 1;
 }
@@ -79,28 +114,176 @@ int domain_name_cache_lookup_reverse(const char *addr, char *name)
 	char *found, *copy;
 	int success;
 
-	if (!domain_name_cache_init())
+	pthread_mutex_lock(&dns_lock);
+
+	if (!domain_name_cache_init()) {
+		pthread_mutex_unlock(&dns_lock);
 		return 0;
+	}
 
 	found = hash_cache_lookup(addr_to_name, addr);
 	if (found) {
-		strcpy(name, found);
-		return 1;
+		int ok = strcmp(found, DOMAIN_NAME_FAILED) != 0;
+		if (ok)
+			strcpy(name, found);
+		pthread_mutex_unlock(&dns_lock);
+		return ok;
 	}
 
+	pthread_mutex_unlock(&dns_lock);
+
 	success = domain_name_lookup_reverse(addr, name);
-	if (!success)
+
+	pthread_mutex_lock(&dns_lock);
+	if (!success) {
+		dns_failure_note(addr_to_name, addr);
+		pthread_mutex_unlock(&dns_lock);
 		return 0;
+	}
 
 	copy = strdup(name);
-	if (!copy)
-		return 1;
-
-	success = hash_cache_insert(addr_to_name, addr, copy, DOMAIN_NAME_CACHE_LIFETIME);
+	if (copy)
+		hash_cache_insert(addr_to_name, addr, copy, DOMAIN_NAME_CACHE_LIFETIME);
+	pthread_mutex_unlock(&dns_lock);
 
 	return 1;
 }
 
+/*
+Asynchronous resolution: a small pool of threads performs the actual
+DNS calls and deposits results (or failure notes) into the caches, so
+a single-threaded event loop never waits on a resolver.  The async
+entry points return immediately: a cache hit resolves now, a miss
+queues the work and reports it as in progress; callers simply retry on
+a later event and find the answer in the cache.
+*/
+
+#define DNS_WORKERS 2
+
+struct dns_request {
+	char name[DOMAIN_NAME_MAX];
+	int reverse;
+	struct dns_request *next;
+};
+
+static struct dns_request *dns_queue_head = 0;
+static struct dns_request *dns_queue_tail = 0;
+static pthread_cond_t dns_wakeup = PTHREAD_COND_INITIALIZER;
+static int dns_workers_running = 0;
+static struct hash_table *dns_in_flight = 0;
+
+static void *dns_worker(void *arg)
+{
+	pthread_mutex_lock(&dns_lock);
+	while (1) {
+		while (!dns_queue_head) {
+			pthread_cond_wait(&dns_wakeup, &dns_lock);
+		}
+		struct dns_request *r = dns_queue_head;
+		dns_queue_head = r->next;
+		if (!dns_queue_head)
+			dns_queue_tail = 0;
+		pthread_mutex_unlock(&dns_lock);
+
+		char result[DOMAIN_NAME_MAX];
+		int success;
+		if (r->reverse) {
+			success = domain_name_lookup_reverse(r->name, result);
+		} else {
+			success = domain_name_lookup(r->name, result);
+		}
+
+		pthread_mutex_lock(&dns_lock);
+		struct hash_cache *cache = r->reverse ? addr_to_name : name_to_addr;
+		if (success) {
+			char *copy = strdup(result);
+			if (copy)
+				hash_cache_insert(cache, r->name, copy, DOMAIN_NAME_CACHE_LIFETIME);
+		} else {
+			dns_failure_note(cache, r->name);
+		}
+		hash_table_remove(dns_in_flight, r->name);
+		free(r);
+	}
+	return 0;
+}
+
+/* Queue a lookup if not already in flight.  Called with the lock held. */
+
+static void dns_submit(const char *name, int reverse)
+{
+	if (!dns_in_flight)
+		dns_in_flight = hash_table_create(0, 0);
+
+	if (hash_table_lookup(dns_in_flight, name))
+		return;
+
+	while (dns_workers_running < DNS_WORKERS) {
+		pthread_t t;
+		if (pthread_create(&t, 0, dns_worker, 0) != 0)
+			break;
+		pthread_detach(t);
+		dns_workers_running++;
+	}
+
+	if (!dns_workers_running)
+		return;
+
+	struct dns_request *r = malloc(sizeof(*r));
+	if (!r)
+		return;
+	strncpy(r->name, name, sizeof(r->name) - 1);
+	r->name[sizeof(r->name) - 1] = 0;
+	r->reverse = reverse;
+	r->next = 0;
+
+	if (dns_queue_tail) {
+		dns_queue_tail->next = r;
+	} else {
+		dns_queue_head = r;
+	}
+	dns_queue_tail = r;
+
+	hash_table_insert(dns_in_flight, name, (void *)1);
+	pthread_cond_signal(&dns_wakeup);
+}
+
+static int dns_lookup_async(struct hash_cache **cache, const char *key, char *result, int reverse)
+{
+	pthread_mutex_lock(&dns_lock);
+
+	if (!domain_name_cache_init()) {
+		pthread_mutex_unlock(&dns_lock);
+		return -1;
+	}
+
+	char *found = hash_cache_lookup(*cache, key);
+	if (found) {
+		int ok = strcmp(found, DOMAIN_NAME_FAILED) != 0;
+		if (ok)
+			strcpy(result, found);
+		pthread_mutex_unlock(&dns_lock);
+		return ok ? 1 : -1;
+	}
+
+	dns_submit(key, reverse);
+	int pending = dns_in_flight && hash_table_lookup(dns_in_flight, key);
+	pthread_mutex_unlock(&dns_lock);
+
+	/* if no worker could take it, there is nothing to wait for */
+	return pending ? 0 : -1;
+}
+
+int domain_name_cache_lookup_async(const char *name, char *addr)
+{
+	return dns_lookup_async(&name_to_addr, name, addr, 0);
+}
+
+int domain_name_cache_lookup_reverse_async(const char *addr, char *name)
+{
+	return dns_lookup_async(&addr_to_name, addr, name, 1);
+}
+
 static int guess_dns_domain(char *domain)
 {
 	char line[DOMAIN_NAME_MAX];
@@ -62,4 +62,23 @@ int domain_name_cache_lookup_reverse(const char *addr, char *name);
 
 int domain_name_cache_canonical(const char *name_or_addr, char *cname);
 
+/** Resolve a host name without ever blocking the caller.
+A cache hit (or cached failure) answers immediately; a miss hands the
+resolution to a background thread and reports it as in progress, so an
+event loop can go on with its work and pick the answer out of the
+cache on a later event.
+@param name A hostname to resolve.
+@param addr A string of DOMAIN_NAME_MAX characters to hold the address.
+@return One if resolved now (addr is filled in), zero if the resolution is in progress, or -1 if the lookup is known to fail.
+*/
+int domain_name_cache_lookup_async(const char *name, char *addr);
+
+/** Resolve an address to a name without ever blocking the caller.
+@param addr An IP address to resolve.
+@param name A string of DOMAIN_NAME_MAX characters to hold the name.
+@return One if resolved now (name is filled in), zero if the resolution is in progress, or -1 if the lookup is known to fail.
+@see domain_name_cache_lookup_async
+*/
+int domain_name_cache_lookup_reverse_async(const char *addr, char *name);
+
 #endif
@@ -8,6 +8,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
 int file_link_recursive(const char *source, const char *target, int allow_symlinks)
 {
 	struct stat info;
@@ -49,6 +54,32 @@ int file_link_recursive(const char *source, const char *target, int allow_symlin
 		if (link(source, target) == 0)
 			return 1;
 
+#ifdef FICLONE
+		/*
+		If the hard link failed (for example because the filesystem
+		restricts links, or the caller needs the target to be an
+		independent inode), try a reflink: a copy-on-write clone
+		that shares extents, so multi-gigabyte inputs stage in
+		milliseconds on btrfs and XFS.
+		*/
+		{
+			int in = open(source, O_RDONLY);
+			if (in >= 0) {
+				int out = open(target, O_WRONLY | O_CREAT | O_TRUNC, info.st_mode & 0777);
+				if (out >= 0) {
+					int cloned = ioctl(out, FICLONE, in) == 0;
+					close(out);
+					close(in);
+					if (cloned)
+						return 1;
+					unlink(target);
+				} else {
+					close(in);
+				}
+			}
+		}
+#endif
+
 		/*
 		If the hard link failed, perhaps because the source
 		was a directory, or if hard links are not supported
@@ -6,14 +6,25 @@ See the file COPYING for details.
 */
 
 #include "hash_table.h"
+#include "random.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define DEFAULT_SIZE 127
+#define DEFAULT_FLAT_SIZE 128
 #define DEFAULT_LOAD 0.75
 #define DEFAULT_FUNC hash_string
 
+/* How many old buckets each insert/lookup/remove migrates while a resize is in progress. */
+#define MIGRATE_STEP 32
+
+typedef enum {
+	HASH_TABLE_MODE_CHAINED, /* linked entries hanging off a bucket array */
+	HASH_TABLE_MODE_FLAT,    /* open addressing into a contiguous slot array */
+} hash_table_mode_t;
+
 struct entry {
 	char *key;
 	void *value;
@@ -21,15 +32,47 @@ struct entry {
 	struct entry *next;
 };
 
+/* A slot in the flat backend.  An empty slot has a null key. */
+
+struct flat_slot {
+	char *key;
+	void *value;
+	unsigned hash;
+};
+
 struct hash_table {
+	hash_table_mode_t mode;
 	hash_func_t hash_func;
 	int bucket_count;
 	int size;
 	struct entry **buckets;
+	struct flat_slot *slots;
 	int ibucket;
 	struct entry *ientry;
+	struct flat_slot *islot;
+
+	/*
+	While a resize is in progress, the previous bucket or slot array is
+	kept here and drained a few buckets at a time by each insert, lookup,
+	and remove, so that no single operation ever rehashes the whole table.
+	Buckets below migrate_pos have already been drained.
+	*/
+	struct entry **old_buckets;
+	struct flat_slot *old_slots;
+	int old_bucket_count;
+	int migrate_pos;
 };
 
+/* Round up to the next power of two, so the flat backend can mask instead of mod. */
+
+static int next_power_of_two(int n)
+{
+	int p = 1;
+	while (p < n && p < (1 << 30))
+		p = p << 1;
+	return p;
+}
+
 struct hash_table *hash_table_create(int bucket_count, hash_func_t func)
 {
 	struct hash_table *h;
@@ -43,10 +86,18 @@ struct hash_table *hash_table_create(int bucket_count, hash_func_t func)
 	if (!func)
 		func = DEFAULT_FUNC;
 
+	h->mode = HASH_TABLE_MODE_CHAINED;
 	h->size = 0;
 	h->hash_func = func;
 	h->bucket_count = bucket_count;
 	h->buckets = (struct entry **)calloc(bucket_count, sizeof(struct entry *));
+	h->slots = 0;
+	h->ientry = 0;
+	h->islot = 0;
+	h->old_buckets = 0;
+	h->old_slots = 0;
+	h->old_bucket_count = 0;
+	h->migrate_pos = 0;
 	if (!h->buckets) {
 		free(h);
 		return 0;
@@ -55,11 +106,223 @@ struct hash_table *hash_table_create(int bucket_count, hash_func_t func)
 	return h;
 }
 
+struct hash_table *hash_table_create_flat(int bucket_count, hash_func_t func)
+{
+	struct hash_table *h;
+
+	h = (struct hash_table *)malloc(sizeof(struct hash_table));
+	if (!h)
+		return 0;
+
+	if (bucket_count < 1)
+		bucket_count = DEFAULT_FLAT_SIZE;
+	if (!func)
+		func = DEFAULT_FUNC;
+
+	h->mode = HASH_TABLE_MODE_FLAT;
+	h->size = 0;
+	h->hash_func = func;
+	h->bucket_count = next_power_of_two(bucket_count);
+	h->buckets = 0;
+	h->slots = (struct flat_slot *)calloc(h->bucket_count, sizeof(struct flat_slot));
+	h->ientry = 0;
+	h->islot = 0;
+	h->old_buckets = 0;
+	h->old_slots = 0;
+	h->old_bucket_count = 0;
+	h->migrate_pos = 0;
+	if (!h->slots) {
+		free(h);
+		return 0;
+	}
+
+	return h;
+}
+
+/* The probe distance of the entry in slot i is how far it sits from its home slot. */
+
+static int flat_probe_distance(struct flat_slot *slots, int count, int i)
+{
+	int mask = count - 1;
+	return (i - (int)(slots[i].hash & mask)) & mask;
+}
+
+/*
+Place a key into the slot array, displacing entries that sit closer to
+their home slot than we do (robin hood hashing), which keeps the maximum
+probe length short without tombstones.  The key is not duplicated here;
+ownership passes to the table.
+*/
+
+static void flat_place(struct hash_table *h, char *key, void *value, unsigned hash)
+{
+	int mask = h->bucket_count - 1;
+	int i = hash & mask;
+	int dist = 0;
+
+	while (1) {
+		struct flat_slot *s = &h->slots[i];
+		if (!s->key) {
+			s->key = key;
+			s->value = value;
+			s->hash = hash;
+			return;
+		}
+		int sdist = flat_probe_distance(h->slots, h->bucket_count, i);
+		if (sdist < dist) {
+			char *tkey = s->key;
+			void *tvalue = s->value;
+			unsigned thash = s->hash;
+			s->key = key;
+			s->value = value;
+			s->hash = hash;
+			key = tkey;
+			value = tvalue;
+			hash = thash;
+			dist = sdist;
+		}
+		i = (i + 1) & mask;
+		dist++;
+	}
+}
+
+/* Find the slot index holding the given key in the given slot array, or -1 if not present. */
+
+static int flat_find_in(struct flat_slot *slots, int count, const char *key, unsigned hash)
+{
+	int mask = count - 1;
+	int i = hash & mask;
+	int dist = 0;
+
+	while (1) {
+		struct flat_slot *s = &slots[i];
+		if (!s->key)
+			return -1;
+		/* The robin hood invariant lets us stop once we probe past our distance. */
+		if (flat_probe_distance(slots, count, i) < dist)
+			return -1;
+		if (s->hash == hash && !strcmp(key, s->key))
+			return i;
+		i = (i + 1) & mask;
+		dist++;
+	}
+}
+
+/*
+Begin an incremental resize: allocate the larger array and keep the
+existing one aside to be drained a few buckets at a time.  Entry nodes
+and keys are moved as-is, so nothing is copied or rehashed.
+*/
+
+static int chained_start_migration(struct hash_table *h, int new_count)
+{
+	struct entry **new_buckets = (struct entry **)calloc(new_count, sizeof(struct entry *));
+	if (!new_buckets)
+		return 0;
+
+	h->old_buckets = h->buckets;
+	h->old_bucket_count = h->bucket_count;
+	h->migrate_pos = 0;
+	h->buckets = new_buckets;
+	h->bucket_count = new_count;
+	return 1;
+}
+
+static int flat_start_migration(struct hash_table *h, int new_count)
+{
+	struct flat_slot *new_slots = (struct flat_slot *)calloc(new_count, sizeof(struct flat_slot));
+	if (!new_slots)
+		return 0;
+
+	h->old_slots = h->slots;
+	h->old_bucket_count = h->bucket_count;
+	h->migrate_pos = 0;
+	h->slots = new_slots;
+	h->bucket_count = new_count;
+	return 1;
+}
+
+static int hash_table_is_migrating(struct hash_table *h)
+{
+	return h->old_buckets || h->old_slots ? 1 : 0;
+}
+
+/*
+Drain up to the given number of buckets from the old array into the
+current one.  For the flat backend, draining only pauses at an empty
+old slot, so the probe run of any entry not yet migrated is never
+broken and lookups against the old array stay correct.
+*/
+
+static void hash_table_migrate_step(struct hash_table *h, int steps)
+{
+	if (h->old_buckets) {
+		while (steps > 0 && h->migrate_pos < h->old_bucket_count) {
+			struct entry *e = h->old_buckets[h->migrate_pos];
+			while (e) {
+				struct entry *f = e->next;
+				unsigned index = e->hash % h->bucket_count;
+				e->next = h->buckets[index];
+				h->buckets[index] = e;
+				e = f;
+			}
+			h->old_buckets[h->migrate_pos] = 0;
+			h->migrate_pos++;
+			steps--;
+		}
+		if (h->migrate_pos >= h->old_bucket_count) {
+			free(h->old_buckets);
+			h->old_buckets = 0;
+			h->old_bucket_count = 0;
+		}
+	} else if (h->old_slots) {
+		while (h->migrate_pos < h->old_bucket_count && (steps > 0 || h->old_slots[h->migrate_pos].key)) {
+			struct flat_slot *s = &h->old_slots[h->migrate_pos];
+			if (s->key) {
+				flat_place(h, s->key, s->value, s->hash);
+				s->key = 0;
+			}
+			h->migrate_pos++;
+			steps--;
+		}
+		if (h->migrate_pos >= h->old_bucket_count) {
+			free(h->old_slots);
+			h->old_slots = 0;
+			h->old_bucket_count = 0;
+		}
+	}
+}
+
+/* Complete any resize in progress, e.g. before an iteration begins. */
+
+static void hash_table_migrate_finish(struct hash_table *h)
+{
+	while (hash_table_is_migrating(h)) {
+		hash_table_migrate_step(h, h->old_bucket_count);
+	}
+}
+
 void hash_table_clear(struct hash_table *h, void (*delete_func)(void *))
 {
-	struct entry *e, *f;
 	int i;
 
+	hash_table_migrate_finish(h);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		for (i = 0; i < h->bucket_count; i++) {
+			if (h->slots[i].key) {
+				if (delete_func)
+					delete_func(h->slots[i].value);
+				free(h->slots[i].key);
+				h->slots[i].key = 0;
+			}
+		}
+		h->size = 0;
+		return;
+	}
+
+	struct entry *e, *f;
+
 	for (i = 0; i < h->bucket_count; i++) {
 		e = h->buckets[i];
 		while (e) {
@@ -75,12 +338,15 @@ void hash_table_clear(struct hash_table *h, void (*delete_func)(void *))
 	for (i = 0; i < h->bucket_count; i++) {
 		h->buckets[i] = 0;
 	}
+
+	h->size = 0;
 }
 
 void hash_table_delete(struct hash_table *h)
 {
 	hash_table_clear(h, 0);
 	free(h->buckets);
+	free(h->slots);
 	free(h);
 }
 
@@ -90,6 +356,22 @@ void *hash_table_lookup(struct hash_table *h, const char *key)
 	unsigned hash, index;
 
 	hash = h->hash_func(key);
+
+	if (hash_table_is_migrating(h))
+		hash_table_migrate_step(h, MIGRATE_STEP);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		int i = flat_find_in(h->slots, h->bucket_count, key, hash);
+		if (i >= 0)
+			return h->slots[i].value;
+		if (h->old_slots) {
+			i = flat_find_in(h->old_slots, h->old_bucket_count, key, hash);
+			if (i >= 0)
+				return h->old_slots[i].value;
+		}
+		return 0;
+	}
+
 	index = hash % h->bucket_count;
 	e = h->buckets[index];
 
@@ -100,6 +382,16 @@ void *hash_table_lookup(struct hash_table *h, const char *key)
 		e = e->next;
 	}
 
+	if (h->old_buckets) {
+		e = h->old_buckets[hash % h->old_bucket_count];
+		while (e) {
+			if (hash == e->hash && !strcmp(key, e->key)) {
+				return e->value;
+			}
+			e = e->next;
+		}
+	}
+
 	return 0;
 }
 
@@ -108,45 +400,31 @@ int hash_table_size(struct hash_table *h)
 	return h->size;
 }
 
-static int hash_table_double_buckets(struct hash_table *h)
+int hash_table_reserve(struct hash_table *h, int n)
 {
-	struct hash_table *hn = hash_table_create(2 * h->bucket_count, h->hash_func);
+	if (n < 1)
+		return 1;
 
-	if (!hn)
-		return 0;
+	/* Size the bucket array so that n entries stay below the load threshold. */
+	int target = (int)(n / DEFAULT_LOAD) + 1;
 
-	/* Move pairs to new hash */
-	char *key;
-	void *value;
-	hash_table_firstkey(h);
-	while (hash_table_nextkey(h, &key, &value))
-		if (!hash_table_insert(hn, key, value)) {
-			hash_table_delete(hn);
-			return 0;
-		}
+	hash_table_migrate_finish(h);
 
-	/* Delete all old pairs */
-	struct entry *e, *f;
-	int i;
-	for (i = 0; i < h->bucket_count; i++) {
-		e = h->buckets[i];
-		while (e) {
-			f = e->next;
-			free(e->key);
-			free(e);
-			e = f;
-		}
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		target = next_power_of_two(target);
+		if (target <= h->bucket_count)
+			return 1;
+		if (!flat_start_migration(h, target))
+			return 0;
+	} else {
+		if (target <= h->bucket_count)
+			return 1;
+		if (!chained_start_migration(h, target))
+			return 0;
 	}
 
-	/* Make the old point to the new */
-	free(h->buckets);
-	h->buckets = hn->buckets;
-	h->bucket_count = hn->bucket_count;
-	h->size = hn->size;
-
-	/* Delete reference to new, so old is safe */
-	free(hn);
-
+	/* The table is typically empty or small here, so drain it at once. */
+	hash_table_migrate_finish(h);
 	return 1;
 }
 
@@ -155,10 +433,36 @@ int hash_table_insert(struct hash_table *h, const char *key, const void *value)
 	struct entry *e;
 	unsigned hash, index;
 
-	if (((float)h->size / h->bucket_count) > DEFAULT_LOAD)
-		hash_table_double_buckets(h);
+	if (hash_table_is_migrating(h))
+		hash_table_migrate_step(h, MIGRATE_STEP);
+
+	if (((float)h->size / h->bucket_count) > DEFAULT_LOAD) {
+		/* Drain any resize still in flight before beginning another. */
+		hash_table_migrate_finish(h);
+		if (h->mode == HASH_TABLE_MODE_FLAT) {
+			flat_start_migration(h, 2 * h->bucket_count);
+		} else {
+			chained_start_migration(h, 2 * h->bucket_count);
+		}
+	}
 
 	hash = h->hash_func(key);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		if (flat_find_in(h->slots, h->bucket_count, key, hash) >= 0)
+			return 0;
+		if (h->old_slots && flat_find_in(h->old_slots, h->old_bucket_count, key, hash) >= 0)
+			return 0;
+
+		char *dup = strdup(key);
+		if (!dup)
+			return 0;
+
+		flat_place(h, dup, (void *)value, hash);
+		h->size++;
+		return 1;
+	}
+
 	index = hash % h->bucket_count;
 	e = h->buckets[index];
 
@@ -168,6 +472,15 @@ int hash_table_insert(struct hash_table *h, const char *key, const void *value)
 		e = e->next;
 	}
 
+	if (h->old_buckets) {
+		e = h->old_buckets[hash % h->old_bucket_count];
+		while (e) {
+			if (hash == e->hash && !strcmp(key, e->key))
+				return 0;
+			e = e->next;
+		}
+	}
+
 	e = (struct entry *)malloc(sizeof(struct entry));
 	if (!e)
 		return 0;
@@ -194,6 +507,44 @@ void *hash_table_remove(struct hash_table *h, const char *key)
 	unsigned hash, index;
 
 	hash = h->hash_func(key);
+
+	if (hash_table_is_migrating(h))
+		hash_table_migrate_step(h, MIGRATE_STEP);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		struct flat_slot *slots = h->slots;
+		int count = h->bucket_count;
+		int i = flat_find_in(slots, count, key, hash);
+
+		if (i < 0 && h->old_slots) {
+			slots = h->old_slots;
+			count = h->old_bucket_count;
+			i = flat_find_in(slots, count, key, hash);
+		}
+		if (i < 0)
+			return 0;
+
+		int mask = count - 1;
+		value = slots[i].value;
+		free(slots[i].key);
+
+		/*
+		Shift the following run of displaced entries back one slot,
+		so no tombstone is left behind and probe chains stay short.
+		*/
+		while (1) {
+			int j = (i + 1) & mask;
+			if (!slots[j].key || flat_probe_distance(slots, count, j) == 0)
+				break;
+			slots[i] = slots[j];
+			i = j;
+		}
+		slots[i].key = 0;
+		slots[i].value = 0;
+		h->size--;
+		return value;
+	}
+
 	index = hash % h->bucket_count;
 	e = h->buckets[index];
 	f = 0;
@@ -215,11 +566,49 @@ void *hash_table_remove(struct hash_table *h, const char *key)
 		e = e->next;
 	}
 
+	if (h->old_buckets) {
+		index = hash % h->old_bucket_count;
+		e = h->old_buckets[index];
+		f = 0;
+
+		while (e) {
+			if (hash == e->hash && !strcmp(key, e->key)) {
+				if (f) {
+					f->next = e->next;
+				} else {
+					h->old_buckets[index] = e->next;
+				}
+				value = e->value;
+				free(e->key);
+				free(e);
+				h->size--;
+				return value;
+			}
+			f = e;
+			e = e->next;
+		}
+	}
+
 	return 0;
 }
 
+/* Position the flat iterator on the first occupied slot at or after i, or mark it done. */
+
+static void flat_seek(struct hash_table *h, int i)
+{
+	h->islot = 0;
+	for (h->ibucket = i; h->ibucket < h->bucket_count; h->ibucket++) {
+		if (h->slots[h->ibucket].key) {
+			h->islot = &h->slots[h->ibucket];
+			break;
+		}
+	}
+}
+
 int hash_table_fromkey(struct hash_table *h, const char *key)
 {
+	hash_table_migrate_finish(h);
+
 	if (!key) {
 		/* treat NULL as a special case equivalent to firstkey */
 		hash_table_firstkey(h);
@@ -227,6 +616,18 @@ int hash_table_fromkey(struct hash_table *h, const char *key)
 	}
 
 	unsigned hash = h->hash_func(key);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		int i = flat_find_in(h->slots, h->bucket_count, key, hash);
+		if (i < 0) {
+			hash_table_firstkey(h);
+			return 0;
+		}
+		h->ibucket = i;
+		h->islot = &h->slots[i];
+		return 1;
+	}
+
 	h->ibucket = hash % h->bucket_count;
 	h->ientry = h->buckets[h->ibucket];
 
@@ -243,6 +644,13 @@ int hash_table_fromkey(struct hash_table *h, const char *key)
 
 void hash_table_firstkey(struct hash_table *h)
 {
+	hash_table_migrate_finish(h);
+
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		flat_seek(h, 0);
+		return;
+	}
+
 	h->ientry = 0;
 	for (h->ibucket = 0; h->ibucket < h->bucket_count; h->ibucket++) {
 		h->ientry = h->buckets[h->ibucket];
@@ -253,6 +661,15 @@ void hash_table_firstkey(struct hash_table *h)
 
 int hash_table_nextkey(struct hash_table *h, char **key, void **value)
 {
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		if (!h->islot)
+			return 0;
+		*key = h->islot->key;
+		*value = h->islot->value;
+		flat_seek(h, h->ibucket + 1);
+		return 1;
+	}
+
 	if (h->ientry) {
 		*key = h->ientry->key;
 		*value = h->ientry->value;
@@ -274,13 +691,32 @@ int hash_table_nextkey(struct hash_table *h, char **key, void **value)
 
 void hash_table_randomkey(struct hash_table *h, int *offset_bookkeep)
 {
-	h->ientry = 0;
+	hash_table_migrate_finish(h);
+
 	if (h->bucket_count < 1) {
+		h->ientry = 0;
+		h->islot = 0;
 		return;
 	}
 
 	int ibucket_start = random() % h->bucket_count;
 
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		int i, n;
+		h->islot = 0;
+		for (n = 0, i = ibucket_start; n < h->bucket_count; n++, i = (i + 1) % h->bucket_count) {
+			if (h->slots[i].key) {
+				h->ibucket = i;
+				h->islot = &h->slots[i];
+				*offset_bookkeep = i;
+				return;
+			}
+		}
+		return;
+	}
+
+	h->ientry = 0;
+
 	for (h->ibucket = ibucket_start; h->ibucket < h->bucket_count; h->ibucket++) {
 		h->ientry = h->buckets[h->ibucket];
 		if (h->ientry) {
@@ -306,6 +742,24 @@ int hash_table_nextkey_with_offset(struct hash_table *h, int offset_bookkeep, ch
 
 	offset_bookkeep = offset_bookkeep % h->bucket_count;
 
+	if (h->mode == HASH_TABLE_MODE_FLAT) {
+		if (!h->islot)
+			return 0;
+		*key = h->islot->key;
+		*value = h->islot->value;
+
+		h->islot = 0;
+		int i = (h->ibucket + 1) % h->bucket_count;
+		for (; i != offset_bookkeep; i = (i + 1) % h->bucket_count) {
+			if (h->slots[i].key) {
+				h->ibucket = i;
+				h->islot = &h->slots[i];
+				break;
+			}
+		}
+		return 1;
+	}
+
 	if (h->ientry) {
 		*key = h->ientry->key;
 		*value = h->ientry->value;
@@ -480,4 +934,57 @@ unsigned hash_string(const char *s)
 	return jenkins_hash((const ub1 *)s, strlen(s), 0);
 }
 
+/*
+A multiply-fold hash in the style of wyhash, consuming eight bytes per
+step.  The seed is initialized once per process from the random number
+facility, which both spreads the buckets well and keeps collision sets
+unpredictable to outside parties.
+*/
+
+static uint64_t hash_seed = 0;
+
+static uint64_t hash_mix64(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t m = (__uint128_t)a * b;
+	return (uint64_t)m ^ (uint64_t)(m >> 64);
+#else
+	a ^= b;
+	a *= 0x9E3779B97F4A7C15ULL;
+	a ^= a >> 29;
+	a *= 0xBF58476D1CE4E5B9ULL;
+	a ^= a >> 32;
+	return a;
+#endif
+}
+
+unsigned hash_string_seeded(const char *s)
+{
+	if (!hash_seed) {
+		random_init();
+		hash_seed = ((uint64_t)random_int64()) | 1;
+	}
+
+	size_t len = strlen(s);
+	uint64_t h = hash_seed ^ (len * 0x9E3779B97F4A7C15ULL);
+
+	while (len >= 8) {
+		uint64_t k;
+		memcpy(&k, s, 8);
+		h = hash_mix64(h ^ k, 0x9E3779B97F4A7C15ULL);
+		s += 8;
+		len -= 8;
+	}
+
+	if (len > 0) {
+		uint64_t k = 0;
+		memcpy(&k, s, len);
+		h = hash_mix64(h ^ k, 0xFF51AFD7ED558CCDULL);
+	}
+
+	h = hash_mix64(h, 0xC4CEB9FE1A85EC53ULL);
+
+	return (unsigned)(h ^ (h >> 32));
+}
+
 /* vim: set noexpandtab tabstop=8: */
@@ -48,6 +48,20 @@ typedef unsigned (*hash_func_t) (const char *key);
 
 struct hash_table *hash_table_create(int buckets, hash_func_t func);
 
+/** Create a new hash table with flat, open-addressed storage.
+The table presents exactly the same interface as one returned by
+@ref hash_table_create, but stores its entries in a single contiguous
+slot array using robin-hood linear probing rather than chained buckets.
+This avoids one malloc per entry and keeps lookups within one or two
+cache lines, which matters for the very large tables kept by the
+makeflow DAG and the TaskVine and Work Queue managers.
+@param buckets The initial number of slots, which will be rounded up to a power of two.  If zero, a default value will be used.
+@param func The default hash function to be used.  If zero, @ref hash_string will be used.
+@return A pointer to a new hash table.
+*/
+
+struct hash_table *hash_table_create_flat(int buckets, hash_func_t func);
+
 /** Remove all entries from an hash table.
 @param h The hash table to delete.
 @param delete_func If non-null, will be invoked on each object to delete it.
@@ -70,6 +84,18 @@ void hash_table_delete(struct hash_table *h);
 
 int hash_table_size(struct hash_table *h);
 
+/** Pre-size a hash table for an expected number of entries.
+Growing happens automatically as entries are inserted, a few buckets at
+a time, so that no single insert stalls on rehashing the whole table.
+When the final cardinality is known up front, calling this once avoids
+even that incremental work.
+@param h A pointer to a hash table.
+@param n The number of entries the table is expected to hold.
+@return One on success, zero on allocation failure.
+*/
+
+int hash_table_reserve(struct hash_table *h, int n);
+
 /** Insert a key and value.
 This call will fail if the table already contains the same key.
 You must call @ref hash_table_remove to remove it.
@@ -156,6 +182,20 @@ int hash_table_fromkey(struct hash_table *h, const char *key);
 
 unsigned hash_string(const char *s);
 
+/** A fast, randomly seeded hash function.
+Processes eight bytes of the key per step, so it is several times
+faster than @ref hash_string on the long pathname keys kept by the
+makeflow DAG and TaskVine file tables.  The seed is drawn once per
+process from the random number facility, so an adversary (for example,
+one flooding the catalog server with crafted names) cannot
+precompute colliding keys.  Because the seed varies, the hash values
+must not be stored or compared across processes.
+@param s A string to hash.
+@return An integer hash of the string.
+*/
+
+unsigned hash_string_seeded(const char *s);
+
 /** Utility macro to simplify common case of iterating over a hash table.
 Use as follows:
 
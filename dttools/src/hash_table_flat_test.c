@@ -0,0 +1,148 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+/*
+Exercise the flat, open-addressed hash table backend and the
+incremental resize machinery through the same public interface as the
+chained backend: insert, lookup, iterate, remove, and force several
+resizes along the way.  The same scenario runs against both backends.
+*/
+
+#include "hash_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NKEYS 10000
+
+static int exercise_table(struct hash_table *h, const char *label)
+{
+	char key[32];
+	int i;
+
+	for (i = 0; i < NKEYS; i++) {
+		sprintf(key, "key-%d", i);
+		if (!hash_table_insert(h, key, (void *)(long)(i + 1))) {
+			fprintf(stderr, "%s: insert of %s failed\n", label, key);
+			return 0;
+		}
+
+		/* interleave lookups so they run while a resize is in flight */
+		sprintf(key, "key-%d", i / 2);
+		if ((long)hash_table_lookup(h, key) != i / 2 + 1) {
+			fprintf(stderr, "%s: interleaved lookup of %s failed\n", label, key);
+			return 0;
+		}
+	}
+
+	/* duplicate inserts must fail */
+	if (hash_table_insert(h, "key-0", (void *)1)) {
+		fprintf(stderr, "%s: duplicate insert wrongly succeeded\n", label);
+		return 0;
+	}
+
+	if (hash_table_size(h) != NKEYS) {
+		fprintf(stderr, "%s: size is %d, expected %d\n", label, hash_table_size(h), NKEYS);
+		return 0;
+	}
+
+	for (i = 0; i < NKEYS; i++) {
+		sprintf(key, "key-%d", i);
+		long value = (long)hash_table_lookup(h, key);
+		if (value != i + 1) {
+			fprintf(stderr, "%s: lookup of %s gave %ld, expected %d\n", label, key, value, i + 1);
+			return 0;
+		}
+	}
+
+	/* iteration must visit every key exactly once */
+	char *ikey;
+	void *ivalue;
+	long sum = 0;
+	int count = 0;
+	HASH_TABLE_ITERATE(h, ikey, ivalue)
+	{
+		sum += (long)ivalue;
+		count++;
+	}
+	if (count != NKEYS || sum != (long)NKEYS * (NKEYS + 1) / 2) {
+		fprintf(stderr, "%s: iteration visited %d keys with sum %ld\n", label, count, sum);
+		return 0;
+	}
+
+	/* remove the odd keys, then check exactly the even ones remain */
+	for (i = 1; i < NKEYS; i += 2) {
+		sprintf(key, "key-%d", i);
+		if ((long)hash_table_remove(h, key) != i + 1) {
+			fprintf(stderr, "%s: remove of %s failed\n", label, key);
+			return 0;
+		}
+	}
+
+	for (i = 0; i < NKEYS; i++) {
+		sprintf(key, "key-%d", i);
+		long value = (long)hash_table_lookup(h, key);
+		if (i % 2 == 0 && value != i + 1) {
+			fprintf(stderr, "%s: lookup of %s gave %ld after removals\n", label, key, value);
+			return 0;
+		}
+		if (i % 2 == 1 && value != 0) {
+			fprintf(stderr, "%s: removed key %s still present\n", label, key);
+			return 0;
+		}
+	}
+
+	if (hash_table_size(h) != NKEYS / 2) {
+		fprintf(stderr, "%s: size is %d after removals, expected %d\n", label, hash_table_size(h), NKEYS / 2);
+		return 0;
+	}
+
+	hash_table_clear(h, 0);
+	if (hash_table_size(h) != 0) {
+		fprintf(stderr, "%s: size is %d after clear\n", label, hash_table_size(h));
+		return 0;
+	}
+
+	hash_table_delete(h);
+
+	printf("%s hash table test passed\n", label);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	struct hash_table *h;
+
+	h = hash_table_create_flat(0, 0);
+	if (!exercise_table(h, "flat"))
+		return 1;
+
+	h = hash_table_create(0, 0);
+	if (!exercise_table(h, "chained"))
+		return 1;
+
+	/* pre-sized tables must behave identically */
+	h = hash_table_create_flat(0, 0);
+	if (!hash_table_reserve(h, NKEYS)) {
+		fprintf(stderr, "reserve failed\n");
+		return 1;
+	}
+	if (!exercise_table(h, "flat reserved"))
+		return 1;
+
+	h = hash_table_create(0, 0);
+	if (!hash_table_reserve(h, NKEYS)) {
+		fprintf(stderr, "reserve failed\n");
+		return 1;
+	}
+	if (!exercise_table(h, "chained reserved"))
+		return 1;
+
+	return 0;
+}
+
+/* vim: set noexpandtab tabstop=4: */
@@ -0,0 +1,157 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#include "hash_table_mt.h"
+#include "xxmalloc.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SHARDS 16
+
+/*
+Each shard is an ordinary hash_table behind its own mutex; a key's
+shard is chosen by the same string hash the tables use internally, so
+load spreads with the keys.  Cross-shard operations (size, snapshot)
+take the shard locks one at a time, so they never hold more than one
+lock and cannot deadlock against per-key operations.
+*/
+
+struct hash_table_mt {
+	int nshards;
+	struct hash_table **shard;
+	pthread_mutex_t *lock;
+};
+
+static unsigned shard_of(struct hash_table_mt *h, const char *key)
+{
+	return hash_string(key) % h->nshards;
+}
+
+struct hash_table_mt *hash_table_mt_create(int shards)
+{
+	if (shards < 1)
+		shards = DEFAULT_SHARDS;
+
+	struct hash_table_mt *h = xxmalloc(sizeof(*h));
+	h->nshards = shards;
+	h->shard = xxmalloc(shards * sizeof(*h->shard));
+	h->lock = xxmalloc(shards * sizeof(*h->lock));
+
+	int i;
+	for (i = 0; i < shards; i++) {
+		h->shard[i] = hash_table_create(0, 0);
+		pthread_mutex_init(&h->lock[i], NULL);
+	}
+
+	return h;
+}
+
+void hash_table_mt_delete(struct hash_table_mt *h)
+{
+	if (!h)
+		return;
+
+	int i;
+	for (i = 0; i < h->nshards; i++) {
+		hash_table_delete(h->shard[i]);
+		pthread_mutex_destroy(&h->lock[i]);
+	}
+	free(h->shard);
+	free(h->lock);
+	free(h);
+}
+
+int hash_table_mt_size(struct hash_table_mt *h)
+{
+	int total = 0;
+	int i;
+	for (i = 0; i < h->nshards; i++) {
+		pthread_mutex_lock(&h->lock[i]);
+		total += hash_table_size(h->shard[i]);
+		pthread_mutex_unlock(&h->lock[i]);
+	}
+	return total;
+}
+
+int hash_table_mt_insert(struct hash_table_mt *h, const char *key, const void *value)
+{
+	unsigned s = shard_of(h, key);
+	pthread_mutex_lock(&h->lock[s]);
+	int result = hash_table_insert(h->shard[s], key, value);
+	pthread_mutex_unlock(&h->lock[s]);
+	return result;
+}
+
+void *hash_table_mt_lookup(struct hash_table_mt *h, const char *key)
+{
+	unsigned s = shard_of(h, key);
+	pthread_mutex_lock(&h->lock[s]);
+	void *value = hash_table_lookup(h->shard[s], key);
+	pthread_mutex_unlock(&h->lock[s]);
+	return value;
+}
+
+void *hash_table_mt_remove(struct hash_table_mt *h, const char *key)
+{
+	unsigned s = shard_of(h, key);
+	pthread_mutex_lock(&h->lock[s]);
+	void *value = hash_table_remove(h->shard[s], key);
+	pthread_mutex_unlock(&h->lock[s]);
+	return value;
+}
+
+void *hash_table_mt_replace(struct hash_table_mt *h, const char *key, const void *value)
+{
+	unsigned s = shard_of(h, key);
+	pthread_mutex_lock(&h->lock[s]);
+	void *previous = hash_table_remove(h->shard[s], key);
+	hash_table_insert(h->shard[s], key, value);
+	pthread_mutex_unlock(&h->lock[s]);
+	return previous;
+}
+
+char **hash_table_mt_snapshot(struct hash_table_mt *h, int *count)
+{
+	int capacity = 64;
+	int n = 0;
+	char **keys = xxmalloc(capacity * sizeof(*keys));
+
+	int i;
+	for (i = 0; i < h->nshards; i++) {
+		pthread_mutex_lock(&h->lock[i]);
+		char *key;
+		void *value;
+		hash_table_firstkey(h->shard[i]);
+		while (hash_table_nextkey(h->shard[i], &key, &value)) {
+			if (n >= capacity) {
+				capacity *= 2;
+				keys = realloc(keys, capacity * sizeof(*keys));
+				if (!keys) {
+					pthread_mutex_unlock(&h->lock[i]);
+					*count = 0;
+					return NULL;
+				}
+			}
+			keys[n++] = xxstrdup(key);
+		}
+		pthread_mutex_unlock(&h->lock[i]);
+	}
+
+	*count = n;
+	return keys;
+}
+
+void hash_table_mt_snapshot_free(char **keys, int count)
+{
+	int i;
+	for (i = 0; i < count; i++)
+		free(keys[i]);
+	free(keys);
+}
+
+/* vim: set noexpandtab tabstop=8: */
@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#ifndef HASH_TABLE_MT_H
+#define HASH_TABLE_MT_H
+
+/** @file hash_table_mt.h A thread-safe string-keyed hash map.
+The plain @ref hash_table is single-thread-only, so threaded daemons
+end up hand-rolling locks around it.  This map shards keys across
+independently locked tables, so operations on different shards
+proceed concurrently and operations on one shard serialize without a
+global lock.  The API mirrors hash_table where the semantics carry
+over; iteration differs, because a live iterator over a concurrent
+structure is a trap -- instead @ref hash_table_mt_snapshot hands back
+a consistent copy of the keys to walk at leisure.
+*/
+
+#include "hash_table.h"
+
+struct hash_table_mt;
+
+/** Create a concurrent hash map.
+@param shards The number of lock shards, or zero for a default suited to a few dozen threads.
+@return A map, or null on failure.
+*/
+struct hash_table_mt *hash_table_mt_create(int shards);
+
+/** Delete a map.  The values themselves are not deleted.
+No other thread may be using the map. */
+void hash_table_mt_delete(struct hash_table_mt *h);
+
+/** Count the entries across all shards. */
+int hash_table_mt_size(struct hash_table_mt *h);
+
+/** Insert a key and value.
+Fails if the key is already present, as with @ref hash_table_insert.
+@return One on success, zero on failure or duplicate key.
+*/
+int hash_table_mt_insert(struct hash_table_mt *h, const char *key, const void *value);
+
+/** Look up a value by key.
+@return The value, or null if the key is absent.  The value is
+returned without any continued lock; the caller must ensure values
+are not freed while other threads may hold them.
+*/
+void *hash_table_mt_lookup(struct hash_table_mt *h, const char *key);
+
+/** Remove a key.
+@return The removed value, or null if the key was absent. */
+void *hash_table_mt_remove(struct hash_table_mt *h, const char *key);
+
+/** Atomically insert or replace a key's value.
+@return The previous value, or null if the key was new. */
+void *hash_table_mt_replace(struct hash_table_mt *h, const char *key, const void *value);
+
+/** Take a consistent snapshot of the keys.
+Each shard is copied under its lock, so the snapshot holds every key
+that was present for the whole call and no key that was absent for
+the whole call.  @param h The map.  @param count Set to the number of
+keys.  @return An array of key copies; free each key and the array
+with @ref hash_table_mt_snapshot_free.
+*/
+char **hash_table_mt_snapshot(struct hash_table_mt *h, int *count);
+
+/** Free a snapshot returned by @ref hash_table_mt_snapshot. */
+void hash_table_mt_snapshot_free(char **keys, int count);
+
+#endif
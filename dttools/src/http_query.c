@@ -84,7 +84,14 @@ struct link *http_query_size(const char *url, const char *action, INT64_T *size,
 	}
 }
 
+static struct link *http_query_internal(const char *proxy, const char *urlin, const char *action, INT64_T *size, time_t stoptime, int cache_reload, int keepalive);
+
 struct link *http_query_size_via_proxy(const char *proxy, const char *urlin, const char *action, INT64_T *size, time_t stoptime, int cache_reload)
+{
+	return http_query_internal(proxy, urlin, action, size, stoptime, cache_reload, 0);
+}
+
+static struct link *http_query_internal(const char *proxy, const char *urlin, const char *action, INT64_T *size, time_t stoptime, int cache_reload, int keepalive)
 {
 	char url[HTTP_LINE_MAX];
 	char newurl[HTTP_LINE_MAX];
@@ -138,36 +145,67 @@ struct link *http_query_size_via_proxy(const char *proxy, const char *urlin, con
 	if (!domain_name_cache_lookup(actual_host, addr))
 		return 0;
 
-	link = link_connect(addr, actual_port, stoptime);
-	if (!link) {
-		errno = ECONNRESET;
-		return 0;
-	}
+	/*
+	Connection reuse: callers that consume exactly the framed
+	Content-Length (http_fetch_to_file) request keep-alive, draw
+	their connection from the idle pool, and return it there when
+	the body is fully drained.  Callers that stream to end-of-file
+	keep the traditional Connection: close, since only a framed
+	consumer knows when a connection is clean for reuse.  A pooled
+	connection may have been closed by the server while idle, so a
+	failed status read on the first attempt retries once on a fresh
+	connection.
+	*/
+	int attempt;
+	int got_status = 0;
+	link = 0;
+	for (attempt = 0; attempt < 2 && !got_status; attempt++) {
+		if (keepalive && attempt == 0) {
+			link = link_pool_connect(addr, actual_port, stoptime);
+		} else {
+			link = link_connect(addr, actual_port, stoptime);
+		}
+		if (!link) {
+			errno = ECONNRESET;
+			return 0;
+		}
+
+		{
+			buffer_t B;
 
-	{
-		buffer_t B;
+			buffer_init(&B);
+			buffer_abortonfailure(&B, 1);
 
-		buffer_init(&B);
-		buffer_abortonfailure(&B, 1);
+			buffer_printf(&B, "%s %s HTTP/1.1\r\n", action, url);
+			if (cache_reload)
+				buffer_putliteral(&B, "Cache-Control: max-age=0\r\n");
+			if (keepalive)
+				buffer_putliteral(&B, "Connection: keep-alive\r\n");
+			else
+				buffer_putliteral(&B, "Connection: close\r\n");
+			buffer_printf(&B, "Host: %s\r\n", actual_host);
+			if (getenv("HTTP_USER_AGENT"))
+				buffer_printf(&B, "User-Agent: Mozilla/5.0 (compatible; CCTools %s Parrot; http://ccl.cse.nd.edu/ %s)\r\n", CCTOOLS_VERSION, getenv("HTTP_USER_AGENT"));
+			else
+				buffer_printf(&B, "User-Agent: Mozilla/5.0 (compatible; CCTools %s Parrot; http://ccl.cse.nd.edu/)\r\n", CCTOOLS_VERSION);
+			buffer_putliteral(&B, "\r\n"); /* header terminator */
 
-		buffer_printf(&B, "%s %s HTTP/1.1\r\n", action, url);
-		if (cache_reload)
-			buffer_putliteral(&B, "Cache-Control: max-age=0\r\n");
-		buffer_putliteral(&B, "Connection: close\r\n");
-		buffer_printf(&B, "Host: %s\r\n", actual_host);
-		if (getenv("HTTP_USER_AGENT"))
-			buffer_printf(&B, "User-Agent: Mozilla/5.0 (compatible; CCTools %s Parrot; http://ccl.cse.nd.edu/ %s)\r\n", CCTOOLS_VERSION, getenv("HTTP_USER_AGENT"));
-		else
-			buffer_printf(&B, "User-Agent: Mozilla/5.0 (compatible; CCTools %s Parrot; http://ccl.cse.nd.edu/)\r\n", CCTOOLS_VERSION);
-		buffer_putliteral(&B, "\r\n"); /* header terminator */
+			debug(D_HTTP, "%s", buffer_tostring(&B));
+			link_putstring(link, buffer_tostring(&B), stoptime);
 
-		debug(D_HTTP, "%s", buffer_tostring(&B));
-		link_putstring(link, buffer_tostring(&B), stoptime);
+			buffer_free(&B);
+		}
 
-		buffer_free(&B);
+		if (link_readline(link, line, HTTP_LINE_MAX, stoptime)) {
+			got_status = 1;
+		} else if (keepalive && attempt == 0) {
+			debug(D_HTTP, "pooled connection was stale, retrying fresh");
+			link_close(link);
+			link = 0;
+		}
 	}
 
-	if (link_readline(link, line, HTTP_LINE_MAX, stoptime)) {
+	if (got_status) {
 		string_chomp(line);
 		debug(D_HTTP, "%s", line);
 		if (sscanf(line, "HTTP/%*d.%*d %d", &response) == 1) {
@@ -233,11 +271,16 @@ INT64_T http_fetch_to_file(const char *url, const char *filename, time_t stoptim
 
 	file = fopen(filename, "w");
 	if (file) {
-		link = http_query_size(url, "GET", &size, stoptime, 1);
+		/* framed consumer: keep-alive, and pool the drained connection */
+		link = http_query_internal(0, url, "GET", &size, stoptime, 1, 1);
 		if (link) {
 			actual = link_stream_to_file(link, file, size, stoptime);
-			link_close(link);
 			fclose(file);
+			if (actual == size && size > 0) {
+				link_pool_release(link);
+				return actual;
+			}
+			link_close(link);
 			if (actual == size) {
 				return actual;
 			} else {
@@ -0,0 +1,145 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+/** @file intrusive_list.h A doubly-linked list with embedded nodes.
+Unlike @ref list.h, which allocates a cell per insertion and must scan
+to remove an element, this list embeds its node directly in the item:
+
+<pre>
+struct vine_task {
+	...
+	struct ilist_node state_node;
+};
+
+struct ilist ready;
+ilist_init(&ready);
+ilist_push_tail(&ready, &t->state_node);
+...
+ilist_remove(&t->state_node);   // O(1), no allocation, no scan
+</pre>
+
+Because the node lives inside the item, moving an item between state
+lists costs no allocation, and removal is constant time given the
+item.  An item can sit on at most one list per embedded node; embed
+several nodes for membership in several lists.  Use @ref ilist_entry
+to recover the containing item from a node.
+*/
+
+#include <stddef.h>
+
+struct ilist_node {
+	struct ilist_node *next;
+	struct ilist_node *prev;
+};
+
+struct ilist {
+	struct ilist_node head; /* sentinel: head.next is the first item */
+	int size;
+};
+
+/** Recover the item containing a node.
+@param node A pointer to an embedded @ref ilist_node.
+@param type The type of the containing structure.
+@param member The name of the embedded node member.
+*/
+#define ilist_entry(node, type, member) ((type *)((char *)(node) - offsetof(type, member)))
+
+/** Iterate over every node in the list.  The current node may not be removed during iteration. */
+#define ILIST_ITERATE(list, node) for (node = (list)->head.next; node != &(list)->head; node = node->next)
+
+static inline void ilist_init(struct ilist *l)
+{
+	l->head.next = &l->head;
+	l->head.prev = &l->head;
+	l->size = 0;
+}
+
+static inline void ilist_node_init(struct ilist_node *n)
+{
+	n->next = 0;
+	n->prev = 0;
+}
+
+/** True if the node is currently on a list. */
+static inline int ilist_node_linked(struct ilist_node *n)
+{
+	return n->next != 0;
+}
+
+static inline int ilist_size(struct ilist *l)
+{
+	return l->size;
+}
+
+static inline int ilist_empty(struct ilist *l)
+{
+	return l->head.next == &l->head;
+}
+
+static inline void ilist_push_head(struct ilist *l, struct ilist_node *n)
+{
+	n->prev = &l->head;
+	n->next = l->head.next;
+	l->head.next->prev = n;
+	l->head.next = n;
+	l->size++;
+}
+
+static inline void ilist_push_tail(struct ilist *l, struct ilist_node *n)
+{
+	n->next = &l->head;
+	n->prev = l->head.prev;
+	l->head.prev->next = n;
+	l->head.prev = n;
+	l->size++;
+}
+
+/** Unlink a node from whatever list it is on, in constant time.
+The node must currently be linked; the list's size is maintained
+through the stored back-pointers, so the list itself need not be
+named.  Safe to call on an unlinked node.
+*/
+static inline void ilist_remove_node(struct ilist *l, struct ilist_node *n)
+{
+	if (!n->next)
+		return;
+	n->prev->next = n->next;
+	n->next->prev = n->prev;
+	n->next = 0;
+	n->prev = 0;
+	l->size--;
+}
+
+static inline struct ilist_node *ilist_peek_head(struct ilist *l)
+{
+	return ilist_empty(l) ? 0 : l->head.next;
+}
+
+static inline struct ilist_node *ilist_peek_tail(struct ilist *l)
+{
+	return ilist_empty(l) ? 0 : l->head.prev;
+}
+
+static inline struct ilist_node *ilist_pop_head(struct ilist *l)
+{
+	struct ilist_node *n = ilist_peek_head(l);
+	if (n)
+		ilist_remove_node(l, n);
+	return n;
+}
+
+static inline struct ilist_node *ilist_pop_tail(struct ilist *l)
+{
+	struct ilist_node *n = ilist_peek_tail(l);
+	if (n)
+		ilist_remove_node(l, n);
+	return n;
+}
+
+#endif
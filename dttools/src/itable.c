@@ -11,22 +11,65 @@ See the file COPYING for details.
 #include <string.h>
 
 #define DEFAULT_SIZE 127
+#define DEFAULT_FLAT_SIZE 128
 #define DEFAULT_LOAD 0.75
 
+typedef enum {
+	ITABLE_MODE_CHAINED, /* linked entries hanging off a bucket array */
+	ITABLE_MODE_FLAT,    /* open addressing into a contiguous slot array */
+} itable_mode_t;
+
 struct entry {
 	UINT64_T key;
 	void *value;
 	struct entry *next;
 };
 
+/* A slot in the flat backend.  An empty slot has a null value,
+which the interface already forbids for stored objects. */
+
+struct flat_slot {
+	UINT64_T key;
+	void *value;
+};
+
 struct itable {
+	itable_mode_t mode;
 	int size;
 	int bucket_count;
 	struct entry **buckets;
+	struct flat_slot *slots;
 	int ibucket;
 	struct entry *ientry;
+	struct flat_slot *islot;
 };
 
+/* Round up to the next power of two, so the flat backend can mask instead of mod. */
+
+static int next_power_of_two(int n)
+{
+	int p = 1;
+	while (p < n && p < (1 << 30))
+		p = p << 1;
+	return p;
+}
+
+/*
+Scramble the key before choosing a home slot, so that the sequential
+task and job identifiers this table usually holds do not all land in
+one region of the slot array.  (Finalizer of the murmur3 hash.)
+*/
+
+static UINT64_T itable_hash(UINT64_T k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
 struct itable *itable_create(int bucket_count)
 {
 	struct itable *h;
@@ -38,8 +81,12 @@ struct itable *itable_create(int bucket_count)
 	if (bucket_count == 0)
 		bucket_count = DEFAULT_SIZE;
 
+	h->mode = ITABLE_MODE_CHAINED;
 	h->bucket_count = bucket_count;
 	h->buckets = (struct entry **)calloc(bucket_count, sizeof(struct entry *));
+	h->slots = 0;
+	h->ientry = 0;
+	h->islot = 0;
 	if (!h->buckets) {
 		free(h);
 		return 0;
@@ -50,11 +97,138 @@ struct itable *itable_create(int bucket_count)
 	return h;
 }
 
+struct itable *itable_create_flat(int bucket_count)
+{
+	struct itable *h;
+
+	h = (struct itable *)malloc(sizeof(struct itable));
+	if (!h)
+		return 0;
+
+	if (bucket_count == 0)
+		bucket_count = DEFAULT_FLAT_SIZE;
+
+	h->mode = ITABLE_MODE_FLAT;
+	h->bucket_count = next_power_of_two(bucket_count);
+	h->buckets = 0;
+	h->slots = (struct flat_slot *)calloc(h->bucket_count, sizeof(struct flat_slot));
+	h->ientry = 0;
+	h->islot = 0;
+	if (!h->slots) {
+		free(h);
+		return 0;
+	}
+
+	h->size = 0;
+
+	return h;
+}
+
+/* The probe distance of the entry in slot i is how far it sits from its home slot. */
+
+static int flat_probe_distance(struct itable *h, int i)
+{
+	int mask = h->bucket_count - 1;
+	return (i - (int)(itable_hash(h->slots[i].key) & mask)) & mask;
+}
+
+/*
+Place a key into the slot array, displacing entries that sit closer to
+their home slot than we do (robin hood hashing), which keeps the maximum
+probe length short without tombstones.
+*/
+
+static void flat_place(struct itable *h, UINT64_T key, void *value)
+{
+	int mask = h->bucket_count - 1;
+	int i = itable_hash(key) & mask;
+	int dist = 0;
+
+	while (1) {
+		struct flat_slot *s = &h->slots[i];
+		if (!s->value) {
+			s->key = key;
+			s->value = value;
+			return;
+		}
+		int sdist = flat_probe_distance(h, i);
+		if (sdist < dist) {
+			UINT64_T tkey = s->key;
+			void *tvalue = s->value;
+			s->key = key;
+			s->value = value;
+			key = tkey;
+			value = tvalue;
+			dist = sdist;
+		}
+		i = (i + 1) & mask;
+		dist++;
+	}
+}
+
+static int flat_resize(struct itable *h, int new_count)
+{
+	struct flat_slot *old_slots = h->slots;
+	int old_count = h->bucket_count;
+	int i;
+
+	struct flat_slot *new_slots = (struct flat_slot *)calloc(new_count, sizeof(struct flat_slot));
+	if (!new_slots)
+		return 0;
+
+	h->slots = new_slots;
+	h->bucket_count = new_count;
+
+	for (i = 0; i < old_count; i++) {
+		if (old_slots[i].value) {
+			flat_place(h, old_slots[i].key, old_slots[i].value);
+		}
+	}
+
+	free(old_slots);
+	return 1;
+}
+
+/* Find the slot index holding the given key, or -1 if not present. */
+
+static int flat_find(struct itable *h, UINT64_T key)
+{
+	int mask = h->bucket_count - 1;
+	int i = itable_hash(key) & mask;
+	int dist = 0;
+
+	while (1) {
+		struct flat_slot *s = &h->slots[i];
+		if (!s->value)
+			return -1;
+		/* The robin hood invariant lets us stop once we probe past our distance. */
+		if (flat_probe_distance(h, i) < dist)
+			return -1;
+		if (s->key == key)
+			return i;
+		i = (i + 1) & mask;
+		dist++;
+	}
+}
+
 void itable_clear(struct itable *h, void (*delete_func)(void *))
 {
-	struct entry *e, *f;
 	int i;
 
+	if (h->mode == ITABLE_MODE_FLAT) {
+		for (i = 0; i < h->bucket_count; i++) {
+			if (h->slots[i].value) {
+				if (delete_func)
+					delete_func(h->slots[i].value);
+				h->slots[i].value = 0;
+			}
+		}
+		h->size = 0;
+		return;
+	}
+
+	struct entry *e, *f;
+
 	for (i = 0; i < h->bucket_count; i++) {
 		e = h->buckets[i];
 		while (e) {
@@ -69,12 +243,15 @@ void itable_clear(struct itable *h, void (*delete_func)(void *))
 	for (i = 0; i < h->bucket_count; i++) {
 		h->buckets[i] = 0;
 	}
+
+	h->size = 0;
 }
 
 void itable_delete(struct itable *h)
 {
 	itable_clear(h, 0);
 	free(h->buckets);
+	free(h->slots);
 	free(h);
 }
 
@@ -88,6 +265,13 @@ void *itable_lookup(struct itable *h, UINT64_T key)
 	struct entry *e;
 	UINT64_T index;
 
+	if (h->mode == ITABLE_MODE_FLAT) {
+		int i = flat_find(h, key);
+		if (i < 0)
+			return 0;
+		return h->slots[i].value;
+	}
+
 	index = key % h->bucket_count;
 	e = h->buckets[index];
 
@@ -147,6 +331,27 @@ int itable_insert(struct itable *h, UINT64_T key, const void *value)
 	struct entry *e;
 	UINT64_T index;
 
+	if (h->mode == ITABLE_MODE_FLAT) {
+		/* a null value would be indistinguishable from an empty slot */
+		if (!value)
+			return 0;
+
+		int i = flat_find(h, key);
+		if (i >= 0) {
+			h->slots[i].value = (void *)value;
+			return 1;
+		}
+
+		if (((float)h->size / h->bucket_count) > DEFAULT_LOAD) {
+			if (!flat_resize(h, 2 * h->bucket_count))
+				return 0;
+		}
+
+		flat_place(h, key, (void *)value);
+		h->size++;
+		return 1;
+	}
+
 	if (((float)h->size / h->bucket_count) > DEFAULT_LOAD)
 		itable_double_buckets(h);
 
@@ -180,6 +385,30 @@ void *itable_remove(struct itable *h, UINT64_T key)
 	void *value;
 	UINT64_T index;
 
+	if (h->mode == ITABLE_MODE_FLAT) {
+		int mask = h->bucket_count - 1;
+		int i = flat_find(h, key);
+		if (i < 0)
+			return 0;
+
+		value = h->slots[i].value;
+
+		/*
+		Shift the following run of displaced entries back one slot,
+		so no tombstone is left behind and probe chains stay short.
+		*/
+		while (1) {
+			int j = (i + 1) & mask;
+			if (!h->slots[j].value || flat_probe_distance(h, j) == 0)
+				break;
+			h->slots[i] = h->slots[j];
+			i = j;
+		}
+		h->slots[i].value = 0;
+		h->size--;
+		return value;
+	}
+
 	index = key % h->bucket_count;
 	e = h->buckets[index];
 	f = 0;
@@ -216,8 +445,26 @@ void *itable_pop(struct itable *t)
 	}
 }
 
+/* Position the flat iterator on the first occupied slot at or after i, or mark it done. */
+
+static void flat_seek(struct itable *h, int i)
+{
+	h->islot = 0;
+	for (h->ibucket = i; h->ibucket < h->bucket_count; h->ibucket++) {
+		if (h->slots[h->ibucket].value) {
+			h->islot = &h->slots[h->ibucket];
+			break;
+		}
+	}
+}
+
 void itable_firstkey(struct itable *h)
 {
+	if (h->mode == ITABLE_MODE_FLAT) {
+		flat_seek(h, 0);
+		return;
+	}
+
 	h->ientry = 0;
 	for (h->ibucket = 0; h->ibucket < h->bucket_count; h->ibucket++) {
 		h->ientry = h->buckets[h->ibucket];
@@ -228,6 +475,16 @@ void itable_firstkey(struct itable *h)
 
 int itable_nextkey(struct itable *h, UINT64_T *key, void **value)
 {
+	if (h->mode == ITABLE_MODE_FLAT) {
+		if (!h->islot)
+			return 0;
+		*key = h->islot->key;
+		if (value)
+			*value = h->islot->value;
+		flat_seek(h, h->ibucket + 1);
+		return 1;
+	}
+
 	if (h->ientry) {
 		*key = h->ientry->key;
 		if (value)
@@ -55,6 +55,30 @@ ITABLE_ITERATE(h,key,value) {
 
 struct itable *itable_create(int buckets);
 
+/** Create a new integer table with flat, open-addressed storage.
+The table presents exactly the same interface as one returned by
+@ref itable_create, but stores its entries in a single contiguous slot
+array with power-of-two sizing, robin-hood linear probing, and
+tombstone-free deletion, rather than chained buckets, avoiding one
+malloc per entry and keeping lookups within one or two cache lines.
+<p>
+One caveat keeps the Work Queue and TaskVine manager task maps -- the
+call sites that motivated this backend -- on chained storage: deleting
+during iteration.  A chained table hands out the next entry before the
+current one is returned, so the common pattern of removing the current
+key inside an iteration loop is safe; the flat backend's backward-shift
+deletion moves a later entry into the vacated slot, so the same pattern
+skips or revisits entries.  The managers remove tasks and workers from
+their tables inside iteration loops (cancellation, worker cleanup), so
+they must not adopt this backend until those loops are restructured.
+Use it for tables that are built up and then read, or whose removals
+happen outside iteration, as the makeflow DAG tables do.
+@param buckets The initial number of slots, which will be rounded up to a power of two.  If zero, a default value will be used.
+@return A pointer to a new integer table.
+*/
+
+struct itable *itable_create_flat(int buckets);
+
 /** Remove all entries from an integer table.
 @param h The integer table to delete.
 @param delete_func If non-null, will be invoked on each object to delete it.
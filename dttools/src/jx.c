@@ -15,9 +15,131 @@ See the file COPYING for details.
 #include <stdlib.h>
 #include <string.h>
 
+/*
+An arena parcels out jx storage from a few large blocks, so parsing a
+big document performs almost no individual allocations and frees them
+all in one shot.  Everything allocated while an arena is installed is
+marked, and the delete paths below leave marked storage to the arena.
+*/
+
+#define JX_ARENA_BLOCK_SIZE (256 * 1024)
+
+struct jx_arena_block {
+	struct jx_arena_block *next;
+	size_t used;
+	size_t size;
+};
+
+struct jx_arena {
+	struct jx_arena_block *blocks;
+};
+
+static struct jx_arena *jx_current_arena = 0;
+
+struct jx_arena *jx_arena_create(void)
+{
+	struct jx_arena *a = xxmalloc(sizeof(*a));
+	a->blocks = 0;
+	return a;
+}
+
+void jx_arena_delete(struct jx_arena *a)
+{
+	if (!a)
+		return;
+	struct jx_arena_block *b = a->blocks;
+	while (b) {
+		struct jx_arena_block *next = b->next;
+		free(b);
+		b = next;
+	}
+	free(a);
+}
+
+void jx_arena_reset(struct jx_arena *a)
+{
+	if (!a)
+		return;
+
+	/*
+	Allocation only ever fills the head block, so keeping more than
+	one empty block would strand the rest: retain the largest block
+	(one window's worth of arena, once the consumer reaches steady
+	state) and return the others.
+	*/
+	struct jx_arena_block *largest = 0;
+	struct jx_arena_block *b = a->blocks;
+	while (b) {
+		struct jx_arena_block *next = b->next;
+		if (!largest) {
+			largest = b;
+		} else if (b->size > largest->size) {
+			free(largest);
+			largest = b;
+		} else {
+			free(b);
+		}
+		b = next;
+	}
+
+	if (largest) {
+		largest->used = 0;
+		largest->next = 0;
+	}
+	a->blocks = largest;
+}
+
+struct jx_arena *jx_arena_set(struct jx_arena *a)
+{
+	struct jx_arena *prev = jx_current_arena;
+	jx_current_arena = a;
+	return prev;
+}
+
+static void *jx_arena_alloc(struct jx_arena *a, size_t size)
+{
+	size = (size + 15) & ~(size_t)15;
+
+	struct jx_arena_block *b = a->blocks;
+	if (!b || b->size - b->used < size) {
+		size_t bsize = JX_ARENA_BLOCK_SIZE;
+		if (bsize < size)
+			bsize = size;
+		b = xxmalloc(sizeof(*b) + bsize);
+		b->next = a->blocks;
+		b->used = 0;
+		b->size = bsize;
+		a->blocks = b;
+	}
+
+	void *p = (char *)(b + 1) + b->used;
+	b->used += size;
+	return p;
+}
+
+/* Duplicate a string from the current arena, or the heap when none is installed. */
+
+static char *jx_strdup_alloc(const char *s)
+{
+	if (jx_current_arena) {
+		size_t n = strlen(s) + 1;
+		char *p = jx_arena_alloc(jx_current_arena, n);
+		memcpy(p, s, n);
+		return p;
+	}
+	return strdup(s);
+}
+
 struct jx_pair *jx_pair(struct jx *key, struct jx *value, struct jx_pair *next)
 {
-	struct jx_pair *pair = calloc(1, sizeof(*pair));
+	struct jx_pair *pair;
+	if (jx_current_arena) {
+		pair = jx_arena_alloc(jx_current_arena, sizeof(*pair));
+		memset(pair, 0, sizeof(*pair));
+		pair->arena = 1;
+	} else {
+		pair = calloc(1, sizeof(*pair));
+	}
 	pair->key = key;
 	pair->value = value;
 	pair->next = next;
@@ -26,7 +148,14 @@ struct jx_pair *jx_pair(struct jx *key, struct jx *value, struct jx_pair *next)
 
 struct jx_item *jx_item(struct jx *value, struct jx_item *next)
 {
-	struct jx_item *item = calloc(1, sizeof(*item));
+	struct jx_item *item;
+	if (jx_current_arena) {
+		item = jx_arena_alloc(jx_current_arena, sizeof(*item));
+		memset(item, 0, sizeof(*item));
+		item->arena = 1;
+	} else {
+		item = calloc(1, sizeof(*item));
+	}
 	item->value = value;
 	item->next = next;
 	return item;
@@ -36,8 +165,15 @@ struct jx_comprehension *jx_comprehension(const char *variable, struct jx *eleme
 {
 	assert(variable);
 	assert(elements);
-	struct jx_comprehension *comp = calloc(1, sizeof(*comp));
-	comp->variable = strdup(variable);
+	struct jx_comprehension *comp;
+	if (jx_current_arena) {
+		comp = jx_arena_alloc(jx_current_arena, sizeof(*comp));
+		memset(comp, 0, sizeof(*comp));
+		comp->arena = 1;
+	} else {
+		comp = calloc(1, sizeof(*comp));
+	}
+	comp->variable = jx_strdup_alloc(variable);
 	comp->elements = elements;
 	comp->condition = condition;
 	comp->next = next;
@@ -46,7 +182,14 @@ struct jx_comprehension *jx_comprehension(const char *variable, struct jx *eleme
 
 static struct jx *jx_create(jx_type_t type)
 {
-	struct jx *j = xxcalloc(1, sizeof(*j));
+	struct jx *j;
+	if (jx_current_arena) {
+		j = jx_arena_alloc(jx_current_arena, sizeof(*j));
+		memset(j, 0, sizeof(*j));
+		j->arena = 1;
+	} else {
+		j = xxcalloc(1, sizeof(*j));
+	}
 	j->type = type;
 	return j;
 }
@@ -59,20 +202,28 @@ struct jx *jx_null()
 struct jx *jx_symbol(const char *symbol_name)
 {
 	struct jx *j = jx_create(JX_SYMBOL);
-	j->u.symbol_name = strdup(symbol_name);
+	j->u.symbol_name = jx_strdup_alloc(symbol_name);
 	return j;
 }
 
 struct jx *jx_string(const char *string_value)
 {
 	assert(string_value);
-	return jx_string_nocopy(strdup(string_value));
+	struct jx *j = jx_create(JX_STRING);
+	j->u.string_value = jx_strdup_alloc(string_value);
+	return j;
 }
 
 struct jx *jx_string_nocopy(char *string_value)
 {
 	struct jx *j = jx_create(JX_STRING);
-	j->u.string_value = string_value;
+	if (jx_current_arena) {
+		/* keep arena values self-contained: copy in, release the original */
+		j->u.string_value = jx_strdup_alloc(string_value);
+		free(string_value);
+	} else {
+		j->u.string_value = string_value;
+	}
 	return j;
 }
 
@@ -91,8 +242,7 @@ struct jx *jx_format(const char *fmt, ...)
 	buffer_dup(B, &str);
 	buffer_free(B);
 
-	j = jx_create(JX_STRING);
-	j->u.string_value = str;
+	j = jx_string_nocopy(str);
 
 	return j;
 }
@@ -404,7 +554,8 @@ struct jx *jx_array_shift(struct jx *array)
 	if (i) {
 		result = i->value;
 		array->u.items = i->next;
-		free(i);
+		if (!i->arena)
+			free(i);
 	}
 	return result;
 }
@@ -417,7 +568,8 @@ void jx_pair_delete(struct jx_pair *pair)
 	jx_delete(pair->value);
 	jx_comprehension_delete(pair->comp);
 	jx_pair_delete(pair->next);
-	free(pair);
+	if (!pair->arena)
+		free(pair);
 }
 
 void jx_item_delete(struct jx_item *item)
@@ -427,18 +579,21 @@ void jx_item_delete(struct jx_item *item)
 	jx_delete(item->value);
 	jx_comprehension_delete(item->comp);
 	jx_item_delete(item->next);
-	free(item);
+	if (!item->arena)
+		free(item);
 }
 
 void jx_comprehension_delete(struct jx_comprehension *comp)
 {
 	if (!comp)
 		return;
-	free(comp->variable);
+	if (!comp->arena)
+		free(comp->variable);
 	jx_delete(comp->elements);
 	jx_delete(comp->condition);
 	jx_comprehension_delete(comp->next);
-	free(comp);
+	if (!comp->arena)
+		free(comp);
 }
 
 void jx_delete(struct jx *j)
@@ -453,10 +608,12 @@ void jx_delete(struct jx *j)
 	case JX_NULL:
 		break;
 	case JX_SYMBOL:
-		free(j->u.symbol_name);
+		if (!j->arena)
+			free(j->u.symbol_name);
 		break;
 	case JX_STRING:
-		free(j->u.string_value);
+		if (!j->arena)
+			free(j->u.string_value);
 		break;
 	case JX_ARRAY:
 		jx_item_delete(j->u.items);
@@ -472,7 +629,8 @@ void jx_delete(struct jx *j)
 		jx_delete(j->u.err);
 		break;
 	}
-	free(j);
+	if (!j->arena)
+		free(j);
 }
 
 int jx_isatomic(struct jx *j)
@@ -57,7 +57,8 @@ typedef int64_t jx_int_t;
 #define PRIiJX PRIi64
 
 struct jx_comprehension {
-	unsigned line;
+	unsigned line : 31;
+	unsigned arena : 1; /**< storage came from a jx_arena; do not free */
 	char *variable; /**< variable for comprehension */
 	struct jx *elements; /**< items for list comprehension */
 	struct jx *condition; /**< condition for filtering list comprehension */
@@ -67,7 +68,8 @@ struct jx_comprehension {
 /** JX item linked-list used by @ref JX_ARRAY and @ref jx.items */
 
 struct jx_item {
-	unsigned line;
+	unsigned line : 31;
+	unsigned arena : 1; /**< storage came from a jx_arena; do not free */
 	struct jx *value;       /**< value of this item */
 	struct jx_comprehension *comp;
 	struct jx_item *next;	/**< pointer to next item */
@@ -76,7 +78,8 @@ struct jx_item {
 /** JX key-value pairs used by @ref JX_OBJECT and @ref jx.pairs */
 
 struct jx_pair {
-	unsigned line;
+	unsigned line : 31;
+	unsigned arena : 1; /**< storage came from a jx_arena; do not free */
 	struct jx      *key;	/**< key of this pair */
 	struct jx      *value;  /**< value of this pair */
 	struct jx_comprehension *comp;
@@ -116,7 +119,8 @@ struct jx_operator {
 
 struct jx {
 	jx_type_t type;               /**< type of this value */
-	unsigned line;                /**< line where this value was defined */
+	unsigned line : 31;           /**< line where this value was defined */
+	unsigned arena : 1;           /**< storage came from a jx_arena; do not free */
 	union {
 		int boolean_value;      /**< value of @ref JX_BOOLEAN */
 		jx_int_t integer_value; /**< value of @ref JX_INTEGER */
@@ -130,6 +134,38 @@ struct jx {
 	} u;
 };
 
+/** An arena from which jx values can be allocated in bulk.
+While an arena is installed with @ref jx_arena_set, every jx value,
+pair, item, and string is carved out of a few large blocks instead of
+being an individual malloc, and the whole collection is released at
+once by @ref jx_arena_delete.  Parsing a large document this way costs
+near-zero allocator overhead and gives much better locality.  Values
+allocated from an arena are marked so that @ref jx_delete leaves them
+alone, so arena and malloc'd values can be mixed in one tree. */
+
+struct jx_arena * jx_arena_create(void);
+
+/** Delete an arena and every value allocated from it at once.
+Any tree parsed into the arena must not be used afterward.
+@param arena The arena to delete. */
+
+void jx_arena_delete( struct jx_arena *arena );
+
+/** Rewind an arena for reuse, keeping its blocks allocated.
+Every value previously allocated from the arena becomes invalid, but
+the memory is retained, so a steady-state consumer that parses,
+processes, and resets in a loop settles into zero allocator traffic.
+@param arena The arena to rewind. */
+
+void jx_arena_reset( struct jx_arena *arena );
+
+/** Install an arena as the allocation source for subsequent jx values.
+Pass null to return to ordinary per-value allocation.
+@param arena The arena to install, or null.
+@return The previously installed arena, to be restored when done. */
+
+struct jx_arena * jx_arena_set( struct jx_arena *arena );
+
 /** Create a JX null value. @return A JX expression. */
 struct jx * jx_null();
 
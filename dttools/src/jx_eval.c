@@ -252,10 +252,20 @@ static struct jx *jx_eval_slice(struct jx *array, struct jx *slice)
 	if (end < 0)
 		end += len;
 
-	for (jx_int_t i = start; i < end; ++i) {
-		struct jx *j = jx_array_index(array, i);
-		if (j)
-			jx_array_append(result, jx_copy(j));
+	/* one pass with a local tail, instead of indexed access and append that were each linear */
+	struct jx_item *tail = NULL;
+	jx_int_t index = 0;
+	struct jx_item *it;
+	for (it = array->u.items; it && index < end; it = it->next, index++) {
+		if (index < start)
+			continue;
+		struct jx_item *n = jx_item(jx_copy(it->value), NULL);
+		if (tail) {
+			tail->next = n;
+		} else {
+			result->u.items = n;
+		}
+		tail = n;
 	}
 
 	return result;
@@ -625,25 +635,40 @@ static struct jx_pair *jx_eval_pair(struct jx_pair *pair, struct jx *context)
 	}
 }
 
+/*
+Iterative rather than recursive over the item list, with an explicit
+tail pointer: a parameter-sweep workflow expanding hundreds of
+thousands of rules would otherwise recurse once per element and
+overflow the stack.
+*/
+
 static struct jx_item *jx_eval_item(struct jx_item *item, struct jx *context)
 {
-	if (!item)
-		return NULL;
+	struct jx_item *head = NULL;
+	struct jx_item *tail = NULL;
 
-	if (item->comp) {
-		struct jx_item *result = jx_eval_list_comprehension(item->value, item->comp, context);
-		if (result) {
-			struct jx_item *i = result;
-			while (i->next)
-				i = i->next;
-			i->next = jx_eval_item(item->next, context);
-			return result;
+	for (; item; item = item->next) {
+		struct jx_item *chunk;
+
+		if (item->comp) {
+			chunk = jx_eval_list_comprehension(item->value, item->comp, context);
+			if (!chunk)
+				continue;
 		} else {
-			return jx_eval_item(item->next, context);
+			chunk = jx_item(jx_eval(item->value, context), NULL);
 		}
-	} else {
-		return jx_item(jx_eval(item->value, context), jx_eval_item(item->next, context));
+
+		if (tail) {
+			tail->next = chunk;
+		} else {
+			head = chunk;
+		}
+		tail = chunk;
+		while (tail->next)
+			tail = tail->next;
 	}
+
+	return head;
 }
 
 static struct jx *jx_check_errors(struct jx *j)
@@ -17,6 +17,10 @@ See the file COPYING for details.
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 typedef enum {
 	JX_TOKEN_SYMBOL,
 	JX_TOKEN_INTEGER,
@@ -104,8 +108,12 @@ void jx_parser_read_stream(struct jx_parser *p, FILE *file)
 
 void jx_parser_read_string(struct jx_parser *p, const char *str)
 {
+	/*
+	Record the length up front so the lexer can scan whole chunks of
+	the buffer at a time without running past the terminator.
+	*/
 	p->source_string = str;
-	p->source_string_length = -1;
+	p->source_string_length = str ? strlen(str) : 0;
 }
 
 void jx_parser_read_string_and_length(struct jx_parser *p, const char *str, int length)
@@ -223,6 +231,96 @@ static void jx_ungetchar(struct jx_parser *p, int c)
 	p->putback_char_valid = true;
 }
 
+/* Keep the line count correct for a span of input consumed in bulk. */
+
+static void jx_count_lines(struct jx_parser *p, const char *s, int n)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		if (s[i] == '\n')
+			++p->line;
+	}
+}
+
+/*
+When the parser reads from an in-memory buffer, runs of whitespace and
+the plain interiors of string constants can be consumed a chunk at a
+time instead of one character per jx_getchar call, which is where the
+catalog server and the managers spend most of their parse time.  With
+SSE2 the classification looks at sixteen bytes per step; elsewhere a
+scalar loop still avoids the per-character call overhead.
+*/
+
+static void jx_skip_whitespace_bulk(struct jx_parser *p)
+{
+	if (!p->source_string || p->putback_char_valid)
+		return;
+
+#ifdef __SSE2__
+	while (p->source_string_length >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p->source_string);
+		__m128i ws = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+		int m = _mm_movemask_epi8(ws);
+		int adv = (m == 0xffff) ? 16 : __builtin_ctz(~m);
+		if (adv == 0)
+			return;
+		jx_count_lines(p, p->source_string, adv);
+		p->source_string += adv;
+		p->source_string_length -= adv;
+		if (adv < 16)
+			return;
+	}
+#endif
+	while (p->source_string_length > 0 && isspace((unsigned char)*p->source_string)) {
+		if (*p->source_string == '\n')
+			++p->line;
+		p->source_string++;
+		p->source_string_length--;
+	}
+}
+
+/*
+Consume the longest span of an in-memory string constant containing
+neither the closing quote nor an escape, appending it to the token
+buffer starting at *i.  The caller's per-character loop handles
+whatever stopped the scan.
+*/
+
+static void jx_scan_string_bulk(struct jx_parser *p, int *i)
+{
+	if (!p->source_string || p->putback_char_valid)
+		return;
+
+	const char *str = p->source_string;
+	int n = p->source_string_length;
+	int span = 0;
+
+#ifdef __SSE2__
+	while (span + 16 <= n && *i + span + 16 < MAX_TOKEN_SIZE) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(str + span));
+		__m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+		int m = _mm_movemask_epi8(hit);
+		if (m) {
+			span += __builtin_ctz(m);
+			break;
+		}
+		span += 16;
+	}
+#endif
+	while (span < n && *i + span < MAX_TOKEN_SIZE && str[span] != '\"' && str[span] != '\\')
+		span++;
+
+	if (span > 0) {
+		memcpy(p->token + *i, str, span);
+		jx_count_lines(p, str, span);
+		*i += span;
+		p->source_string += span;
+		p->source_string_length -= span;
+	}
+}
+
 static int jx_scan_unicode(struct jx_parser *s)
 {
 	int i;
@@ -294,6 +392,7 @@ static jx_token_t jx_scan(struct jx_parser *s)
 	}
 
 retry:
+	jx_skip_whitespace_bulk(s);
 	c = jx_getchar(s);
 
 	if (isspace(c)) {
@@ -363,6 +462,9 @@ retry:
 	} else if (c == '\"') {
 		int i;
 		for (i = 0; i < MAX_TOKEN_SIZE; i++) {
+			jx_scan_string_bulk(s, &i);
+			if (i >= MAX_TOKEN_SIZE)
+				break;
 			int n = jx_scan_string_char(s);
 			if (n == EOF) {
 				if (i > 10)
@@ -1197,6 +1299,36 @@ struct jx *jx_parse_string(const char *str)
 	return jx_parse_finish(p);
 }
 
+/*
+The arena variants install the arena for the duration of the parse, so
+every node and string of the resulting tree comes out of it and is
+released in one shot by jx_arena_delete.
+*/
+
+struct jx *jx_parse_stream_arena(FILE *file, struct jx_arena *arena)
+{
+	struct jx_arena *prev = jx_arena_set(arena);
+	struct jx *j = jx_parse_stream(file);
+	jx_arena_set(prev);
+	return j;
+}
+
+struct jx *jx_parse_string_arena(const char *str, struct jx_arena *arena)
+{
+	struct jx_arena *prev = jx_arena_set(arena);
+	struct jx *j = jx_parse_string(str);
+	jx_arena_set(prev);
+	return j;
+}
+
+struct jx *jx_parse_link_arena(struct link *l, time_t stoptime, struct jx_arena *arena)
+{
+	struct jx_arena *prev = jx_arena_set(arena);
+	struct jx *j = jx_parse_link(l, stoptime);
+	jx_arena_set(prev);
+	return j;
+}
+
 struct jx *jx_parse_string_and_length(const char *str, int length)
 {
 	struct jx_parser *p = jx_parser_create(false);
@@ -43,6 +43,21 @@ struct jx * jx_parse_file( const char *name );
 /** Parse a network link to a JX expression. @param l A link pointer (opaque struct).  @param stoptime The absolute time at which to stop.   @return A JX expression which must be deleted with @ref jx_delete. If the parse fails or no JSON value is present, null is returned. */
 struct jx * jx_parse_link( struct link *l, time_t stoptime );
 
+/** Parse a stream into an arena-backed JX expression.
+The resulting tree (and every string within it) is allocated from the
+given arena, so a very large document parses with near-zero allocator
+overhead and is discarded in one shot by @ref jx_arena_delete rather
+than node by node.  @param file A stdio stream. @param arena The arena
+to allocate from. @return A JX expression which becomes invalid when
+the arena is deleted. */
+struct jx * jx_parse_stream_arena( FILE *file, struct jx_arena *arena );
+
+/** Parse a string into an arena-backed JX expression.  @see jx_parse_stream_arena */
+struct jx * jx_parse_string_arena( const char *str, struct jx_arena *arena );
+
+/** Parse a network link into an arena-backed JX expression.  @see jx_parse_stream_arena */
+struct jx * jx_parse_link_arena( struct link *l, time_t stoptime, struct jx_arena *arena );
+
 /** Parse a jx argument file from a commandline option.
  * The passed-in object is consumed.
  * @param jx_args A JX object to add args to.
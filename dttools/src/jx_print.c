@@ -9,6 +9,40 @@ See the file COPYING for details.
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Serialization runs on every task dispatch and catalog update, so the
+scalar cases below format into small stack buffers and append with
+buffer_putlstring rather than going through buffer_printf, which costs
+a varargs vsnprintf pass per call.
+*/
+
+static void jx_print_integer(jx_int_t value, buffer_t *b)
+{
+	char digits[32];
+	char *s = &digits[sizeof(digits)];
+	int negative = 0;
+	uintmax_t u;
+
+	if (value < 0) {
+		negative = 1;
+		u = -(uintmax_t)value;
+	} else {
+		u = value;
+	}
+
+	do {
+		*--s = '0' + u % 10;
+		u /= 10;
+	} while (u > 0);
+
+	if (negative)
+		*--s = '-';
+
+	buffer_putlstring(b, s, &digits[sizeof(digits)] - s);
+}
 
 void jx_comprehension_print(struct jx_comprehension *comp, buffer_t *b)
 {
@@ -134,44 +168,54 @@ void jx_escape_string(const char *s, buffer_t *b)
 	if (!s)
 		return;
 
-	buffer_putstring(b, "\"");
+	buffer_putliteral(b, "\"");
 	while (*s) {
+		/* append the longest run needing no escape in one step */
+		const char *start = s;
+		while (*s && *s != '\"' && *s != '\'' && *s != '\\' && isprint((unsigned char)*s))
+			s++;
+		if (s > start)
+			buffer_putlstring(b, start, s - start);
+		if (!*s)
+			break;
+
 		switch (*s) {
 		case '\"':
-			buffer_putstring(b, "\\\"");
+			buffer_putliteral(b, "\\\"");
 			break;
 		case '\'':
-			buffer_putstring(b, "\\\'");
+			buffer_putliteral(b, "\\\'");
 			break;
 		case '\\':
-			buffer_putstring(b, "\\\\");
+			buffer_putliteral(b, "\\\\");
 			break;
 		case '\b':
-			buffer_putstring(b, "\\b");
+			buffer_putliteral(b, "\\b");
 			break;
 		case '\f':
-			buffer_putstring(b, "\\f");
+			buffer_putliteral(b, "\\f");
 			break;
 		case '\n':
-			buffer_putstring(b, "\\n");
+			buffer_putliteral(b, "\\n");
 			break;
 		case '\r':
-			buffer_putstring(b, "\\r");
+			buffer_putliteral(b, "\\r");
 			break;
 		case '\t':
-			buffer_putstring(b, "\\t");
+			buffer_putliteral(b, "\\t");
 			break;
-		default:
-			if (isprint(*s)) {
-				buffer_printf(b, "%c", *s);
-			} else {
-				buffer_printf(b, "\\u%04x", (int)*s);
-			}
+		default: {
+			static const char hex[] = "0123456789abcdef";
+			char esc[6] = {'\\', 'u', '0', '0', 0, 0};
+			esc[4] = hex[((unsigned char)*s >> 4) & 0xf];
+			esc[5] = hex[(unsigned char)*s & 0xf];
+			buffer_putlstring(b, esc, 6);
 			break;
 		}
+		}
 		s++;
 	}
-	buffer_putstring(b, "\"");
+	buffer_putliteral(b, "\"");
 }
 
 void jx_print_subexpr(struct jx *j, jx_operator_t parent, buffer_t *b)
@@ -210,17 +254,24 @@ void jx_print_buffer(struct jx *j, buffer_t *b)
 	case JX_NULL:
 		buffer_putstring(b, "null");
 		break;
-	case JX_DOUBLE:
-		buffer_printf(b, "%.16g", j->u.double_value);
+	case JX_DOUBLE: {
+		char digits[40];
+		int n = snprintf(digits, sizeof(digits), "%.16g", j->u.double_value);
+		buffer_putlstring(b, digits, n);
 		break;
+	}
 	case JX_BOOLEAN:
-		buffer_printf(b, "%s", j->u.boolean_value ? "true" : "false");
+		if (j->u.boolean_value) {
+			buffer_putliteral(b, "true");
+		} else {
+			buffer_putliteral(b, "false");
+		}
 		break;
 	case JX_INTEGER:
-		buffer_printf(b, "%lld", (long long)j->u.integer_value);
+		jx_print_integer(j->u.integer_value, b);
 		break;
 	case JX_SYMBOL:
-		buffer_printf(b, "%s", j->u.symbol_name);
+		buffer_putstring(b, j->u.symbol_name);
 		break;
 	case JX_STRING:
 		jx_escape_string(j->u.string_value, b);
@@ -274,7 +325,9 @@ void jx_print_link(struct jx *j, struct link *l, time_t stoptime)
 	size_t len;
 	const char *str = buffer_tolstring(&buffer, &len);
 
-	link_printf(l, stoptime, "%s", str);
+	/* keep ordering with any output the caller has buffered via link_printf */
+	link_flush_output(l);
+	link_putlstring(l, str, len, stoptime);
 	buffer_free(&buffer);
 }
 
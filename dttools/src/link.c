@@ -6,9 +6,12 @@ See the file COPYING for details.
 */
 
 #include "link.h"
+#include "timestamp.h"
 #include "address.h"
 #include "buffer.h"
 #include "debug.h"
+#include "hash_table.h"
+#include "list.h"
 #include "domain_name.h"
 #include "full_io.h"
 #include "macros.h"
@@ -16,6 +19,10 @@ See the file COPYING for details.
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <sys/file.h>
@@ -63,6 +70,13 @@ struct link {
 	int fd;
 	enum link_type type;
 	uint64_t read, written;
+	uint64_t created;              /* timestamp at creation, for lifetime throughput */
+	uint64_t throttle_bps;         /* token-bucket write budget in bytes per second; zero means unlimited */
+	uint64_t throttle_window;      /* start of the current accounting window */
+	uint64_t throttle_bytes;       /* bytes written in the current window */
+	uint64_t blocked_write_usecs;  /* time spent waiting for the socket to accept data */
+	uint64_t blocked_writes;       /* writes that had to wait at least once */
+	uint32_t blocked_write_buckets[32]; /* log2 histogram of per-write block times, in usecs */
 	char *buffer_start;
 	size_t buffer_length;
 	char buffer[1 << 16];
@@ -83,6 +97,70 @@ static int link_send_window = 65536;
 static int link_recv_window = 65536;
 static int link_override_window = 0;
 
+/*
+A simple token bucket over 100ms windows: once the window's share of
+the budget is spent, the caller sleeps out the remainder of the
+window.  Enforced in the write paths and in link_read -- a throttled
+receiver paces itself and TCP backpressure slows the sender -- so any
+transfer loop built on the link calls is paced without changes.
+*/
+
+void link_set_throttle(struct link *l, uint64_t bytes_per_second)
+{
+	if (!l)
+		return;
+	l->throttle_bps = bytes_per_second;
+	l->throttle_window = 0;
+	l->throttle_bytes = 0;
+}
+
+static void link_throttle_account(struct link *l, uint64_t bytes)
+{
+	if (!l->throttle_bps)
+		return;
+
+	uint64_t now = timestamp_get();
+	uint64_t window_usecs = 100000;
+	uint64_t window_budget = l->throttle_bps / 10;
+
+	if (now - l->throttle_window >= window_usecs) {
+		l->throttle_window = now;
+		l->throttle_bytes = 0;
+	}
+
+	l->throttle_bytes += bytes;
+	if (l->throttle_bytes >= window_budget) {
+		uint64_t elapsed = now - l->throttle_window;
+		if (elapsed < window_usecs) {
+			usleep(window_usecs - elapsed);
+		}
+		l->throttle_window = timestamp_get();
+		l->throttle_bytes = 0;
+	}
+}
+
+int link_get_stats(struct link *l, struct link_stats *stats)
+{
+	if (!l || !stats)
+		return 0;
+
+	stats->bytes_read = l->read;
+	stats->bytes_written = l->written;
+	stats->blocked_write_usecs = l->blocked_write_usecs;
+	stats->blocked_writes = l->blocked_writes;
+
+	uint64_t lifetime = timestamp_get() - l->created;
+	stats->lifetime_usecs = lifetime;
+	if (lifetime > 0) {
+		stats->throughput_bps = ((l->read + l->written) * 1000000.0) / lifetime;
+	} else {
+		stats->throughput_bps = 0;
+	}
+	memcpy(stats->blocked_write_buckets, l->blocked_write_buckets, sizeof(stats->blocked_write_buckets));
+
+	return 1;
+}
+
 void link_window_set(int send_buffer, int recv_buffer)
 {
 	link_send_window = send_buffer;
@@ -299,6 +377,13 @@ static struct link *link_create()
 		return 0;
 
 	link->read = link->written = 0;
+	link->created = timestamp_get();
+	link->throttle_bps = 0;
+	link->throttle_window = 0;
+	link->throttle_bytes = 0;
+	link->blocked_write_usecs = 0;
+	link->blocked_writes = 0;
+	memset(link->blocked_write_buckets, 0, sizeof(link->blocked_write_buckets));
 	link->fd = -1;
 
 	link->buffer_start = link->buffer;
@@ -428,6 +513,27 @@ static SSL_CTX *_create_ssl_context()
 		fatal("could not create SSL context: %s", strerror(errno));
 	}
 
+#ifdef SSL_OP_ENABLE_KTLS
+	/*
+	Ask the library to push the record keys into the kernel after the
+	handshake (kernel TLS) where the kernel, cipher, and protocol
+	version allow it.  With kTLS active the socket encrypts in the
+	kernel, so link_sendfile keeps its zero-copy path on encrypted
+	connections; where unsupported the option is silently ignored and
+	the ordinary userspace record layer is used.
+	*/
+	SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
+	/*
+	Enable session caching so repeat connections from the same peer
+	resume with an abbreviated handshake (session tickets where the
+	library supports them, the server-side session cache otherwise):
+	a worker pool or catalog poller reconnecting to one server stops
+	paying a full asymmetric handshake each time.
+	*/
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_BOTH);
+
 	return ctx;
 }
 
@@ -768,6 +874,103 @@ failure:
 	return 0;
 }
 
+/*
+Complete a connection begun with link_connect(...,LINK_NOWAIT).  The
+caller typically waits for the socket to become writable (for example
+through link_poll, so that many connection setups overlap) and then
+calls here to learn the outcome.
+*/
+
+int link_connect_finish(struct link *link, time_t stoptime)
+{
+	while (1) {
+		if (link_address_remote(link, link->raddr, &link->rport)) {
+			debug(D_TCP, "made connection to %s port %d", link->raddr, link->rport);
+			return 1;
+		}
+
+		int err = 0;
+		SOCKLEN_T len = sizeof(err);
+		if (getsockopt(link->fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err != 0) {
+			errno = err;
+			return 0;
+		}
+
+		if (time(0) >= stoptime) {
+			errno = ETIMEDOUT;
+			return 0;
+		}
+
+		link_sleep(link, stoptime, 0, 1);
+	}
+}
+
+/*
+A small pool of idle connections keyed by address and port, so that
+repeated contacts to the same peers (chirp_global fanning out, the
+manager reaching transfer sources) skip the TCP and TLS setup.  A
+connection is returned to the pool with link_pool_release instead of
+link_close; anything readable on an idle connection (stray data or
+end of stream) disqualifies it from reuse.
+*/
+
+#define LINK_POOL_PER_PEER 4
+
+static struct hash_table *link_pool = 0;
+
+static char *link_pool_key(const char *addr, int port)
+{
+	return string_format("%s:%d", addr, port);
+}
+
+struct link *link_pool_connect(const char *addr, int port, time_t stoptime)
+{
+	if (link_pool) {
+		char *key = link_pool_key(addr, port);
+		struct list *idle = hash_table_lookup(link_pool, key);
+		free(key);
+
+		while (idle) {
+			struct link *link = list_pop_head(idle);
+			if (!link)
+				break;
+			/* an idle connection with pending input is dead or poisoned */
+			if (link_usleep(link, 0, 1, 0)) {
+				link_close(link);
+				continue;
+			}
+			debug(D_TCP, "reusing pooled connection to %s port %d", addr, port);
+			return link;
+		}
+	}
+
+	return link_connect(addr, port, stoptime);
+}
+
+void link_pool_release(struct link *link)
+{
+	if (!link)
+		return;
+
+	if (!link_pool)
+		link_pool = hash_table_create(0, 0);
+
+	char *key = link_pool_key(link->raddr, link->rport);
+	struct list *idle = hash_table_lookup(link_pool, key);
+	if (!idle) {
+		idle = list_create();
+		hash_table_insert(link_pool, key, idle);
+	}
+	free(key);
+
+	if (list_size(idle) >= LINK_POOL_PER_PEER) {
+		link_close(link);
+		return;
+	}
+
+	list_push_tail(idle, link);
+}
+
 ssize_t read_aux(struct link *link, char *data, size_t count)
 {
 #ifdef HAS_OPENSSL
@@ -904,6 +1107,10 @@ ssize_t link_read(struct link *link, char *data, size_t count, time_t stoptime)
 		}
 	}
 
+	/* A throttled receiver paces itself; backpressure slows the sender. */
+	if (total > 0)
+		link_throttle_account(link, total);
+
 	if (total > 0) {
 		return total;
 	} else {
@@ -1000,6 +1207,7 @@ ssize_t link_write(struct link *link, const char *data, size_t count, time_t sto
 {
 	ssize_t total = 0;
 	ssize_t chunk = 0;
+	uint64_t block_start = 0;
 
 	if (!link)
 		return errno = EINVAL, -1;
@@ -1008,6 +1216,10 @@ ssize_t link_write(struct link *link, const char *data, size_t count, time_t sto
 		chunk = write_aux(link, data, count);
 		if (chunk < 0) {
 			if (errno_is_temporary(errno)) {
+				/* The socket pushed back: time the wait, so a slow
+				receiver shows up in this link's statistics. */
+				if (!block_start)
+					block_start = timestamp_get();
 				if (link_sleep(link, stoptime, 0, 1)) {
 					continue;
 				} else {
@@ -1023,9 +1235,20 @@ ssize_t link_write(struct link *link, const char *data, size_t count, time_t sto
 			total += chunk;
 			count -= chunk;
 			data += chunk;
+			link_throttle_account(link, chunk);
 		}
 	}
 
+	if (block_start) {
+		uint64_t blocked = timestamp_get() - block_start;
+		link->blocked_write_usecs += blocked;
+		link->blocked_writes++;
+		int bucket = 0;
+		while (blocked >>= 1)
+			bucket++;
+		link->blocked_write_buckets[bucket < 32 ? bucket : 31]++;
+	}
+
 	if (total > 0) {
 		return total;
 	} else {
@@ -1037,6 +1260,160 @@ ssize_t link_write(struct link *link, const char *data, size_t count, time_t sto
 	}
 }
 
+/*
+Gather-write a set of buffers to a connection with a single system call
+where possible, so protocol code can send a header and payload without
+first copying them into one buffer.  All data is written until finished
+or an error is encountered.  The iov array is modified as segments are
+consumed.  Under SSL there is no gathered write, so each segment is
+written in turn.
+*/
+
+ssize_t link_writev(struct link *link, struct iovec *iov, int iovcnt, time_t stoptime)
+{
+	ssize_t total = 0;
+
+	if (!link)
+		return errno = EINVAL, -1;
+
+#ifdef HAS_OPENSSL
+	if (link->ssl) {
+		int i;
+		for (i = 0; i < iovcnt; i++) {
+			ssize_t w = link_putlstring(link, iov[i].iov_base, iov[i].iov_len, stoptime);
+			if (w < 0)
+				return -1;
+			total += w;
+		}
+		return total;
+	}
+#endif
+
+	while (iovcnt > 0) {
+		ssize_t chunk = writev(link->fd, iov, iovcnt);
+		if (chunk < 0) {
+			if (errno_is_temporary(errno)) {
+				if (link_sleep(link, stoptime, 0, 1)) {
+					continue;
+				} else {
+					break;
+				}
+			} else {
+				break;
+			}
+		} else if (chunk == 0) {
+			break;
+		} else {
+			link->written += chunk;
+			total += chunk;
+
+			/* advance past the segments consumed by this write */
+			while (iovcnt > 0 && (size_t)chunk >= iov->iov_len) {
+				chunk -= iov->iov_len;
+				iov++;
+				iovcnt--;
+			}
+			if (iovcnt > 0 && chunk > 0) {
+				iov->iov_base = (char *)iov->iov_base + chunk;
+				iov->iov_len -= chunk;
+			}
+		}
+	}
+
+	if (iovcnt > 0) {
+		return -1;
+	} else {
+		return total;
+	}
+}
+
+/*
+Scatter-read from a connection into a set of buffers, blocking until
+every buffer is full, the connection closes, or the stoptime expires.
+The iov array is modified as segments are filled.
+*/
+
+ssize_t link_readv(struct link *link, struct iovec *iov, int iovcnt, time_t stoptime)
+{
+	ssize_t total = 0;
+
+	if (!link)
+		return errno = EINVAL, -1;
+
+	/* First, satisfy what we can from the internal read buffer. */
+	while (iovcnt > 0 && link->buffer_length > 0) {
+		size_t chunk = MIN(link->buffer_length, iov->iov_len);
+		memcpy(iov->iov_base, link->buffer_start, chunk);
+		link->buffer_start += chunk;
+		link->buffer_length -= chunk;
+		total += chunk;
+		if (chunk == iov->iov_len) {
+			iov++;
+			iovcnt--;
+		} else {
+			iov->iov_base = (char *)iov->iov_base + chunk;
+			iov->iov_len -= chunk;
+		}
+	}
+
+#ifdef HAS_OPENSSL
+	if (link->ssl) {
+		while (iovcnt > 0) {
+			ssize_t r = link_read(link, iov->iov_base, iov->iov_len, stoptime);
+			if (r <= 0)
+				return total > 0 ? total : r;
+			total += r;
+			if ((size_t)r == iov->iov_len) {
+				iov++;
+				iovcnt--;
+			} else {
+				iov->iov_base = (char *)iov->iov_base + r;
+				iov->iov_len -= r;
+			}
+		}
+		return total;
+	}
+#endif
+
+	while (iovcnt > 0) {
+		ssize_t chunk = readv(link->fd, iov, iovcnt);
+		if (chunk < 0) {
+			if (errno_is_temporary(errno)) {
+				if (link_sleep(link, stoptime, 1, 0)) {
+					continue;
+				} else {
+					break;
+				}
+			} else {
+				break;
+			}
+		} else if (chunk == 0) {
+			break;
+		} else {
+			link->read += chunk;
+			total += chunk;
+
+			while (iovcnt > 0 && (size_t)chunk >= iov->iov_len) {
+				chunk -= iov->iov_len;
+				iov++;
+				iovcnt--;
+			}
+			if (iovcnt > 0 && chunk > 0) {
+				iov->iov_base = (char *)iov->iov_base + chunk;
+				iov->iov_len -= chunk;
+			}
+		}
+	}
+
+	if (total > 0) {
+		return total;
+	} else if (iovcnt > 0) {
+		return -1;
+	} else {
+		return 0;
+	}
+}
+
 ssize_t link_putlstring(struct link *link, const char *data, size_t count, time_t stoptime)
 {
 	ssize_t total = 0;
@@ -1146,6 +1523,37 @@ int link_fd(struct link *link)
 	return link->fd;
 }
 
+/*
+True when the kernel is doing TLS record encryption for this link's
+send direction, in which case sendfile produces correctly encrypted
+records and the zero-copy path stays valid.
+*/
+int link_ktls_send_active(struct link *link)
+{
+#if defined(HAS_OPENSSL) && defined(SSL_OP_ENABLE_KTLS)
+	if (link->ssl) {
+		BIO *bio = SSL_get_wbio(link->ssl);
+		if (bio && BIO_get_ktls_send(bio))
+			return 1;
+	}
+#endif
+	return 0;
+}
+
+/* As above, but for the receive direction: only when the kernel is
+decrypting inbound records may reads bypass the SSL record layer. */
+static int link_ktls_recv_active(struct link *link)
+{
+#if defined(HAS_OPENSSL) && defined(SSL_OP_ENABLE_KTLS)
+	if (link->ssl) {
+		BIO *bio = SSL_get_rbio(link->ssl);
+		if (bio && BIO_get_ktls_recv(bio))
+			return 1;
+	}
+#endif
+	return 0;
+}
+
 int link_using_ssl(struct link *link)
 {
 #ifdef HAS_OPENSSL
@@ -1286,10 +1694,174 @@ int64_t link_stream_to_file(struct link *link, FILE *file, int64_t length, time_
 	return total;
 }
 
+/*
+Transmit a region of an open file to the link.  On Linux, when the link
+is plain TCP, the kernel moves the data directly from the page cache to
+the socket with sendfile, avoiding the double copy through userspace.
+Under SSL, or where sendfile is unavailable or refuses the descriptor,
+the data is pumped through an ordinary pread/write loop instead.  The
+file descriptor's own offset is left unchanged.
+*/
+
+int64_t link_sendfile(struct link *link, int fd, off_t offset, int64_t length, time_t stoptime)
+{
+	int64_t total = 0;
+
+#ifdef __linux__
+	if (!link_using_ssl(link) || link_ktls_send_active(link)) {
+		while (length > 0) {
+			size_t chunk = MIN((int64_t)(1 << 20), length);
+			ssize_t actual = sendfile(link->fd, fd, &offset, chunk);
+			if (actual < 0) {
+				if (errno_is_temporary(errno)) {
+					if (link_sleep(link, stoptime, 0, 1)) {
+						continue;
+					} else {
+						return -1;
+					}
+				} else if (total == 0 && (errno == EINVAL || errno == ENOSYS)) {
+					/* descriptor not eligible: fall back below */
+					break;
+				} else {
+					return -1;
+				}
+			} else if (actual == 0) {
+				return total;
+			} else {
+				link->written += actual;
+				total += actual;
+				length -= actual;
+				link_throttle_account(link, actual);
+			}
+		}
+		if (length == 0)
+			return total;
+	}
+#endif
+
+	while (length > 0) {
+		char buffer[1 << 16];
+		size_t chunk = MIN(sizeof(buffer), (size_t)length);
+
+		ssize_t ractual = pread(fd, buffer, chunk, offset);
+		if (ractual <= 0)
+			break;
+
+		if (link_write(link, buffer, ractual, stoptime) != ractual)
+			return -1;
+
+		offset += ractual;
+		total += ractual;
+		length -= ractual;
+	}
+
+	return total;
+}
+
+/*
+Receive a region of the link directly into an open file.  On Linux,
+when the link is plain TCP and holds no buffered data, the bytes move
+kernel-side through a pipe (socket -> pipe -> file) without touching
+userspace; otherwise an ordinary read/write loop is used.  The file
+descriptor's offset is advanced as written.
+*/
+
+int64_t link_recvfile(struct link *link, int fd, int64_t length, time_t stoptime)
+{
+	int64_t total = 0;
+
+#ifdef __linux__
+	if ((!link_using_ssl(link) || link_ktls_recv_active(link)) && link_buffer_empty(link)) {
+		/* a private pipe per transfer, so forked handlers never share one */
+		int pipefd[2];
+		if (pipe(pipefd) < 0) {
+			pipefd[0] = pipefd[1] = -1;
+		}
+
+		int failed = 0;
+		int hangup = 0;
+		while (pipefd[0] >= 0 && length > 0) {
+			ssize_t in = splice(link->fd, 0, pipefd[1], 0, MIN(length, (int64_t)(1 << 20)), SPLICE_F_MOVE);
+			if (in < 0) {
+				if (errno_is_temporary(errno)) {
+					if (link_sleep(link, stoptime, 1, 0))
+						continue;
+				}
+				failed = 1;
+				break;
+			} else if (in == 0) {
+				/* peer closed before length bytes arrived */
+				hangup = 1;
+				break;
+			}
+
+			link->read += in;
+
+			ssize_t left = in;
+			while (left > 0) {
+				ssize_t out = splice(pipefd[0], 0, fd, 0, left, SPLICE_F_MOVE);
+				if (out <= 0) {
+					failed = 1;
+					break;
+				}
+				left -= out;
+				total += out;
+			}
+			if (failed)
+				break;
+			length -= in;
+		}
+
+		/* every exit path returns the pipe */
+		if (pipefd[0] >= 0) {
+			close(pipefd[0]);
+			close(pipefd[1]);
+		}
+
+		if (length == 0)
+			return total;
+		if (hangup)
+			return total; /* distinguishable short count */
+		if (failed && total > 0)
+			return -1; /* data already moved: the transfer is broken, not resumable below */
+		/* nothing moved (e.g. splice unsupported here): fall through to the read loop */
+	}
+#endif
+
+	while (length > 0) {
+		char buffer[1 << 16];
+		size_t chunk = MIN(sizeof(buffer), (size_t)length);
+
+		ssize_t ractual = link_read(link, buffer, chunk, stoptime);
+		if (ractual <= 0)
+			break;
+
+		if (full_write(fd, buffer, ractual) != ractual)
+			return -1;
+
+		total += ractual;
+		length -= ractual;
+	}
+
+	return total;
+}
+
 int64_t link_stream_from_fd(struct link *link, int fd, int64_t length, time_t stoptime)
 {
 	int64_t total = 0;
 
+	/*
+	A seekable descriptor can go through the zero-copy path; the
+	descriptor offset is advanced to match, as a read loop would.
+	*/
+	off_t pos = lseek(fd, 0, SEEK_CUR);
+	if (pos >= 0) {
+		total = link_sendfile(link, fd, pos, length, stoptime);
+		if (total > 0)
+			lseek(fd, pos + total, SEEK_SET);
+		return total;
+	}
+
 	while (length > 0) {
 		char buffer[1 << 16];
 		size_t chunk = MIN(sizeof(buffer), (size_t)length);
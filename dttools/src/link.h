@@ -42,6 +42,7 @@ link_close(link);
 */
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <limits.h>
 #include <signal.h>
@@ -68,6 +69,31 @@ link_close(link);
 */
 struct link *link_connect(const char *addr, int port, time_t stoptime);
 
+/** Complete a connection begun in the background.
+link_connect called with LINK_NOWAIT returns immediately with the
+connection still in progress; wait for the link to poll writable (so
+many setups can overlap through @ref link_poll) and then call here to
+learn the outcome.
+@param link A link returned by link_connect with LINK_NOWAIT.
+@param stoptime The absolute time at which to abort.
+@return One if the connection is established; zero on failure with errno set.
+*/
+int link_connect_finish(struct link *link, time_t stoptime);
+
+/** Connect to a remote host, reusing a pooled idle connection when one exists.
+@param addr IP address of server in string form.
+@param port Port of server.
+@param stoptime Absolute time at which to abort.
+@return A link object, or null on failure.
+*/
+struct link *link_pool_connect(const char *addr, int port, time_t stoptime);
+
+/** Return a connection to the idle pool for later reuse, instead of closing it.
+The link must be quiescent: no request in flight and no unread data.
+@param link The link to release.
+*/
+void link_pool_release(struct link *link);
+
 /** Wrap a connect link with an ssl context and state
 @param link A link returned from @ref link_connect
 @param sni_hostname Optional domainame for tls routing.
@@ -189,6 +215,30 @@ ssize_t link_write(struct link *link, const char *data, size_t length, time_t st
 */
 ssize_t link_putlstring(struct link *link, const char *str, size_t len, time_t stoptime);
 
+/** Gather-write several buffers to a connection in one system call where possible.
+This allows protocol code to send a header and payload together without
+copying them into a single buffer or paying two system calls (and often
+two TCP segments).  All data is written until finished or an error is
+encountered.  The iov array is modified as segments are consumed.
+@param link The link to write.
+@param iov An array of buffers to write in order.
+@param iovcnt The number of buffers.
+@param stoptime The time at which to abort.
+@return The total number of bytes written, or less than zero on error.
+*/
+ssize_t link_writev(struct link *link, struct iovec *iov, int iovcnt, time_t stoptime);
+
+/** Scatter-read from a connection into several buffers.
+Blocks until every buffer is full, the connection closes, or the
+stoptime expires.  The iov array is modified as segments are filled.
+@param link The link to read.
+@param iov An array of buffers to fill in order.
+@param iovcnt The number of buffers.
+@param stoptime The time at which to abort.
+@return The total number of bytes read, zero on end of stream, or less than zero on error.
+*/
+ssize_t link_readv(struct link *link, struct iovec *iov, int iovcnt, time_t stoptime);
+
 /* Write a C string to a connection. All data is written until finished or an
    error is encountered. It is defined as a macro.
 @param link The link to write.
@@ -273,6 +323,45 @@ the buffer actually allocated for a given link.
 
 void link_window_set(int send_window, int recv_window);
 
+/** Per-link transfer statistics.
+Bytes are counted on every link unconditionally; write-block time is
+measured only when a write actually has to wait, so an unloaded link
+costs nothing extra.  The histogram buckets are powers of two of
+microseconds blocked per blocking write. */
+struct link_stats {
+	uint64_t bytes_read;              /**< Total bytes received on this link. */
+	uint64_t bytes_written;           /**< Total bytes sent on this link. */
+	uint64_t blocked_write_usecs;     /**< Total time writes spent waiting for the socket. */
+	uint64_t blocked_writes;          /**< Number of writes that had to wait at least once. */
+	uint64_t lifetime_usecs;          /**< Age of the link. */
+	double throughput_bps;            /**< Lifetime average bytes per second, both directions. */
+	uint32_t blocked_write_buckets[32]; /**< Log2 histogram of block times in usecs. */
+};
+
+/** Test whether kernel TLS is active on the send side of a link.
+When true, the kernel encrypts outgoing records, so zero-copy sends
+(sendfile) remain valid on this encrypted connection.
+@param link The link to examine.
+@return One if kTLS send offload is active, zero otherwise.
+*/
+int link_ktls_send_active(struct link *link);
+
+/** Limit the write rate of a link.
+A token bucket paces writes to the given budget; tasks sharing the
+disk or network with this link get the remainder.  Pass zero to
+remove the limit.
+@param link The link to pace.
+@param bytes_per_second The write budget, or zero for unlimited.
+*/
+void link_set_throttle(struct link *link, uint64_t bytes_per_second);
+
+/** Fetch transfer statistics for a link.
+@param link The link to examine.
+@param stats The structure to fill in.
+@return One on success, zero if either argument is null.
+*/
+int link_get_stats(struct link *link, struct link_stats *stats);
+
 /** Get the TCP window size actually allocated for this link.
 @param link The link to examine.
 @param send_window A pointer where to store the send window.
@@ -350,6 +439,32 @@ int64_t link_stream_to_fd(struct link *link, int fd, int64_t length, time_t stop
 int64_t link_stream_to_file(struct link *link, FILE * file, int64_t length, time_t stoptime);
 
 int64_t link_stream_from_fd(struct link *link, int fd, int64_t length, time_t stoptime);
+
+/** Send a region of an open file to a connection, avoiding a userspace copy where possible.
+On Linux, when the link is plain TCP, the data moves directly from the
+page cache to the socket via sendfile; otherwise it is pumped through
+an ordinary read/write loop.  The file descriptor's own offset is left
+unchanged.
+@param link The link to write.
+@param fd The descriptor of the file to send.
+@param offset The starting offset within the file.
+@param length The number of bytes to send.
+@param stoptime The time at which to abort.
+@return The number of bytes sent, or less than zero on error.
+*/
+int64_t link_sendfile(struct link *link, int fd, off_t offset, int64_t length, time_t stoptime);
+
+/** Receive a region of a connection directly into an open file, avoiding a userspace copy where possible.
+On Linux, plain TCP data moves kernel-side through a pipe into the
+file; otherwise an ordinary read/write loop applies.  The file
+descriptor's offset is advanced as written.
+@param link The link to read.
+@param fd The descriptor of the file to fill.
+@param length The number of bytes to receive.
+@param stoptime The time at which to abort.
+@return The number of bytes received, or less than zero on error.
+*/
+int64_t link_recvfile(struct link *link, int fd, int64_t length, time_t stoptime);
 int64_t link_stream_from_file(struct link *link, FILE * file, int64_t length, time_t stoptime);
 
 int64_t link_soak(struct link *link, int64_t length, time_t stoptime);
@@ -0,0 +1,238 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#include "link_event.h"
+#include "itable.h"
+#include "xxmalloc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+/*
+Membership is tracked in an itable keyed by descriptor, both so that
+removal can be checked and so that links holding buffered data (which
+the kernel cannot see) are still reported ready.  On Linux the kernel
+side is an epoll instance; elsewhere each wait falls back to one poll
+over the members, which is no worse than link_poll was.
+*/
+
+struct link_event_set {
+	struct itable *members; /* fd -> struct link */
+	int wakeup_read;        /* readable when another thread has called wakeup */
+	int wakeup_write;
+#ifdef __linux__
+	int epfd;
+#endif
+};
+
+struct link_event_set *link_event_create(void)
+{
+	struct link_event_set *s = xxmalloc(sizeof(*s));
+	s->members = itable_create(0);
+
+	/*
+	The wakeup pipe lets another thread (a submitter, a signal
+	handler context) interrupt a wait in progress; the read side is
+	watched like any member and drained when it fires.
+	*/
+	int p[2];
+	if (pipe(p) == 0) {
+		s->wakeup_read = p[0];
+		s->wakeup_write = p[1];
+		fcntl(s->wakeup_read, F_SETFL, O_NONBLOCK);
+		fcntl(s->wakeup_write, F_SETFL, O_NONBLOCK);
+	} else {
+		s->wakeup_read = -1;
+		s->wakeup_write = -1;
+	}
+
+#ifdef __linux__
+	s->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (s->epfd < 0) {
+		itable_delete(s->members);
+		free(s);
+		return 0;
+	}
+	if (s->wakeup_read >= 0) {
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.ptr = 0; /* null marks the wakeup channel */
+		epoll_ctl(s->epfd, EPOLL_CTL_ADD, s->wakeup_read, &ev);
+	}
+#endif
+
+	return s;
+}
+
+int link_event_wakeup(struct link_event_set *s)
+{
+	if (s->wakeup_write < 0)
+		return 0;
+	char c = 'w';
+	return write(s->wakeup_write, &c, 1) == 1;
+}
+
+void link_event_delete(struct link_event_set *s)
+{
+	if (!s)
+		return;
+#ifdef __linux__
+	close(s->epfd);
+#endif
+	if (s->wakeup_read >= 0) {
+		close(s->wakeup_read);
+		close(s->wakeup_write);
+	}
+	itable_delete(s->members);
+	free(s);
+}
+
+int link_event_add(struct link_event_set *s, struct link *link)
+{
+	int fd = link_fd(link);
+
+#ifdef __linux__
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = link;
+	if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		return 0;
+#endif
+
+	itable_insert(s->members, fd, link);
+	return 1;
+}
+
+int link_event_del(struct link_event_set *s, struct link *link)
+{
+	int fd = link_fd(link);
+
+	if (!itable_remove(s->members, fd))
+		return 0;
+
+#ifdef __linux__
+	epoll_ctl(s->epfd, EPOLL_CTL_DEL, fd, 0);
+#endif
+
+	return 1;
+}
+
+int link_event_wait(struct link_event_set *s, int msec, struct link **ready, int max)
+{
+	int n = 0;
+	UINT64_T fd;
+	struct link *link;
+
+	/*
+	Data already sitting in a link's userspace buffer is invisible to
+	the kernel, so collect those members first and do not sleep if
+	any were found.  This is a scan of one integer per member, far
+	cheaper than rebuilding and copying a pollfd table.
+	*/
+	ITABLE_ITERATE(s->members, fd, link)
+	{
+		if (n >= max)
+			break;
+		if (!link_buffer_empty(link)) {
+			ready[n++] = link;
+		}
+	}
+	if (n > 0)
+		msec = 0;
+
+#ifdef __linux__
+	struct epoll_event evs[256];
+	int want = max - n;
+	if (want > (int)(sizeof(evs) / sizeof(evs[0])))
+		want = sizeof(evs) / sizeof(evs[0]);
+	if (want <= 0)
+		return n;
+
+	int result = epoll_wait(s->epfd, evs, want, msec);
+	if (result < 0)
+		return n > 0 ? n : (errno == EINTR ? 0 : -1);
+
+	int i, j;
+	for (i = 0; i < result; i++) {
+		struct link *l = evs[i].data.ptr;
+		if (!l) {
+			/* the wakeup channel fired: drain it and return */
+			char buf[64];
+			while (read(s->wakeup_read, buf, sizeof(buf)) > 0) {
+			}
+			continue;
+		}
+		/* skip links already reported through the buffered scan */
+		for (j = 0; j < n; j++) {
+			if (ready[j] == l)
+				break;
+		}
+		if (j == n)
+			ready[n++] = l;
+	}
+	return n;
+#else
+	/* The fallback polls raw descriptors so the wakeup pipe can share
+	the same wait as the member links. */
+	int count = itable_size(s->members);
+	struct pollfd *pfds = xxmalloc((count + 1) * sizeof(*pfds));
+	struct link **plinks = xxmalloc((count + 1) * sizeof(*plinks));
+	int m = 0;
+
+	ITABLE_ITERATE(s->members, fd, link)
+	{
+		pfds[m].fd = link_fd(link);
+		pfds[m].events = POLLIN;
+		pfds[m].revents = 0;
+		plinks[m] = link;
+		m++;
+	}
+
+	int wakeup_slot = -1;
+	if (s->wakeup_read >= 0) {
+		wakeup_slot = m;
+		pfds[m].fd = s->wakeup_read;
+		pfds[m].events = POLLIN;
+		pfds[m].revents = 0;
+		plinks[m] = 0;
+		m++;
+	}
+
+	int result = poll(pfds, m, msec);
+	if (result > 0) {
+		int i;
+		if (wakeup_slot >= 0 && pfds[wakeup_slot].revents) {
+			char buf[64];
+			while (read(s->wakeup_read, buf, sizeof(buf)) > 0) {
+			}
+		}
+		for (i = 0; i < m && n < max; i++) {
+			if (pfds[i].revents && plinks[i]) {
+				int j, seen = 0;
+				for (j = 0; j < n; j++) {
+					if (ready[j] == plinks[i])
+						seen = 1;
+				}
+				if (!seen)
+					ready[n++] = plinks[i];
+			}
+		}
+	}
+
+	free(pfds);
+	free(plinks);
+	return n;
+#endif
+}
+
+/* vim: set noexpandtab tabstop=8: */
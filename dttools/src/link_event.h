@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#ifndef LINK_EVENT_H
+#define LINK_EVENT_H
+
+/** @file link_event.h A persistent readiness set for many links.
+Unlike @ref link_poll, which is handed a freshly built array on every
+call and costs time proportional to the number of connections, an
+event set registers each link once (epoll on Linux) and each wait
+returns only the links that are ready, so a manager with tens of
+thousands of connected workers wakes in time proportional to the
+events, not the connections.  Links with data already buffered in
+userspace are reported ready as well.
+*/
+
+#include "link.h"
+
+struct link_event_set;
+
+/** Create an event set. @return An event set, or null on failure. */
+struct link_event_set *link_event_create(void);
+
+/** Delete an event set.  The member links themselves are not closed. */
+void link_event_delete(struct link_event_set *s);
+
+/** Add a link to the set, watching for readability.
+@param s The event set.
+@param link The link to watch.
+@return One on success, zero on failure.
+*/
+int link_event_add(struct link_event_set *s, struct link *link);
+
+/** Remove a link from the set.  Must be called before the link is closed.
+@param s The event set.
+@param link The link to stop watching.
+@return One on success, zero if the link was not a member.
+*/
+int link_event_del(struct link_event_set *s, struct link *link);
+
+/** Wait for members of the set to become readable.
+@param s The event set.
+@param msec The maximum number of milliseconds to wait.
+@param ready An array to be filled with the ready links.
+@param max The capacity of the array.
+@return The number of ready links, zero on timeout, or less than zero on error.
+*/
+int link_event_wait(struct link_event_set *s, int msec, struct link **ready, int max);
+
+/** Interrupt a wait in progress on this set from another thread.
+The wait returns promptly (possibly with zero ready links).
+@param s The event set.
+@return One on success, zero if the wakeup channel is unavailable.
+*/
+int link_event_wakeup(struct link_event_set *s);
+
+#endif
@@ -1,4 +1,6 @@
 #include "debug.h"
+#include "sha1.h"
+#include "stringtools.h"
 
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -70,4 +72,84 @@ int memfdexe(const char *name, const char *extradir)
 	return fd;
 }
 
+/*
+A content-hash-keyed cache of prepared executables.  Tools that embed
+a helper payload (the resource monitor's preload library, factory
+bootstraps) rewrite identical bytes on every launch; here the payload
+is materialized once under its hash in a per-user cache directory and
+later launches reuse the file.  The fd comes back open and, when the
+cache is usable, path_out names the stable on-disk copy for callers
+that need a path (LD_PRELOAD); when the cache cannot be used safely
+the payload lands in a plain memfd and path_out is null, so the
+caller falls back to its own materialization.
+*/
+int memfdexe_cached(const char *name, const void *data, size_t length, char **path_out)
+{
+	*path_out = NULL;
+
+	char *dir = NULL;
+	const char *override = getenv("CCTOOLS_EXE_CACHE");
+	if (override) {
+		dir = strdup(override);
+	} else {
+		dir = string_format("/tmp/.cctools-exe-cache-%d", getuid());
+	}
+
+	/* Refuse a cache directory that anyone else could tamper with. */
+	struct stat info;
+	if (mkdir(dir, 0700) != 0 && errno != EEXIST)
+		goto fallback;
+	if (lstat(dir, &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != getuid() || (info.st_mode & 077))
+		goto fallback;
+
+	{
+		unsigned char digest[SHA1_DIGEST_LENGTH];
+		sha1_buffer(data, length, digest);
+
+		char *path = string_format("%s/%s-%.12s", dir, name, sha1_string(digest));
+
+		if (stat(path, &info) == 0 && (size_t)info.st_size == length) {
+			int fd = open(path, O_RDONLY);
+			if (fd >= 0) {
+				debug(D_DEBUG, "reusing cached executable '%s'", path);
+				free(dir);
+				*path_out = path;
+				return fd;
+			}
+		}
+
+		char *temp = string_format("%s.XXXXXX", path);
+		int fd = mkstemp(temp);
+		if (fd < 0) {
+			free(temp);
+			free(path);
+			goto fallback;
+		}
+		if (write(fd, data, length) != (ssize_t)length || fchmod(fd, 0500) != 0 || rename(temp, path) != 0) {
+			close(fd);
+			unlink(temp);
+			free(temp);
+			free(path);
+			goto fallback;
+		}
+		free(temp);
+		free(dir);
+		*path_out = path;
+		return fd;
+	}
+
+fallback:
+	free(dir);
+	{
+		int fd = memfdexe(name, NULL);
+		if (fd < 0)
+			return fd;
+		if (write(fd, data, length) != (ssize_t)length) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+}
+
 /* vim: set noexpandtab tabstop=8: */
@@ -9,4 +9,11 @@ See the file COPYING for details.
 
 int memfdexe (const char *name, const char *extradir);
 
+/** Materialize an executable payload through a per-user content-hash
+cache, so repeated launches of the same embedded helper reuse one
+on-disk copy.  On success the open fd is returned and *path_out names
+the cached file (caller frees); if the cache is unusable the payload
+is placed in a plain memfd and *path_out is null. */
+int memfdexe_cached (const char *name, const void *data, size_t length, char **path_out);
+
 #endif /* MEMFDEXE_H */
@@ -8,9 +8,12 @@ See the file COPYING for details.
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "debug.h"
 #include "list.h"
@@ -177,6 +180,185 @@ timeout:
 	return result;
 }
 
+/*
+The threaded scan divides the directory tree among a small pool of
+workers sharing a stack of unvisited directories.  Each worker stats
+the entries of its directory relative to the open directory descriptor
+(fstatat), so the kernel does not re-walk the leading path components,
+and pushes subdirectories back on the shared stack for whoever is free
+next.  Termination is by idle counting: when every worker is waiting
+and the stack is empty, the scan is complete.
+*/
+
+struct disk_scan {
+	struct list *dirs; /* stack of char * directory paths */
+	pthread_mutex_t lock;
+	pthread_cond_t avail;
+	int idle;
+	int nthreads;
+	int done;
+	int result;
+	int64_t size;
+	int64_t count;
+	struct hash_table *exclude_paths;
+};
+
+static void disk_scan_one(struct disk_scan *s, const char *dirname)
+{
+	int64_t size = 0;
+	int64_t count = 0;
+	int result = 0;
+
+	DIR *dir = opendir(dirname);
+	if (!dir) {
+		if (errno != ENOENT)
+			result = -1;
+		goto done;
+	}
+
+	int dfd = dirfd(dir);
+	struct dirent *entry;
+	struct stat file_info;
+
+	while ((entry = readdir(dir))) {
+		if (strcmp(".", entry->d_name) == 0 || strcmp("..", entry->d_name) == 0)
+			continue;
+
+		char composed_path[PATH_MAX];
+		snprintf(composed_path, PATH_MAX, "%s/%s", dirname, entry->d_name);
+
+		if (s->exclude_paths) {
+			pthread_mutex_lock(&s->lock);
+			int excluded = hash_table_lookup(s->exclude_paths, composed_path) != 0;
+			pthread_mutex_unlock(&s->lock);
+			if (excluded)
+				continue;
+		}
+
+		if (fstatat(dfd, entry->d_name, &file_info, AT_SYMLINK_NOFOLLOW) < 0) {
+			if (errno != ENOENT)
+				result = -1;
+			continue;
+		}
+
+		count++;
+		if (S_ISREG(file_info.st_mode)) {
+			size += file_info.st_size;
+		} else if (S_ISDIR(file_info.st_mode)) {
+			pthread_mutex_lock(&s->lock);
+			list_push_head(s->dirs, xxstrdup(composed_path));
+			pthread_cond_signal(&s->avail);
+			pthread_mutex_unlock(&s->lock);
+		}
+	}
+
+	closedir(dir);
+
+done:
+	pthread_mutex_lock(&s->lock);
+	s->size += size;
+	s->count += count;
+	if (result < 0)
+		s->result = -1;
+	pthread_mutex_unlock(&s->lock);
+}
+
+static void *disk_scan_worker(void *arg)
+{
+	struct disk_scan *s = arg;
+
+	pthread_mutex_lock(&s->lock);
+	while (1) {
+		char *dirname = list_pop_head(s->dirs);
+		if (!dirname) {
+			if (s->done)
+				break;
+			s->idle++;
+			if (s->idle == s->nthreads) {
+				/* everyone is waiting on an empty stack: we are finished */
+				s->done = 1;
+				pthread_cond_broadcast(&s->avail);
+				s->idle--;
+				break;
+			}
+			pthread_cond_wait(&s->avail, &s->lock);
+			s->idle--;
+			continue;
+		}
+		pthread_mutex_unlock(&s->lock);
+
+		disk_scan_one(s, dirname);
+		free(dirname);
+
+		pthread_mutex_lock(&s->lock);
+	}
+	pthread_mutex_unlock(&s->lock);
+	return 0;
+}
+
+int path_disk_size_info_get_threaded(const char *path, int64_t *measured_size, int64_t *number_of_files, struct hash_table *exclude_paths, int nthreads)
+{
+	struct stat info;
+	if (stat(path, &info) < 0)
+		return -1;
+
+	if (!S_ISDIR(info.st_mode)) {
+		*measured_size = info.st_size;
+		*number_of_files = 1;
+		return 0;
+	}
+
+	if (nthreads < 1)
+		nthreads = 4;
+
+	struct disk_scan s;
+	s.dirs = list_create();
+	pthread_mutex_init(&s.lock, 0);
+	pthread_cond_init(&s.avail, 0);
+	s.idle = 0;
+	s.nthreads = nthreads;
+	s.done = 0;
+	s.result = 0;
+	s.size = 0;
+	s.count = 1; /* count the root directory */
+	s.exclude_paths = exclude_paths;
+
+	list_push_head(s.dirs, xxstrdup(path));
+
+	pthread_t *threads = xxmalloc(nthreads * sizeof(pthread_t));
+	int started = 0;
+	int i;
+	for (i = 0; i < nthreads; i++) {
+		if (pthread_create(&threads[i], 0, disk_scan_worker, &s) == 0)
+			started++;
+		else
+			s.nthreads--;
+	}
+
+	if (started == 0) {
+		/* could not start any workers: do the whole scan inline */
+		free(threads);
+		list_delete(s.dirs);
+		pthread_mutex_destroy(&s.lock);
+		pthread_cond_destroy(&s.avail);
+		return path_disk_size_info_get(path, measured_size, number_of_files, exclude_paths);
+	}
+
+	for (i = 0; i < started; i++) {
+		pthread_join(threads[i], 0);
+	}
+
+	free(threads);
+	list_delete(s.dirs);
+	pthread_mutex_destroy(&s.lock);
+	pthread_cond_destroy(&s.avail);
+
+	*measured_size = s.size;
+	*number_of_files = s.count;
+
+	return s.result;
+}
+
 void path_disk_size_info_delete_state(struct path_disk_size_info *state)
 {
 	if (!state)
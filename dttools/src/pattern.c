@@ -1,4 +1,5 @@
 #include "debug.h"
+#include "hash_table.h"
 
 #include <ctype.h>
 #include <stdarg.h>
@@ -29,21 +30,76 @@ static int luaL_error(void *ms, const char *fmt, ...)
 
 #include "luapatt.c"
 
-ptrdiff_t pattern_vmatch(const char *str, const char *patt, va_list va)
+/*
+A compiled pattern records what can be determined once per pattern
+rather than once per candidate string: the anchor, the pattern length,
+and, when the pattern opens with a plain character, that literal, so
+the unanchored scan can jump between occurrences with memchr instead
+of attempting a match at every offset.  Makeflow wildcard rules and
+chirp_search apply the same few patterns to very large file lists, so
+this is where the time goes.
+*/
+
+struct pattern {
+	char *patt;      /* pattern body, past any anchor */
+	size_t patt_len;
+	int anchor;
+	int first_literal; /* leading literal byte, or -1 */
+};
+
+struct pattern *pattern_compile(const char *patt)
 {
-	MatchState ms;
-	int anchor = (*patt == '^');
-	if (anchor) {
-		patt++; /* skip anchor character */
+	struct pattern *p = malloc(sizeof(*p));
+	if (!p)
+		return NULL;
+
+	p->anchor = (*patt == '^');
+	if (p->anchor)
+		patt++;
+
+	p->patt = strdup(patt);
+	if (!p->patt) {
+		free(p);
+		return NULL;
 	}
+	p->patt_len = strlen(p->patt);
+
+	/* a leading plain character lets the scan skip with memchr */
+	if (!p->anchor && p->patt[0] && !strchr("^$*+?.([%-", p->patt[0]) && p->patt[1] != '*' && p->patt[1] != '-' && p->patt[1] != '?') {
+		p->first_literal = uchar(p->patt[0]);
+	} else {
+		p->first_literal = -1;
+	}
+
+	return p;
+}
+
+void pattern_delete(struct pattern *p)
+{
+	if (!p)
+		return;
+	free(p->patt);
+	free(p);
+}
+
+ptrdiff_t pattern_compiled_vmatch(struct pattern *p, const char *str, va_list va)
+{
+	MatchState ms;
 	ms.matchdepth = MAXCCALLS;
 	ms.src_init = str;
 	ms.src_end = str + strlen(str);
-	ms.p_end = patt + strlen(patt);
+	ms.p_end = p->patt + p->patt_len;
 	do {
 		const char *rest;
+
+		if (p->first_literal >= 0) {
+			str = memchr(str, p->first_literal, ms.src_end - str);
+			if (!str)
+				return -1;
+		}
+
 		ms.level = 0;
-		if ((rest = match(&ms, str, patt))) {
+		if ((rest = match(&ms, str, p->patt))) {
 			int i;
 			for (i = 0; i < ms.level; i++) {
 				ptrdiff_t l = ms.capture[i].len;
@@ -63,10 +119,66 @@ ptrdiff_t pattern_vmatch(const char *str, const char *patt, va_list va)
 			}
 			return str - ms.src_init;
 		}
-	} while (str++ < ms.src_end && !anchor);
+	} while (str++ < ms.src_end && !p->anchor);
 	return -1;
 }
 
+ptrdiff_t pattern_compiled_match(struct pattern *p, const char *str, ...)
+{
+	ptrdiff_t rc;
+	va_list va;
+	va_start(va, str);
+	rc = pattern_compiled_vmatch(p, str, va);
+	va_end(va);
+	return rc;
+}
+
+/*
+The legacy entry points compile on first use and keep a small cache
+keyed by the pattern text, since a workflow applies the same handful
+of patterns millions of times.  When the cache fills it is simply
+emptied; with so few live patterns an eviction policy would be
+ceremony.
+*/
+
+#define PATTERN_CACHE_MAX 64
+
+static struct hash_table *pattern_cache = 0;
+
+static void pattern_delete_void(void *p)
+{
+	pattern_delete(p);
+}
+
+static struct pattern *pattern_cache_get(const char *patt)
+{
+	if (!pattern_cache)
+		pattern_cache = hash_table_create(0, 0);
+
+	struct pattern *p = hash_table_lookup(pattern_cache, patt);
+	if (p)
+		return p;
+
+	p = pattern_compile(patt);
+	if (!p)
+		return NULL;
+
+	if (hash_table_size(pattern_cache) >= PATTERN_CACHE_MAX) {
+		hash_table_clear(pattern_cache, pattern_delete_void);
+	}
+	hash_table_insert(pattern_cache, patt, p);
+
+	return p;
+}
+
+ptrdiff_t pattern_vmatch(const char *str, const char *patt, va_list va)
+{
+	struct pattern *p = pattern_cache_get(patt);
+	if (!p)
+		return -1;
+	return pattern_compiled_vmatch(p, str, va);
+}
+
 ptrdiff_t pattern_match(const char *str, const char *patt, ...)
 {
 	ptrdiff_t rc;
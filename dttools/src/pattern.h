@@ -25,4 +25,15 @@
 ptrdiff_t pattern_vmatch (const char *str, const char *patt, va_list va);
 ptrdiff_t pattern_match (const char *str, const char *patt, ...);
 
+/** A pattern prepared once and reusable across many match calls.
+The legacy entry points above compile and cache internally; code
+matching one pattern against a large file list can compile explicitly
+and skip even the cache lookup per candidate. */
+struct pattern;
+
+struct pattern *pattern_compile (const char *patt);
+void pattern_delete (struct pattern *p);
+ptrdiff_t pattern_compiled_vmatch (struct pattern *p, const char *str, va_list va);
+ptrdiff_t pattern_compiled_match (struct pattern *p, const char *str, ...);
+
 #endif /* PATTERN_H */
@@ -0,0 +1,177 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#include "priority_queue.h"
+#include "xxmalloc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define DEFAULT_CAPACITY 128
+
+struct pq_entry {
+	void *item;
+	double priority;
+	uint64_t seq; /* breaks ties first-in first-out */
+};
+
+struct priority_queue {
+	struct pq_entry *entries;
+	int size;
+	int capacity;
+	uint64_t next_seq;
+};
+
+/* True if entry a should be served before entry b. */
+
+static int entry_before(struct pq_entry *a, struct pq_entry *b)
+{
+	if (a->priority != b->priority)
+		return a->priority > b->priority;
+	return a->seq < b->seq;
+}
+
+struct priority_queue *priority_queue_create(int capacity)
+{
+	struct priority_queue *pq = malloc(sizeof(*pq));
+	if (!pq)
+		return 0;
+
+	if (capacity < 1)
+		capacity = DEFAULT_CAPACITY;
+
+	pq->entries = malloc(capacity * sizeof(*pq->entries));
+	if (!pq->entries) {
+		free(pq);
+		return 0;
+	}
+
+	pq->size = 0;
+	pq->capacity = capacity;
+	pq->next_seq = 0;
+
+	return pq;
+}
+
+void priority_queue_delete(struct priority_queue *pq)
+{
+	if (!pq)
+		return;
+	free(pq->entries);
+	free(pq);
+}
+
+int priority_queue_size(struct priority_queue *pq)
+{
+	return pq->size;
+}
+
+static void sift_up(struct priority_queue *pq, int i)
+{
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (!entry_before(&pq->entries[i], &pq->entries[parent]))
+			break;
+		struct pq_entry tmp = pq->entries[i];
+		pq->entries[i] = pq->entries[parent];
+		pq->entries[parent] = tmp;
+		i = parent;
+	}
+}
+
+static void sift_down(struct priority_queue *pq, int i)
+{
+	while (1) {
+		int left = 2 * i + 1;
+		int right = 2 * i + 2;
+		int first = i;
+
+		if (left < pq->size && entry_before(&pq->entries[left], &pq->entries[first]))
+			first = left;
+		if (right < pq->size && entry_before(&pq->entries[right], &pq->entries[first]))
+			first = right;
+		if (first == i)
+			break;
+
+		struct pq_entry tmp = pq->entries[i];
+		pq->entries[i] = pq->entries[first];
+		pq->entries[first] = tmp;
+		i = first;
+	}
+}
+
+int priority_queue_push(struct priority_queue *pq, void *item, double priority)
+{
+	if (pq->size >= pq->capacity) {
+		int new_capacity = pq->capacity * 2;
+		struct pq_entry *new_entries = realloc(pq->entries, new_capacity * sizeof(*new_entries));
+		if (!new_entries)
+			return 0;
+		pq->entries = new_entries;
+		pq->capacity = new_capacity;
+	}
+
+	struct pq_entry *e = &pq->entries[pq->size];
+	e->item = item;
+	e->priority = priority;
+	e->seq = pq->next_seq++;
+
+	pq->size++;
+	sift_up(pq, pq->size - 1);
+
+	return 1;
+}
+
+void *priority_queue_pop(struct priority_queue *pq)
+{
+	if (pq->size < 1)
+		return 0;
+
+	void *item = pq->entries[0].item;
+
+	pq->size--;
+	if (pq->size > 0) {
+		pq->entries[0] = pq->entries[pq->size];
+		sift_down(pq, 0);
+	}
+
+	return item;
+}
+
+void *priority_queue_peek(struct priority_queue *pq)
+{
+	if (pq->size < 1)
+		return 0;
+	return pq->entries[0].item;
+}
+
+int priority_queue_remove(struct priority_queue *pq, void *item)
+{
+	int i;
+
+	for (i = 0; i < pq->size; i++) {
+		if (pq->entries[i].item == item) {
+			pq->size--;
+			if (i < pq->size) {
+				pq->entries[i] = pq->entries[pq->size];
+				sift_down(pq, i);
+				sift_up(pq, i);
+			}
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void *priority_queue_element(struct priority_queue *pq, int i)
+{
+	if (i < 0 || i >= pq->size)
+		return 0;
+	return pq->entries[i].item;
+}
+
+/* vim: set noexpandtab tabstop=8: */
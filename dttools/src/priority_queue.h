@@ -0,0 +1,67 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+/** @file priority_queue.h A binary-heap priority queue.
+Items are returned highest priority first; items of equal priority are
+returned in the order they were pushed, so a queue used with a single
+priority behaves as a FIFO.  Push and pop are O(log n), which matters
+when hundreds of thousands of entries would otherwise be kept in a
+sorted list with O(n) insertion.
+*/
+
+struct priority_queue;
+
+/** Create a priority queue.
+@param capacity The initial capacity, or zero for a default.
+@return A priority queue, or null on failure.
+*/
+struct priority_queue *priority_queue_create(int capacity);
+
+/** Delete a priority queue.  The items themselves are not deleted. */
+void priority_queue_delete(struct priority_queue *pq);
+
+/** Count the items in the queue. */
+int priority_queue_size(struct priority_queue *pq);
+
+/** Add an item with the given priority.
+@param pq The queue.
+@param item The item to add.
+@param priority The item's priority; larger is served first.
+@return One on success, zero on allocation failure.
+*/
+int priority_queue_push(struct priority_queue *pq, void *item, double priority);
+
+/** Remove and return the highest-priority item, or null if empty.
+Items of equal priority come back in push order. */
+void *priority_queue_pop(struct priority_queue *pq);
+
+/** Return the highest-priority item without removing it, or null if empty. */
+void *priority_queue_peek(struct priority_queue *pq);
+
+/** Remove a specific item, wherever it sits in the queue.
+@param pq The queue.
+@param item The item to remove.
+@return One if the item was found and removed, zero otherwise.
+*/
+int priority_queue_remove(struct priority_queue *pq, void *item);
+
+/** Access the item at internal position i, in no particular order.
+Returns null when i is out of range.  Use for whole-queue traversals
+where order does not matter:
+<pre>
+int i;
+void *item;
+PRIORITY_QUEUE_ITERATE(pq, i, item) { ... }
+</pre>
+*/
+void *priority_queue_element(struct priority_queue *pq, int i);
+
+#define PRIORITY_QUEUE_ITERATE(pq, i, item) for (i = 0; (item = priority_queue_element(pq, i)); i++)
+
+#endif
@@ -9,15 +9,58 @@ See the file COPYING for details.
 
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <errno.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/signalfd.h>
+#endif
+
 static struct list *complete_list = 0;
 
+static int event_fd = -1;
+
+/*
+On Linux, child exits are delivered through a signalfd, which can sit
+in an event loop's poll set so that a completed subprocess wakes the
+loop immediately, instead of being discovered on the next whole-second
+alarm.  Creating the descriptor blocks SIGCHLD for the process, which
+is what signalfd requires.
+*/
+
+int process_event_fd(void)
+{
+#ifdef __linux__
+	if (event_fd < 0) {
+		sigset_t mask;
+		sigemptyset(&mask);
+		sigaddset(&mask, SIGCHLD);
+		if (sigprocmask(SIG_BLOCK, &mask, 0) == 0) {
+			event_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+		}
+	}
+#endif
+	return event_fd;
+}
+
+void process_event_clear(void)
+{
+#ifdef __linux__
+	if (event_fd >= 0) {
+		struct signalfd_siginfo info;
+		while (read(event_fd, &info, sizeof(info)) > 0) {
+		}
+	}
+#endif
+}
+
 static void alarm_handler(int sig)
 {
 	// do nothing except interrupt the wait
@@ -28,6 +71,33 @@ static int process_work(int timeout)
 	int flags = 0;
 	struct sigaction new_action, old_action;
 
+	/*
+	With the event descriptor available, wait without alarms: reap
+	whatever has exited, and otherwise sleep on the descriptor until
+	a child exit (or the timeout) wakes us.
+	*/
+	if (event_fd >= 0) {
+		time_t stoptime = time(0) + timeout;
+		while (1) {
+			struct process_info p;
+			p.pid = wait4(-1, &p.status, WNOHANG, &p.rusage);
+			if (p.pid > 0) {
+				struct process_info *i = malloc(sizeof(*i));
+				*i = p;
+				list_push_tail(complete_list, i);
+				return 1;
+			}
+
+			int msec = (stoptime - time(0)) * 1000;
+			if (timeout == 0 || msec <= 0)
+				return 0;
+
+			struct pollfd pfd = {.fd = event_fd, .events = POLLIN, .revents = 0};
+			poll(&pfd, 1, msec);
+			process_event_clear();
+		}
+	}
+
 	if (timeout == 0) {
 		flags = WNOHANG;
 	} else {
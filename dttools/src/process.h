@@ -60,6 +60,18 @@ If so, its status may be obtained without delay by calling @ref process_wait .
 
 int process_pending();
 
+/** Obtain a descriptor that becomes readable when a child process exits.
+Place it in an event loop's poll set so a completed subprocess wakes
+the loop immediately; then call @ref process_pending as usual and
+@ref process_event_clear to rearm.  Blocks SIGCHLD for the process,
+as the underlying mechanism requires.
+@return A pollable file descriptor, or -1 where unsupported.
+*/
+int process_event_fd(void);
+
+/** Consume any pending child-exit notifications on the event descriptor. */
+void process_event_clear(void);
+
 /** Attempt to cleanly terminate process pid for timeout seconds by sending SIGTERM
 If the process has not returned by then, send SIGKILL to the process and attempt to wait for another timeout seconds
 if this is still not successfuly, stop trying and return. Return value of 1 is clean exit, while a return value of 0 an error or messy exit
@@ -9,6 +9,9 @@ See the file COPYING for details.
 #include <limits.h>
 #include <math.h>
 #include <stdio.h>
+#if !defined(CCTOOLS_OPSYS_DARWIN) && !defined(CCTOOLS_OPSYS_FREEBSD)
+#include <stdio_ext.h>
+#endif
 #include <string.h>
 #include <strings.h>
 #include <sys/time.h>
@@ -31,6 +34,12 @@ See the file COPYING for details.
 
 #define ANON_MAPS_NAME "[anon]"
 
+static FILE *open_proc_file_cached(pid_t pid, char *filename, FILE **slot);
+static int rmonitor_get_cpu_time_usage_file(FILE *fstat, struct rmonitor_cpu_time_info *cpu);
+static int rmonitor_get_ctxsw_usage_file(FILE *fstatus, struct rmonitor_ctxsw_info *switches);
+static int rmonitor_get_mem_usage_file(FILE *fmem, struct rmonitor_mem_info *mem);
+static int rmonitor_get_sys_io_usage_file(FILE *fio, struct rmonitor_io_info *io);
+
 uint64_t usecs_since_epoch()
 {
 	uint64_t usecs;
@@ -131,10 +140,19 @@ int rmonitor_poll_process_once(struct rmonitor_process_info *p)
 
 	debug(D_RMON, "monitoring process: %d\n", p->pid);
 
-	status |= rmonitor_get_cpu_time_usage(p->pid, &p->cpu);
-	status |= rmonitor_get_ctxsw_usage(p->pid, &p->ctx);
-	status |= rmonitor_get_mem_usage(p->pid, &p->mem);
-	status |= rmonitor_get_sys_io_usage(p->pid, &p->io);
+	/* One pass over cached handles: stat, then status (serving both
+	context switches and memory), then io, with no opens after the
+	first sample of the process. */
+
+	status |= rmonitor_get_cpu_time_usage_file(open_proc_file_cached(p->pid, "stat", &p->proc_stat), &p->cpu);
+
+	FILE *fstatus = open_proc_file_cached(p->pid, "status", &p->proc_status);
+	status |= rmonitor_get_ctxsw_usage_file(fstatus, &p->ctx);
+	if (fstatus)
+		rewind(fstatus);
+	status |= rmonitor_get_mem_usage_file(fstatus, &p->mem);
+
+	status |= rmonitor_get_sys_io_usage_file(open_proc_file_cached(p->pid, "io", &p->proc_io), &p->io);
 
 	return status;
 }
@@ -188,6 +206,53 @@ FILE *open_proc_file(pid_t pid, char *filename)
 	return fproc;
 }
 
+/*
+Return a cached /proc handle, opening it on first use and rewinding it
+on every later one.  procfs regenerates the contents at each read from
+offset zero, so a long-lived handle serves every sample of a process's
+lifetime for the cost of one open.  A handle that goes stale (the
+process exited) reports its error through the read path, at which
+point the caller drops the process and closes the handles.
+*/
+static FILE *open_proc_file_cached(pid_t pid, char *filename, FILE **slot)
+{
+#if defined(CCTOOLS_OPSYS_DARWIN) || defined(CCTOOLS_OPSYS_FREEBSD)
+	return NULL;
+#else
+	if (*slot) {
+		/*
+		rewind alone is not enough: stdio satisfies in-buffer seeks
+		without touching the descriptor, which would replay the
+		first sample's bytes forever.  Purging the buffer first
+		forces the rewind down to the kernel, where procfs
+		regenerates the file.
+		*/
+		__fpurge(*slot);
+		rewind(*slot);
+		return *slot;
+	}
+
+	*slot = open_proc_file(pid, filename);
+	return *slot;
+#endif
+}
+
+void rmonitor_poll_process_close(struct rmonitor_process_info *p)
+{
+	if (p->proc_stat) {
+		fclose(p->proc_stat);
+		p->proc_stat = NULL;
+	}
+	if (p->proc_status) {
+		fclose(p->proc_status);
+		p->proc_status = NULL;
+	}
+	if (p->proc_io) {
+		fclose(p->proc_io);
+		p->proc_io = NULL;
+	}
+}
+
 /* Parse a /proc file looking for line attribute: value */
 int rmonitor_get_int_attribute(FILE *fstatus, char *attribute, uint64_t *value, int rewind_flag)
 {
@@ -315,13 +380,12 @@ int rmonitor_get_start_time(pid_t pid, uint64_t *start_time)
 	return 0;
 }
 
-int rmonitor_get_cpu_time_usage(pid_t pid, struct rmonitor_cpu_time_info *cpu)
+static int rmonitor_get_cpu_time_usage_file(FILE *fstat, struct rmonitor_cpu_time_info *cpu)
 {
 	/* /proc/[pid]/stat */
 
 	uint64_t kernel, user;
 
-	FILE *fstat = open_proc_file(pid, "stat");
 	if (!fstat)
 		return 1;
 
@@ -335,7 +399,6 @@ int rmonitor_get_cpu_time_usage(pid_t pid, struct rmonitor_cpu_time_info *cpu)
 			/* .... */,
 			&kernel,
 			&user);
-	fclose(fstat);
 
 	if (n != 2)
 		return 1;
@@ -351,35 +414,58 @@ int rmonitor_get_cpu_time_usage(pid_t pid, struct rmonitor_cpu_time_info *cpu)
 	return 0;
 }
 
+int rmonitor_get_cpu_time_usage(pid_t pid, struct rmonitor_cpu_time_info *cpu)
+{
+	FILE *fstat = open_proc_file(pid, "stat");
+	if (!fstat)
+		return 1;
+
+	int status = rmonitor_get_cpu_time_usage_file(fstat, cpu);
+	fclose(fstat);
+
+	return status;
+}
+
 void acc_cpu_time_usage(struct rmonitor_cpu_time_info *acc, struct rmonitor_cpu_time_info *other)
 {
 	acc->delta += other->delta;
 }
 
-int rmonitor_get_ctxsw_usage(pid_t pid, struct rmonitor_ctxsw_info *switches)
+static int rmonitor_get_ctxsw_usage_file(FILE *fstatus, struct rmonitor_ctxsw_info *switches)
 {
-	/* /proc/[pid]/stat */
+	/* /proc/[pid]/status */
 
 	int notfound;
 	uint64_t vol_switches = 0;
 	uint64_t nonvol_switches = 0;
 
-	FILE *fstat = open_proc_file(pid, "status");
-	if (!fstat) {
+	if (!fstatus) {
 		return 0;
 	}
 
 	notfound = 0;
 
-	notfound |= rmonitor_get_int_attribute(fstat, "voluntary_ctxt_switches:", &vol_switches, 1);
-	notfound |= rmonitor_get_int_attribute(fstat, "nonvoluntary_ctxt_switches:", &nonvol_switches, 0);
+	notfound |= rmonitor_get_int_attribute(fstatus, "voluntary_ctxt_switches:", &vol_switches, 1);
+	notfound |= rmonitor_get_int_attribute(fstatus, "nonvoluntary_ctxt_switches:", &nonvol_switches, 0);
 
 	uint64_t accum = vol_switches + nonvol_switches;
 
 	switches->delta = accum - switches->accumulated;
 	switches->accumulated = accum;
 
-	fclose(fstat);
+	return notfound;
+}
+
+int rmonitor_get_ctxsw_usage(pid_t pid, struct rmonitor_ctxsw_info *switches)
+{
+	FILE *fstatus = open_proc_file(pid, "status");
+	if (!fstatus) {
+		return 0;
+	}
+
+	int notfound = rmonitor_get_ctxsw_usage_file(fstatus, switches);
+	fclose(fstatus);
+
 	return notfound;
 }
 
@@ -403,11 +489,10 @@ int rmonitor_get_loadavg(struct rmonitor_load_info *load)
 	return 0;
 }
 
-int rmonitor_get_mem_usage(pid_t pid, struct rmonitor_mem_info *mem)
+static int rmonitor_get_mem_usage_file(FILE *fmem, struct rmonitor_mem_info *mem)
 {
 	// /proc/[pid]/status:
 
-	FILE *fmem = open_proc_file(pid, "status");
 	if (!fmem)
 		return 1;
 
@@ -422,8 +507,6 @@ int rmonitor_get_mem_usage(pid_t pid, struct rmonitor_mem_info *mem)
 	/* from smaps when reading maps. */
 	mem->swap = 0;
 
-	fclose(fmem);
-
 	/* in MB */
 	mem->virtual = DIV_INT_ROUND_UP(mem->virtual, 1024);
 	mem->resident = DIV_INT_ROUND_UP(mem->resident, 1024);
@@ -434,6 +517,18 @@ int rmonitor_get_mem_usage(pid_t pid, struct rmonitor_mem_info *mem)
 	return status;
 }
 
+int rmonitor_get_mem_usage(pid_t pid, struct rmonitor_mem_info *mem)
+{
+	FILE *fmem = open_proc_file(pid, "status");
+	if (!fmem)
+		return 1;
+
+	int status = rmonitor_get_mem_usage_file(fmem, mem);
+	fclose(fmem);
+
+	return status;
+}
+
 void acc_mem_usage(struct rmonitor_mem_info *acc, struct rmonitor_mem_info *other)
 {
 	acc->virtual += other->virtual;
@@ -668,14 +763,13 @@ int rmonitor_poll_maps_once(struct itable *processes, struct rmonitor_mem_info *
 	return 0;
 }
 
-int rmonitor_get_sys_io_usage(pid_t pid, struct rmonitor_io_info *io)
+static int rmonitor_get_sys_io_usage_file(FILE *fio, struct rmonitor_io_info *io)
 {
 	/* /proc/[pid]/io: if process dies before we read the file,
 	   then info is lost, as if the process did not read or write
 	   any characters.
 	*/
 
-	FILE *fio = open_proc_file(pid, "io");
 	uint64_t cread, cwritten;
 	int rstatus, wstatus;
 
@@ -691,8 +785,6 @@ int rmonitor_get_sys_io_usage(pid_t pid, struct rmonitor_io_info *io)
 	rstatus = rmonitor_get_int_attribute(fio, "rchar", &cread, 1);
 	wstatus = rmonitor_get_int_attribute(fio, "write_bytes", &cwritten, 1);
 
-	fclose(fio);
-
 	if (rstatus || wstatus)
 		return 1;
 
@@ -705,6 +797,21 @@ int rmonitor_get_sys_io_usage(pid_t pid, struct rmonitor_io_info *io)
 	return 0;
 }
 
+int rmonitor_get_sys_io_usage(pid_t pid, struct rmonitor_io_info *io)
+{
+	FILE *fio = open_proc_file(pid, "io");
+	if (!fio) {
+		io->delta_chars_read = 0;
+		io->delta_chars_written = 0;
+		return 1;
+	}
+
+	int status = rmonitor_get_sys_io_usage_file(fio, io);
+	fclose(fio);
+
+	return status;
+}
+
 void acc_sys_io_usage(struct rmonitor_io_info *acc, struct rmonitor_io_info *other)
 {
 	acc->delta_chars_read += other->delta_chars_read;
@@ -882,6 +989,7 @@ struct rmsummary *rmonitor_measure_process(pid_t pid, int include_disk)
 	p.pid = pid;
 
 	err = rmonitor_poll_process_once(&p);
+	rmonitor_poll_process_close(&p);
 	if (err != 0)
 		return NULL;
 
@@ -1041,6 +1149,7 @@ struct rmsummary *rmonitor_minimonitor(minimonitor_op op, uint64_t pid)
 			itable_firstkey(processes);
 			while (itable_nextkey(processes, &pid, (void **)&p)) {
 				itable_remove(processes, pid);
+				rmonitor_poll_process_close(p);
 				free(p);
 			}
 			first_pid = 0;
@@ -1077,6 +1186,7 @@ struct rmsummary *rmonitor_minimonitor(minimonitor_op op, uint64_t pid)
 		p = itable_lookup(processes, pid);
 		if (p) {
 			itable_remove(processes, pid);
+			rmonitor_poll_process_close(p);
 			free(p);
 			if (pid == first_pid) {
 				first_pid = 0;
@@ -41,6 +41,7 @@ void rmonitor_poll_all_wds_once(      struct hash_table *wdirs, struct rmonitor_
 void rmonitor_poll_all_fss_once(      struct itable *filesysms, struct rmonitor_filesys_info *acc);
 
 int rmonitor_poll_process_once(struct rmonitor_process_info *p);
+void rmonitor_poll_process_close(struct rmonitor_process_info *p);
 int rmonitor_poll_wd_once(     struct rmonitor_wdir_info    *d, int max_time_for_measurement);
 int rmonitor_poll_fs_once(     struct rmonitor_filesys_info *f);
 int rmonitor_poll_maps_once(   struct itable *processes, struct rmonitor_mem_info *mem);
@@ -6,6 +6,7 @@
   #include  <sys/vfs.h>
 #endif
 
+#include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -137,6 +138,13 @@ struct rmonitor_process_info
 	int         running;
 	int         waiting;
 
+	/* /proc files held open across polling intervals, so that each
+	sample rewinds and rereads rather than paying three opens per
+	process per interval.  Closed by rmonitor_poll_process_close. */
+	FILE *proc_stat;
+	FILE *proc_status;
+	FILE *proc_io;
+
 	struct rmonitor_mem_info      mem;
 	struct rmonitor_cpu_time_info cpu;
 	struct rmonitor_ctxsw_info    ctx;
@@ -28,6 +28,7 @@
 #include "jx.h"
 #include "jx_parse.h"
 #include "jx_pretty_print.h"
+#include "jx_binary.h"
 #include "jx_print.h"
 #include "list.h"
 #include "macros.h"
@@ -462,6 +463,69 @@ struct rmsummary *json_to_rmsummary(struct jx *j)
 }
 
 /* Parse the file, assuming there is a single summary in it. */
+/*
+The binary summary format is simply the jx form of the summary in the
+compact jx_binary encoding, one record after another, with a short
+magic word so readers can reject the wrong kind of file.  An archive
+of millions of summaries loads an order of magnitude faster than the
+verbose JSON form, without inventing a second schema.
+*/
+
+#define RMSUMMARY_BINARY_MAGIC "RMSB"
+
+int rmsummary_print_binary(FILE *stream, const struct rmsummary *s)
+{
+	struct jx *j = rmsummary_to_json(s, 0);
+	if (!j)
+		return -1;
+
+	if (fwrite(RMSUMMARY_BINARY_MAGIC, 1, 4, stream) != 4) {
+		jx_delete(j);
+		return -1;
+	}
+
+	int result = jx_binary_write(stream, j) ? 0 : -1;
+	jx_delete(j);
+	return result;
+}
+
+struct rmsummary *rmsummary_parse_binary(FILE *stream)
+{
+	char magic[4];
+
+	if (fread(magic, 1, 4, stream) != 4)
+		return NULL;
+	if (memcmp(magic, RMSUMMARY_BINARY_MAGIC, 4))
+		return NULL;
+
+	struct jx *j = jx_binary_read(stream);
+	if (!j)
+		return NULL;
+
+	struct rmsummary *s = json_to_rmsummary(j);
+	jx_delete(j);
+	return s;
+}
+
+struct list *rmsummary_parse_file_multiple_binary(const char *filename)
+{
+	FILE *stream = fopen(filename, "r");
+	if (!stream) {
+		debug(D_NOTICE, "Cannot open resources summary file: %s : %s\n", filename, strerror(errno));
+		return NULL;
+	}
+
+	struct list *lst = list_create();
+	struct rmsummary *s;
+
+	while ((s = rmsummary_parse_binary(stream))) {
+		list_push_tail(lst, s);
+	}
+
+	fclose(stream);
+	return lst;
+}
+
 struct rmsummary *rmsummary_parse_file_single(const char *filename)
 {
 	FILE *stream;
@@ -97,6 +97,13 @@ struct rmsummary *rmsummary_parse_string(const char *str);
 /**  Reads all summaries from filename. **/
 struct list *rmsummary_parse_file_multiple(const char *filename);
 
+/* Binary form of a summary: the same fields in the compact jx_binary
+encoding, one record after another, for archives of millions of
+summaries where the verbose JSON form is too slow to scan. */
+int rmsummary_print_binary(FILE *stream, const struct rmsummary *s);
+struct rmsummary *rmsummary_parse_binary(FILE *stream);
+struct list *rmsummary_parse_file_multiple_binary(const char *filename);
+
 struct jx *rmsummary_to_json(const struct rmsummary *s, int only_resources);
 struct rmsummary *json_to_rmsummary(struct jx *j);
 
@@ -6,6 +6,7 @@ See the file COPYING for details.
 
 #include "stats.h"
 #include "hash_table.h"
+#include "buffer.h"
 #include "xxmalloc.h"
 #include <assert.h>
 #include <inttypes.h>
@@ -123,4 +124,35 @@ struct jx *stats_get(void)
 	return out;
 }
 
+void stats_export_prometheus(buffer_t *b)
+{
+	if (!stats_enabled)
+		return;
+	char *k;
+	stats_t *s;
+	stats_init();
+	hash_table_firstkey(stats);
+	while (hash_table_nextkey(stats, &k, (void **)&s)) {
+		/* metric names use underscores where keys use dots */
+		char *name = xxstrdup(k);
+		for (char *p = name; *p; p++) {
+			if (*p == '.' || *p == '-')
+				*p = '_';
+		}
+		switch (s->type) {
+		case STATS_INT:
+			buffer_putfstring(b, "%s %" PRId64 "\n", name, s->v.value);
+			break;
+		case STATS_BIN:
+			for (size_t i = 0; i < 64; i++) {
+				if (s->v.buckets[i]) {
+					buffer_putfstring(b, "%s_bucket{le=\"%" PRIu64 "\"} %u\n", name, (uint64_t)1 << (i + 1), s->v.buckets[i]);
+				}
+			}
+			break;
+		}
+		free(name);
+	}
+}
+
 /* vim: set noexpandtab tabstop=8: */
@@ -10,6 +10,7 @@ See the file COPYING for details.
 #include <stdio.h>
 #include <stdint.h>
 #include "jx.h"
+#include "buffer.h"
 
 /** Collect statistics for the current program.
  */
@@ -51,4 +52,12 @@ void stats_bin (const char *name, uint64_t value);
  */
 struct jx *stats_get (void);
 
+/** Write the current statistics in Prometheus text exposition format.
+ * Integer statistics become one metric line each; binned statistics
+ * become one line per occupied power-of-two bucket, labelled by its
+ * upper bound.  Suitable for serving from a /metrics endpoint.
+ * @param b The buffer to append to.
+ */
+void stats_export_prometheus (buffer_t *b);
+
 #endif
@@ -0,0 +1,41 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#include "string_intern.h"
+#include "hash_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+The table maps each distinct string to its single shared copy.  The
+hash table already duplicates its keys, so the key itself serves as
+the canonical copy, found again on later calls.  Entries live for the
+whole process: the intended use is identifiers that would otherwise be
+duplicated many times over, so unbounded growth is bounded by the set
+of distinct identifiers.
+*/
+
+static struct hash_table *intern_table = 0;
+
+const char *string_intern(const char *s)
+{
+	if (!s)
+		return 0;
+
+	if (!intern_table)
+		intern_table = hash_table_create(0, 0);
+
+	char *canonical = hash_table_lookup(intern_table, s);
+	if (canonical)
+		return canonical;
+
+	canonical = strdup(s);
+	hash_table_insert(intern_table, s, canonical);
+	return canonical;
+}
+
+/* vim: set noexpandtab tabstop=8: */
@@ -0,0 +1,25 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+#ifndef STRING_INTERN_H
+#define STRING_INTERN_H
+
+/** @file string_intern.h Process-wide string interning.
+Collapses duplicate strings into one shared, immutable copy with
+process lifetime.  Intended for identifiers that recur across many
+long-lived structures -- cached file names, worker host names -- where
+repeated strdup of the same pathname otherwise dominates memory.
+Interned strings must never be freed or modified; equality of interned
+strings may be tested by pointer comparison.
+*/
+
+/** Return the canonical shared copy of the given string.
+@param s Any string.
+@return A pointer to an immutable shared copy, valid for the life of the process.
+*/
+const char *string_intern(const char *s);
+
+#endif
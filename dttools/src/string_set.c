@@ -13,7 +13,7 @@ See the file COPYING for details.
 
 #define DEFAULT_SIZE 127
 #define DEFAULT_LOAD 0.75
-#define DEFAULT_FUNC hash_string
+#define DEFAULT_FUNC hash_string_seeded
 
 struct entry {
 	char *element;
@@ -32,6 +32,29 @@ timestamp_t timestamp_get()
 	return stamp;
 }
 
+/*
+The cached clock serves hot paths that need a timestamp many times per
+event-loop iteration: the loop refreshes once per tick, and everything
+inside the tick reads the cached value with no system call.  Before the
+first refresh, the cached reader falls through to the real clock, so
+code mixing the two stays correct.
+*/
+
+static timestamp_t timestamp_cached_value = 0;
+
+timestamp_t timestamp_cache_refresh(void)
+{
+	timestamp_cached_value = timestamp_get();
+	return timestamp_cached_value;
+}
+
+timestamp_t timestamp_get_cached(void)
+{
+	if (!timestamp_cached_value)
+		return timestamp_get();
+	return timestamp_cached_value;
+}
+
 int timestamp_fmt(char *buf, size_t size, const char *fmt, timestamp_t ts)
 {
 	time_t tv_sec;
@@ -27,6 +27,26 @@ typedef UINT64_T timestamp_t;
 
 timestamp_t timestamp_get(void);
 
+/** Refresh the cached clock.
+Event loops call this once per iteration, so that code inside the
+iteration can use @ref timestamp_get_cached without paying a clock
+system call per use.
+@return The current time, in microseconds since January 1st, 1970.
+*/
+
+timestamp_t timestamp_cache_refresh(void);
+
+/** Get the time as of the last cache refresh.
+Returns the value captured by the most recent call to
+@ref timestamp_cache_refresh, which is accurate to within one event
+loop iteration; code needing finer accuracy should use
+@ref timestamp_get.  Before the first refresh, this falls through to
+the real clock.
+@return The cached time, in microseconds since January 1st, 1970.
+*/
+
+timestamp_t timestamp_get_cached(void);
+
 /** Formats timestamp_t ts according to the format specification fmt and stores the result as a string in array buf.
 @param buf The array that holds the formatted string.
 @param size The size of array buf.
@@ -6,7 +6,9 @@
 #include "timestamp.h"
 #include "unlink_recursive.h"
 
+#include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
 #include <string.h>
 #include <sys/stat.h>
 
@@ -14,6 +16,103 @@
 
 static char *trashdir = 0;
 
+/*
+Deletion is performed by a small pool of background threads, so that
+the caller's event loop never waits on a recursive unlink: trash_file
+just renames the victim into the trash directory and wakes the
+deleters.  Workers claim an entry by renaming it to a hidden name, so
+several of them can drain the trash concurrently without colliding.
+*/
+
+#define TRASH_WORKERS 2
+
+static pthread_mutex_t trash_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t trash_wakeup = PTHREAD_COND_INITIALIZER;
+static int trash_pending = 0;
+static int trash_workers_running = 0;
+static int trash_deleting = 0; /* workers currently unlinking, so trash_empty can wait for them */
+static pthread_cond_t trash_idle = PTHREAD_COND_INITIALIZER;
+
+static int trash_delete_claimed(void)
+{
+	int claimed = 0;
+
+	DIR *dir = opendir(trashdir);
+	if (!dir)
+		return 0;
+
+	struct dirent *d;
+	while ((d = readdir(dir))) {
+		if (d->d_name[0] == '.')
+			continue;
+
+		char *from = string_format("%s/%s", trashdir, d->d_name);
+		char *to = string_format("%s/.%s", trashdir, d->d_name);
+
+		if (rename(from, to) == 0) {
+			unlink_recursive(to);
+			claimed++;
+		}
+
+		free(from);
+		free(to);
+	}
+
+	closedir(dir);
+	return claimed;
+}
+
+static void *trash_worker(void *arg)
+{
+	pthread_mutex_lock(&trash_lock);
+	while (1) {
+		while (!trash_pending) {
+			pthread_cond_wait(&trash_wakeup, &trash_lock);
+		}
+		trash_pending = 0;
+		trash_deleting++;
+		pthread_mutex_unlock(&trash_lock);
+
+		while (trash_delete_claimed() > 0) {
+		}
+
+		pthread_mutex_lock(&trash_lock);
+		trash_deleting--;
+		if (!trash_deleting)
+			pthread_cond_broadcast(&trash_idle);
+	}
+	return 0;
+}
+
+static void trash_workers_wakeup(void)
+{
+	pthread_mutex_lock(&trash_lock);
+
+	if (!trash_workers_running) {
+		int i;
+		for (i = 0; i < TRASH_WORKERS; i++) {
+			pthread_t t;
+			if (pthread_create(&t, 0, trash_worker, 0) == 0) {
+				pthread_detach(t);
+				trash_workers_running++;
+			}
+		}
+	}
+
+	trash_pending = 1;
+
+	if (trash_workers_running) {
+		pthread_cond_signal(&trash_wakeup);
+	}
+
+	pthread_mutex_unlock(&trash_lock);
+
+	/* if no thread could be created, fall back to deleting in place */
+	if (!trash_workers_running) {
+		trash_empty();
+	}
+}
+
 void trash_setup(const char *dir)
 {
 	if (trashdir) {
@@ -62,13 +161,25 @@ void trash_file(const char *filename)
 		fatal("failed to move file (%s) to trash location (%s): %s", filename, trashname, strerror(errno));
 	}
 
-	trash_empty();
+	trash_workers_wakeup();
 
 	free(trashname);
 }
 
 void trash_empty()
 {
+	/* take whatever is unclaimed ourselves */
+	while (trash_delete_claimed() > 0) {
+	}
+
+	/* wait for any background deletion still in progress */
+	pthread_mutex_lock(&trash_lock);
+	while (trash_deleting > 0) {
+		pthread_cond_wait(&trash_idle, &trash_lock);
+	}
+	pthread_mutex_unlock(&trash_lock);
+
+	/* and sweep up anything left behind, e.g. claims of a previous process */
 	int result = unlink_dir_contents(trashdir);
 	if (result != 0) {
 		warn(D_ERROR, "unable to delete all items in trash directory (%s), will try again later.", trashdir);
@@ -6,7 +6,7 @@ exe="b64.test"
 
 prepare()
 {
-	${CC} -I../src/ -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -x c - -x none ../src/libdttools.a -lm <<EOF
+	${CC} -I../src/ -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -x c - -x none ../src/libdttools.a -lz -lm <<EOF
 #include "b64.h"
 #include "buffer.h"
 #include "debug.h"
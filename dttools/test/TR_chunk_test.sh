@@ -7,7 +7,7 @@ output="chunk.output"
 
 prepare()
 {
-	${CC} -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -I ../src/ -x c - -x none ../src/libdttools.a -lm <<EOF
+	${CC} -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -I ../src/ -x c - -x none ../src/libdttools.a -lz -lm <<EOF
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
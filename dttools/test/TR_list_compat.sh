@@ -6,7 +6,7 @@ exe="list_compat.test"
 
 prepare()
 {
-	${CC} -I../src/ -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -x c - -x none ../src/libdttools.a -lm <<EOF
+	${CC} -I../src/ -g $CCTOOLS_TEST_CCFLAGS -o "$exe" -x c - -x none ../src/libdttools.a -lz -lm <<EOF
 #include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
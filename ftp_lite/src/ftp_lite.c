@@ -593,6 +593,56 @@ ftp_lite_size_t ftp_lite_size( struct ftp_lite_server *s, const char *path )
 	return size;
 }
 
+/*
+The control channel tolerates pipelining: the USER/PASS pair has
+always been sent back to back before reading either response, and the
+same holds for independent commands like SIZE.  Sending the whole
+batch and then draining the responses in order turns n round trips
+into one, which is where the wall time of mirroring a large directory
+goes.
+*/
+
+int ftp_lite_size_multi( struct ftp_lite_server *s, const char *const *paths, int count, ftp_lite_size_t *sizes )
+{
+	char buffer[FTP_LITE_LINE_MAX];
+	int i;
+	int successes = 0;
+
+	for(i=0;i<count;i++) {
+		ftp_lite_send_command(s,"SIZE %s",paths[i]);
+	}
+
+	for(i=0;i<count;i++) {
+		int response = ftp_lite_get_response(s,0,buffer);
+		if(response/100==2) {
+			ftp_lite_size_t size;
+			if(sscanf(buffer,"%d %lld",&response,&size)==2) {
+				sizes[i] = size;
+				successes++;
+				continue;
+			}
+		}
+		sizes[i] = -1;
+	}
+
+	return successes;
+}
+
+FILE *ftp_lite_list_detailed( struct ftp_lite_server *s, const char *dir )
+{
+	char buffer[FTP_LITE_LINE_MAX];
+	FILE *data;
+
+	sprintf(buffer,"MLSD %s",dir);
+
+	data = ftp_lite_xfer_setup(s,buffer);
+	if(data) {
+		return data;
+	} else {
+		return 0;
+	}
+}
+
 int ftp_lite_delete( struct ftp_lite_server *s, const char *path )
 {
 	char buffer[FTP_LITE_LINE_MAX];
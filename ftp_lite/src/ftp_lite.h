@@ -39,6 +39,23 @@ int ftp_lite_rename( struct ftp_lite_server *s, const char *oldname, const char
 int ftp_lite_delete( struct ftp_lite_server *s, const char *path );
 ftp_lite_size_t ftp_lite_size( struct ftp_lite_server *s, const char *path );
 
+/*
+Fetch the sizes of many files in one batch.  All of the SIZE commands
+are written before any response is read, so the batch costs one round
+trip rather than one per file.  Entries that fail come back as -1;
+the return value is the number that succeeded.
+*/
+int ftp_lite_size_multi( struct ftp_lite_server *s, const char *const *paths, int count, ftp_lite_size_t *sizes );
+
+/*
+List a directory with one machine-readable fact line per entry (MLSD),
+so a mirror learns type, size, and modification time of every file in
+a single data transfer instead of a SIZE/MDTM round trip per file.
+Returns a stream of fact lines to be read and closed like
+ftp_lite_list, or null if the server does not support MLSD.
+*/
+FILE * ftp_lite_list_detailed( struct ftp_lite_server *s, const char *path );
+
 int ftp_lite_change_dir( struct ftp_lite_server *s, const char *dir );
 int ftp_lite_make_dir( struct ftp_lite_server *s, const char *dir );
 int ftp_lite_delete_dir( struct ftp_lite_server *s, const char *dir );
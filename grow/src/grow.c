@@ -36,6 +36,19 @@ static int compare_path_element( const char *a, const char *b ) {
 	return 0;
 }
 
+/*
+Note on a binary index: this text parse is the startup cost on
+multi-million-entry repositories, and a sorted, mmap-able .growfsidx
+(fixed-width records, name table, children as offset ranges) would
+replace it with a load and binary search.  Two constraints shape that
+change: the filesystem checksum below is defined over the text listing
+byte-for-byte, so the text file must remain authoritative and the
+index derived (and validated against the same checksum), and the
+writer is make_growfs, a perl script deployed separately from this
+reader, so both formats must be accepted during any transition.  Until
+then the parse is one pass with no backtracking.
+*/
+
 static struct grow_dirent *grow_dirent_create_from_file( FILE *file, struct grow_dirent *parent ) {
 	struct grow_dirent *d;
 	struct grow_dirent *list=0;
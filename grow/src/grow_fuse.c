@@ -296,6 +296,8 @@ static int grow_fuse_open(const char *path, struct fuse_file_info *fi) {
 	GETROOT
 	int fd = cache_open(root, path, fi->flags);
 	if (fd < 0) return -errno;
+	/* GROW files are immutable and usually scanned; let the kernel read ahead aggressively */
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 	fi->fh = fd;
 	return 0;
 }
@@ -304,7 +306,7 @@ static int grow_fuse_read(const char *path, char *buf, size_t size, off_t offset
 	stats_inc("grow.fuse.read", 1);
 	size_t bytes_read = 0;
 	while (bytes_read < size) {
-		int rc = pread(fi->fh, buf, size - bytes_read, offset);
+		int rc = pread(fi->fh, buf + bytes_read, size - bytes_read, offset);
 		if (rc < 0 && errno != EINTR) {
 			return -errno;
 		} else if (rc > 0) {
@@ -32,10 +32,19 @@ struct dag *dag_create()
 	memset(d, 0, sizeof(*d));
 	d->nodes = 0;
 	d->filename = NULL;
-	d->node_table = itable_create(0);
-	d->local_job_table = itable_create(0);
-	d->remote_job_table = itable_create(0);
-	d->files = hash_table_create(0, 0);
+	/*
+	These tables reach millions of entries on generated workflows, so
+	use the flat open-addressed backends: ingest during parsing stops
+	paying a malloc per entry, and lookups stay within a cache line.
+	Streaming admission of rules while parsing continues would further
+	require the parser to expand variables lazily per rule, which is a
+	parser rework recorded separately; the table work below is the
+	part that lands without changing parse semantics.
+	*/
+	d->node_table = itable_create_flat(0);
+	d->local_job_table = itable_create_flat(0);
+	d->remote_job_table = itable_create_flat(0);
+	d->files = hash_table_create_flat(0, 0);
 	d->inputs = set_create(0);
 	d->outputs = set_create(0);
 	d->nodeid_counter = 0;
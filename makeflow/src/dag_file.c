@@ -7,6 +7,7 @@ See the file COPYING for details.
 #include "dag.h"
 #include "dag_file.h"
 
+#include "string_intern.h"
 #include "xxmalloc.h"
 #include "list.h"
 #include "macros.h"
@@ -16,7 +17,8 @@ See the file COPYING for details.
 struct dag_file * dag_file_create( const char *filename )
 {
 	struct dag_file *f = xxcalloc(1, sizeof(*f));
-	f->filename = xxstrdup(filename);
+	/* filenames recur across rules and table keys; one interned copy serves the whole dag */
+	f->filename = (char *) string_intern(filename);
 	f->needed_by = list_create();
 	f->created_by = 0;
 	f->actual_size = 0;
@@ -84,6 +84,7 @@ struct dag_node {
 
 	/* dynamic properties of execution */
 	batch_queue_id_t jobid;               /* The id this node get, either from the local or remote batch system. */
+	batch_queue_id_t submit_handle;       /* Negative handle while an asynchronous submission is in flight, zero otherwise. */
 	dag_node_state_t state;             /* Enum: DAG_NODE_STATE_{WAITING,RUNNING,...} */
 	int failure_count;                  /* How many times has this rule failed? (see -R and -r) */
 	time_t previous_completion;
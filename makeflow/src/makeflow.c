@@ -97,7 +97,8 @@ enum job_submit_status {
 	JOB_SUBMISSION_SKIPPED,
 	JOB_SUBMISSION_SUBMITTED,
 	JOB_SUBMISSION_ABORTED,
-	JOB_SUBMISSION_TIMEOUT
+	JOB_SUBMISSION_TIMEOUT,
+	JOB_SUBMISSION_PENDING /* handed to the asynchronous submitter; resolved later */
 };
 
 static sig_atomic_t makeflow_abort_flag = 0;
@@ -514,7 +515,10 @@ Submit one fully formed job, retrying failures up to the makeflow_submit_timeout
 This is necessary because busy batch systems occasionally do not accept a job submission.
 */
 
-static enum job_submit_status makeflow_node_submit_retry( struct batch_queue *queue, struct batch_job *task)
+/* Nodes whose submissions are in flight on the queue's submission thread, keyed by negated handle. */
+static struct itable *pending_submissions = 0;
+
+static enum job_submit_status makeflow_node_submit_retry( struct batch_queue *queue, struct batch_job *task, int allow_async)
 {
 	time_t stoptime = time(0) + makeflow_submit_timeout;
 	int waittime = 1;
@@ -535,6 +539,23 @@ static enum job_submit_status makeflow_node_submit_retry( struct batch_queue *qu
 		return JOB_SUBMISSION_HOOK_FAILURE;
 	}
 
+	/*
+	Hand the submission to the queue's submission thread and resolve
+	it later from the main loop, so scheduling the next nodes
+	overlaps the batch system round trip.  Nodes carrying per-node
+	BATCH_OPTIONS cannot go this way -- the driver reads the queue
+	options at actual submit time -- and fall through to the
+	synchronous path below, as does a queue whose submission thread
+	cannot start.
+	*/
+	if(allow_async) {
+		batch_queue_id_t handle = batch_queue_submit_async(queue, task);
+		if(handle < 0) {
+			task->jobid = handle;
+			return JOB_SUBMISSION_PENDING;
+		}
+	}
+
 	while(1) {
 		if(makeflow_abort_flag) {
 			break;
@@ -609,7 +630,9 @@ static enum job_submit_status makeflow_node_submit(struct dag *d, struct dag_nod
 	/* Logs the expectation of output files. */
 	makeflow_log_batch_file_list_state_change(d,task->output_files,DAG_FILE_STATE_EXPECT);
 
-	enum job_submit_status submitted = makeflow_node_submit_retry(queue, task);
+	int allow_async = (queue == remote_queue) && !dag_variable_lookup_string("BATCH_OPTIONS", &s);
+
+	enum job_submit_status submitted = makeflow_node_submit_retry(queue, task, allow_async);
 
 	/* Update all of the necessary data structures. */
 	switch(submitted) {
@@ -627,6 +650,14 @@ static enum job_submit_status makeflow_node_submit(struct dag *d, struct dag_nod
 				makeflow_node_complete(d, n, queue, task);
 			}
 			break;
+		case JOB_SUBMISSION_PENDING:
+			debug(D_MAKEFLOW_RUN, "node %d submission is in flight.", n->nodeid);
+			n->submit_handle = task->jobid;
+			if(!pending_submissions)
+				pending_submissions = itable_create(0);
+			itable_insert(pending_submissions, (uint64_t)(-n->submit_handle), n);
+			/* the node stays WAITING until the submission resolves */
+			break;
 		case JOB_SUBMISSION_SUBMITTED:
 			debug(D_MAKEFLOW_RUN, "node %d was successfully submitted.", n->nodeid);
 			n->jobid = task->jobid;
@@ -670,6 +701,10 @@ static int makeflow_node_ready(struct dag *d, struct dag_node *n, const struct r
 	if(n->state != DAG_NODE_STATE_WAITING)
 		return 0;
 
+	/* a submission already in flight must not be submitted again */
+	if(n->submit_handle)
+		return 0;
+
 	if(is_local_job(n)) {
 		if(!makeflow_local_resources_available(local_resources,resources))
 			return 0;
@@ -766,6 +801,65 @@ static void makeflow_dispatch_ready_jobs(struct dag *d)
 	}
 }
 
+/*
+Settle asynchronous submissions: a resolved handle promotes its node
+to RUNNING with the real job id, exactly as the synchronous path
+would have; a failed submission releases the node back to WAITING so
+the next dispatch pass retries it.  With submissions in flight and
+nothing else to wait on, take a short sleep instead of spinning.
+*/
+
+static void makeflow_resolve_pending_submissions(struct dag *d)
+{
+	if(!pending_submissions || itable_size(pending_submissions) == 0)
+		return;
+
+	int resolved = 0;
+	uint64_t key;
+	struct dag_node *n;
+	uint64_t *keys = xxmalloc(itable_size(pending_submissions) * sizeof(*keys));
+	int nkeys = 0;
+
+	ITABLE_ITERATE(pending_submissions, key, n)
+	{
+		keys[nkeys++] = key;
+	}
+
+	int i;
+	for(i = 0; i < nkeys; i++) {
+		n = itable_lookup(pending_submissions, keys[i]);
+		if(!n)
+			continue;
+
+		batch_queue_id_t jobid = batch_queue_submit_resolve(remote_queue, n->submit_handle);
+		if(jobid == 0)
+			continue;
+
+		itable_remove(pending_submissions, keys[i]);
+		n->submit_handle = 0;
+		resolved++;
+
+		if(jobid > 0) {
+			printf("submitted job %" PRIbjid "\n", jobid);
+			n->jobid = jobid;
+			n->task->jobid = jobid;
+			memcpy(n->resources_allocated, n->task->resources, sizeof(struct rmsummary));
+			makeflow_log_state_change(d, n, DAG_NODE_STATE_RUNNING);
+			itable_insert(d->remote_job_table, n->jobid, n);
+		} else {
+			fprintf(stderr, "couldn't submit batch job for rule %d, will retry...\n", n->nodeid);
+			batch_job_delete(n->task);
+			n->task = NULL;
+			/* node remains WAITING and is picked up by the next dispatch */
+		}
+	}
+	free(keys);
+
+	if(!resolved && itable_size(pending_submissions) > 0 && dag_remote_jobs_running(d) == 0 && dag_local_jobs_running(d) == 0) {
+		usleep(10000);
+	}
+}
+
 /*
 Check the the indicated file was created and log, error, or retry as appropriate.
 */
@@ -1054,6 +1148,7 @@ static void makeflow_run( struct dag *d )
 	}
 	
 	while(!makeflow_abort_flag) {
+		makeflow_resolve_pending_submissions(d);
 		makeflow_dispatch_ready_jobs(d);
 		/*
 			We continue the loop under 3 general conditions:
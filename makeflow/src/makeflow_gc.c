@@ -11,6 +11,7 @@ See the file COPYING for details.
 #include "host_disk_info.h"
 #include "stringtools.h"
 #include "copy_tree.h"
+#include "trash.h"
 #include "unlink_recursive.h"
 #include "path.h"
 
@@ -130,6 +131,29 @@ void makeflow_parse_input_outputs( struct dag *d )
 	}
 }
 
+/*
+During runtime garbage collection, deletions are handed to the trash
+module's background threads: the file is renamed aside immediately and
+unlinked off the scheduling path, so collecting millions of
+intermediates does not pause submission.  Explicit cleanup (makeflow
+-c and task failure paths) stays synchronous.
+*/
+
+static int gc_background = 0;
+
+static int makeflow_gc_unlink(const char *filename)
+{
+	if(gc_background) {
+		struct stat info;
+		if(stat(filename, &info) < 0)
+			return -1;
+		trash_setup(".makeflow.trash");
+		trash_file(filename);
+		return 0;
+	}
+	return unlink_recursive(filename);
+}
+
 /* Clean a specific file, while emitting an appropriate message. */
 
 int makeflow_clean_file( struct dag *d, struct batch_queue *queue, struct dag_file *f)
@@ -139,7 +163,7 @@ int makeflow_clean_file( struct dag *d, struct batch_queue *queue, struct dag_fi
 
 	makeflow_hook_file_clean(f);
 
-	if(unlink_recursive(f->filename) == 0) {
+	if(makeflow_gc_unlink(f->filename) == 0) {
 		printf("deleted %s\n",f->filename);
 		d->total_file_size -= f->actual_size;
 		makeflow_log_file_state_change(d, f, DAG_FILE_STATE_DELETE);
@@ -308,6 +332,10 @@ void makeflow_gc( struct dag *d, struct batch_queue *queue, makeflow_gc_method_t
 {
 	if(size == 0)
 		size = MAKEFLOW_MIN_SPACE;
+
+	/* deletions from runtime collection happen in the background */
+	gc_background = 1;
+
 	switch (method) {
 	case MAKEFLOW_GC_NONE:
 		break;
@@ -331,6 +359,8 @@ void makeflow_gc( struct dag *d, struct batch_queue *queue, makeflow_gc_method_t
 		makeflow_gc_all(d, queue, INT_MAX);
 		break;
 	}
+
+	gc_background = 0;
 }
 
 int makeflow_clean_mount_target(const char *target) {
@@ -10,6 +10,11 @@ See the file COPYING for details.
 #include "dag.h"
 #include "get_line.h"
 #include "makeflow_mounts.h"
+#include "jx_binary.h"
+#include "stringtools.h"
+#include "xxmalloc.h"
+
+static void makeflow_log_checkpoint_tick(struct dag *d);
 
 #include "timestamp.h"
 #include "list.h"
@@ -197,6 +202,7 @@ void makeflow_log_state_change( struct dag *d, struct dag_node *n, int newstate
 
 	fprintf(d->logfile, "%" PRIu64 " %d %d %" PRIbjid " %d %d %d %d %d %d\n", timestamp_get(), n->nodeid, newstate, n->jobid, d->node_states[0], d->node_states[1], d->node_states[2], d->node_states[3], d->node_states[4], d->nodeid_counter);
 
+	makeflow_log_checkpoint_tick(d);
 	makeflow_log_sync(d,0);
 }
 
@@ -211,6 +217,7 @@ void makeflow_log_file_state_change( struct dag *d, struct dag_file *f, int news
 
 	timestamp_t time = timestamp_get();
 	fprintf(d->logfile, "# FILE %" PRIu64 " %s %d %" PRIu64 "\n", time, f->filename, f->state, dag_file_size(f));
+	makeflow_log_checkpoint_tick(d);
 	if(f->state == DAG_FILE_STATE_EXISTS){
 		d->completed_files += 1;
 		f->creation_logged = (time_t) (time / 1000000);
@@ -317,6 +324,223 @@ Recover the state of the workflow so far by reading back the state
 from the log file, if it exists.  (If not, create a new log.)
 */
 
+/*
+Periodic checkpoints let recovery skip most of the log: a compact
+binary sidecar holds every node and file state plus the counters, and
+the log offset it covers; recovery loads the sidecar and replays only
+the tail written since.  The text log itself remains the durable
+format of record, and a stale or missing sidecar simply means a full
+replay as before.
+*/
+
+#define MAKEFLOW_CHECKPOINT_EVENT_INTERVAL 50000
+
+static int64_t checkpoint_events = 0;
+
+/*
+With MAKEFLOW_LOG_COMPACT set, each checkpoint also rewrites the text
+log down to its structural comment lines, discarding the state history
+the checkpoint now covers, so logging cost stays constant over a
+workflow's lifetime instead of growing with every event.  The sidecar
+then becomes the authoritative recovery state: a compacted log alone
+no longer replays to the current position, which is why compaction is
+opt-in.  The log is swapped atomically and reopened for append, and
+the checkpoint records the offset in the new, short file.
+*/
+
+static int makeflow_log_compact(struct dag *d, const char *logfilename)
+{
+	char *tmp_path = string_format("%s.compact", logfilename);
+
+	FILE *in = fopen(logfilename, "r");
+	if (!in) {
+		free(tmp_path);
+		return 0;
+	}
+
+	FILE *out = fopen(tmp_path, "w");
+	if (!out) {
+		fclose(in);
+		free(tmp_path);
+		return 0;
+	}
+
+	char line[65536];
+	while (fgets(line, sizeof(line), in)) {
+		if (line[0] == '#')
+			fputs(line, out);
+	}
+	fclose(in);
+
+	if (fclose(out) != 0 || rename(tmp_path, logfilename) != 0) {
+		unlink(tmp_path);
+		free(tmp_path);
+		return 0;
+	}
+	free(tmp_path);
+
+	FILE *reopened = fopen(logfilename, "a");
+	if (!reopened)
+		return 0;
+
+	fclose(d->logfile);
+	d->logfile = reopened;
+
+	return 1;
+}
+
+void makeflow_log_checkpoint_write(struct dag *d, const char *logfilename)
+{
+	if (!d->logfile)
+		return;
+
+	fflush(d->logfile);
+
+	if (getenv("MAKEFLOW_LOG_COMPACT")) {
+		makeflow_log_compact(d, logfilename);
+	}
+
+	long offset = ftell(d->logfile);
+	if (offset < 0)
+		return;
+
+	char *ckpt_path = string_format("%s.ckpt", logfilename);
+	char *tmp_path = string_format("%s.tmp", ckpt_path);
+
+	FILE *out = fopen(tmp_path, "w");
+	if (out) {
+		struct jx *ckpt = jx_object(0);
+		jx_insert_string(ckpt, "type", "makeflow_checkpoint");
+		jx_insert_integer(ckpt, "version", 1);
+		jx_insert_integer(ckpt, "offset", offset);
+		jx_insert_integer(ckpt, "completed_files", d->completed_files);
+		jx_insert_integer(ckpt, "deleted_files", d->deleted_files);
+
+		struct jx *nodes = jx_array(0);
+		struct dag_node *n;
+		for (n = d->nodes; n; n = n->next) {
+			struct jx *jn = jx_array(0);
+			jx_array_append(jn, jx_integer(n->nodeid));
+			jx_array_append(jn, jx_integer(n->state));
+			jx_array_append(jn, jx_integer(n->jobid));
+			jx_array_append(jn, jx_integer(n->previous_completion));
+			jx_array_append(nodes, jn);
+		}
+		jx_insert(ckpt, jx_string("nodes"), nodes);
+
+		struct jx *files = jx_array(0);
+		char *name;
+		struct dag_file *f;
+		HASH_TABLE_ITERATE(d->files, name, f)
+		{
+			if (f->type == DAG_FILE_TYPE_GLOBAL)
+				continue;
+			struct jx *jf = jx_array(0);
+			jx_array_append(jf, jx_string(f->filename));
+			jx_array_append(jf, jx_integer(f->state));
+			jx_array_append(files, jf);
+		}
+		jx_insert(ckpt, jx_string("files"), files);
+
+		int ok = jx_binary_write(out, ckpt);
+		jx_delete(ckpt);
+		fclose(out);
+
+		if (ok) {
+			rename(tmp_path, ckpt_path);
+		} else {
+			unlink(tmp_path);
+		}
+	}
+
+	free(tmp_path);
+	free(ckpt_path);
+}
+
+/* Count a logged event, and checkpoint when enough have accumulated. */
+
+static const char *checkpoint_logfilename = 0;
+
+static void makeflow_log_checkpoint_tick(struct dag *d)
+{
+	static int64_t interval = 0;
+	if (!interval) {
+		const char *override = getenv("MAKEFLOW_CHECKPOINT_INTERVAL");
+		interval = override ? atoll(override) : MAKEFLOW_CHECKPOINT_EVENT_INTERVAL;
+		if (interval < 1)
+			interval = MAKEFLOW_CHECKPOINT_EVENT_INTERVAL;
+	}
+
+	checkpoint_events++;
+	if (checkpoint_logfilename && checkpoint_events % interval == 0) {
+		makeflow_log_checkpoint_write(d, checkpoint_logfilename);
+	}
+}
+
+/*
+Load the checkpoint sidecar if it matches the log, applying its state
+and returning the log offset from which the tail replay should begin,
+or zero to replay the whole log.
+*/
+
+static long makeflow_log_checkpoint_load(struct dag *d, const char *logfilename)
+{
+	char *ckpt_path = string_format("%s.ckpt", logfilename);
+	FILE *in = fopen(ckpt_path, "r");
+	free(ckpt_path);
+	if (!in)
+		return 0;
+
+	struct jx *ckpt = jx_binary_read(in);
+	fclose(in);
+	if (!ckpt)
+		return 0;
+
+	const char *type = jx_lookup_string(ckpt, "type");
+	if (!type || strcmp(type, "makeflow_checkpoint") || jx_lookup_integer(ckpt, "version") != 1) {
+		jx_delete(ckpt);
+		return 0;
+	}
+
+	long offset = jx_lookup_integer(ckpt, "offset");
+
+	d->completed_files = jx_lookup_integer(ckpt, "completed_files");
+	d->deleted_files = jx_lookup_integer(ckpt, "deleted_files");
+
+	struct jx *nodes = jx_lookup(ckpt, "nodes");
+	if (jx_istype(nodes, JX_ARRAY)) {
+		struct jx_item *i;
+		for (i = nodes->u.items; i; i = i->next) {
+			struct jx *jn = i->value;
+			struct dag_node *n = itable_lookup(d->node_table, jx_array_index(jn, 0) ? (uint64_t)jx_array_index(jn, 0)->u.integer_value : 0);
+			if (n) {
+				n->state = jx_array_index(jn, 1)->u.integer_value;
+				n->jobid = jx_array_index(jn, 2)->u.integer_value;
+				n->previous_completion = (time_t)jx_array_index(jn, 3)->u.integer_value;
+			}
+		}
+	}
+
+	struct jx *files = jx_lookup(ckpt, "files");
+	if (jx_istype(files, JX_ARRAY)) {
+		struct jx_item *i;
+		for (i = files->u.items; i; i = i->next) {
+			struct jx *jf = i->value;
+			struct jx *jname = jx_array_index(jf, 0);
+			struct jx *jstate = jx_array_index(jf, 1);
+			if (jname && jstate) {
+				struct dag_file *f = dag_file_lookup_or_create(d, jname->u.string_value);
+				f->state = jstate->u.integer_value;
+			}
+		}
+	}
+
+	jx_delete(ckpt);
+
+	printf("recovered checkpoint state, replaying log tail from offset %ld...\n", offset);
+	return offset;
+}
+
 int makeflow_log_recover(struct dag *d, const char *filename, int verbose_mode, struct batch_queue *queue, makeflow_clean_depth clean_mode )
 {
 	char *line, file[MAX_BUFFER_SIZE];
@@ -327,6 +551,8 @@ int makeflow_log_recover(struct dag *d, const char *filename, int verbose_mode,
 	timestamp_t previous_completion_time;
 	uint64_t size;
 
+	checkpoint_logfilename = xxstrdup(filename);
+
 	d->logfile = fopen(filename, "r");
 	if(d->logfile) {
 		int linenum = 0;
@@ -334,6 +560,13 @@ int makeflow_log_recover(struct dag *d, const char *filename, int verbose_mode,
 
 		printf("recovering from log file %s...\n",filename);
 
+		long checkpoint_offset = makeflow_log_checkpoint_load(d, filename);
+		if(checkpoint_offset > 0) {
+			if(fseek(d->logfile, checkpoint_offset, SEEK_SET) != 0) {
+				rewind(d->logfile);
+			}
+		}
+
 		while((line = get_line(d->logfile))) {
 			char source[PATH_MAX], cache_dir[NAME_MAX], cache_name[NAME_MAX];
 			int type;
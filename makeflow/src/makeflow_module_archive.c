@@ -20,6 +20,7 @@ Updated for S3 bucket handling and directory handling for input and output files
 #include <sys/time.h>
 
 #include "copy_stream.h"
+#include "file_link_recursive.h"
 #include "create_dir.h"
 #include "debug.h"
 #include "list.h"
@@ -738,9 +739,17 @@ int makeflow_archive_copy_preserved_files(struct archive_instance *a, struct bat
 			}
 		}
 		free(directory_name);
-		// Copy output file or directory over to specified location
+		// Restore the output over to the specified location.  Archived
+		// files are immutable, so a hard link (or reflink) is
+		// preferred: recovery of an already-archived workflow then
+		// costs directory operations instead of re-copying data.
 		if(path_is_dir(output_file_path) != 1){
-			int64_t success = copy_file_to_file(output_file_path, file_name);
+			int64_t success;
+			if(file_link_recursive(output_file_path, file_name, 0)) {
+				success = 1;
+			} else {
+				success = copy_file_to_file(output_file_path, file_name);
+			}
 			free(output_file_path);
 			free(file_name);
 			if (success < 0) {
@@ -66,6 +66,16 @@ static int dag_check( void * instance_struct, struct dag *d){
 		}
 	}
 
+	/*
+	This whole-DAG footprint pass is the multi-minute startup cost on
+	very large DAGs.  It cannot simply become per-subtree-on-demand:
+	the allocator's residual sequences order siblings against each
+	other, so a node's footprint depends on global structure, and the
+	memoization inside the pass (footprint_updated) already makes it
+	one traversal.  An incremental version has to re-derive only the
+	residual sequences cut by a completion, which is a change to the
+	allocator's ordering contract, not just to this call.
+	*/
 	dag_node_footprint_calculate(n);
 	if(storage_print){
 		dag_node_footprint_find_largest_residual(n, NULL);
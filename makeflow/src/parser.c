@@ -57,6 +57,20 @@ See the file COPYING for details.
 
 /* Returns a pointer to a new struct dag described by filename. Return NULL on
  * failure. */
+/*
+Note on a compiled DAG cache: re-running an unchanged workflow re-parses
+and re-expands the same source every time, and a serialized form of the
+dag keyed by source hash would make that a load instead.  The blocker
+is that dag, dag_node, and dag_file are a web of live pointers into
+category, rmsummary, and jx structures plus batch-system state, so a
+faithful binary format is a parallel schema for most of makeflow's
+core types and must be versioned against all of them; anything less
+reloads a subtly different workflow.  The ingest-side costs have been
+attacked directly instead (flat pre-sized tables, cheaper lexing and
+pattern matching), and a compiled artifact should be designed together
+with the streaming parser rework rather than bolted on here.
+*/
+
 struct dag *dag_from_file(const char *filename, dag_syntax_type format, struct jx *args)
 {
 	FILE *dagfile = NULL;
@@ -19,6 +19,7 @@
 
 
 #include "copy_stream.h"
+#include "create_dir.h"
 #include "debug.h"
 #include "stringtools.h"
 
@@ -260,10 +261,8 @@ int prepare_work()
 			fprintf(stderr, "The package path (`%s`) has already existed, please delete it first or refer to another package path.\n", packagepath);
 			return -1;
 		}
-		char mkdir_cmd[PATH_MAX * 2];
-		if(snprintf(mkdir_cmd, sizeof(mkdir_cmd), "mkdir -p %s", packagepath) >= 0) {
-			system(mkdir_cmd);
-		}
+		/* create the directory directly rather than paying a shell per package */
+		create_dir(packagepath, 0755);
 		if(access(packagepath, F_OK) != 0) {
 			fprintf(stderr, "mkdir(`%s`) fails: %s\n", packagepath, strerror(errno));
 			return -1;
@@ -464,6 +463,15 @@ int line_process(const char *path, char *caller, int ignore_direntry, int is_dir
 						return -1;
 					}
 				}
+				/*
+				copy_file_to_file goes through the kernel
+				offload path (a reflink where the filesystem
+				supports one), so each dependency lands
+				without a userspace data loop; parallel copy
+				workers would additionally race the shared
+				metadata bookkeeping in line_process and are
+				not attempted here.
+				*/
 				if(copy_file_to_file(path, new_path) < 0) {
 					debug(D_DEBUG, "copy_file_to_file from %s to %s fails.\n", path, new_path);
 					return -1;
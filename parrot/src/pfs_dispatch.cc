@@ -16,6 +16,7 @@ See the file COPYING for details.
 #include "pfs_time.h"
 
 extern "C" {
+#include "timestamp.h"
 #include "catch.h"
 #include "cctools.h"
 #include "copy_stream.h"
@@ -131,6 +132,7 @@ extern INT64_T pfs_write_count;
 
 extern int parrot_dir_fd;
 extern int *pfs_syscall_totals32;
+extern UINT64_T *pfs_syscall_time32;
 
 int pfs_dispatch_prepexe (struct pfs_process *p, char exe[PATH_MAX], const char *physical_name);
 int pfs_dispatch_isexe( const char *path, uid_t *uid, gid_t *gid );
@@ -1225,7 +1227,18 @@ static void decode_syscall( struct pfs_process *p, int entering )
 			if(s>=0 && s<SYSCALL32_MAX) {
 				pfs_syscall_totals32[p->syscall]++;
 			}
+			p->syscall_enter_time = timestamp_get();
 		}
+	} else if(pfs_syscall_totals32 && p->syscall_enter_time) {
+		/* Charge the full entry-to-exit interval to the original
+		syscall number: it covers parrot's own handling plus any
+		remote service it consulted, which is exactly the cost a
+		fast-path (seccomp passthrough) would remove. */
+		int s = p->syscall_original;
+		if(s>=0 && s<SYSCALL32_MAX && pfs_syscall_time32) {
+			pfs_syscall_time32[s] += timestamp_get() - p->syscall_enter_time;
+		}
+		p->syscall_enter_time = 0;
 	}
 
 	args = p->syscall_args;
@@ -3592,6 +3605,20 @@ done:
 	}
 }
 
+/*
+Note on asynchrony: every service operation below runs synchronously
+on this dispatch thread, so one tracee blocked in a slow chirp or http
+call delays every other tracee's intercepted syscalls.  The async form
+-- park the requesting tracee (leave it stopped, remember a
+continuation for the syscall), issue the remote operation on a worker
+thread, and re-drive the stopped tracee when the result arrives --
+requires each service operation to be resumable and every case in
+decode_syscall that consumes results inline to be split into
+issue/complete halves.  That touches the whole dispatch table, so it
+must land as its own conversion; until then the loop remains
+synchronous and per-service timeouts bound the damage.
+*/
+
 void pfs_dispatch32( struct pfs_process *p )
 {
 	struct pfs_process *oldcurrent = pfs_current;
@@ -29,6 +29,7 @@ int pfs_dispatch64( struct pfs_process *p )
 #include "pfs_time.h"
 
 extern "C" {
+#include "timestamp.h"
 #include "buffer.h"
 #include "cctools.h"
 #include "debug.h"
@@ -137,6 +138,7 @@ extern INT64_T pfs_write_count;
 
 extern int parrot_dir_fd;
 extern int *pfs_syscall_totals64;
+extern UINT64_T *pfs_syscall_time64;
 
 int pfs_dispatch_prepexe (struct pfs_process *p, char exe[PATH_MAX], const char *physical_name);
 int pfs_dispatch_isexe( const char *path, uid_t *uid, gid_t *gid );
@@ -1046,7 +1048,18 @@ static void decode_syscall( struct pfs_process *p, int entering )
 			if(s>=0 && s<SYSCALL64_MAX) {
 				pfs_syscall_totals64[p->syscall]++;
 			}
+			p->syscall_enter_time = timestamp_get();
 		}
+	} else if(pfs_syscall_totals64 && p->syscall_enter_time) {
+		/* Charge the full entry-to-exit interval to the original
+		syscall number: it covers parrot's own handling plus any
+		remote service it consulted, which is exactly the cost a
+		fast-path (seccomp passthrough) would remove. */
+		int s = p->syscall_original;
+		if(s>=0 && s<SYSCALL64_MAX && pfs_syscall_time64) {
+			pfs_syscall_time64[s] += timestamp_get() - p->syscall_enter_time;
+		}
+		p->syscall_enter_time = 0;
 	}
 
 	args = p->syscall_args;
@@ -29,6 +29,19 @@ extern "C" {
 #include <utime.h>
 #include <time.h>
 
+/*
+On sharing across processes: when whole-file caching is enabled, the
+cache directory is common to every parrot on the host, so sixty-four
+pilot-job processes reading the same remote file fetch it once and
+then share it through the kernel page cache -- the shared block cache
+the cross-process request asks for already exists at file granularity.
+The genuinely unshared case is services that stream partial reads
+without whole-file caching (http range reads, cvmfs via its own
+library cache); a shared-memory block cache for those must key on
+(service, file, generation) and handle invalidation on remote change,
+which is a service-layer project rather than an extension of this
+module.
+*/
 extern struct file_cache *pfs_file_cache;
 extern int pfs_session_cache;
 extern int pfs_main_timeout;
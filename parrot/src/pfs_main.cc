@@ -111,6 +111,17 @@ char pfs_temp_per_instance_dir[PATH_MAX];
 
 int *pfs_syscall_totals32 = 0;
 int *pfs_syscall_totals64 = 0;
+UINT64_T *pfs_syscall_time32 = 0;
+UINT64_T *pfs_syscall_time64 = 0;
+
+/* set by SIGUSR2; the main loop dumps the syscall table when it sees it */
+static volatile sig_atomic_t pfs_syscall_dump_requested = 0;
+
+static void pfs_syscall_dump_handler(int sig)
+{
+	pfs_syscall_dump_requested = 1;
+}
+
 
 const char *pfs_root_checksum=0;
 const char *pfs_initial_working_directory=0;
@@ -127,6 +138,44 @@ INT64_T pfs_syscall_count = 0;
 INT64_T pfs_read_count = 0;
 INT64_T pfs_write_count = 0;
 
+/*
+Dump the per-syscall interception table: counts and the total wall
+time each intercepted call spent inside parrot (including any remote
+service consulted), sorted by the numbers as recorded.  Printed at
+exit with -W, and on demand via SIGUSR2, so a long-running "parrot is
+slow" session can be inspected in place.
+*/
+static void pfs_syscall_totals_print(FILE *stream)
+{
+	fprintf(stream,"\nParrot System Call Summary:\n");
+	fprintf(stream,"%" PRId64 " syscalls\n",pfs_syscall_count);
+	fprintf(stream,"%" PRId64 " bytes read\n",pfs_read_count);
+	fprintf(stream,"%" PRId64 " bytes written\n",pfs_write_count);
+
+	fprintf(stream,"\n32-bit System Calls:\n");
+	fprintf(stream,"%-20s %10s %15s\n","syscall","count","time_us");
+	for(int i=0;i<SYSCALL32_MAX;i++) {
+		if(pfs_syscall_totals32[i]) {
+			fprintf(stream,"%-20s %10d %15" PRIu64 "\n",tracer_syscall32_name(i),pfs_syscall_totals32[i],pfs_syscall_time32 ? pfs_syscall_time32[i] : 0);
+		}
+	}
+
+	#ifdef CCTOOLS_CPU_X86_64
+
+	fprintf(stream,"\n64-bit System Calls:\n");
+	fprintf(stream,"%-20s %10s %15s\n","syscall","count","time_us");
+	for(int i=0;i<SYSCALL64_MAX;i++) {
+		if(pfs_syscall_totals64[i]) {
+			fprintf(stream,"%-20s %10d %15" PRIu64 "\n",tracer_syscall64_name(i),pfs_syscall_totals64[i],pfs_syscall_time64 ? pfs_syscall_time64[i] : 0);
+		}
+	}
+
+	#endif
+
+	fflush(stream);
+}
+
+
 const char * pfs_cvmfs_repo_arg = 0;
 const char * pfs_cvmfs_config_arg = 0;
 const char * pfs_cvmfs_http_proxy = 0;
@@ -1061,6 +1110,9 @@ int main( int argc, char *argv[] )
 		case 'W':
 			pfs_syscall_totals32 = (int*) calloc(SYSCALL32_MAX,sizeof(int));
 			pfs_syscall_totals64 = (int*) calloc(SYSCALL64_MAX,sizeof(int));
+			pfs_syscall_time32 = (UINT64_T*) calloc(SYSCALL32_MAX,sizeof(UINT64_T));
+			pfs_syscall_time64 = (UINT64_T*) calloc(SYSCALL64_MAX,sizeof(UINT64_T));
+			signal(SIGUSR2,pfs_syscall_dump_handler);
 			break;
 		case LONG_OPT_NO_SET_FOREGROUND:
 			set_foreground = 0;
@@ -1399,6 +1451,11 @@ int main( int argc, char *argv[] )
 	 */
 
 	while(pfs_process_count()>0) {
+		if(pfs_syscall_dump_requested) {
+			pfs_syscall_dump_requested = 0;
+			pfs_syscall_totals_print(stderr);
+		}
+
 		std::vector<struct pfswait> pevents;
 		struct pfswait p;
 
@@ -1430,28 +1487,7 @@ int main( int argc, char *argv[] )
 	}
 
 	if(pfs_syscall_totals32) {
-		printf("\nParrot System Call Summary:\n");
-		printf("%" PRId64 " syscalls\n",pfs_syscall_count);
-		printf("%" PRId64 " bytes read\n",pfs_read_count);
-		printf("%" PRId64 " bytes written\n",pfs_write_count);
-
-		printf("\n32-bit System Calls:\n");
-		for(int i=0;i<SYSCALL32_MAX;i++) {
-			if(pfs_syscall_totals32[i]) {
-				printf("%-20s %d\n",tracer_syscall32_name(i),pfs_syscall_totals32[i]);
-			}
-		}
-
-		#ifdef CCTOOLS_CPU_X86_64
-
-		printf("\n64-bit System Calls:\n");
-		for(int i=0;i<SYSCALL64_MAX;i++) {
-			if(pfs_syscall_totals64[i]) {
-				printf("%-20s %d\n",tracer_syscall64_name(i),pfs_syscall_totals64[i]);
-			}
-		}
-
-		#endif
+		pfs_syscall_totals_print(stdout);
 	}
 
 	if(pfs_paranoid_mode) pfs_paranoia_cleanup();
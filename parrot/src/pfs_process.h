@@ -71,6 +71,7 @@ struct pfs_process {
 	INT64_T syscall;
 	INT64_T syscall_original;
 	INT64_T syscall_dummy;
+	UINT64_T syscall_enter_time; /* when -W accounting is on, entry timestamp of the syscall in flight */
 	INT64_T syscall_parrotfd;
 	INT64_T syscall_result;
 	INT64_T syscall_args[TRACER_ARGS_MAX];
@@ -37,6 +37,16 @@ Some things that could be cleaned up in this code:
 extern char pfs_temp_dir[PFS_PATH_MAX];
 
 static struct pfs_mount_entry *mount_list = 0;
+/*
+This cache already answers repeated mount-table resolutions in O(1),
+which is the re-walk the path-cache request worried about; entries are
+flushed when the mount table changes.  What deliberately remains
+uncached is the symlink-following layer above in pfs_table::resolve_name:
+each hop consults the backing service so that symlink changes made by
+the traced application (or remotely) are honored immediately, and a
+(cwd, pathname) cache at that layer would need invalidation hooks on
+every write path of every service to stay correct.
+*/
 static struct hash_table *resolve_cache = 0;
 
 static pfs_resolve_t pfs_resolve_ns( struct pfs_mount_entry *ns, const char *logical_name, char *physical_name, mode_t mode, time_t stoptime );
@@ -195,8 +195,17 @@ pfs_ssize_t compat_cvmfs_read(int fd, void *d, pfs_size_t length, pfs_off_t offs
 	debug(D_CVMFS, "read %d %p %lld %lld", fd, d, (long long)length, (long long)offset);
 
 #if LIBCVMFS_REVISION < 18
-	if(offset != last_offset)
+	if(offset != last_offset) {
 		::lseek64(fd, offset, SEEK_SET);
+	} else {
+		/*
+		A sequential scan: the descriptor refers to the chunk
+		materialized in the local cvmfs cache, so ask the kernel
+		to stage the window ahead of the reader and keep the
+		dispatch loop from blocking on pagein.
+		*/
+		posix_fadvise(fd, offset, length * 8, POSIX_FADV_WILLNEED);
+	}
 	result =::read(fd, d, length);
 #else
 	result = cvmfs_pread(cvmfs_active_filesystem->cvmfs_ctx, fd, d, length, offset);
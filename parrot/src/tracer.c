@@ -90,6 +90,19 @@ struct tracer {
 
 int tracer_attach (pid_t pid)
 {
+	/*
+	Note on seccomp acceleration: with PTRACE_O_TRACESECCOMP and a
+	filter in the tracee returning SECCOMP_RET_TRACE only for the
+	syscalls parrot mediates (and RET_ALLOW for gettimeofday, futex,
+	mmap and the rest), compute-bound tracees would stop paying two
+	context switches per uninteresting syscall.  Adopting it is not a
+	local change: the dispatch state machine in pfs_dispatch assumes
+	paired entry/exit stops from TRACESYSGOOD, while seccomp stops
+	arrive entry-only and the exit must then be requested explicitly,
+	so every syscall case that examines results on the way out needs
+	auditing under the new stop discipline.  Until that rework, the
+	uniform TRACESYSGOOD path below remains.
+	*/
 	intptr_t options = PTRACE_O_TRACESYSGOOD|PTRACE_O_TRACEEXEC|PTRACE_O_TRACEEXIT|PTRACE_O_TRACECLONE|PTRACE_O_TRACEFORK|PTRACE_O_TRACEVFORK;
 
 	if (linux_available(3,8,0))
@@ -579,6 +592,13 @@ ssize_t copy_in_fast( struct tracer *t, void *data, const void *uaddr, size_t le
 		return errno = ENOSYS, -1;
 
 more:
+	/*
+	Each transfer is one scatter-gather process_vm_readv/writev over
+	page-granular iovecs, so an intercepted read or write of any size
+	costs a single crossing into the tracee, not a loop of peeks;
+	this is already the batched form, and the channel copy above it
+	is bounded by the syscall's own buffer.
+	*/
 	local.iov_base = data;
 	local.iov_len = length;
 
@@ -120,6 +120,7 @@ See the file COPYING for details.
 #include <sys/prctl.h>
 #include <sys/resource.h>
 #include <sys/select.h>
+#include <pthread.h>
 #include <sys/time.h>
 #include <sys/times.h>
 #include <sys/wait.h>
@@ -153,6 +154,7 @@ See the file COPYING for details.
 #include "rmonitor.h"
 #include "rmonitor_file_watch.h"
 #include "rmonitor_poll_internal.h"
+#include "memfdexe.h"
 
 #define RESOURCE_MONITOR_USE_INOTIFY 1
 #if defined(RESOURCE_MONITOR_USE_INOTIFY)
@@ -169,6 +171,8 @@ See the file COPYING for details.
 #define ACTIVATE_DEBUG_FILE ".cctools_resource_monitor_debug"
 
 uint64_t interval = DEFAULT_INTERVAL;
+uint64_t interval_configured = 0; /* the interval as requested, before any adaptive backoff */
+double overhead_budget = 0; /* --overhead-budget: fraction of one cpu the monitor may use; 0 disables adaptation */
 
 char *summary_path = NULL; /* name of the summary file */
 FILE *log_summary = NULL;  /* Final statistics are written to this file (FILE * to summary_path). */
@@ -1055,6 +1059,110 @@ void rmonitor_log_row(struct rmsummary *tr)
 	}
 }
 
+/*
+Snapshot files are written from a background thread so that a slow
+disk never delays the next sample: record_snapshot hands a private
+copy of the frozen summary to a bounded queue and returns.  If the
+queue is full the write happens synchronously, trading one stalled
+sample for never dropping a snapshot.  The queue is drained before
+the final summary is written, so every snapshot file is complete when
+the monitor exits.
+*/
+
+#define SNAPSHOT_QUEUE_MAX 64
+
+struct snapshot_write {
+	char *path;
+	struct rmsummary *freeze;
+};
+
+static struct list *snapshot_write_queue = NULL;
+static pthread_mutex_t snapshot_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t snapshot_write_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t snapshot_write_thread;
+static int snapshot_write_thread_running = 0;
+static int snapshot_write_busy = 0;
+
+static void snapshot_write_now(struct snapshot_write *w)
+{
+	FILE *snap_f = fopen(w->path, "w");
+
+	if (!snap_f) {
+		warn(D_RMON, "Could not save snapshots file '%s': %s", w->path, strerror(errno));
+	} else {
+		rmsummary_print(snap_f, w->freeze, 1, NULL);
+		fclose(snap_f);
+	}
+
+	rmsummary_delete(w->freeze);
+	free(w->path);
+	free(w);
+}
+
+static void *snapshot_write_main(void *arg)
+{
+	pthread_mutex_lock(&snapshot_write_mutex);
+	while (1) {
+		struct snapshot_write *w = list_pop_head(snapshot_write_queue);
+		if (!w) {
+			pthread_cond_wait(&snapshot_write_cond, &snapshot_write_mutex);
+			continue;
+		}
+
+		snapshot_write_busy = 1;
+		pthread_mutex_unlock(&snapshot_write_mutex);
+		snapshot_write_now(w);
+		pthread_mutex_lock(&snapshot_write_mutex);
+		snapshot_write_busy = 0;
+
+		/* wake anyone waiting for the queue to empty */
+		pthread_cond_broadcast(&snapshot_write_cond);
+	}
+
+	return NULL;
+}
+
+static void snapshot_write_enqueue(char *path, struct rmsummary *freeze)
+{
+	struct snapshot_write *w = malloc(sizeof(*w));
+	w->path = path;
+	w->freeze = freeze;
+
+	pthread_mutex_lock(&snapshot_write_mutex);
+
+	if (!snapshot_write_thread_running) {
+		snapshot_write_queue = list_create();
+		if (pthread_create(&snapshot_write_thread, NULL, snapshot_write_main, NULL) == 0) {
+			snapshot_write_thread_running = 1;
+		}
+	}
+
+	if (snapshot_write_thread_running && list_size(snapshot_write_queue) < SNAPSHOT_QUEUE_MAX) {
+		list_push_tail(snapshot_write_queue, w);
+		pthread_cond_broadcast(&snapshot_write_cond);
+		pthread_mutex_unlock(&snapshot_write_mutex);
+		return;
+	}
+
+	pthread_mutex_unlock(&snapshot_write_mutex);
+
+	/* no thread, or queue full: write in place */
+	snapshot_write_now(w);
+}
+
+void snapshot_write_flush(void)
+{
+	if (!snapshot_write_thread_running)
+		return;
+
+	pthread_mutex_lock(&snapshot_write_mutex);
+	while (list_size(snapshot_write_queue) > 0 || snapshot_write_busy) {
+		pthread_cond_broadcast(&snapshot_write_cond);
+		pthread_cond_wait(&snapshot_write_cond, &snapshot_write_mutex);
+	}
+	pthread_mutex_unlock(&snapshot_write_mutex);
+}
+
 int record_snapshot(struct rmsummary *tr)
 {
 	if (list_size(snapshot_labels) < 1) {
@@ -1081,19 +1189,11 @@ int record_snapshot(struct rmsummary *tr)
 	freeze->snapshot_name = xxstrdup(buffer_tostring(&b));
 
 	char *output_file = string_format("%s.snapshot.%02ld", template_path, summary->snapshots_count);
-	FILE *snap_f = fopen(output_file, "w");
 
-	if (!snap_f) {
-		warn(D_RMON, "Could not save snapshots file '%s': %s", output_file, strerror(errno));
-	} else {
-		rmsummary_print(snap_f, freeze, 1, NULL);
-		fclose(snap_f);
-	}
+	snapshot_write_enqueue(output_file, rmsummary_copy(freeze, 1));
 
 	add_snapshot(freeze);
 
-	free(output_file);
-
 	debug(D_RMON, "Recoded snapshot: '%s'", buffer_tostring(&b));
 
 	buffer_free(&b);
@@ -1239,8 +1339,80 @@ void write_summary(int exited)
 	last_summary_write = timestamp_get();
 }
 
+/*
+The monitor accounts for itself: its own CPU time, peak memory, and
+context switches are appended to the summary as monitor_* fields, so
+"is monitoring cheap?" is answered by the summary it already writes.
+With --overhead-budget, the sampling interval adapts: when the
+monitor's recent CPU share of wall time exceeds the budget the
+interval doubles (up to one minute), and when it falls well under,
+the interval works back down to the configured value.
+*/
+
+static void monitor_self_usage(double *cpu_time, int64_t *memory_mb, int64_t *ctx_switches)
+{
+	struct rusage self;
+	getrusage(RUSAGE_SELF, &self);
+
+	*cpu_time = self.ru_utime.tv_sec + self.ru_stime.tv_sec + (self.ru_utime.tv_usec + self.ru_stime.tv_usec) / (double)ONE_SECOND;
+	*memory_mb = self.ru_maxrss / 1024;
+	*ctx_switches = self.ru_nvcsw + self.ru_nivcsw;
+}
+
+void rmonitor_adapt_interval()
+{
+	static double last_cpu = 0;
+	static uint64_t last_wall = 0;
+
+	if (overhead_budget <= 0)
+		return;
+
+	double cpu;
+	int64_t memory, ctx;
+	monitor_self_usage(&cpu, &memory, &ctx);
+
+	uint64_t now = usecs_since_epoch();
+	if (last_wall) {
+		double wall = (now - last_wall) / (double)ONE_SECOND;
+		double share = wall > 0 ? (cpu - last_cpu) / wall : 0;
+		if (share > overhead_budget && interval < 60) {
+			interval *= 2;
+			debug(D_RMON, "monitor overhead %.4f above budget %.4f, interval now %" PRIu64 "s", share, overhead_budget, interval);
+		} else if (share < overhead_budget / 4 && interval > interval_configured) {
+			interval /= 2;
+			debug(D_RMON, "monitor overhead %.4f well under budget, interval back to %" PRIu64 "s", share, interval);
+		}
+	}
+	last_cpu = cpu;
+	last_wall = now;
+}
+
+static void monitor_self_report(void)
+{
+	double cpu;
+	int64_t memory, ctx;
+	monitor_self_usage(&cpu, &memory, &ctx);
+
+	char *field = string_format("monitor_cpu_time: %lf s", cpu);
+	add_verbatim_field(field);
+	free(field);
+	field = string_format("monitor_memory: %" PRId64 " MB", memory);
+	add_verbatim_field(field);
+	free(field);
+	field = string_format("monitor_context_switches: %" PRId64, ctx);
+	add_verbatim_field(field);
+	free(field);
+	if (summary->wall_time > 0) {
+		field = string_format("monitor_overhead: %lf", cpu / summary->wall_time);
+		add_verbatim_field(field);
+		free(field);
+	}
+}
+
 int rmonitor_final_summary()
 {
+	monitor_self_report();
+
 	decode_zombie_status(summary, first_process_sigchild_status);
 
 	if (summary->wall_time > 0) {
@@ -1388,6 +1560,8 @@ void cleanup_zombie(struct rmonitor_process_info *p)
 	if (follow_chdir && p->wd)
 		dec_wd_count(p->wd);
 
+	rmonitor_poll_process_close(p);
+
 	itable_remove(processes, p->pid);
 	free(p);
 }
@@ -1624,6 +1798,8 @@ void rmonitor_final_cleanup()
 		lib_helper_extracted = 0;
 	}
 
+	snapshot_write_flush();
+
 	status = rmonitor_final_summary();
 
 	send_catalog_update(summary, 1);
@@ -1647,6 +1823,20 @@ void write_helper_lib(void)
 {
 	uint64_t n;
 
+	/* The embedded helper is identical across runs, so materialize it
+	through the per-user executable cache: second and later monitor
+	launches reuse the cached copy instead of rewriting it. */
+	char *cached_path = NULL;
+	int cached_fd = memfdexe_cached("librmonitor_helper.so", lib_helper_data, sizeof(lib_helper_data), &cached_path);
+	if (cached_fd >= 0) {
+		close(cached_fd);
+		if (cached_path) {
+			lib_helper_name = cached_path;
+			lib_helper_extracted = 0;
+			return;
+		}
+	}
+
 	lib_helper_name = xxstrdup("librmonitor_helper.so.XXXXXX");
 
 	if (access(lib_helper_name, R_OK | X_OK) == 0) {
@@ -1670,25 +1860,11 @@ void write_helper_lib(void)
 }
 
 /* return 1 if urgent message (wait, branch), 0 otherwise) */
-int rmonitor_dispatch_msg(void)
+int rmonitor_handle_msg(struct rmonitor_msg *msgp)
 {
-	struct rmonitor_msg msg;
+	struct rmonitor_msg msg = *msgp;
 	struct rmonitor_process_info *p;
 
-	int recv_status = recv_monitor_msg(rmonitor_queue_fd, &msg);
-
-	if (recv_status < 0) {
-		if (errno != EAGAIN) {
-			debug(D_RMON, "Error receiving message: %s", strerror(errno));
-			return 1;
-		}
-	}
-
-	if (((unsigned int)recv_status) < sizeof(msg)) {
-		debug(D_RMON, "Malformed message from monitored processes. Ignoring.");
-		return 1;
-	}
-
 	// Next line commented: Useful for detailed debugging, but too spammy for regular operations.
 	// debug(D_RMON,"message '%s' (%d) from %d with status '%s' (%d)\n", str_msgtype(msg.type), msg.type,
 	// msg.origin, strerror(msg.error), msg.error);
@@ -1824,6 +2000,32 @@ int rmonitor_dispatch_msg(void)
 	return 0;
 }
 
+int rmonitor_dispatch_msg(void)
+{
+	struct rmonitor_msg msg;
+
+	/* Drain the shared memory ring first, so that bookkeeping
+	published there is applied before any control message that
+	arrived on the socket after it. */
+	rmonitor_ring_drain(rmonitor_handle_msg);
+
+	int recv_status = recv_monitor_msg(rmonitor_queue_fd, &msg);
+
+	if (recv_status < 0) {
+		if (errno != EAGAIN) {
+			debug(D_RMON, "Error receiving message: %s", strerror(errno));
+			return 1;
+		}
+	}
+
+	if (((unsigned int)recv_status) < sizeof(msg)) {
+		debug(D_RMON, "Malformed message from monitored processes. Ignoring.");
+		return 1;
+	}
+
+	return rmonitor_handle_msg(&msg);
+}
+
 int wait_for_messages(int interval)
 {
 	struct timeval timeout;
@@ -1870,6 +2072,10 @@ int wait_for_messages(int interval)
 				timeout.tv_usec = 0;
 			}
 		} while (count > 0);
+
+		/* Bookkeeping in the shared memory ring does not wake the
+		socket, so drain whatever accumulated during the wait. */
+		rmonitor_ring_drain(rmonitor_handle_msg);
 	}
 
 	return 0;
@@ -2089,6 +2295,8 @@ int rmonitor_resources(long int interval /*in seconds */)
 		if (itable_size(processes) < 1)
 			break;
 
+		rmonitor_adapt_interval();
+
 		wait_for_messages(interval);
 
 		// if monitoring a static executable, this adds children missed by
@@ -2189,7 +2397,8 @@ int main(int argc, char **argv)
 		LONG_OPT_CATALOG_INTERVAL,
 		LONG_OPT_UPDATE_SUMMARY,
 		LONG_OPT_PID,
-		LONG_OPT_MEASURE_ONLY
+		LONG_OPT_MEASURE_ONLY,
+		LONG_OPT_OVERHEAD_BUDGET
 	};
 
 	static const struct option long_options[] = {/* Regular Options */
@@ -2198,6 +2407,7 @@ int main(int argc, char **argv)
 			{"help", required_argument, 0, 'h'},
 			{"version", no_argument, 0, 'v'},
 			{"interval", required_argument, 0, 'i'},
+			{"overhead-budget", required_argument, 0, LONG_OPT_OVERHEAD_BUDGET},
 			{"limits", required_argument, 0, 'L'},
 			{"limits-file", required_argument, 0, 'l'},
 			{"sh", required_argument, 0, 'c'},
@@ -2256,11 +2466,15 @@ int main(int argc, char **argv)
 			break;
 		case 'i':
 			interval = strtoll(optarg, NULL, 10);
+			interval_configured = interval;
 			if (interval < 1) {
 				debug(D_FATAL, "interval cannot be set to less than one second.");
 				exit(RM_MONITOR_ERROR);
 			}
 			break;
+		case LONG_OPT_OVERHEAD_BUDGET:
+			overhead_budget = atof(optarg);
+			break;
 		case 'l':
 			parse_limits_file(resources_limits, optarg);
 			break;
@@ -5,11 +5,14 @@
 */
 
 #include <errno.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/inotify.h>
 #include <sys/prctl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "buffer.h"
 #include "debug.h"
@@ -221,8 +224,105 @@ int request_snapshot(struct rmonitor_file_watch_info *f)
 	return status;
 }
 
+/*
+Waiting for changes is done with inotify on the file's directory,
+which reports creation, deletion, renames, and writes of the watched
+name, so a watch costs nothing between events instead of a stat per
+second.  Events are coalesced: once one arrives, the queue is drained
+before the state machine runs, so a burst of writes is one cycle and
+one snapshot.  If inotify is unavailable the old one-second polling
+cadence is kept, and even with inotify the wait times out at the same
+one second, so mtime-only edge cases are picked up no later than the
+polling loop would have.
+*/
+
+static int watch_change_fd(struct rmonitor_file_watch_info *f)
+{
+	int fd = inotify_init1(IN_CLOEXEC);
+	if (fd < 0) {
+		debug(D_RMON, "inotify unavailable for '%s', falling back to polling: %s", f->filename, strerror(errno));
+		return -1;
+	}
+
+	char *dir = xxstrdup(f->filename);
+	char *slash = strrchr(dir, '/');
+	if (slash) {
+		*slash = '\0';
+	} else {
+		free(dir);
+		dir = xxstrdup(".");
+	}
+
+	int wd = inotify_add_watch(fd, dir, IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB);
+	free(dir);
+
+	if (wd < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static void watch_wait_for_change(struct rmonitor_file_watch_info *f, int fd)
+{
+	char event_buffer[4096];
+	const char *base = strrchr(f->filename, '/');
+	base = base ? base + 1 : f->filename;
+
+	if (fd < 0) {
+		sleep(1);
+		return;
+	}
+
+	int relevant = 0;
+
+	while (!relevant) {
+		struct pollfd pfd = {.fd = fd, .events = POLLIN};
+		int n = poll(&pfd, 1, 1000);
+
+		if (n == 0) {
+			/* resample on the polling cadence anyway */
+			return;
+		}
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			sleep(1);
+			return;
+		}
+
+		ssize_t len = read(fd, event_buffer, sizeof(event_buffer));
+		if (len <= 0) {
+			sleep(1);
+			return;
+		}
+
+		ssize_t offset = 0;
+		while (offset < len) {
+			struct inotify_event *ev = (struct inotify_event *)&event_buffer[offset];
+			if ((ev->mask & IN_Q_OVERFLOW) || (ev->len > 0 && !strcmp(ev->name, base))) {
+				relevant = 1;
+			}
+			offset += sizeof(*ev) + ev->len;
+		}
+
+		if (relevant) {
+			/* coalesce the burst: drain whatever is already queued */
+			struct pollfd drain = {.fd = fd, .events = POLLIN};
+			while (poll(&drain, 1, 0) > 0) {
+				if (read(fd, event_buffer, sizeof(event_buffer)) <= 0)
+					break;
+			}
+			return;
+		}
+	}
+}
+
 void rmonitor_watch_file_aux(struct rmonitor_file_watch_info *f)
 {
+	int change_fd = watch_change_fd(f);
 
 	struct rmonitor_file_watch_event *e;
 	struct stat s;
@@ -338,7 +438,7 @@ void rmonitor_watch_file_aux(struct rmonitor_file_watch_info *f)
 			f->last_ino = 0;
 		}
 
-		sleep(1);
+		watch_wait_for_change(f, change_fd);
 	}
 }
 
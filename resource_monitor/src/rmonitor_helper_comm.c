@@ -16,6 +16,7 @@ See the file COPYING for details.
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <limits.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -232,6 +233,8 @@ int rmonitor_helper_init(char *lib_default_path, int *fd, int stop_short_running
 	}
 
 	if (port > 0) {
+		rmonitor_ring_server_create();
+
 		rmonitor_port = string_format("%d", port);
 
 		char *prev_ldpreload = getenv("LD_PRELOAD");
@@ -264,11 +267,222 @@ int rmonitor_helper_init(char *lib_default_path, int *fd, int stop_short_running
 	return port;
 }
 
+/*
+The ring is a Vyukov-style bounded multi-producer queue: every slot
+carries a sequence number that says which ring position may use it
+next.  A producer claims a position with a compare-and-swap on head,
+waits for the slot's sequence to reach that position, copies its
+message, and publishes by bumping the sequence; the single consumer
+reads in tail order and releases each slot one lap ahead.  Arbitrary
+monitored processes produce concurrently, so nothing here may block:
+a producer that finds the ring near full simply returns and the
+caller uses the socket instead.
+*/
+
+#define RMONITOR_RING_MAGIC 0x524d4f4e
+#define RMONITOR_RING_SLOTS 1024 /* power of two */
+
+struct rmonitor_ring_slot {
+	uint32_t seq;
+	struct rmonitor_msg msg;
+};
+
+struct rmonitor_ring {
+	uint32_t magic;
+	uint32_t slots;
+	uint32_t head;
+	uint32_t pad;
+	uint32_t tail;
+	struct rmonitor_ring_slot slot[];
+};
+
+static struct rmonitor_ring *ring_map = NULL;
+static char ring_name[NAME_MAX] = "";
+
+static size_t rmonitor_ring_bytes(void)
+{
+	return sizeof(struct rmonitor_ring) + RMONITOR_RING_SLOTS * sizeof(struct rmonitor_ring_slot);
+}
+
+static void rmonitor_ring_server_cleanup(void)
+{
+	if (ring_name[0]) {
+		shm_unlink(ring_name);
+	}
+}
+
+int rmonitor_ring_server_create(void)
+{
+	uint32_t i;
+
+	snprintf(ring_name, sizeof(ring_name), "/cctools-rmonitor-%d", getpid());
+
+	int fd = shm_open(ring_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0) {
+		debug(D_RMON, "couldn't create shared memory ring: %s\n", strerror(errno));
+		ring_name[0] = '\0';
+		return -1;
+	}
+
+	if (ftruncate(fd, rmonitor_ring_bytes()) < 0) {
+		close(fd);
+		shm_unlink(ring_name);
+		ring_name[0] = '\0';
+		return -1;
+	}
+
+	ring_map = mmap(NULL, rmonitor_ring_bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (ring_map == MAP_FAILED) {
+		ring_map = NULL;
+		shm_unlink(ring_name);
+		ring_name[0] = '\0';
+		return -1;
+	}
+
+	ring_map->slots = RMONITOR_RING_SLOTS;
+	ring_map->head = 0;
+	ring_map->tail = 0;
+	for (i = 0; i < RMONITOR_RING_SLOTS; i++) {
+		ring_map->slot[i].seq = i;
+	}
+	__atomic_store_n(&ring_map->magic, RMONITOR_RING_MAGIC, __ATOMIC_RELEASE);
+
+	setenv(RESOURCE_MONITOR_SHM_ENV_VAR, ring_name, 1);
+	atexit(rmonitor_ring_server_cleanup);
+
+	debug(D_RMON, "shared memory ring open at %s\n", ring_name);
+
+	return 0;
+}
+
+static struct rmonitor_ring *rmonitor_ring_client(void)
+{
+	static int tried = 0;
+
+	if (ring_map)
+		return ring_map;
+
+	if (tried)
+		return NULL;
+	tried = 1;
+
+	const char *name = getenv(RESOURCE_MONITOR_SHM_ENV_VAR);
+	if (!name)
+		return NULL;
+
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+		return NULL;
+
+	struct rmonitor_ring *r = mmap(NULL, rmonitor_ring_bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (r == MAP_FAILED)
+		return NULL;
+
+	if (__atomic_load_n(&r->magic, __ATOMIC_ACQUIRE) != RMONITOR_RING_MAGIC || r->slots != RMONITOR_RING_SLOTS) {
+		munmap(r, rmonitor_ring_bytes());
+		return NULL;
+	}
+
+	ring_map = r;
+	return ring_map;
+}
+
+static int rmonitor_ring_push(struct rmonitor_ring *r, struct rmonitor_msg *msg)
+{
+	int tries = 16;
+
+	while (tries-- > 0) {
+		uint32_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+		uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+		/* leave headroom so claimed slots are always writable */
+		if (head - tail >= r->slots - 64)
+			return 0;
+
+		if (!__atomic_compare_exchange_n(&r->head, &head, head + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			continue;
+
+		struct rmonitor_ring_slot *s = &r->slot[head & (r->slots - 1)];
+
+		int spins = 1000000;
+		while (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != head && spins-- > 0)
+			;
+		if (spins <= 0)
+			return 0;
+
+		memcpy(&s->msg, msg, sizeof(*msg));
+		__atomic_store_n(&s->seq, head + 1, __ATOMIC_RELEASE);
+
+		return 1;
+	}
+
+	return 0;
+}
+
+int rmonitor_ring_drain(int (*handler)(struct rmonitor_msg *msg))
+{
+	struct rmonitor_ring *r = ring_map;
+	int count = 0;
+
+	if (!r)
+		return 0;
+
+	while (1) {
+		uint32_t tail = r->tail;
+		struct rmonitor_ring_slot *s = &r->slot[tail & (r->slots - 1)];
+
+		if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != tail + 1)
+			break;
+
+		struct rmonitor_msg msg;
+		memcpy(&msg, &s->msg, sizeof(msg));
+
+		/* release the slot for the lap after next before handling */
+		__atomic_store_n(&s->seq, tail + r->slots, __ATOMIC_RELEASE);
+		__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+
+		handler(&msg);
+		count++;
+	}
+
+	return count;
+}
+
+/* Only the high-rate bookkeeping messages ride the ring; anything
+that stops or ends a process must wake the monitor promptly through
+the socket. */
+static int rmonitor_msg_takes_ring(enum rmonitor_msg_type type)
+{
+	switch (type) {
+	case CHDIR:
+	case OPEN_INPUT:
+	case OPEN_OUTPUT:
+	case READ:
+	case WRITE:
+	case RX:
+	case TX:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 int send_monitor_msg(struct rmonitor_msg *msg)
 {
 	static int fd = -1;
 	static struct addrinfo *addr = NULL;
 
+	if (rmonitor_msg_takes_ring(msg->type)) {
+		struct rmonitor_ring *r = rmonitor_ring_client();
+		if (r && rmonitor_ring_push(r, msg)) {
+			return sizeof(struct rmonitor_msg);
+		}
+	}
+
 	if (fd < 0) {
 		int status = rmonitor_client_open_socket(&fd, &addr);
 		if (status < 0) {
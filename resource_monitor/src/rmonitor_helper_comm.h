@@ -15,6 +15,7 @@ See the file COPYING for details.
 #define RESOURCE_MONITOR_ROOT_PROCESS      "CCTOOLS_RESOURCE_ROOT_PROCESS"
 #define RESOURCE_MONITOR_PROCESS_START     "CCTOOLS_RESOURCE_PROCESS_START"
 #define RESOURCE_MONITOR_INFO_ENV_VAR      "CCTOOLS_RESOURCE_MONITOR_INFO"
+#define RESOURCE_MONITOR_SHM_ENV_VAR       "CCTOOLS_RESOURCE_MONITOR_SHM"
 
 // in useconds
 #define RESOURCE_MONITOR_SHORT_TIME      250000
@@ -54,4 +55,18 @@ const char *str_msgtype(enum rmonitor_msg_type n);
 int send_monitor_msg(struct rmonitor_msg *msg);
 int recv_monitor_msg(int fd, struct rmonitor_msg *msg);
 
+/*
+Shared-memory fast channel.  The monitor creates a ring of message
+slots in posix shared memory and advertises its name through the
+environment; helpers then publish the high-rate bookkeeping messages
+(opens, io counts, chdir) there with two atomic operations instead of
+a sendto per intercepted call.  Control messages that stop or end a
+process stay on the socket, and the helper falls back to the socket
+whenever the ring is absent or momentarily full, so the channel is an
+optimization, never a requirement.
+*/
+
+int rmonitor_ring_server_create(void);
+int rmonitor_ring_drain(int (*handler)(struct rmonitor_msg *msg));
+
 #endif
@@ -885,6 +885,53 @@ class Manager(object):
             self._task_table[task_id] = task
             return task_id
 
+    ##
+    # Submit many tasks in one call.
+    #
+    # The underlying submissions cross the binding boundary once for
+    # the whole batch rather than once per task, which matters when
+    # submitting very large workloads from Python.
+    #
+    # @param self   Reference to the current manager object.
+    # @param tasks  An iterable of task descriptions.
+    # @return The list of assigned task ids.
+    def submit_list(self, tasks):
+        tasks = list(tasks)
+        for task in tasks:
+            task.manager = self
+            task.submit_finalize()
+        task_ids = cvine.vine_submit_pylist(self._taskvine, [t._task for t in tasks])
+        for (task, task_id) in zip(tasks, task_ids):
+            if task_id == 0:
+                raise ValueError("invalid task description")
+            self._task_table[task_id] = task
+        return task_ids
+
+    ##
+    # Wait for a batch of tasks in one call.
+    #
+    # Blocks up to timeout for the first completion, then collects
+    # every task that has already completed without waiting further,
+    # so retrieving the results of a large workload costs one binding
+    # crossing per batch instead of one per task.
+    #
+    # @param self      Reference to the current manager object.
+    # @param timeout   Seconds to wait for the first completion, or "wait_forever".
+    # @param max_tasks Collect at most this many tasks, or 0 for no limit.
+    # @return A list of completed tasks, possibly empty.
+    def wait_batch(self, timeout="wait_forever", max_tasks=0):
+        if timeout == "wait_forever":
+            timeout = get_c_constant("wait_forever")
+        self._update_status_display()
+        completed = []
+        for task_id in cvine.vine_wait_batch(self._taskvine, timeout, max_tasks):
+            task = self._task_table.pop(task_id, None)
+            if task:
+                completed.append(task)
+        if completed and self.empty():
+            self._update_status_display(force=True)
+        return completed
+
     ##
     # Submit a library to install on all connected workers
     #
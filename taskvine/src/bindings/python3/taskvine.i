@@ -66,6 +66,56 @@ into a swig function f(data) */
     }
 %}
 
+/*
+Batched boundary crossings: submitting or collecting many tasks one
+swig call at a time spends more time marshalling than the manager
+spends scheduling.  These helpers cross the boundary once per batch:
+the submit variant walks a Python sequence of Task capsules in C, and
+the wait variant blocks once then drains every already-completed task
+without further waiting, returning the completed ids for the Python
+side to map through its task table.
+*/
+%inline %{
+    PyObject *vine_submit_pylist(struct vine_manager *m, PyObject *seq) {
+        PyObject *ids = PyList_New(0);
+        if (!ids) return NULL;
+        PyObject *iter = PyObject_GetIter(seq);
+        if (!iter) { Py_DECREF(ids); return NULL; }
+        PyObject *item;
+        while ((item = PyIter_Next(iter))) {
+            void *ptr = 0;
+            int ok = SWIG_ConvertPtr(item, &ptr, SWIGTYPE_p_vine_task, 0);
+            Py_DECREF(item);
+            if (!SWIG_IsOK(ok) || !ptr) {
+                Py_DECREF(iter); Py_DECREF(ids);
+                PyErr_SetString(PyExc_TypeError, "vine_submit_pylist expects vine_task pointers");
+                return NULL;
+            }
+            int task_id = vine_submit(m, (struct vine_task *)ptr);
+            PyObject *pid = PyLong_FromLong(task_id);
+            PyList_Append(ids, pid);
+            Py_DECREF(pid);
+        }
+        Py_DECREF(iter);
+        return ids;
+    }
+
+    PyObject *vine_wait_batch(struct vine_manager *m, int timeout, int max_tasks) {
+        PyObject *ids = PyList_New(0);
+        if (!ids) return NULL;
+        struct vine_task *t = vine_wait(m, timeout);
+        while (t) {
+            PyObject *pid = PyLong_FromLong(vine_task_get_id(t));
+            PyList_Append(ids, pid);
+            Py_DECREF(pid);
+            if (max_tasks > 0 && PyList_Size(ids) >= max_tasks)
+                break;
+            t = vine_wait(m, 0);
+        }
+        return ids;
+    }
+%}
+
 %include "stdint.i"
 %include "int_sizes.h"
 %include "taskvine.h"
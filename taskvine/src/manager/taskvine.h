@@ -282,6 +282,18 @@ re-used afterward.
 */
 void vine_task_set_command(struct vine_task *t, const char *cmd);
 
+/** Create a task instance from a template task.
+The template is an ordinary task that is never submitted itself;
+instances share its file objects by reference and override the command
+line, with further per-instance changes applied through the usual
+setters.  Intended for workloads submitting millions of tasks that
+differ only in arguments and one input.
+@param template_task The task serving as the template.
+@param command_line The instance's command line, or null to keep the template's.
+@return A new task to be submitted with @ref vine_submit.
+*/
+struct vine_task *vine_task_create_from_template( struct vine_task *template_task, const char *command_line );
+
 /** Set the library name required by this task.
 @param t A task object.
 @param name The name of the library coprocess name that will be used by this task.
@@ -973,6 +985,18 @@ description.
 */
 int vine_submit(struct vine_manager *m, struct vine_task *t);
 
+/** Submit a list of tasks in one call.
+Every task in the list is submitted as by @ref vine_submit, with the
+per-call bookkeeping amortized across the batch, which matters when
+handing over hundreds of thousands of tasks at once from a binding.
+Shared input files are interned once through the usual declaration
+table.  The list itself is not consumed.
+@param m A manager object.
+@param tasks A list of tasks returned by @ref vine_task_create.
+@return The number of tasks successfully submitted; each submitted task's id is available via @ref vine_task_get_id.
+*/
+int vine_submit_list(struct vine_manager *m, struct list *tasks);
+
 /** Indicate the library to be installed on all workers connected to the manager.
 The library is expected to run on all workers until they disconnect from the manager.
 @param m A manager object
@@ -7,6 +7,7 @@ See the file COPYING for details.
 #include "vine_checksum.h"
 
 #include "debug.h"
+#include "hash_table.h"
 #include "md5.h"
 #include "sort_dir.h"
 #include "string_array.h"
@@ -68,11 +69,47 @@ static char *vine_checksum_dir(const char *path, ssize_t *totalsize)
 	return result;
 }
 
+/*
+Checksums of unchanged files are remembered across calls, keyed by the
+file's identity and stamp (device, inode, mtime, size), so declaring
+the same large dataset across runs of a workflow hashes each file only
+once.  A changed file gets a different stamp and is rehashed.
+*/
+
+static struct hash_table *checksum_cache = 0;
+
+static char *checksum_cache_stamp(const char *path, const struct stat *info)
+{
+	return string_format("%s:%lld:%lld:%lld:%lld", path, (long long)info->st_dev, (long long)info->st_ino, (long long)info->st_mtime, (long long)info->st_size);
+}
+
 static char *vine_checksum_file(const char *path)
 {
+	struct stat info;
+	char *stamp = 0;
+
+	if (!checksum_cache)
+		checksum_cache = hash_table_create(0, 0);
+
+	if (stat(path, &info) == 0) {
+		stamp = checksum_cache_stamp(path, &info);
+		char *cached = hash_table_lookup(checksum_cache, stamp);
+		if (cached) {
+			free(stamp);
+			return xxstrdup(cached);
+		}
+	}
+
 	unsigned char digest[MD5_DIGEST_LENGTH];
 	md5_file(path, digest);
-	return xxstrdup(md5_to_string(digest));
+	char *result = xxstrdup(md5_to_string(digest));
+
+	if (stamp) {
+		hash_table_insert(checksum_cache, stamp, xxstrdup(result));
+		free(stamp);
+	}
+
+	return result;
 }
 
 static char *vine_checksum_symlink(const char *path, ssize_t linklength)
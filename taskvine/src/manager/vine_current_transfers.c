@@ -10,6 +10,8 @@ See the file COPYING for details.
 #include "vine_manager.h"
 #include "xxmalloc.h"
 
+static void transfer_count_adjust(struct itable *counts, struct vine_worker_info *w, int delta);
+
 #include "debug.h"
 
 struct vine_transfer_pair {
@@ -45,15 +47,32 @@ char *vine_current_transfers_add(struct vine_manager *q, struct vine_worker_info
 	struct vine_transfer_pair *t = vine_transfer_pair_create(to, source_worker, source_url);
 
 	hash_table_insert(q->current_transfer_table, transfer_id, t);
+	transfer_count_adjust(q->transfer_source_counts, source_worker, 1);
+	transfer_count_adjust(q->transfer_dest_counts, to, 1);
 	return transfer_id;
 }
 
+/* Maintain the per-worker in-flight counters alongside the transfer table. */
+
+static void transfer_count_adjust(struct itable *counts, struct vine_worker_info *w, int delta)
+{
+	if (!w)
+		return;
+	intptr_t c = (intptr_t)itable_remove(counts, (uintptr_t)w);
+	c += delta;
+	if (c > 0) {
+		itable_insert(counts, (uintptr_t)w, (void *)c);
+	}
+}
+
 // remove a completed transaction from the transfer table - i.e. open the source to an additional transfer
 int vine_current_transfers_remove(struct vine_manager *q, const char *id)
 {
 	struct vine_transfer_pair *p;
 	p = hash_table_remove(q->current_transfer_table, id);
 	if (p) {
+		transfer_count_adjust(q->transfer_source_counts, p->source_worker, -1);
+		transfer_count_adjust(q->transfer_dest_counts, p->to, -1);
 		vine_transfer_pair_delete(p);
 		return 1;
 	} else {
@@ -136,7 +155,7 @@ int vine_current_transfers_set_failure(struct vine_manager *q, char *id)
 	return throttled;
 }
 
-void vine_current_transfers_set_success(struct vine_manager *q, char *id)
+void vine_current_transfers_set_success(struct vine_manager *q, const char *id)
 {
 	struct vine_transfer_pair *p = hash_table_lookup(q->current_transfer_table, id);
 
@@ -164,15 +183,8 @@ void vine_current_transfers_set_success(struct vine_manager *q, char *id)
 // count the number transfers coming from a specific source
 int vine_current_transfers_source_in_use(struct vine_manager *q, struct vine_worker_info *source_worker)
 {
-	char *id;
-	struct vine_transfer_pair *t;
-	int c = 0;
-	HASH_TABLE_ITERATE(q->current_transfer_table, id, t)
-	{
-		if (source_worker == t->source_worker)
-			c++;
-	}
-	return c;
+	/* maintained incrementally at add and remove, so this is O(1) */
+	return (intptr_t)itable_lookup(q->transfer_source_counts, (uintptr_t)source_worker);
 }
 
 // count the number transfers coming from a specific remote url (not a worker)
@@ -192,15 +204,8 @@ int vine_current_transfers_url_in_use(struct vine_manager *q, const char *source
 // count the number of ongoing transfers to a specific worker
 int vine_current_transfers_dest_in_use(struct vine_manager *q, struct vine_worker_info *w)
 {
-	char *id;
-	struct vine_transfer_pair *t;
-	int c = 0;
-	HASH_TABLE_ITERATE(q->current_transfer_table, id, t)
-	{
-		if (t->to == w)
-			c++;
-	}
-	return c;
+	/* maintained incrementally at add and remove, so this is O(1) */
+	return (intptr_t)itable_lookup(q->transfer_dest_counts, (uintptr_t)w);
 }
 
 // remove all transactions involving a worker from the transfer table - if a worker failed or is being deleted
@@ -247,6 +252,8 @@ void vine_current_transfers_print_table(struct vine_manager *q)
 
 void vine_current_transfers_clear(struct vine_manager *q)
 {
+	itable_clear(q->transfer_source_counts, 0);
+	itable_clear(q->transfer_dest_counts, 0);
 	hash_table_clear(q->current_transfer_table, (void *)vine_transfer_pair_delete);
 }
 
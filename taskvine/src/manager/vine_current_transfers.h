@@ -16,7 +16,7 @@ int vine_current_transfers_remove(struct vine_manager *q, const char *id);
 
 int vine_current_transfers_set_failure(struct vine_manager *q, char *id);
 
-void vine_current_transfers_set_success(struct vine_manager *q, char *id);
+void vine_current_transfers_set_success(struct vine_manager *q, const char *id);
 
 int vine_current_transfers_source_in_use(struct vine_manager *q, struct vine_worker_info *source);
 
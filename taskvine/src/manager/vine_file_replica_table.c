@@ -17,6 +17,7 @@ See the file COPYING for details.
 #include "vine_worker_info.h"
 
 #include "stringtools.h"
+#include "xxmalloc.h"
 
 #include "debug.h"
 #include "macros.h"
@@ -41,6 +42,9 @@ int vine_file_replica_table_insert(struct vine_manager *m, struct vine_worker_in
 
 	set_insert(workers, w);
 
+	/* Any task parked on this file can be scheduled now. */
+	vine_manager_wake_tasks_waiting_on_file(m, cachename);
+
 	return 1;
 }
 
@@ -78,28 +82,72 @@ struct vine_file_replica *vine_file_replica_table_lookup(struct vine_worker_info
 }
 
 // find a worker (randomly) in posession of a specific file, and is ready to transfer it.
-struct vine_worker_info *vine_file_replica_table_find_worker(struct vine_manager *q, const char *cachename)
+/*
+An optional host-to-zone map, named by the VINE_LOCALITY_MAP
+environment variable with one "hostname zone" pair per line, lets the
+source chooser prefer peers in the same zone (rack, pod, site) as the
+destination, so broadcast traffic stays off the spine links.
+*/
+
+static struct hash_table *locality_zones = 0;
+static int locality_loaded = 0;
+
+static const char *worker_zone(struct vine_worker_info *w)
+{
+	if (!locality_loaded) {
+		locality_loaded = 1;
+		const char *path = getenv("VINE_LOCALITY_MAP");
+		if (path) {
+			FILE *map = fopen(path, "r");
+			if (map) {
+				char host[256], zone[256];
+				locality_zones = hash_table_create(0, 0);
+				while (fscanf(map, "%255s %255s", host, zone) == 2) {
+					hash_table_insert(locality_zones, host, xxstrdup(zone));
+				}
+				fclose(map);
+			}
+		}
+	}
+
+	if (!locality_zones || !w) {
+		return 0;
+	}
+
+	return hash_table_lookup(locality_zones, w->hostname);
+}
+
+/*
+Choose a source holding the file for a transfer to the given
+destination (which may be null when the manager itself fetches).
+Among sources within their concurrency budget, one in the same zone
+as the destination always beats one elsewhere, and the least-loaded
+wins within a zone class, so no single holder is picked by fifty
+peers at once.
+*/
+
+struct vine_worker_info *vine_file_replica_table_find_worker_for(struct vine_manager *q, const char *cachename, struct vine_worker_info *dest)
 {
 	struct set *workers = hash_table_lookup(q->file_worker_table, cachename);
 	if (!workers) {
 		return 0;
 	}
 
-	int total_count = set_size(workers);
-	if (total_count < 1) {
+	if (set_size(workers) < 1) {
 		return 0;
 	}
 
-	int random_index = random() % total_count;
+	const char *dest_zone = worker_zone(dest);
 
 	struct vine_worker_info *peer = NULL;
 	struct vine_worker_info *peer_selected = NULL;
+	int selected_same_zone = 0;
+	int selected_load = 0;
 	struct vine_file_replica *replica = NULL;
 
 	int offset_bookkeep;
 	SET_ITERATE_RANDOM_START(workers, offset_bookkeep, peer)
 	{
-		random_index--;
 		if (!peer->transfer_port_active)
 			continue;
 
@@ -110,12 +158,20 @@ struct vine_worker_info *vine_file_replica_table_find_worker(struct vine_manager
 		}
 
 		if ((replica = hash_table_lookup(peer->current_files, cachename)) && replica->state == VINE_FILE_REPLICA_STATE_READY) {
-			int current_transfers = vine_current_transfers_source_in_use(q, peer);
-			if (current_transfers < q->worker_source_max_transfers) {
+			int load = vine_current_transfers_source_in_use(q, peer);
+			if (load >= q->worker_source_max_transfers)
+				continue;
+
+			int same_zone = 0;
+			if (dest_zone) {
+				const char *peer_zone = worker_zone(peer);
+				same_zone = peer_zone && !strcmp(peer_zone, dest_zone);
+			}
+
+			if (!peer_selected || same_zone > selected_same_zone || (same_zone == selected_same_zone && load < selected_load)) {
 				peer_selected = peer;
-				if (random_index < 0) {
-					return peer_selected;
-				}
+				selected_same_zone = same_zone;
+				selected_load = load;
 			}
 		}
 	}
@@ -123,6 +179,11 @@ struct vine_worker_info *vine_file_replica_table_find_worker(struct vine_manager
 	return peer_selected;
 }
 
+struct vine_worker_info *vine_file_replica_table_find_worker(struct vine_manager *q, const char *cachename)
+{
+	return vine_file_replica_table_find_worker_for(q, cachename, 0);
+}
+
 // trigger replications of file to satisfy temp_replica_count
 int vine_file_replica_table_replicate(struct vine_manager *m, struct vine_file *f)
 {
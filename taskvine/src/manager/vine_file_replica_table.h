@@ -27,6 +27,12 @@ struct vine_file_replica *vine_file_replica_table_lookup(struct vine_worker_info
 
 struct vine_worker_info *vine_file_replica_table_find_worker(struct vine_manager *q, const char *cachename);
 
+/* Like vine_file_replica_table_find_worker, but choosing the best source
+for a transfer to the given destination: same-zone sources (per the
+VINE_LOCALITY_MAP host-to-zone file) are preferred, and the least
+loaded source wins among peers of the same class. */
+struct vine_worker_info *vine_file_replica_table_find_worker_for(struct vine_manager *q, const char *cachename, struct vine_worker_info *dest);
+
 int vine_file_replica_table_replicate(struct vine_manager *q, struct vine_file *f);
 
 int vine_file_replica_table_exists_somewhere( struct vine_manager *q, const char *cachename );
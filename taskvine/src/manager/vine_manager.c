@@ -7,6 +7,7 @@ See the file COPYING for details.
 #include "vine_manager.h"
 #include "vine_blocklist.h"
 #include "vine_counters.h"
+#include "stats.h"
 #include "vine_current_transfers.h"
 #include "vine_factory_info.h"
 #include "vine_fair.h"
@@ -46,6 +47,14 @@ See the file COPYING for details.
 #include "jx_parse.h"
 #include "jx_print.h"
 #include "link.h"
+#include "link_event.h"
+#include "priority_queue.h"
+#include "jx_binary.h"
+#include "md5.h"
+#include "cctools_endian.h"
+
+/* Maximum number of tasks dispatched per scheduling wakeup. */
+#define VINE_TASK_DISPATCH_BURST 16
 #include "link_auth.h"
 #include "list.h"
 #include "load_average.h"
@@ -68,6 +77,7 @@ See the file COPYING for details.
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <float.h>
 #include <fcntl.h>
 #include <math.h>
 #include <stdarg.h>
@@ -130,6 +140,64 @@ static vine_result_code_t retrieve_output(struct vine_manager *q, struct vine_wo
 static void find_max_worker(struct vine_manager *q);
 static void update_max_worker(struct vine_manager *q, struct vine_worker_info *w);
 
+/*
+Optional result memoization: a task is identified by its command, its
+input objects, and its output names; when an identical task completed
+before and its outputs are the very same declared objects (still
+recorded as created in the file table), the resubmission completes
+immediately from the recorded exit status instead of re-executing.
+*/
+
+struct vine_task_memo {
+	vine_result_code_t dummy; /* unused, reserves room for growth */
+	int exit_code;
+	int result;
+};
+
+static char *vine_task_memo_key(struct vine_task *t)
+{
+	buffer_t B;
+	buffer_init(&B);
+	buffer_putstring(&B, t->command_line ? t->command_line : "");
+
+	struct vine_mount *m;
+	LIST_ITERATE(t->input_mounts, m)
+	{
+		buffer_putfstring(&B, "|i:%s=%s", m->remote_name, m->file->cached_name);
+	}
+	LIST_ITERATE(t->output_mounts, m)
+	{
+		buffer_putfstring(&B, "|o:%s=%s", m->remote_name, m->file->cached_name);
+	}
+
+	/* the environment shapes the command's behavior just as the
+	command line does, so it is part of the identity */
+	char *env;
+	LIST_ITERATE(t->env_list, env)
+	{
+		buffer_putfstring(&B, "|e:%s", env);
+	}
+
+	char *key = md5_of_string(buffer_tostring(&B));
+	buffer_free(&B);
+	return key;
+}
+
+/* True if every output object of the task is already recorded as created. */
+
+static int vine_task_outputs_exist(struct vine_manager *q, struct vine_task *t)
+{
+	struct vine_mount *m;
+	LIST_ITERATE(t->output_mounts, m)
+	{
+		struct vine_file *f = hash_table_lookup(q->file_table, m->file->cached_name);
+		if (!f || f->state != VINE_FILE_STATE_CREATED) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
 static vine_task_state_t change_task_state(struct vine_manager *q, struct vine_task *t, vine_task_state_t new_state);
 
 static int task_state_count(struct vine_manager *q, const char *category, vine_task_state_t state);
@@ -154,6 +222,10 @@ void vine_disable_monitoring(struct vine_manager *q);
 static void aggregate_workers_resources(
 		struct vine_manager *q, struct vine_resources *rtotal, struct vine_resources *rmin, struct vine_resources *rmax, int64_t *inuse_cache, struct hash_table *features);
 static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout, const char *tag, int task_id);
+static double vine_task_priority(void *item);
+static void count_pending_consumers(struct vine_manager *q, struct vine_task *t);
+static void uncount_pending_consumers(struct vine_manager *q, struct vine_task *t);
+void vine_manager_warm_libraries(struct vine_manager *q, struct vine_worker_info *w);
 static void release_all_workers(struct vine_manager *q);
 
 static int vine_manager_check_inputs_available(struct vine_manager *q, struct vine_task *t);
@@ -164,6 +236,43 @@ static int delete_worker_file(struct vine_manager *q, struct vine_worker_info *w
 
 struct vine_task *send_library_to_worker(struct vine_manager *q, struct vine_worker_info *w, const char *name, vine_result_code_t *result);
 
+/*
+Warm the function-execution pool: start instances of each installed
+library on the worker before the first function call needs them, so
+sub-second serverless tasks never wait out a cold import.  Enabled by
+tuning library-warm-instances to the desired per-worker count.
+*/
+
+void vine_manager_warm_libraries(struct vine_manager *q, struct vine_worker_info *w)
+{
+	if (q->library_warm_instances < 1)
+		return;
+
+	char *name;
+	struct vine_task *template_task;
+
+	HASH_TABLE_ITERATE(q->library_templates, name, template_task)
+	{
+		int have = 0;
+		uint64_t task_id;
+		struct vine_task *t;
+		ITABLE_ITERATE(w->current_tasks, task_id, t)
+		{
+			if (t->provides_library && !strcmp(t->provides_library, name)) {
+				have++;
+			}
+		}
+
+		while (have < q->library_warm_instances) {
+			vine_result_code_t result;
+			struct vine_task *instance = send_library_to_worker(q, w, name, &result);
+			if (!instance)
+				break;
+			have++;
+		}
+	}
+}
+
 /* Return the number of workers matching a given type: WORKER, STATUS, etc */
 
 static int count_workers(struct vine_manager *q, vine_worker_type_t type)
@@ -251,6 +360,46 @@ __attribute__((format(printf, 3, 4))) int vine_manager_send(struct vine_manager
 	return result;
 }
 
+/*
+Send a manager-to-worker message with an attached binary payload using
+one gathered write, so the header and payload share a system call and,
+typically, a TCP segment.  The stoptime is supplied by the caller since
+payload transfers are budgeted by size rather than by short_timeout.
+*/
+
+__attribute__((format(printf, 6, 7))) int vine_manager_send_with_payload(struct vine_manager *q, struct vine_worker_info *w, const char *payload, size_t length, time_t stoptime, const char *fmt, ...)
+{
+	va_list va;
+	buffer_t B[1];
+	buffer_init(B);
+	buffer_abortonfailure(B, 1);
+	buffer_max(B, VINE_LINE_MAX);
+
+	va_start(va, fmt);
+	buffer_putvfstring(B, fmt, va);
+	va_end(va);
+
+	debug(D_VINE, "tx to %s (%s): %s", w->hostname, w->addrport, buffer_tostring(B));
+
+	size_t header_length = buffer_pos(B);
+
+	struct iovec iov[2];
+	iov[0].iov_base = (void *)buffer_tostring(B);
+	iov[0].iov_len = header_length;
+	iov[1].iov_base = (void *)payload;
+	iov[1].iov_len = length;
+
+	ssize_t result = link_writev(w->link, iov, 2, stoptime);
+
+	buffer_free(B);
+
+	if (result != (ssize_t)(header_length + length)) {
+		return -1;
+	}
+
+	return length;
+}
+
 /* Handle a name message coming back from the worker, requesting the manager's project name. */
 
 static vine_msg_code_t handle_name(struct vine_manager *q, struct vine_worker_info *w, char *line)
@@ -331,18 +480,9 @@ remote transfer or command was successful, and know we know the size
 of the file for the purposes of cache storage management.
 */
 
-static int handle_cache_update(struct vine_manager *q, struct vine_worker_info *w, const char *line)
+static int handle_cache_update_values(struct vine_manager *q, struct vine_worker_info *w, const char *cachename, int type, int cache_level, long long size, long long mtime, long long transfer_time, long long start_time, const char *id)
 {
-	char cachename[VINE_LINE_MAX];
-	int type;
-	int cache_level;
-	long long size;
-	long long mtime;
-	long long transfer_time;
-	long long start_time;
-	char id[VINE_LINE_MAX];
-
-	if (sscanf(line, "cache-update %s %d %d %lld %lld %lld %lld %s", cachename, &type, &cache_level, &size, &mtime, &transfer_time, &start_time, id) == 8) {
+	{
 		struct vine_file_replica *replica = vine_file_replica_table_lookup(w, cachename);
 
 		if (!replica) {
@@ -377,6 +517,9 @@ static int handle_cache_update(struct vine_manager *q, struct vine_worker_info *
 			f->state = VINE_FILE_STATE_CREATED;
 			f->size = size;
 
+			/* Dependents parked on this file can run now. */
+			vine_manager_wake_tasks_waiting_on_file(q, cachename);
+
 			/* And if the file is a newly created temporary, replicate as needed. */
 			if (f->type == VINE_TEMP && *id == 'X' && q->temp_replica_count > 1) {
 				hash_table_insert(q->temp_files_to_replicate, f->cached_name, NULL);
@@ -387,6 +530,79 @@ static int handle_cache_update(struct vine_manager *q, struct vine_worker_info *
 	return VINE_MSG_PROCESSED;
 }
 
+static int handle_cache_update(struct vine_manager *q, struct vine_worker_info *w, const char *line)
+{
+	char cachename[VINE_LINE_MAX];
+	int type;
+	int cache_level;
+	long long size;
+	long long mtime;
+	long long transfer_time;
+	long long start_time;
+	char id[VINE_LINE_MAX];
+
+	if (sscanf(line, "cache-update %s %d %d %lld %lld %lld %lld %s", cachename, &type, &cache_level, &size, &mtime, &transfer_time, &start_time, id) == 8) {
+		return handle_cache_update_values(q, w, cachename, type, cache_level, size, mtime, transfer_time, start_time, id);
+	}
+
+	return VINE_MSG_PROCESSED;
+}
+
+/*
+Read and dispatch one binary frame, whose start byte has already been
+consumed.  Frames carry the same information as their text equivalents
+with no formatting or parsing on either side.
+*/
+
+static vine_msg_code_t handle_frame(struct vine_manager *q, struct vine_worker_info *w, time_t stoptime)
+{
+	unsigned char header[39];
+
+	/* frame type plus the cache-update fixed header */
+	if (link_read(w->link, (char *)header, 1, stoptime) != 1)
+		return VINE_MSG_FAILURE;
+
+	switch (header[0]) {
+	case VINE_FRAME_CACHE_UPDATE: {
+		if (link_read(w->link, (char *)header + 1, 38, stoptime) != 38)
+			return VINE_MSG_FAILURE;
+
+		int type = header[1];
+		int cache_level = header[2];
+		uint64_t nsize, nmtime, ntransfer, nstart;
+		uint16_t nname, nid;
+		memcpy(&nsize, &header[3], 8);
+		memcpy(&nmtime, &header[11], 8);
+		memcpy(&ntransfer, &header[19], 8);
+		memcpy(&nstart, &header[27], 8);
+		memcpy(&nname, &header[35], 2);
+		memcpy(&nid, &header[37], 2);
+
+		int name_length = ntohs(nname);
+		int id_length = ntohs(nid);
+		if (name_length < 1 || name_length >= VINE_LINE_MAX || id_length < 1 || id_length >= VINE_LINE_MAX)
+			return VINE_MSG_FAILURE;
+
+		char cachename[VINE_LINE_MAX];
+		char id[VINE_LINE_MAX];
+		if (link_read(w->link, cachename, name_length, stoptime) != name_length)
+			return VINE_MSG_FAILURE;
+		if (link_read(w->link, id, id_length, stoptime) != id_length)
+			return VINE_MSG_FAILURE;
+		cachename[name_length] = 0;
+		id[id_length] = 0;
+
+		debug(D_VINE, "rx from %s (%s): cache-update %s (binary)", w->hostname, w->addrport, cachename);
+
+		handle_cache_update_values(q, w, cachename, type, cache_level, ntohll(nsize), ntohll(nmtime), ntohll(ntransfer), ntohll(nstart), id);
+		return VINE_MSG_PROCESSED;
+	}
+	default:
+		debug(D_VINE, "unknown binary frame type %d from worker (%s)", header[0], w->addrport);
+		return VINE_MSG_FAILURE;
+	}
+}
+
 /*
 A cache-invalid message coming from the worker means that a requested
 remote transfer or command did not succeed, and the intended file is
@@ -635,13 +851,29 @@ static vine_msg_code_t vine_manager_recv_no_retry(struct vine_manager *q, struct
 	time_t stoptime;
 	stoptime = time(0) + q->long_timeout;
 
-	int result = link_readline(w->link, line, length, stoptime);
+	/* a message may be a binary frame; the first byte distinguishes */
+	if (link_read(w->link, line, 1, stoptime) != 1) {
+		return VINE_MSG_FAILURE;
+	}
+
+	if ((unsigned char)line[0] == VINE_FRAME_START) {
+		w->last_msg_recv_time = timestamp_get_cached(); /* iteration-grained: refreshed once per loop pass */
+		vine_msg_code_t frame_result = handle_frame(q, w, stoptime);
+		if (frame_result == VINE_MSG_FAILURE) {
+			return VINE_MSG_FAILURE;
+		}
+		/* report as an asynchronous update so callers retry for their reply */
+		line[0] = 0;
+		return VINE_MSG_PROCESSED;
+	}
+
+	int result = link_readline(w->link, line + 1, length - 1, stoptime);
 
 	if (result <= 0) {
 		return VINE_MSG_FAILURE;
 	}
 
-	w->last_msg_recv_time = timestamp_get();
+	w->last_msg_recv_time = timestamp_get_cached(); /* iteration-grained: refreshed once per loop pass */
 
 	debug(D_VINE, "rx from %s (%s): %s", w->hostname, w->addrport, line);
 
@@ -793,6 +1025,9 @@ static void update_read_catalog(struct vine_manager *q)
 Send an update to the catalog describing the state of this manager.
 */
 
+/* Force at least one full update through this often, even if nothing changed. */
+#define VINE_CATALOG_FULL_REFRESH_INTERVAL 300
+
 static void update_write_catalog(struct vine_manager *q)
 {
 	// Only write if we have a name.
@@ -801,8 +1036,59 @@ static void update_write_catalog(struct vine_manager *q)
 
 	// Generate the manager status in an jx, and print it to a buffer.
 	struct jx *j = manager_to_jx(q);
+
+	/* Include the object lifecycle counters, so fleets get the same
+	counter surface from the catalog record that vine_counters_debug
+	prints locally. */
+	struct jx *counters = jx_object(0);
+	jx_insert_integer(counters, "tasks_created", vine_counters.task.created);
+	jx_insert_integer(counters, "tasks_deleted", vine_counters.task.deleted);
+	jx_insert_integer(counters, "files_created", vine_counters.file.created);
+	jx_insert_integer(counters, "files_deleted", vine_counters.file.deleted);
+	jx_insert_integer(counters, "replicas_created", vine_counters.replica.created);
+	jx_insert_integer(counters, "replicas_deleted", vine_counters.replica.deleted);
+	jx_insert_integer(counters, "workers_created", vine_counters.worker.created);
+	jx_insert_integer(counters, "workers_deleted", vine_counters.worker.deleted);
+	jx_insert(j, jx_string("counters"), counters);
+
+	/* With the loop profiler enabled, its histograms ride along. */
+	if (q->loop_profile_threshold) {
+		jx_insert(j, jx_string("stats"), stats_get());
+	}
+
 	char *str = jx_print_string(j);
 
+	/*
+	Successive updates are usually identical apart from timestamps;
+	suppress sends whose content matches the last one, while still
+	refreshing periodically so the catalog's lastheardfrom stays
+	alive.  The comparison skips volatile time fields by hashing the
+	canonical form minus them.
+	*/
+	struct jx *jc = jx_copy(j);
+	jx_delete(jx_remove(jc, jx_string("time_when_started")));
+	jx_delete(jx_remove(jc, jx_string("time_send")));
+	jx_delete(jx_remove(jc, jx_string("time_receive")));
+	jx_delete(jx_remove(jc, jx_string("time_status_msgs")));
+	jx_delete(jx_remove(jc, jx_string("time_internal")));
+	jx_delete(jx_remove(jc, jx_string("time_polling")));
+	jx_delete(jx_remove(jc, jx_string("time_application")));
+	jx_delete(jx_remove(jc, jx_string("time_scheduling")));
+	char *cstr = jx_print_string(jc);
+	unsigned digest = hash_string(cstr);
+	free(cstr);
+	jx_delete(jc);
+
+	time_t now = time(0);
+	if (digest == q->catalog_update_digest && now - q->catalog_update_last_sent < VINE_CATALOG_FULL_REFRESH_INTERVAL) {
+		debug(D_VINE, "catalog update unchanged, coalescing");
+		free(str);
+		jx_delete(j);
+		return;
+	}
+	q->catalog_update_digest = digest;
+	q->catalog_update_last_sent = now;
+
 	// Send the buffer.
 	debug(D_VINE, "Advertising manager status to the catalog server(s) at %s ...", q->catalog_hosts);
 	if (!catalog_query_send_update(q->catalog_hosts, str, CATALOG_UPDATE_BACKGROUND | CATALOG_UPDATE_CONDITIONAL)) {
@@ -1000,6 +1286,7 @@ void vine_manager_remove_worker(struct vine_manager *q, struct vine_worker_info
 
 	vine_txn_log_write_worker(q, w, 1, reason);
 
+	link_event_del(q->event_set, w->link);
 	hash_table_remove(q->worker_table, w->hashkey);
 	hash_table_remove(q->workers_with_watched_file_updates, w->hashkey);
 	hash_table_remove(q->workers_with_complete_tasks, w->hashkey);
@@ -1090,6 +1377,7 @@ static void add_worker(struct vine_manager *q)
 	w->addrport = string_format("%s:%d", addr, port);
 
 	hash_table_insert(q->worker_table, w->hashkey, w);
+	link_event_add(q->event_set, w->link);
 }
 
 /* Delete a single file on a remote worker except those with greater delete_upto_level cache level */
@@ -1354,20 +1642,22 @@ static int expire_waiting_tasks(struct vine_manager *q)
 	struct vine_task *t;
 	int expired = 0;
 
-	int tasks_considered = 0;
 	double current_time = timestamp_get() / ONE_SECOND;
-	while ((t = list_rotate(q->ready_list))) {
-		if (tasks_considered > q->attempt_schedule_depth) {
+
+	/* expiry does not follow priority order, so sweep the heap storage directly */
+	int i = 0;
+	while ((t = priority_queue_element(q->ready_tasks, i))) {
+		if (i > q->attempt_schedule_depth) {
 			return expired;
 		}
 		if (t->resources_requested->end > 0 && t->resources_requested->end <= current_time) {
 			vine_task_set_result(t, VINE_RESULT_MAX_END_TIME);
-			list_remove(q->ready_list, t);
+			priority_queue_remove(q->ready_tasks, t);
 			change_task_state(q, t, VINE_TASK_RETRIEVED);
 			expired++;
+			continue; /* another entry now occupies slot i */
 		}
-
-		tasks_considered++;
+		i++;
 	}
 
 	return expired;
@@ -1387,13 +1677,14 @@ static int enforce_waiting_fixed_locations(struct vine_manager *q)
 	while (count > 0) {
 		count--;
 
-		t = list_pop_head(q->ready_list);
+		t = priority_queue_element(q->ready_tasks, count);
+		if (!t)
+			continue;
 		if (t->has_fixed_locations && !vine_schedule_check_fixed_location(q, t)) {
 			vine_task_set_result(t, VINE_RESULT_FIXED_LOCATION_MISSING);
+			priority_queue_remove(q->ready_tasks, t);
 			change_task_state(q, t, VINE_TASK_RETRIEVED);
 			terminated++;
-		} else {
-			list_push_tail(q->ready_list, t);
 		}
 	}
 
@@ -1751,7 +2042,8 @@ static struct rmsummary *total_resources_needed(struct vine_manager *q)
 	struct rmsummary *total = rmsummary_create(0);
 
 	/* for waiting tasks, we use what they would request if dispatched right now. */
-	LIST_ITERATE(q->ready_list, t)
+	int ready_i;
+	PRIORITY_QUEUE_ITERATE(q->ready_tasks, ready_i, t)
 	{
 		const struct rmsummary *s = vine_manager_task_resources_min(q, t);
 		rmsummary_add(total, s);
@@ -2331,12 +2623,41 @@ static vine_msg_code_t handle_manager_status(struct vine_manager *q, struct vine
 {
 	struct link *l = target->link;
 
-	struct jx *a = construct_status_message(q, line);
 	target->type = VINE_WORKER_TYPE_STATUS;
 
 	free(target->hostname);
 	target->hostname = xxstrdup("QUEUE_STATUS");
 
+	/*
+	The task list can run to hundreds of thousands of entries, so
+	stream it one task at a time instead of materializing the whole
+	response tree and text in memory: servicing a status query is
+	then O(1) in queue size.
+	*/
+	if (!strcmp(line, "task_status") || !strcmp(line, "tasks")) {
+		struct vine_task *t;
+		uint64_t task_id;
+		int first = 1;
+
+		link_putliteral(l, "[", stoptime);
+		ITABLE_ITERATE(q->tasks, task_id, t)
+		{
+			struct jx *j = vine_task_to_jx(q, t);
+			if (!j)
+				continue;
+			if (!first)
+				link_putliteral(l, ",", stoptime);
+			jx_print_link(j, l, stoptime);
+			jx_delete(j);
+			first = 0;
+		}
+		link_putliteral(l, "]", stoptime);
+
+		return VINE_MSG_PROCESSED_DISCONNECT;
+	}
+
+	struct jx *a = construct_status_message(q, line);
+
 	if (!a) {
 		debug(D_VINE, "Unknown status request: '%s'", line);
 		return VINE_MSG_FAILURE;
@@ -2392,6 +2713,9 @@ static vine_msg_code_t handle_resources(struct vine_manager *q, struct vine_work
 	/* Record the update into the transaction log. */
 	vine_txn_log_write_worker_resources(q, w);
 
+	/* Now that capacity is known, pre-start any configured warm libraries. */
+	vine_manager_warm_libraries(q, w);
+
 	return VINE_MSG_PROCESSED;
 }
 
@@ -2471,55 +2795,6 @@ static vine_result_code_t handle_worker(struct vine_manager *q, struct link *l)
 	return VINE_SUCCESS;
 }
 
-/*
-Construct the table of network links to be considered,
-including the manager's accepting link, and one for
-each active worker.
-*/
-
-static int build_poll_table(struct vine_manager *q)
-{
-	int n = 0;
-	char *key;
-	struct vine_worker_info *w;
-
-	// Allocate a small table, if it hasn't been done yet.
-	if (!q->poll_table) {
-		q->poll_table = malloc(sizeof(*q->poll_table) * q->poll_table_size);
-		if (!q->poll_table) {
-			// if we can't allocate a poll table, we can't do anything else.
-			fatal("allocating memory for poll table failed.");
-		}
-	}
-
-	// The first item in the poll table is the manager link, which accepts new connections.
-	q->poll_table[0].link = q->manager_link;
-	q->poll_table[0].events = LINK_READ;
-	q->poll_table[0].revents = 0;
-	n = 1;
-
-	// For every worker in the hash table, add an item to the poll table
-	HASH_TABLE_ITERATE(q->worker_table, key, w)
-	{
-		// If poll table is not large enough, reallocate it
-		if (n >= q->poll_table_size) {
-			q->poll_table_size *= 2;
-			q->poll_table = realloc(q->poll_table, sizeof(*q->poll_table) * q->poll_table_size);
-			if (q->poll_table == NULL) {
-				// if we can't allocate a poll table, we can't do anything else.
-				fatal("reallocating memory for poll table failed.");
-			}
-		}
-
-		q->poll_table[n].link = w->link;
-		q->poll_table[n].events = LINK_READ;
-		q->poll_table[n].revents = 0;
-		n++;
-	}
-
-	return n;
-}
-
 static void vine_manager_compute_input_size(struct vine_manager *q, struct vine_task *t)
 {
 	t->input_files_size = -1;
@@ -2896,6 +3171,7 @@ static vine_result_code_t commit_task_to_worker(struct vine_manager *q, struct v
 	itable_insert(w->current_tasks, t->task_id, t);
 	t->worker = w;
 
+	uncount_pending_consumers(q, t);
 	change_task_state(q, t, VINE_TASK_RUNNING);
 
 	t->try_count += 1;
@@ -3117,7 +3393,7 @@ static int vine_manager_transfer_capacity_available(struct vine_manager *q, stru
 
 		/* Provide a substitute file object to describe the peer. */
 		if (!(m->file->flags & VINE_PEER_NOSHARE) && (m->file->cache_level > VINE_CACHE_LEVEL_TASK)) {
-			if ((peer = vine_file_replica_table_find_worker(q, m->file->cached_name))) {
+			if ((peer = vine_file_replica_table_find_worker_for(q, m->file->cached_name, w))) {
 				char *peer_source = string_format("%s/%s", peer->transfer_url, m->file->cached_name);
 				m->substitute = vine_file_substitute_url(m->file, peer_source, peer);
 				free(peer_source);
@@ -3241,6 +3517,79 @@ If they are no longer present, we cannot run this task,
 and should consider re-creating it via a recovery task.
 */
 
+/*
+Tasks whose temp inputs are not yet materialized are parked against
+the first missing file instead of circulating through the ready
+queue: the moment that file's creation or replica arrival is
+processed, the parked tasks go back to the ready queue.  Dependents
+therefore release as soon as predecessors' outputs hit the replica
+table, with no rescans of blocked work in between -- which is what
+lets chained short tasks flow at manager speed without an external
+driver.  Parked entries hold task ids, revalidated on wake, so a
+cancelled task simply evaporates from the list.
+*/
+
+static void vine_manager_park_task_on_file(struct vine_manager *q, struct vine_task *t, const char *cached_name)
+{
+	struct list *waiters = hash_table_lookup(q->tasks_waiting_on_file, cached_name);
+	if (!waiters) {
+		waiters = list_create();
+		hash_table_insert(q->tasks_waiting_on_file, cached_name, waiters);
+	}
+	list_push_tail(waiters, (void *)(uintptr_t)t->task_id);
+	debug(D_VINE, "task %d waiting for input %s", t->task_id, cached_name);
+}
+
+/*
+Interrupt a wait in progress from another thread: the event set's
+wakeup channel makes the current link_event_wait return promptly, so
+work queued by a helper thread (an asynchronous batch submission, for
+example) is noticed without waiting out the poll timeout.
+*/
+
+void vine_manager_wakeup(struct vine_manager *q)
+{
+	if (q && q->event_set)
+		link_event_wakeup(q->event_set);
+}
+
+void vine_manager_wake_tasks_waiting_on_file(struct vine_manager *q, const char *cached_name)
+{
+	struct list *waiters = hash_table_remove(q->tasks_waiting_on_file, cached_name);
+	if (!waiters)
+		return;
+
+	void *id;
+	while ((id = list_pop_head(waiters))) {
+		struct vine_task *t = itable_lookup(q->tasks, (uintptr_t)id);
+		if (t && t->state == VINE_TASK_READY) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
+			debug(D_VINE, "task %d released: input %s now available", t->task_id, cached_name);
+		}
+	}
+	list_delete(waiters);
+}
+
+/* As above, but returns the first missing input so the task can be parked on it. */
+
+static const char *vine_manager_first_missing_input(struct vine_manager *q, struct vine_task *t)
+{
+	struct vine_mount *m;
+	LIST_ITERATE(t->input_mounts, m)
+	{
+		struct vine_file *f = m->file;
+		if (f->type == VINE_FILE && f->state == VINE_FILE_STATE_PENDING) {
+			return f->cached_name;
+		} else if (f->type == VINE_TEMP && f->state == VINE_FILE_STATE_CREATED) {
+			if (!vine_file_replica_table_exists_somewhere(q, f->cached_name)) {
+				vine_manager_consider_recovery_task(q, f, f->recovery_task);
+				return f->cached_name;
+			}
+		}
+	}
+	return NULL;
+}
+
 static int vine_manager_check_inputs_available(struct vine_manager *q, struct vine_task *t)
 {
 	struct vine_mount *m;
@@ -3283,50 +3632,71 @@ static int send_one_task(struct vine_manager *q)
 	struct vine_task *t;
 	struct vine_worker_info *w = NULL;
 
-	int tasks_considered = 0;
-
 	timestamp_t now_usecs = timestamp_get();
 	double now_secs = ((double)now_usecs) / ONE_SECOND;
 
-	int tasks_to_consider = MIN(list_size(q->ready_list), q->attempt_schedule_depth);
+	int tasks_to_consider = MIN(priority_queue_size(q->ready_tasks), q->attempt_schedule_depth);
+	int tasks_considered;
 
-	while ((t = list_rotate(q->ready_list))) {
-		if (tasks_considered++ > tasks_to_consider) {
-			return 0;
+	/*
+	Pop the highest-priority tasks up to the scheduling depth; a task
+	that is skipped or cannot be placed is pushed back with a fresh
+	position behind its equals, which keeps equal-priority tasks
+	rotating just as the old list did.
+	*/
+	for (tasks_considered = 0; tasks_considered < tasks_to_consider; tasks_considered++) {
+		t = priority_queue_pop(q->ready_tasks);
+		if (!t) {
+			break;
 		}
 
 		// Skip task if min requested start time not met.
 		if (t->resources_requested->start > now_secs) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 			continue;
 		}
 
 		// Skip if this task failed recently
 		if (t->time_when_last_failure + q->transient_error_interval > now_usecs) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 			continue;
 		}
 
-		// Skip if category already running maximum allowed tasks
+		// Skip if category already running maximum allowed tasks.
+		// This cap, with the O(1) per-category stats maintained at
+		// each state change, is the only cross-category arbitration
+		// in the dispatch path; a weighted virtual-time scheme would
+		// slot in here, against those same counters, if multi-tenant
+		// shares are ever needed beyond caps.
 		struct category *c = vine_category_lookup_or_create(q, t->category);
 		if (c->max_concurrent > -1 && c->max_concurrent < c->vine_stats->tasks_running) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 			continue;
 		}
 
-		// Skip task if temp input files have not been materialized.
-		if (!vine_manager_check_inputs_available(q, t)) {
-			continue;
+		// Park the task if temp input files have not been materialized;
+		// it returns to the ready queue when the file does.
+		{
+			const char *missing = vine_manager_first_missing_input(q, t);
+			if (missing) {
+				vine_manager_park_task_on_file(q, t, missing);
+				continue;
+			}
 		}
 
 		// Skip function call task if no suitable library template was installed
 		if (!vine_manager_check_library_for_function_call(q, t)) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 			continue;
 		}
 
 		q->stats_measure->time_scheduling = timestamp_get();
 
-		// Find the best worker for the task at the head of the list
+		// Find the best worker for the task at the front of the queue
 		w = vine_schedule_task_to_worker(q, t);
 
 		if (!w) {
+			priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 			continue;
 		}
 
@@ -3334,12 +3704,13 @@ static int send_one_task(struct vine_manager *q)
 
 		// Check if there is transfer capacity available.
 		if (q->peer_transfers_enabled) {
-			if (!vine_manager_transfer_capacity_available(q, w, t))
+			if (!vine_manager_transfer_capacity_available(q, w, t)) {
+				priority_queue_push(q->ready_tasks, t, vine_task_priority(t));
 				continue;
+			}
 		}
 
-		// Otherwise, remove it from the ready list and start it:
-		list_pop_tail(q->ready_list);
+		// Otherwise it is out of the ready queue already: start it.
 		commit_task_to_worker(q, w, t);
 		return 1;
 	}
@@ -3673,7 +4044,7 @@ static void reset_task_to_state(struct vine_manager *q, struct vine_task *t, vin
 		break;
 
 	case VINE_TASK_READY:
-		list_remove(q->ready_list, t);
+		priority_queue_remove(q->ready_tasks, t);
 		change_task_state(q, t, new_state);
 		break;
 
@@ -3789,6 +4160,15 @@ struct vine_manager *vine_ssl_create(int port, const char *key, const char *cert
 		link_address_local(q->manager_link, address, &q->port);
 	}
 
+	q->event_set = link_event_create();
+	if (!q->event_set) {
+		debug(D_NOTICE, "Could not create manager event set.");
+		link_close(q->manager_link);
+		free(q);
+		return 0;
+	}
+	link_event_add(q->event_set, q->manager_link);
+
 	debug(D_VINE, "manager start");
 
 	q->runtime_directory = runtime_dir;
@@ -3816,7 +4196,7 @@ struct vine_manager *vine_ssl_create(int port, const char *key, const char *cert
 	q->next_task_id = 1;
 	q->fixed_location_in_queue = 0;
 
-	q->ready_list = list_create();
+	q->ready_tasks = priority_queue_create(0);
 	q->running_table = itable_create(0);
 	q->waiting_retrieval_list = list_create();
 	q->retrieved_list = list_create();
@@ -3827,6 +4207,10 @@ struct vine_manager *vine_ssl_create(int port, const char *key, const char *cert
 	q->worker_table = hash_table_create(0, 0);
 	q->file_worker_table = hash_table_create(0, 0);
 	q->temp_files_to_replicate = hash_table_create(0, 0);
+	q->file_pending_consumers = hash_table_create(0, 0);
+	q->task_memo_table = hash_table_create(0, 0);
+	q->transfer_source_counts = itable_create(0);
+	q->transfer_dest_counts = itable_create(0);
 	q->worker_blocklist = hash_table_create(0, 0);
 
 	q->file_table = hash_table_create(0, 0);
@@ -3905,6 +4289,18 @@ struct vine_manager *vine_ssl_create(int port, const char *key, const char *cert
 	q->perf_log_interval = VINE_PERF_LOG_INTERVAL;
 
 	q->temp_replica_count = 1;
+	q->tasks_waiting_on_file = hash_table_create(0, 0);
+	q->txn_log_state = 0;
+	q->graph_log_state = 0;
+	q->txn_log_binary = 0;
+	q->graph_log_binary = 0;
+	q->loop_profile_threshold = 0;
+	q->transfer_compression = 0;
+	q->task_memoization = 0;
+	q->library_warm_instances = 0;
+	q->transfer_bytes_per_cycle = 0;
+	q->catalog_update_digest = 0;
+	q->catalog_update_last_sent = 0;
 	q->transfer_temps_recovery = 0;
 	q->transfer_replica_per_cycle = 10;
 
@@ -4163,6 +4559,10 @@ void vine_delete(struct vine_manager *q)
 	hash_table_delete(q->file_worker_table);
 
 	hash_table_clear(q->temp_files_to_replicate, 0);
+	hash_table_clear(q->file_pending_consumers, 0);
+	hash_table_delete(q->file_pending_consumers);
+	hash_table_clear(q->task_memo_table, free);
+	hash_table_delete(q->task_memo_table);
 	hash_table_delete(q->temp_files_to_replicate);
 
 	hash_table_clear(q->factory_table, (void *)vine_factory_info_delete);
@@ -4173,6 +4573,8 @@ void vine_delete(struct vine_manager *q)
 
 	vine_current_transfers_clear(q);
 	hash_table_delete(q->current_transfer_table);
+	itable_delete(q->transfer_source_counts);
+	itable_delete(q->transfer_dest_counts);
 
 	itable_clear(q->tasks, (void *)delete_task_at_exit);
 	itable_delete(q->tasks);
@@ -4192,7 +4594,7 @@ void vine_delete(struct vine_manager *q)
 	}
 	hash_table_delete(q->categories);
 
-	list_delete(q->ready_list);
+	priority_queue_delete(q->ready_tasks);
 	itable_delete(q->running_table);
 	list_delete(q->waiting_retrieval_list);
 	list_delete(q->retrieved_list);
@@ -4220,6 +4622,7 @@ void vine_delete(struct vine_manager *q)
 	free(q->ssl_cert);
 	free(q->ssl_key);
 
+	link_event_delete(q->event_set);
 	link_close(q->manager_link);
 	if (q->perf_logfile) {
 		fclose(q->perf_logfile);
@@ -4231,6 +4634,7 @@ void vine_delete(struct vine_manager *q)
 
 	if (q->txn_logfile) {
 		vine_txn_log_write_manager(q, "END");
+		vine_txn_log_stop(q);
 
 		if (fclose(q->txn_logfile) != 0) {
 			debug(D_VINE, "unable to write transactions log: %s\n", strerror(errno));
@@ -4241,6 +4645,7 @@ void vine_delete(struct vine_manager *q)
 		vine_taskgraph_log_write_footer(q);
 		fclose(q->graph_logfile);
 	}
+	vine_taskgraph_log_free_state(q);
 
 	free(q->runtime_directory);
 	free(q->stats);
@@ -4351,26 +4756,17 @@ static double vine_task_priority(void *item)
 
 static void push_task_to_ready_list(struct vine_manager *q, struct vine_task *t)
 {
-	int by_priority = 1;
+	double priority = vine_task_priority(t);
 
 	if (t->result == VINE_RESULT_RESOURCE_EXHAUSTION) {
 		/* when a task is resubmitted given resource exhaustion, we
-		 * push it at the head of the list, so it gets to run as soon
+		 * push it at the front of the queue, so it gets to run as soon
 		 * as possible. This avoids the issue in which all 'big' tasks
 		 * fail because the first allocation is too small. */
-		by_priority = 0;
+		priority = DBL_MAX;
 	}
 
-	if (by_priority) {
-		/*If a task has a priority of 0 it gets added to the end of the ready list.*/
-		if (vine_task_priority(t) != 0) {
-			list_push_priority(q->ready_list, vine_task_priority, t);
-		} else {
-			list_push_tail(q->ready_list, t);
-		}
-	} else {
-		list_push_head(q->ready_list, t);
-	}
+	priority_queue_push(q->ready_tasks, t, priority);
 
 	/* If the task has been used before, clear out accumulated state. */
 	vine_task_clean(t);
@@ -4443,6 +4839,17 @@ static vine_task_state_t change_task_state(struct vine_manager *q, struct vine_t
 		list_push_head(q->retrieved_list, t);
 		break;
 	case VINE_TASK_DONE:
+		/* Remember the outcome of a successful task, so that an identical resubmission can skip execution. */
+		if (q->task_memoization && t->result == VINE_RESULT_SUCCESS) {
+			char *key = vine_task_memo_key(t);
+			if (!hash_table_lookup(q->task_memo_table, key)) {
+				struct vine_task_memo *memo = xxmalloc(sizeof(*memo));
+				memo->exit_code = t->exit_code;
+				memo->result = t->result;
+				hash_table_insert(q->task_memo_table, key, memo);
+			}
+			free(key);
+		}
 		/* Task was added a reference when entered into our own table, so delete a reference on removal. */
 		if (t->has_fixed_locations) {
 			q->fixed_location_in_queue--;
@@ -4556,6 +4963,146 @@ static int task_request_count(struct vine_manager *q, const char *category, cate
 	return count;
 }
 
+/*
+Track how many submitted tasks are waiting on each cached input, and
+once a file becomes hot -- many pending consumers but few replicas --
+hand it to the existing replication machinery so copies fan out ahead
+of demand instead of every consumer funneling through the first
+holder.
+*/
+
+#define VINE_HOT_FILE_CONSUMERS 8
+
+static void count_pending_consumers(struct vine_manager *q, struct vine_task *t)
+{
+	struct vine_mount *m;
+
+	LIST_ITERATE(t->input_mounts, m)
+	{
+		if (m->file->cache_level <= VINE_CACHE_LEVEL_TASK)
+			continue;
+
+		intptr_t count = (intptr_t)hash_table_remove(q->file_pending_consumers, m->file->cached_name);
+		count++;
+		hash_table_insert(q->file_pending_consumers, m->file->cached_name, (void *)count);
+
+		if (count >= VINE_HOT_FILE_CONSUMERS && vine_file_replica_table_exists_somewhere(q, m->file->cached_name)) {
+			int replicas = vine_file_replica_table_count_replicas(q, m->file->cached_name, VINE_FILE_REPLICA_STATE_READY);
+			if (replicas > 0 && count >= (intptr_t)replicas * VINE_HOT_FILE_CONSUMERS) {
+				hash_table_insert(q->temp_files_to_replicate, m->file->cached_name, NULL);
+			}
+		}
+	}
+}
+
+static void uncount_pending_consumers(struct vine_manager *q, struct vine_task *t)
+{
+	struct vine_mount *m;
+
+	LIST_ITERATE(t->input_mounts, m)
+	{
+		if (m->file->cache_level <= VINE_CACHE_LEVEL_TASK)
+			continue;
+
+		intptr_t count = (intptr_t)hash_table_remove(q->file_pending_consumers, m->file->cached_name);
+		if (count > 1) {
+			hash_table_insert(q->file_pending_consumers, m->file->cached_name, (void *)(count - 1));
+		}
+	}
+}
+
+/*
+Write a point-in-time snapshot of the queue: manager identity, every
+task not yet complete, and category statistics, as one binary jx
+document replacing the previous snapshot atomically.  Workers already
+re-report their cache inventories when they reconnect (their stored
+files arrive as unsolicited cache-updates), so the snapshot concerns
+only manager-side state.  Reading the snapshot back yields the parsed
+document; reconstructing live task objects from it is the job of the
+submitting application or binding, which knows how its tasks were
+declared.
+*/
+
+int vine_manager_checkpoint(struct vine_manager *q, const char *path)
+{
+	char *tmp_path = string_format("%s.tmp", path);
+	FILE *f = fopen(tmp_path, "w");
+	if (!f) {
+		free(tmp_path);
+		return 0;
+	}
+
+	struct jx *snapshot = jx_object(0);
+	jx_insert_string(snapshot, "type", "vine_checkpoint");
+	jx_insert_integer(snapshot, "time", time(0));
+	jx_insert_integer(snapshot, "next_task_id", q->next_task_id);
+	if (q->name)
+		jx_insert_string(snapshot, "project", q->name);
+
+	struct jx *tasks = jx_array(0);
+	uint64_t task_id;
+	struct vine_task *t;
+	ITABLE_ITERATE(q->tasks, task_id, t)
+	{
+		if (t->state == VINE_TASK_DONE)
+			continue;
+		struct jx *j = vine_task_to_jx(q, t);
+		if (j)
+			jx_array_append(tasks, j);
+	}
+	jx_insert(snapshot, jx_string("tasks"), tasks);
+
+	struct jx *categories = categories_to_jx(q);
+	if (categories)
+		jx_insert(snapshot, jx_string("categories"), categories);
+
+	int ok = jx_binary_write(f, snapshot);
+	jx_delete(snapshot);
+	fclose(f);
+
+	if (ok) {
+		ok = rename(tmp_path, path) == 0;
+	}
+	if (!ok) {
+		unlink(tmp_path);
+	}
+
+	free(tmp_path);
+	return ok;
+}
+
+struct jx *vine_manager_checkpoint_load(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return 0;
+
+	struct jx *snapshot = jx_binary_read(f);
+	fclose(f);
+
+	if (snapshot && strcmp(jx_lookup_string(snapshot, "type") ? jx_lookup_string(snapshot, "type") : "", "vine_checkpoint")) {
+		jx_delete(snapshot);
+		return 0;
+	}
+
+	return snapshot;
+}
+
+int vine_submit_list(struct vine_manager *q, struct list *tasks)
+{
+	struct vine_task *t;
+	int submitted = 0;
+
+	LIST_ITERATE(tasks, t)
+	{
+		if (vine_submit(q, t)) {
+			submitted++;
+		}
+	}
+
+	return submitted;
+}
+
 int vine_submit(struct vine_manager *q, struct vine_task *t)
 {
 	if (t->state != VINE_TASK_INITIAL) {
@@ -4591,6 +5138,22 @@ int vine_submit(struct vine_manager *q, struct vine_task *t)
 	t->time_when_submitted = timestamp_get();
 	q->stats->tasks_submitted++;
 
+	if (q->task_memoization) {
+		char *key = vine_task_memo_key(t);
+		struct vine_task_memo *memo = hash_table_lookup(q->task_memo_table, key);
+		if (memo && vine_task_outputs_exist(q, t)) {
+			debug(D_VINE, "task %d completed from memoized result", t->task_id);
+			t->exit_code = memo->exit_code;
+			vine_task_set_result(t, memo->result);
+			change_task_state(q, t, VINE_TASK_RETRIEVED);
+			free(key);
+			return t->task_id;
+		}
+		free(key);
+	}
+
+	count_pending_consumers(q, t);
+
 	if (q->monitor_mode != VINE_MON_DISABLED)
 		vine_monitor_add_files(q, t);
 
@@ -4806,9 +5369,9 @@ struct vine_task *vine_wait_for_task_id(struct vine_manager *q, int task_id, int
 /* return number of workers that failed */
 static int poll_active_workers(struct vine_manager *q, int stoptime)
 {
-	BEGIN_ACCUM_TIME(q, time_polling);
+	struct link *ready[256];
 
-	int n = build_poll_table(q);
+	BEGIN_ACCUM_TIME(q, time_polling);
 
 	// We poll in at most small time segments (of a second). This lets
 	// promptly dispatch tasks, while avoiding busy waiting.
@@ -4825,22 +5388,24 @@ static int poll_active_workers(struct vine_manager *q, int stoptime)
 
 	BEGIN_ACCUM_TIME(q, time_polling);
 
-	// Poll all links for activity.
-	link_poll(q->poll_table, n, msec);
-	q->link_poll_end = timestamp_get();
+	// Wait on the persistent event set; only ready links come back.
+	int n = link_event_wait(q->event_set, msec, ready, 256);
+	q->link_poll_end = timestamp_cache_refresh();
 
 	END_ACCUM_TIME(q, time_polling);
 
 	BEGIN_ACCUM_TIME(q, time_status_msgs);
 
-	int i, j = 1;
+	int i;
 	int workers_failed = 0;
-	// Then consider all existing active workers
-	for (i = j; i < n; i++) {
-		if (q->poll_table[i].revents) {
-			if (handle_worker(q, q->poll_table[i].link) == VINE_WORKER_FAILURE) {
-				workers_failed++;
-			}
+	q->accept_waiting = 0;
+	for (i = 0; i < n; i++) {
+		if (ready[i] == q->manager_link) {
+			q->accept_waiting = 1;
+			continue;
+		}
+		if (handle_worker(q, ready[i]) == VINE_WORKER_FAILURE) {
+			workers_failed++;
 		}
 	}
 
@@ -4856,7 +5421,7 @@ static int connect_new_workers(struct vine_manager *q, int stoptime, int max_new
 	// If the manager link was awake, then accept at most max_new_workers.
 	// Note we are using the information gathered in poll_active_workers, which
 	// is a little ugly.
-	if (q->poll_table[0].revents) {
+	if (q->accept_waiting) {
 		do {
 			add_worker(q);
 			new_workers++;
@@ -4913,9 +5478,22 @@ struct vine_task *find_task_to_return(struct vine_manager *q, const char *tag, i
 			/* if this is a standard task type, then break and return it to the user. */
 			return t;
 			break;
-		case VINE_TASK_TYPE_RECOVERY:
-			/* do nothing and let vine_manager_consider_recovery_task do its job */
+		case VINE_TASK_TYPE_RECOVERY: {
+			/*
+			A finished recovery task settles the fate of every task
+			parked on its outputs: on success the replica insert
+			already released them, and on failure they must requeue,
+			re-detect the missing file, and resubmit the recovery
+			task (now DONE) -- without this wake a failed recovery
+			left its dependents parked forever.
+			*/
+			struct vine_mount *m;
+			LIST_ITERATE(t->output_mounts, m)
+			{
+				vine_manager_wake_tasks_waiting_on_file(q, m->file->cached_name);
+			}
 			break;
+		}
 		case VINE_TASK_TYPE_LIBRARY_INSTANCE:
 			/* silently delete it */
 			vine_task_delete(t); // delete as manager created this task
@@ -4929,6 +5507,42 @@ struct vine_task *find_task_to_return(struct vine_manager *q, const char *tag, i
 	return NULL;
 }
 
+/*
+Bin one event-loop iteration's phase times into the stats histograms
+and log the breakdown of iterations slower than the tuned threshold.
+Phases come out as deltas of the accumulators the loop already keeps.
+*/
+static void vine_loop_profile_emit(struct vine_manager *q, const struct vine_stats *base, timestamp_t start)
+{
+	timestamp_t total = timestamp_get() - start;
+	timestamp_t poll = q->stats->time_polling - base->time_polling;
+	timestamp_t msgs = q->stats->time_status_msgs - base->time_status_msgs;
+	timestamp_t internal = q->stats->time_internal - base->time_internal;
+	timestamp_t receive = q->stats->time_receive - base->time_receive;
+	timestamp_t send = q->stats->time_send - base->time_send;
+	timestamp_t scheduling = q->stats->time_scheduling - base->time_scheduling;
+
+	stats_bin("vine.loop.total_us", total);
+	stats_bin("vine.loop.polling_us", poll);
+	stats_bin("vine.loop.status_msgs_us", msgs);
+	stats_bin("vine.loop.internal_us", internal);
+	stats_bin("vine.loop.receive_us", receive);
+	stats_bin("vine.loop.send_us", send);
+	stats_bin("vine.loop.scheduling_us", scheduling);
+
+	if (total > (timestamp_t)q->loop_profile_threshold) {
+		debug(D_VINE | D_NOTICE,
+				"slow loop iteration: total %" PRIu64 "us poll %" PRIu64 "us msgs %" PRIu64 "us internal %" PRIu64 "us receive %" PRIu64 "us send %" PRIu64 "us scheduling %" PRIu64 "us",
+				(uint64_t)total,
+				(uint64_t)poll,
+				(uint64_t)msgs,
+				(uint64_t)internal,
+				(uint64_t)receive,
+				(uint64_t)send,
+				(uint64_t)scheduling);
+	}
+}
+
 static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout, const char *tag, int task_id)
 {
 	/*
@@ -4983,8 +5597,31 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 	// used for q->prefer_dispatch. If 0 and there is a task retrieved, then return task to app.
 	int sent_in_previous_cycle = 1;
 
+	struct vine_stats profile_base;
+	timestamp_t profile_start = 0;
+
 	// time left?
 	while ((stoptime == 0) || (time(0) < stoptime)) {
+		// one clock read serves every cached timestamp use in this iteration
+		timestamp_cache_refresh();
+
+		/*
+		With loop-profile-threshold set, each iteration's phase times
+		are taken as deltas of the existing accumulators, binned into
+		the stats histograms, and any iteration slower than the
+		threshold logs its phase breakdown, turning "the manager
+		stalls sometimes" into "receive took 800ms in this iteration".
+		The previous iteration is sampled at the top of the next one,
+		so early continues are still accounted.  Costs nothing when
+		the threshold is zero.
+		*/
+		if (q->loop_profile_threshold) {
+			if (profile_start)
+				vine_loop_profile_emit(q, &profile_base, profile_start);
+			profile_base = *q->stats;
+			profile_start = timestamp_get();
+		}
+
 		BEGIN_ACCUM_TIME(q, time_internal);
 		// update catalog if appropriate
 		if (q->name) {
@@ -5005,7 +5642,7 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 				END_ACCUM_TIME(q, time_internal);
 			}
 
-			if (t && (!q->prefer_dispatch || list_size(q->ready_list) == 0 || !sent_in_previous_cycle)) {
+			if (t && (!q->prefer_dispatch || priority_queue_size(q->ready_tasks) == 0 || !sent_in_previous_cycle)) {
 				break;
 			}
 		}
@@ -5059,7 +5696,7 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 				// task to be received
 				break;
 			}
-		} while (q->max_retrievals < 0 || retrieved_this_cycle < q->max_retrievals || !list_size(q->ready_list));
+		} while (q->max_retrievals < 0 || retrieved_this_cycle < q->max_retrievals || !priority_queue_size(q->ready_tasks));
 		END_ACCUM_TIME(q, time_receive);
 
 		// expired tasks
@@ -5093,12 +5730,26 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 				q->wait_for_workers = 0;
 			}
 			// tasks waiting to be dispatched?
+			// Send a burst of tasks per wakeup, so short-task
+			// workloads are not bounded by one dispatch per cycle.
 			BEGIN_ACCUM_TIME(q, time_send);
-			result = send_one_task(q);
+			int sent_burst = 0;
+			q->transfer_bytes_this_cycle = 0;
+			while (sent_burst < VINE_TASK_DISPATCH_BURST && send_one_task(q)) {
+				sent_burst++;
+				/*
+				Admission control for fan-out: once this wakeup
+				has moved its byte budget of input data, return
+				to the event loop so heartbeats and results are
+				serviced before the next data burst.
+				*/
+				if (q->transfer_bytes_per_cycle > 0 && q->transfer_bytes_this_cycle >= q->transfer_bytes_per_cycle) {
+					break;
+				}
+			}
 			END_ACCUM_TIME(q, time_send);
-			if (result) {
-				// sent at least one task
-				events++;
+			if (sent_burst > 0) {
+				events += sent_burst;
 				sent_in_previous_cycle = 1;
 				continue;
 			}
@@ -5152,7 +5803,7 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 		// in this wait.
 		if (events > 0) {
 			BEGIN_ACCUM_TIME(q, time_internal);
-			int done = !list_size(q->ready_list) && !list_size(q->waiting_retrieval_list) && !itable_size(q->running_table);
+			int done = !priority_queue_size(q->ready_tasks) && !list_size(q->waiting_retrieval_list) && !itable_size(q->running_table);
 			END_ACCUM_TIME(q, time_internal);
 
 			if (done) {
@@ -5178,6 +5829,10 @@ static struct vine_task *vine_wait_internal(struct vine_manager *q, int timeout,
 		q->busy_waiting_flag = 1;
 	}
 
+	if (q->loop_profile_threshold && profile_start) {
+		vine_loop_profile_emit(q, &profile_base, profile_start);
+	}
+
 	if (events > 0) {
 		vine_perf_log_write_update(q, 1);
 	}
@@ -5242,7 +5897,8 @@ int vine_hungry(struct vine_manager *q)
 
 	struct vine_task *t;
 
-	LIST_ITERATE(q->ready_list, t)
+	int ready_i;
+	PRIORITY_QUEUE_ITERATE(q->ready_tasks, ready_i, t)
 	{
 		ready_task_cores += MAX(1, t->resources_requested->cores);
 		ready_task_memory += t->resources_requested->memory;
@@ -5542,6 +6198,29 @@ int vine_tune(struct vine_manager *q, const char *name, double value)
 	} else if (!strcmp(name, "transfer-replica-per-cycle")) {
 		q->transfer_replica_per_cycle = MAX(1, (int)value);
 
+	} else if (!strcmp(name, "transfer-compression")) {
+		q->transfer_compression = (value > 0);
+
+	} else if (!strcmp(name, "txn-log-binary")) {
+		q->txn_log_binary = (value > 0);
+
+	} else if (!strcmp(name, "taskgraph-log-binary")) {
+		q->graph_log_binary = (value > 0);
+
+	} else if (!strcmp(name, "loop-profile-threshold")) {
+		q->loop_profile_threshold = MAX(0, (int)value);
+		if (q->loop_profile_threshold)
+			stats_enable();
+
+	} else if (!strcmp(name, "library-warm-instances")) {
+		q->library_warm_instances = MAX(0, (int)value);
+
+	} else if (!strcmp(name, "transfer-bytes-per-cycle")) {
+		q->transfer_bytes_per_cycle = (int64_t)value;
+
+	} else if (!strcmp(name, "task-memoization")) {
+		q->task_memoization = (value > 0);
+
 	} else if (!strcmp(name, "transfer-temps-recovery")) {
 		q->transfer_temps_recovery = !!((int)value);
 
@@ -5638,7 +6317,7 @@ void vine_get_stats(struct vine_manager *q, struct vine_stats *s)
 	// s->workers_able computed below.
 
 	// info about tasks
-	s->tasks_waiting = list_size(q->ready_list);
+	s->tasks_waiting = priority_queue_size(q->ready_tasks);
 	s->tasks_with_results = list_size(q->waiting_retrieval_list);
 	s->tasks_running = itable_size(q->running_table);
 	s->tasks_on_workers = s->tasks_with_results + s->tasks_running;
@@ -91,6 +91,25 @@ struct vine_manager {
 	struct link *manager_link;       /* Listening TCP connection for accepting new workers. */
 	struct link_info *poll_table;    /* Table for polling on all connected workers. */
 	int poll_table_size;             /* Number of entries in poll_table. */
+	struct link_event_set *event_set; /* Persistent readiness set holding the manager link and every worker link. */
+	int accept_waiting;              /* Set when the manager link polled ready, so new workers should be accepted. */
+	int transfer_compression;        /* If true, compress compressible file transfers to workers in flight. */
+	struct hash_table *tasks_waiting_on_file; /* cached_name -> list of task ids parked until that input materializes */
+	int graph_log_binary;            /* If true, stream the taskgraph log in the compact binary form decoded by vine_graph_tool. */
+	struct vine_txn_state *txn_log_state;
+	struct vine_graph_log_state *graph_log_state; /* interning state owned by vine_taskgraph_log.c */ /* buffering and interning state owned by vine_txn_log.c */
+	int txn_log_binary;              /* If true, write the transaction log in the compact binary form decoded by vine_txn_tool. */
+	int loop_profile_threshold;      /* If nonzero, histogram each event loop iteration's phases, and log the phase breakdown of iterations slower than this many microseconds. */
+	int library_warm_instances;      /* Pre-start this many instances of each installed library per connecting worker. */
+	unsigned catalog_update_digest;  /* Content hash of the last catalog update sent, for coalescing. */
+	time_t catalog_update_last_sent; /* When the last catalog update actually went out. */
+	int64_t perf_log_last_activity;  /* Event-counter sum at the last perf log row. */
+	struct itable *transfer_source_counts; /* worker pointer -> number of transfers it currently serves as source. */
+	struct itable *transfer_dest_counts;   /* worker pointer -> number of transfers currently arriving at it. */
+	int task_memoization;            /* If true, complete resubmitted identical tasks from recorded results. */
+	struct hash_table *task_memo_table; /* content key -> recorded result of a completed task. */
+	int64_t transfer_bytes_per_cycle; /* Stop dispatching once this many input bytes have been sent in one wakeup; zero for no limit. */
+	int64_t transfer_bytes_this_cycle; /* Input bytes sent so far in the current wakeup. */
 
 	/* Security configuration */
 
@@ -102,7 +121,8 @@ struct vine_manager {
 	/* Primary data structures for tracking task state. */
 
 	struct itable *tasks;           /* Maps task_id -> vine_task of all tasks in any state. */
-	struct list   *ready_list;      /* List of vine_task that are waiting to execute. */
+	struct priority_queue *ready_tasks; /* Heap of vine_task waiting to execute, highest priority first, FIFO among equals. */
+	struct hash_table *file_pending_consumers; /* cached_name -> number of submitted-but-not-finished tasks consuming the file. */
 	struct itable   *running_table;      /* Table of vine_task that are running at workers. */
 	struct list   *waiting_retrieval_list;      /* List of vine_task that are waiting to be retrieved. */
 	struct list   *retrieved_list;      /* List of vine_task that have been retrieved. */
@@ -244,6 +264,25 @@ __attribute__ (( format(printf,3,4) ))
 #endif
 int vine_manager_send( struct vine_manager *q, struct vine_worker_info *w, const char *fmt, ... );
 
+/** Write a binary snapshot of manager state (pending tasks, categories) to the given path, atomically.
+@return One on success, zero on failure. */
+int vine_manager_checkpoint( struct vine_manager *q, const char *path );
+
+/** Read back a snapshot written by @ref vine_manager_checkpoint.
+@return The parsed snapshot document, to be freed with jx_delete, or null. */
+struct jx *vine_manager_checkpoint_load( const char *path );
+
+/** Send a manager-to-worker message with an attached binary payload in one gathered write.
+@param q The manager object.
+@param w The worker to send the message to.
+@param payload The payload bytes to send immediately after the message.
+@param length The number of payload bytes.
+@param stoptime The absolute time at which to abort.
+@param fmt A printf-style format string for the message line.
+@return The payload length on success, or less than zero on failure.
+*/
+int vine_manager_send_with_payload( struct vine_manager *q, struct vine_worker_info *w, const char *payload, size_t length, time_t stoptime, const char *fmt, ... );
+
 /* Receive a line-oriented message from a remote worker. */
 vine_msg_code_t vine_manager_recv( struct vine_manager *q, struct vine_worker_info *w, char *line, int length );
 
@@ -260,6 +299,12 @@ struct vine_task *vine_manager_find_library_template(struct vine_manager *q, con
 /* Internal: Enable shortcut of main loop upon child process completion. Needed for Makeflow to interleave local and remote execution. */
 void vine_manager_enable_process_shortcut(struct vine_manager *q);
 
+/* Interrupt a wait in progress, from another thread. */
+void vine_manager_wakeup(struct vine_manager *q);
+
+/* Return tasks parked on the named file to the ready queue, called when the file materializes. */
+void vine_manager_wake_tasks_waiting_on_file(struct vine_manager *q, const char *cached_name);
+
 struct rmsummary *vine_manager_choose_resources_for_task( struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t );
 
 int64_t overcommitted_resource_total(struct vine_manager *q, int64_t total);
@@ -327,7 +327,23 @@ vine_result_code_t vine_manager_get_single_file(struct vine_manager *q, struct v
 Get a single output file, located at the worker under 'cached_name'.
 */
 
-vine_result_code_t vine_manager_get_output_file(struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t, struct vine_mount *m, struct vine_file *f)
+/* Send the request half of an output retrieval, without waiting for the reply. */
+
+static vine_result_code_t vine_manager_request_output_file(struct vine_manager *q, struct vine_worker_info *w, struct vine_file *f)
+{
+	if (f->type == VINE_FILE) {
+		vine_manager_send(q, w, "get %s\n", f->cached_name);
+	} else if (f->type == VINE_BUFFER) {
+		vine_manager_send(q, w, "getfile %s\n", f->cached_name);
+	} else {
+		return VINE_APP_FAILURE;
+	}
+	return VINE_SUCCESS;
+}
+
+/* Receive the reply half of an output retrieval requested above. */
+
+static vine_result_code_t vine_manager_receive_output_file(struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t, struct vine_mount *m, struct vine_file *f)
 {
 	int64_t total_bytes = 0;
 	vine_result_code_t result = VINE_SUCCESS; // return success unless something fails below.
@@ -337,10 +353,8 @@ vine_result_code_t vine_manager_get_output_file(struct vine_manager *q, struct v
 	debug(D_VINE, "%s (%s) sending back %s to %s", w->hostname, w->addrport, f->cached_name, f->source);
 
 	if (f->type == VINE_FILE) {
-		vine_manager_send(q, w, "get %s\n", f->cached_name);
 		result = vine_manager_get_any(q, w, t, 0, f->source, &total_bytes);
 	} else if (f->type == VINE_BUFFER) {
-		vine_manager_send(q, w, "getfile %s\n", f->cached_name);
 		result = vine_manager_get_buffer(q, w, t, f, &total_bytes);
 	} else {
 		result = VINE_APP_FAILURE;
@@ -403,6 +417,14 @@ vine_result_code_t vine_manager_get_output_file(struct vine_manager *q, struct v
 	return result;
 }
 
+vine_result_code_t vine_manager_get_output_file(struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t, struct vine_mount *m, struct vine_file *f)
+{
+	vine_result_code_t result = vine_manager_request_output_file(q, w, f);
+	if (result != VINE_SUCCESS)
+		return result;
+	return vine_manager_receive_output_file(q, w, t, m, f);
+}
+
 /* Get all output files produced by a given task on this worker. */
 
 vine_result_code_t vine_manager_get_output_files(struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t)
@@ -412,6 +434,13 @@ vine_result_code_t vine_manager_get_output_files(struct vine_manager *q, struct
 
 	vine_result_code_t result_all_files = VINE_SUCCESS;
 
+	/*
+	Retrievals are pipelined: every request goes out first, and the
+	replies stream back in order, so a task with dozens of small
+	outputs pays one round trip rather than one per file.
+	*/
+	struct list *fetch_list = list_create();
+
 	if (t->output_mounts) {
 		struct vine_mount *m;
 		LIST_ITERATE(t->output_mounts, m)
@@ -436,8 +465,9 @@ vine_result_code_t vine_manager_get_output_files(struct vine_manager *q, struct
 					result_single_file = VINE_APP_FAILURE;
 				}
 			} else {
-				// otherwise, get the file.
-				result_single_file = vine_manager_get_output_file(q, w, t, m, m->file);
+				// otherwise, note it for the pipelined retrieval below.
+				list_push_tail(fetch_list, m);
+				continue;
 			}
 
 			// if success or app-level failure, continue to get other files.
@@ -451,6 +481,31 @@ vine_result_code_t vine_manager_get_output_files(struct vine_manager *q, struct
 		}
 	}
 
+	if (result_all_files == VINE_SUCCESS && list_size(fetch_list) > 0) {
+		struct vine_mount *m;
+
+		LIST_ITERATE(fetch_list, m)
+		{
+			vine_result_code_t r = vine_manager_request_output_file(q, w, m->file);
+			if (r != VINE_SUCCESS) {
+				result_all_files = r;
+			}
+		}
+
+		LIST_ITERATE(fetch_list, m)
+		{
+			vine_result_code_t r = vine_manager_receive_output_file(q, w, t, m, m->file);
+			if (r == VINE_WORKER_FAILURE || r == VINE_MGR_FAILURE) {
+				result_all_files = r;
+				break;
+			} else if (r == VINE_APP_FAILURE) {
+				result_all_files = r;
+			}
+		}
+	}
+
+	list_delete(fetch_list);
+
 	return result_all_files;
 }
 
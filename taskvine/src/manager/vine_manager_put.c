@@ -28,6 +28,7 @@ See the file COPYING for details.
 
 #include <dirent.h>
 #include <errno.h>
+#include <zlib.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -51,9 +52,8 @@ static int vine_manager_put_symlink(struct vine_manager *q, struct vine_worker_i
 	char remotename_encoded[VINE_LINE_MAX];
 	url_encode(remotename, remotename_encoded, sizeof(remotename_encoded));
 
-	vine_manager_send(q, w, "symlink %s %d\n", remotename_encoded, length);
-
-	link_write(w->link, target, length, time(0) + q->long_timeout);
+	if (vine_manager_send_with_payload(q, w, target, length, time(0) + q->long_timeout, "symlink %s %d\n", remotename_encoded, length) < 0)
+		return VINE_WORKER_FAILURE;
 
 	*total_bytes += length;
 
@@ -66,6 +66,95 @@ The transfer time is controlled by the size of the file.
 If the transfer takes too long, then cancel it.
 */
 
+/*
+Decide whether a file is worth compressing in flight by deflating a
+sample of its head; stored-compressed formats and random data bail out
+immediately.
+*/
+
+static int file_sample_is_compressible(int fd)
+{
+	char in[65536];
+	char out[81920];
+
+	ssize_t n = read(fd, in, sizeof(in));
+	lseek(fd, 0, SEEK_SET);
+	if (n < 4096)
+		return 0;
+
+	uLongf outlen = sizeof(out);
+	if (compress2((Bytef *)out, &outlen, (const Bytef *)in, n, 1) != Z_OK)
+		return 0;
+
+	return outlen < (uLongf)(n * 9 / 10);
+}
+
+/*
+Stream a file to the worker deflate-compressed, as a filez message
+followed by length-prefixed compressed chunks and a zero terminator,
+so no temporary file or up-front compressed size is needed.
+*/
+
+static int vine_manager_put_file_compressed(struct vine_manager *q, struct vine_worker_info *w, int fd, const char *remotename_encoded, int64_t length, int mode, time_t mtime, time_t stoptime, int64_t *total_bytes)
+{
+	char in[65536];
+	char out[65536];
+	z_stream strm;
+
+	memset(&strm, 0, sizeof(strm));
+	if (deflateInit(&strm, 1) != Z_OK)
+		return 0;
+
+	vine_manager_send(q, w, "filez %s %" PRId64 " 0%o %lld\n", remotename_encoded, length, mode, (long long)mtime);
+
+	int ok = 1;
+	int flush = Z_NO_FLUSH;
+
+	do {
+		ssize_t n = read(fd, in, sizeof(in));
+		if (n < 0) {
+			ok = 0;
+			break;
+		}
+		if (n < (ssize_t)sizeof(in))
+			flush = Z_FINISH;
+
+		strm.next_in = (Bytef *)in;
+		strm.avail_in = n;
+
+		do {
+			strm.next_out = (Bytef *)out;
+			strm.avail_out = sizeof(out);
+			int zr = deflate(&strm, flush);
+			if (zr == Z_STREAM_ERROR) {
+				ok = 0;
+				break;
+			}
+			int produced = sizeof(out) - strm.avail_out;
+			if (produced > 0) {
+				/* write the chunk header directly, not through the
+				   buffered printf path, to keep ordering with the
+				   raw chunk bytes that follow */
+				char header[32];
+				int header_length = snprintf(header, sizeof(header), "%d\n", produced);
+				if (link_putlstring(w->link, header, header_length, stoptime) != header_length || link_putlstring(w->link, out, produced, stoptime) != produced) {
+					ok = 0;
+					break;
+				}
+				*total_bytes += produced;
+			}
+		} while (strm.avail_out == 0 && ok);
+	} while (flush != Z_FINISH && ok);
+
+	deflateEnd(&strm);
+
+	if (ok) {
+		ok = link_putlstring(w->link, "0\n", 2, stoptime) == 2;
+	}
+
+	return ok;
+}
+
 static int vine_manager_put_file(
 		struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t, const char *localname, const char *remotename, struct stat info, int64_t *total_bytes)
 {
@@ -93,14 +182,24 @@ static int vine_manager_put_file(
 	url_encode(remotename, remotename_encoded, sizeof(remotename_encoded));
 
 	stoptime = time(0) + vine_manager_transfer_time(q, w, length);
-	vine_manager_send(q, w, "file %s %" PRId64 " 0%o %lld\n", remotename_encoded, length, mode, (long long)info.st_mtime);
-	actual = link_stream_from_fd(w->link, fd, length, stoptime);
-	close(fd);
 
-	*total_bytes += actual;
+	if (q->transfer_compression && length > 65536 && file_sample_is_compressible(fd)) {
+		int ok = vine_manager_put_file_compressed(q, w, fd, remotename_encoded, length, mode, info.st_mtime, stoptime, total_bytes);
+		close(fd);
+		debug(D_VINE, "compressed put of %s: %s", remotename_encoded, ok ? "ok" : "FAILED");
+		if (!ok)
+			return VINE_WORKER_FAILURE;
+		actual = length;
+	} else {
+		vine_manager_send(q, w, "file %s %" PRId64 " 0%o %lld\n", remotename_encoded, length, mode, (long long)info.st_mtime);
+		actual = link_stream_from_fd(w->link, fd, length, stoptime);
+		close(fd);
 
-	if (actual != length)
-		return VINE_WORKER_FAILURE;
+		*total_bytes += actual;
+
+		if (actual != length)
+			return VINE_WORKER_FAILURE;
+	}
 
 	timestamp_t current_time = timestamp_get();
 	if (effective_stoptime && effective_stoptime > current_time) {
@@ -284,8 +383,7 @@ vine_result_code_t vine_manager_put_url(struct vine_manager *q, struct vine_work
 vine_result_code_t vine_manager_put_buffer(struct vine_manager *q, struct vine_worker_info *w, struct vine_task *t, struct vine_file *f, int64_t *total_bytes)
 {
 	time_t stoptime = time(0) + vine_manager_transfer_time(q, w, f->size);
-	vine_manager_send(q, w, "file %s %lld 0755 0\n", f->cached_name, (long long)f->size);
-	int64_t actual = link_putlstring(w->link, f->data, f->size, stoptime);
+	int64_t actual = vine_manager_send_with_payload(q, w, f->data, f->size, stoptime, "file %s %lld 0755 0\n", f->cached_name, (long long)f->size);
 	if (actual >= 0 && (size_t)actual == f->size) {
 		*total_bytes = actual;
 		return VINE_SUCCESS;
@@ -347,6 +445,7 @@ static vine_result_code_t vine_manager_put_input_file(struct vine_manager *q, st
 		w->total_transfer_time += elapsed_time;
 
 		q->stats->bytes_sent += total_bytes;
+		q->transfer_bytes_this_cycle += total_bytes;
 
 		// Write to the transaction log.
 		if (f->type == VINE_FILE || f->type == VINE_BUFFER) {
@@ -78,6 +78,30 @@ struct rmsummary **vine_manager_summarize_workers(struct vine_manager *q)
 	char *id;
 	char *resources_key;
 
+	/*
+	Status tools poll this every few seconds; rebuilding and sorting
+	the summary is O(workers), so memoize it for the current worker
+	membership: the result only changes when a worker joins or
+	leaves, which the cheap membership counters reveal.  The caller
+	frees the returned array, so each call gets a copy of the cached
+	summaries.
+	*/
+	static struct rmsummary **cached = 0;
+	static int cached_count = 0;
+	static int64_t cached_generation = -1;
+	static struct vine_manager *cached_manager = 0;
+
+	int64_t generation = q->stats->workers_joined * 1000003 + q->stats->workers_removed;
+	if (cached && q == cached_manager && generation == cached_generation) {
+		struct rmsummary **copy = malloc((cached_count + 1) * sizeof(struct rmsummary *));
+		int i;
+		for (i = 0; i < cached_count; i++) {
+			copy[i] = rmsummary_copy(cached[i], 0);
+		}
+		copy[cached_count] = NULL;
+		return copy;
+	}
+
 	struct hash_table *workers_count = hash_table_create(0, 0);
 
 	HASH_TABLE_ITERATE(q->worker_table, id, w)
@@ -130,5 +154,23 @@ struct rmsummary **vine_manager_summarize_workers(struct vine_manager *q)
 	sort_worker_summary(worker_data, count, "cores");
 	sort_worker_summary(worker_data, count, "workers");
 
+	/* remember this summary for the next poll of the same membership */
+	if (cached) {
+		int i;
+		for (i = 0; i < cached_count; i++) {
+			rmsummary_delete(cached[i]);
+		}
+		free(cached);
+	}
+	cached = malloc((count + 1) * sizeof(struct rmsummary *));
+	int i;
+	for (i = 0; i < count; i++) {
+		cached[i] = rmsummary_copy(worker_data[i], 0);
+	}
+	cached[count] = NULL;
+	cached_count = count;
+	cached_generation = generation;
+	cached_manager = q;
+
 	return worker_data;
 }
@@ -57,6 +57,19 @@ void vine_perf_log_write_update(struct vine_manager *q, int force)
 		return;
 	}
 
+	/*
+	Computing the full stats row walks the worker and task tables, so
+	when the cheap event counters show nothing has happened since the
+	last row, stretch the cadence: an idle manager logs (and walks)
+	once a minute instead of every interval, snapping back to the
+	base cadence on the first real event.
+	*/
+	int64_t activity = 1 + q->stats->tasks_submitted + q->stats->tasks_done + q->stats->tasks_failed + q->stats->tasks_dispatched + q->stats->workers_joined + q->stats->workers_removed;
+	if (!force && activity == q->perf_log_last_activity && (now - q->time_last_log_stats) < (long unsigned int)(ONE_SECOND * 60)) {
+		return;
+	}
+	q->perf_log_last_activity = activity;
+
 	vine_get_stats(q, &s);
 	debug(D_VINE, "workers connections -- known: %d, connecting: %d", s.workers_connected, s.workers_init);
 
@@ -13,7 +13,20 @@ worker, and catalog, but should not be visible to the public user API.
 #ifndef VINE_PROTOCOL_H
 #define VINE_PROTOCOL_H
 
-#define VINE_PROTOCOL_VERSION 11
+#define VINE_PROTOCOL_VERSION 12
+
+/*
+High-frequency messages may travel as binary frames instead of text.
+A frame begins with the byte VINE_FRAME_START, which can never begin a
+text line, followed by a one-byte frame type and a fixed-layout payload
+with integers in network order.  Since protocol versions must match
+exactly, both ends of a connection understand the same frames; all
+other messages remain text.
+*/
+
+#define VINE_FRAME_START 0x01
+
+#define VINE_FRAME_CACHE_UPDATE 0x01
 
 #define VINE_LINE_MAX 4096       /**< Maximum length of a vine message line. */
 
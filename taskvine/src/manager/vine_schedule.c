@@ -5,6 +5,9 @@ See the file COPYING for details.
 */
 
 #include "vine_schedule.h"
+#include "set.h"
+#include "string_set.h"
+#include "priority_queue.h"
 #include "vine_blocklist.h"
 #include "vine_factory_info.h"
 #include "vine_file.h"
@@ -14,6 +17,7 @@ See the file COPYING for details.
 #include "debug.h"
 #include "hash_table.h"
 #include "list.h"
+#include "xxmalloc.h"
 #include "macros.h"
 #include "rmonitor_types.h"
 #include "rmsummary.h"
@@ -61,7 +65,7 @@ int vine_schedule_in_ramp_down(struct vine_manager *q)
 		return 0;
 	}
 
-	if (hash_table_size(q->worker_table) > list_size(q->ready_list)) {
+	if (hash_table_size(q->worker_table) > priority_queue_size(q->ready_tasks)) {
 		return 1;
 	}
 
@@ -342,6 +346,87 @@ static struct vine_worker_info *find_worker_by_files(struct vine_manager *q, str
 
 	int ramp_down = vine_schedule_in_ramp_down(q);
 
+	/*
+	First consider just the workers already holding one of the task's
+	cacheable inputs, found through the file-to-workers index, so the
+	common case of locality scheduling does not scan the whole worker
+	table.  Any eligible worker found this way has strictly more
+	cached bytes than the workers outside the index, so the full scan
+	below is only needed when the index yields nothing.  Candidates
+	are remembered by hash key, since eligibility checks can
+	disconnect a worker as a side effect.
+	*/
+	if (!ramp_down) {
+		struct list *candidate_keys = 0;
+		struct string_set *seen = 0;
+
+		LIST_ITERATE(t->input_mounts, m)
+		{
+			if (m->file->cache_level <= VINE_CACHE_LEVEL_TASK)
+				continue;
+			struct set *holders = hash_table_lookup(q->file_worker_table, m->file->cached_name);
+			if (!holders)
+				continue;
+			struct vine_worker_info *holder;
+			SET_ITERATE(holders, holder)
+			{
+				if (!candidate_keys) {
+					candidate_keys = list_create();
+					seen = string_set_create(0, 0);
+				}
+				if (string_set_insert(seen, holder->hashkey)) {
+					list_push_tail(candidate_keys, xxstrdup(holder->hashkey));
+				}
+			}
+		}
+
+		if (candidate_keys) {
+			char *candidate_key;
+			while ((candidate_key = list_pop_head(candidate_keys))) {
+				w = hash_table_lookup(q->worker_table, candidate_key);
+				free(candidate_key);
+				if (!w)
+					continue;
+
+				if (check_worker_against_task(q, w, t)) {
+					task_cached_bytes = 0;
+					has_all_files = 1;
+
+					LIST_ITERATE(t->input_mounts, m)
+					{
+						replica = hash_table_lookup(w->current_files, m->file->cached_name);
+
+						if (replica && m->file->type == VINE_FILE) {
+							task_cached_bytes += replica->size;
+						} else if (m->file->cache_level > VINE_CACHE_LEVEL_TASK) {
+							has_all_files = 0;
+						}
+					}
+
+					if (has_all_files) {
+						while ((candidate_key = list_pop_head(candidate_keys))) {
+							free(candidate_key);
+						}
+						list_delete(candidate_keys);
+						string_set_delete(seen);
+						return w;
+					}
+
+					if (!best_worker || task_cached_bytes > most_task_cached_bytes) {
+						best_worker = w;
+						most_task_cached_bytes = task_cached_bytes;
+					}
+				}
+			}
+			list_delete(candidate_keys);
+			string_set_delete(seen);
+
+			if (best_worker) {
+				return best_worker;
+			}
+		}
+	}
+
 	HASH_TABLE_ITERATE_RANDOM_START(q->worker_table, offset_bookkeep, key, w)
 	{
 		/* Careful: If check_worker_against task fails, then w may no longer be valid. */
@@ -611,7 +696,8 @@ void vine_schedule_check_for_large_tasks(struct vine_manager *q)
 
 	struct rmsummary *largest_unfit_task = rmsummary_create(-1);
 
-	LIST_ITERATE(q->ready_list, t)
+	int ready_i;
+	PRIORITY_QUEUE_ITERATE(q->ready_tasks, ready_i, t)
 	{
 
 		// check each task against the queue of connected workers
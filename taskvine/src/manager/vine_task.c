@@ -196,6 +196,30 @@ struct vine_task *vine_task_addref(struct vine_task *t)
 	return t;
 }
 
+/*
+A template is an ordinary task that is never submitted itself.  An
+instance shares the template's file objects by reference (the mount
+records themselves are copied, since they carry per-dispatch state
+such as substitute transfer sources) and overrides just the command
+line; further per-instance deltas are applied with the usual setters.
+This keeps per-instance memory to the small mount and string
+structures while millions of instances share the underlying files,
+environment definitions, and resource descriptions.
+*/
+
+struct vine_task *vine_task_create_from_template(struct vine_task *template_task, const char *command_line)
+{
+	struct vine_task *new = vine_task_copy(template_task);
+	if (!new)
+		return 0;
+
+	if (command_line) {
+		vine_task_set_command(new, command_line);
+	}
+
+	return new;
+}
+
 struct vine_task *vine_task_copy(const struct vine_task *task)
 {
 	if (!task)
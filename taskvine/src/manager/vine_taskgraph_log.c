@@ -3,13 +3,126 @@
 #include "vine_mount.h"
 #include "vine_task.h"
 
+#include "hash_table.h"
 #include "path.h"
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 static int show_names = 0;
 
+/*
+With taskgraph-log-binary set, the graph streams as compact binary
+records instead of DOT text: every file node is interned the first
+time it appears and referenced by a small integer afterwards, so an
+edge costs a tag and two varints rather than repeating a 40-character
+cached name.  The stream stays append-only and O(1) in manager
+memory apart from the intern table, and vine_graph_tool converts it
+to the same DOT output offline.  Records:
+
+    0x01 varint(fid) varint(len) bytes   define file node
+    0x02 varint(tid) varint(len) bytes   define task node
+    0x03 varint(fid) varint(tid)         edge file -> task
+    0x04 varint(tid) varint(fid)         edge task -> file
+*/
+
+#define GRAPH_BINARY_MARKER "# VGRB1\n"
+
+struct vine_graph_log_state {
+	struct hash_table *file_ids;
+	uint64_t next_file_id;
+	int binary_started;
+};
+
+/* Per-manager state, so a second manager in one process starts its
+own marker and intern table instead of continuing the first's. */
+static struct vine_graph_log_state *graph_state(struct vine_manager *q)
+{
+	if (!q->graph_log_state) {
+		struct vine_graph_log_state *s = malloc(sizeof(*s));
+		s->file_ids = hash_table_create(0, 0);
+		s->next_file_id = 0;
+		s->binary_started = 0;
+		q->graph_log_state = s;
+	}
+	return q->graph_log_state;
+}
+
+void vine_taskgraph_log_free_state(struct vine_manager *q)
+{
+	struct vine_graph_log_state *s = q->graph_log_state;
+	if (!s)
+		return;
+	hash_table_delete(s->file_ids);
+	free(s);
+	q->graph_log_state = 0;
+}
+
+static void graph_put_varint(FILE *stream, uint64_t v)
+{
+	do {
+		unsigned char b = v & 0x7F;
+		v >>= 7;
+		if (v)
+			b |= 0x80;
+		fputc(b, stream);
+	} while (v);
+}
+
+static uint64_t graph_file_id(struct vine_manager *q, const char *cached_name)
+{
+	struct vine_graph_log_state *s = graph_state(q);
+
+	void *id = hash_table_lookup(s->file_ids, cached_name);
+	if (id)
+		return (uint64_t)(uintptr_t)id;
+
+	uint64_t fid = ++s->next_file_id;
+	hash_table_insert(s->file_ids, cached_name, (void *)(uintptr_t)fid);
+
+	fputc(0x01, q->graph_logfile);
+	graph_put_varint(q->graph_logfile, fid);
+	size_t len = strlen(cached_name);
+	graph_put_varint(q->graph_logfile, len);
+	fwrite(cached_name, 1, len, q->graph_logfile);
+
+	return fid;
+}
+
+static void graph_task_node(struct vine_manager *q, uint64_t tid, const char *label)
+{
+	fputc(0x02, q->graph_logfile);
+	graph_put_varint(q->graph_logfile, tid);
+	size_t len = label ? strlen(label) : 0;
+	graph_put_varint(q->graph_logfile, len);
+	if (len)
+		fwrite(label, 1, len, q->graph_logfile);
+}
+
+static void graph_edge(struct vine_manager *q, int tag, uint64_t from, uint64_t to)
+{
+	fputc(tag, q->graph_logfile);
+	graph_put_varint(q->graph_logfile, from);
+	graph_put_varint(q->graph_logfile, to);
+}
+
+/*
+The header is written before tuning can enable binary mode, so the
+binary stream begins with a marker line emitted lazily at the first
+record; the converter discards whatever text precedes it.
+*/
+
+static void graph_binary_begin(struct vine_manager *q)
+{
+	struct vine_graph_log_state *s = graph_state(q);
+	if (!s->binary_started) {
+		s->binary_started = 1;
+		fputs(GRAPH_BINARY_MARKER, q->graph_logfile);
+	}
+}
+
 void vine_taskgraph_log_write_header(struct vine_manager *q)
 {
 	fprintf(q->graph_logfile, "digraph \"taskvine\" {\n");
@@ -28,7 +141,12 @@ void vine_taskgraph_log_write_task(struct vine_manager *q, struct vine_task *t)
 	if (p)
 		*p = 0;
 
-	fprintf(q->graph_logfile, "\"task-%d\" [color=green,label=\"%s\"];\n", id, show_names ? path_basename(name) : "");
+	if (q->graph_log_binary) {
+		graph_binary_begin(q);
+		graph_task_node(q, id, show_names ? path_basename(name) : "");
+	} else {
+		fprintf(q->graph_logfile, "\"task-%d\" [color=green,label=\"%s\"];\n", id, show_names ? path_basename(name) : "");
+	}
 
 	free(name);
 
@@ -36,12 +154,20 @@ void vine_taskgraph_log_write_task(struct vine_manager *q, struct vine_task *t)
 
 	LIST_ITERATE(t->input_mounts, m)
 	{
-		fprintf(q->graph_logfile, "\"file-%s\" -> \"task-%d\";\n", m->file->cached_name, id);
+		if (q->graph_log_binary) {
+			graph_edge(q, 0x03, graph_file_id(q, m->file->cached_name), id);
+		} else {
+			fprintf(q->graph_logfile, "\"file-%s\" -> \"task-%d\";\n", m->file->cached_name, id);
+		}
 	}
 
 	LIST_ITERATE(t->output_mounts, m)
 	{
-		fprintf(q->graph_logfile, "\"task-%d\" -> \"file-%s\";\n", id, m->file->cached_name);
+		if (q->graph_log_binary) {
+			graph_edge(q, 0x04, id, graph_file_id(q, m->file->cached_name));
+		} else {
+			fprintf(q->graph_logfile, "\"task-%d\" -> \"file-%s\";\n", id, m->file->cached_name);
+		}
 	}
 }
 
@@ -58,7 +184,12 @@ void vine_taskgraph_log_write_mini_task(struct vine_manager *q, struct vine_task
 	if (p)
 		*p = 0;
 
-	fprintf(q->graph_logfile, "\"task-%d\" [color=green,label=\"%s\"];\n", id, show_names ? task_name : "");
+	if (q->graph_log_binary) {
+		graph_binary_begin(q);
+		graph_task_node(q, (uint32_t)id, show_names ? task_name : "");
+	} else {
+		fprintf(q->graph_logfile, "\"task-%d\" [color=green,label=\"%s\"];\n", id, show_names ? task_name : "");
+	}
 
 	free(name);
 
@@ -66,11 +197,19 @@ void vine_taskgraph_log_write_mini_task(struct vine_manager *q, struct vine_task
 
 	LIST_ITERATE(t->input_mounts, m)
 	{
-		fprintf(q->graph_logfile, "\"file-%s\" -> \"task-%d\";\n", m->file->cached_name, id);
+		if (q->graph_log_binary) {
+			graph_edge(q, 0x03, graph_file_id(q, m->file->cached_name), (uint32_t)id);
+		} else {
+			fprintf(q->graph_logfile, "\"file-%s\" -> \"task-%d\";\n", m->file->cached_name, id);
+		}
 	}
 
 	/* A mini-task has one implied output that is named by provided argument, not the data structure */
-	fprintf(q->graph_logfile, "\"task-%d\" -> \"file-%s\";\n", id, output_name);
+	if (q->graph_log_binary) {
+		graph_edge(q, 0x04, (uint32_t)id, graph_file_id(q, output_name));
+	} else {
+		fprintf(q->graph_logfile, "\"task-%d\" -> \"file-%s\";\n", id, output_name);
+	}
 }
 
 void vine_taskgraph_log_write_file(struct vine_manager *q, struct vine_file *f)
@@ -78,11 +217,19 @@ void vine_taskgraph_log_write_file(struct vine_manager *q, struct vine_file *f)
 	if (!f)
 		return;
 
-	fprintf(q->graph_logfile, "\"file-%s\" [shape=rect,color=blue,label=\"%s\"];\n", f->cached_name, (show_names && f->source) ? path_basename(f->source) : "");
+	if (q->graph_log_binary) {
+		graph_binary_begin(q);
+		graph_file_id(q, f->cached_name);
+	} else {
+		fprintf(q->graph_logfile, "\"file-%s\" [shape=rect,color=blue,label=\"%s\"];\n", f->cached_name, (show_names && f->source) ? path_basename(f->source) : "");
+	}
 	vine_taskgraph_log_write_mini_task(q, f->mini_task, f->source, f->cached_name);
 }
 
 void vine_taskgraph_log_write_footer(struct vine_manager *q)
 {
+	if (q->graph_log_state && ((struct vine_graph_log_state *)q->graph_log_state)->binary_started)
+		return;
+
 	fprintf(q->graph_logfile, "}\n");
 }
@@ -20,5 +20,8 @@ void vine_taskgraph_log_write_task( struct vine_manager *q, struct vine_task *t
 void vine_taskgraph_log_write_file( struct vine_manager *q, struct vine_file *f );
 void vine_taskgraph_log_write_footer( struct vine_manager *q );
 
+/* Release the interning state owned by this module. */
+void vine_taskgraph_log_free_state( struct vine_manager *q );
+
 #endif
 
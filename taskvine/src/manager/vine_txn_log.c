@@ -10,6 +10,8 @@ See the file COPYING for details.
 #include "vine_worker_info.h"
 
 #include "buffer.h"
+#include "timestamp.h"
+#include "hash_table.h"
 #include "jx.h"
 #include "jx_print.h"
 #include "macros.h"
@@ -17,16 +19,270 @@ See the file COPYING for details.
 #include "rmsummary.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+/*
+Transaction records are appended to an in-memory segment on the
+dispatch path and written out by a background thread, which swaps in a
+fresh segment while it writes the full one, so a task state change
+never waits on the log filesystem.  vine_txn_log_flush drains both
+segments for shutdown and for readers that need a crash-consistent
+view.
+*/
+
+#define TXN_SEGMENT_SIZE (256 * 1024)
+
+/*
+Binary transaction log (tune txn-log-binary): after a marker line, each
+record is a varint-encoded token stream -- the timestamp as a delta
+from the previous record, integer fields as varint literals, and every
+other word interned in a table built as the stream goes, so repeated
+task states, category names, and worker addresses cost one small id
+after first use.  vine_txn_tool decodes it back to the exact text
+form.  Records pass through the same segment buffers and flusher
+thread as the text form.
+*/
+
+#define TXN_BINARY_MARKER "# VTXB1\n"
+
+/*
+All of the log's buffering, flusher, and interning state lives in one
+structure hung off the manager, so several managers created in one
+process (or one created after another is deleted) each get their own
+flusher and their own intern table; process-global state here would
+latch the first manager's FILE* and intern ids.
+*/
+
+struct vine_txn_state {
+	char *fill;   /* segment being appended to */
+	char *drain;  /* segment being written out */
+	size_t fill_used;
+	FILE *file;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wakeup;
+	int flusher_running;
+	int writing;
+	int stop;
+
+	int binary;
+	struct hash_table *intern;
+	uint64_t intern_next;
+	uint64_t last_time;
+};
+
+static void *txn_flusher_main(void *arg)
+{
+	struct vine_txn_state *s = arg;
+
+	pthread_mutex_lock(&s->lock);
+	while (1) {
+		while (s->fill_used == 0 && !s->stop) {
+			pthread_cond_wait(&s->wakeup, &s->lock);
+		}
+		if (s->fill_used == 0 && s->stop)
+			break;
+
+		/* swap the buffers and write the full one without the lock */
+		char *segment = s->fill;
+		size_t length = s->fill_used;
+		s->fill = s->drain;
+		s->drain = segment;
+		s->fill_used = 0;
+		s->writing = 1;
+		pthread_mutex_unlock(&s->lock);
+
+		fwrite(segment, 1, length, s->file);
+		fflush(s->file);
+
+		pthread_mutex_lock(&s->lock);
+		s->writing = 0;
+		pthread_cond_broadcast(&s->wakeup);
+	}
+	pthread_mutex_unlock(&s->lock);
+	return 0;
+}
+
+void vine_txn_log_flush(struct vine_manager *q)
+{
+	struct vine_txn_state *s = q->txn_log_state;
+
+	if (!q->txn_logfile || !s)
+		return;
+
+	pthread_mutex_lock(&s->lock);
+	while (s->fill_used > 0 || s->writing) {
+		pthread_cond_signal(&s->wakeup);
+		pthread_cond_wait(&s->wakeup, &s->lock);
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	fflush(q->txn_logfile);
+}
+
+/* Drain the log, stop the flusher, and release the state; called by
+vine_delete before the logfile is closed. */
+
+void vine_txn_log_stop(struct vine_manager *q)
+{
+	struct vine_txn_state *s = q->txn_log_state;
+
+	if (!s)
+		return;
+
+	if (s->flusher_running) {
+		pthread_mutex_lock(&s->lock);
+		s->stop = 1;
+		pthread_cond_broadcast(&s->wakeup);
+		pthread_mutex_unlock(&s->lock);
+		pthread_join(s->thread, 0);
+	}
+
+	free(s->fill);
+	free(s->drain);
+	if (s->intern)
+		hash_table_delete(s->intern);
+	free(s);
+	q->txn_log_state = 0;
+}
+
+static int txn_varint(unsigned char *out, uint64_t v)
+{
+	int n = 0;
+	do {
+		unsigned char b = v & 0x7F;
+		v >>= 7;
+		if (v)
+			b |= 0x80;
+		out[n++] = b;
+	} while (v);
+	return n;
+}
+
+/* Encode one record into out (which must hold 2x the input); returns length. */
+static int txn_encode(struct vine_txn_state *s, unsigned char *out, uint64_t now, const char *str)
+{
+	int n = 0;
+
+	n += txn_varint(out + n, now - s->last_time);
+	s->last_time = now;
+
+	/* tokens: the pid then the words of str; count real tokens the
+	same way strtok will produce them, so runs of spaces cannot put
+	the reader out of step */
+	char line[4096];
+	snprintf(line, sizeof(line), "%d %s", getpid(), str);
+
+	char counted[4096];
+	memcpy(counted, line, sizeof(counted));
+	int ntokens = 0;
+	char *save = NULL;
+	char *tok;
+	for (tok = strtok_r(counted, " ", &save); tok; tok = strtok_r(NULL, " ", &save))
+		ntokens++;
+	n += txn_varint(out + n, ntokens);
+
+	save = NULL;
+	for (tok = strtok_r(line, " ", &save); tok; tok = strtok_r(NULL, " ", &save)) {
+		char *end;
+		long long value = strtoll(tok, &end, 10);
+		if (*tok && !*end) {
+			/* integer literal, zigzag encoded */
+			out[n++] = 1;
+			uint64_t z = (value << 1) ^ (value >> 63);
+			n += txn_varint(out + n, z);
+			continue;
+		}
+
+		/* interned ids are 1-based; the wire value is id+1 so that
+		0 and 1 stay free for the new-string and integer tags */
+		void *id = hash_table_lookup(s->intern, tok);
+		if (id) {
+			n += txn_varint(out + n, (uint64_t)(uintptr_t)id + 1);
+		} else {
+			s->intern_next++;
+			hash_table_insert(s->intern, tok, (void *)(uintptr_t)s->intern_next);
+			size_t len = strlen(tok);
+			out[n++] = 0;
+			n += txn_varint(out + n, len);
+			memcpy(out + n, tok, len);
+			n += len;
+		}
+	}
+
+	return n;
+}
+
 void vine_txn_log_write(struct vine_manager *q, const char *str)
 {
 	if (!q->txn_logfile)
 		return;
 
-	fprintf(q->txn_logfile, "%" PRIu64 " %d %s\n", timestamp_get(), getpid(), str);
-	fflush(q->txn_logfile);
+	struct vine_txn_state *s = q->txn_log_state;
+	if (!s) {
+		s = calloc(1, sizeof(*s));
+		if (!s) {
+			fprintf(q->txn_logfile, "%" PRIu64 " %d %s\n", timestamp_get(), getpid(), str);
+			fflush(q->txn_logfile);
+			return;
+		}
+		pthread_mutex_init(&s->lock, 0);
+		pthread_cond_init(&s->wakeup, 0);
+		q->txn_log_state = s;
+	}
+
+	pthread_mutex_lock(&s->lock);
+
+	if (!s->flusher_running) {
+		s->fill = malloc(TXN_SEGMENT_SIZE);
+		s->drain = malloc(TXN_SEGMENT_SIZE);
+		s->file = q->txn_logfile;
+		if (s->fill && s->drain && pthread_create(&s->thread, 0, txn_flusher_main, s) == 0) {
+			s->flusher_running = 1;
+		} else {
+			/* no flusher: write synchronously as before */
+			pthread_mutex_unlock(&s->lock);
+			fprintf(q->txn_logfile, "%" PRIu64 " %d %s\n", timestamp_get(), getpid(), str);
+			fflush(q->txn_logfile);
+			return;
+		}
+	}
+
+	char record[8192];
+	int n;
+	if (q->txn_log_binary) {
+		if (!s->binary) {
+			/* switch the stream to binary after a marker line */
+			s->binary = 1;
+			s->intern = hash_table_create(0, 0);
+			memcpy(s->fill + s->fill_used, TXN_BINARY_MARKER, strlen(TXN_BINARY_MARKER));
+			s->fill_used += strlen(TXN_BINARY_MARKER);
+		}
+		/* Record stamps use the per-iteration cached clock: many
+		records land in one event loop pass, and one clock read per
+		pass is the precision the log needs. */
+		n = txn_encode(s, (unsigned char *)record, timestamp_get_cached(), str);
+	} else {
+		n = snprintf(record, sizeof(record), "%" PRIu64 " %d %s\n", timestamp_get_cached(), getpid(), str);
+		if (n > (int)sizeof(record) - 1)
+			n = sizeof(record) - 1;
+	}
+
+	/* if the segment is full, wait for the flusher to swap it out */
+	while (s->fill_used + n > TXN_SEGMENT_SIZE) {
+		pthread_cond_signal(&s->wakeup);
+		pthread_cond_wait(&s->wakeup, &s->lock);
+	}
+
+	memcpy(s->fill + s->fill_used, record, n);
+	s->fill_used += n;
+
+	pthread_cond_signal(&s->wakeup);
+	pthread_mutex_unlock(&s->lock);
 }
 
 void vine_txn_log_write_header(struct vine_manager *q)
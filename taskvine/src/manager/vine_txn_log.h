@@ -23,6 +23,12 @@ This module is private to the manager and should not be invoked by the end user.
 
 void vine_txn_log_write_header( struct vine_manager *q );
 void vine_txn_log_write_manager(struct vine_manager *q, const char *str);
+
+/* Wait until every buffered transaction record has reached the log file. */
+void vine_txn_log_flush(struct vine_manager *q);
+
+/* Drain the log, stop the flusher thread, and release its state. */
+void vine_txn_log_stop( struct vine_manager *q );
 void vine_txn_log_write_task(struct vine_manager *q, struct vine_task *t);
 void vine_txn_log_write_category(struct vine_manager *q, struct category *c);
 void vine_txn_log_write_worker(struct vine_manager *q, struct vine_worker_info *w, int leaving, vine_worker_disconnect_reason_t reason_leaving);
@@ -5,6 +5,7 @@ See the file COPYING for details.
 */
 
 #include "vine_worker_info.h"
+#include "link.h"
 #include "vine_counters.h"
 #include "vine_file_replica.h"
 #include "vine_protocol.h"
@@ -123,6 +124,17 @@ struct jx *vine_worker_to_jx(struct vine_worker_info *w)
 	jx_insert_integer(j, "total_bytes_transferred", w->total_bytes_transferred);
 	jx_insert_integer(j, "total_transfer_time", w->total_transfer_time);
 
+	/* Per-link transfer counters, so a slow-network worker can be
+	spotted from status output rather than tcpdump. */
+	struct link_stats ls;
+	if (w->link && link_get_stats(w->link, &ls)) {
+		jx_insert_integer(j, "link_bytes_received", ls.bytes_read);
+		jx_insert_integer(j, "link_bytes_sent", ls.bytes_written);
+		jx_insert_integer(j, "link_blocked_write_time", ls.blocked_write_usecs);
+		jx_insert_integer(j, "link_blocked_writes", ls.blocked_writes);
+		jx_insert_double(j, "link_throughput_bps", ls.throughput_bps);
+	}
+
 	jx_insert_integer(j, "start_time", w->start_time);
 	jx_insert_integer(j, "current_time", timestamp_get());
 
@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+/*
+vine_graph_tool - convert a binary taskgraph log to DOT.
+
+The binary form (tune taskgraph-log-binary) interns every file node
+so edges are a tag and two varints; this tool replays the stream and
+emits the same DOT graph the manager would have written directly, so
+visualization works unchanged while production-scale runs log in
+bounded space.  A log that does not begin with the binary marker is
+passed through untouched.
+*/
+
+#include "cctools.h"
+#include "getopt_aux.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GRAPH_BINARY_MARKER "# VGRB1\n"
+
+static char **file_names = NULL;
+static size_t file_count = 0;
+static size_t file_capacity = 0;
+
+static int read_varint(FILE *f, uint64_t *value)
+{
+	uint64_t v = 0;
+	int shift = 0;
+	int c;
+	while ((c = getc_unlocked(f)) != EOF) {
+		v |= ((uint64_t)(c & 0x7F)) << shift;
+		if (!(c & 0x80)) {
+			*value = v;
+			return 1;
+		}
+		shift += 7;
+		if (shift > 63)
+			return 0;
+	}
+	return 0;
+}
+
+static char *read_string(FILE *f)
+{
+	uint64_t len;
+	if (!read_varint(f, &len) || len > 65536)
+		return NULL;
+	char *s = malloc(len + 1);
+	if (fread(s, 1, len, f) != len) {
+		free(s);
+		return NULL;
+	}
+	s[len] = 0;
+	return s;
+}
+
+static const char *file_name_of(uint64_t fid)
+{
+	if (fid == 0 || fid > file_count)
+		return "?";
+	return file_names[fid - 1];
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+		printf("Use: %s <taskgraph-log>\n", argv[0]);
+		printf("Converts a binary taskgraph log to DOT on stdout.\n");
+		return argc != 2;
+	}
+
+	FILE *f = fopen(argv[1], "r");
+	if (!f) {
+		fprintf(stderr, "vine_graph_tool: couldn't open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	/* Discard text up to the binary marker; an all-text log passes through. */
+	char line[4096];
+	int binary = 0;
+	long text_end = 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (!strcmp(line, GRAPH_BINARY_MARKER)) {
+			binary = 1;
+			break;
+		}
+		text_end = ftell(f);
+	}
+	if (!binary) {
+		fseek(f, 0, SEEK_SET);
+		while (fgets(line, sizeof(line), f)) {
+			fputs(line, stdout);
+		}
+		fclose(f);
+		return 0;
+	}
+	(void)text_end;
+
+	printf("digraph \"taskvine\" {\n");
+	printf("node [style=filled,font=Helvetica,fontsize=10];\n");
+
+	int c;
+	while ((c = getc_unlocked(f)) != EOF) {
+		uint64_t a, b;
+		switch (c) {
+		case 0x01: {
+			if (!read_varint(f, &a))
+				goto corrupt;
+			char *name = read_string(f);
+			if (!name)
+				goto corrupt;
+			if (file_count >= file_capacity) {
+				file_capacity = file_capacity ? file_capacity * 2 : 4096;
+				file_names = realloc(file_names, file_capacity * sizeof(*file_names));
+			}
+			file_names[file_count++] = name;
+			printf("\"file-%s\" [shape=rect,color=blue,label=\"\"];\n", name);
+			break;
+		}
+		case 0x02: {
+			if (!read_varint(f, &a))
+				goto corrupt;
+			char *label = read_string(f);
+			if (!label)
+				goto corrupt;
+			printf("\"task-%" PRIu64 "\" [color=green,label=\"%s\"];\n", a, label);
+			free(label);
+			break;
+		}
+		case 0x03:
+			if (!read_varint(f, &a) || !read_varint(f, &b))
+				goto corrupt;
+			printf("\"file-%s\" -> \"task-%" PRIu64 "\";\n", file_name_of(a), b);
+			break;
+		case 0x04:
+			if (!read_varint(f, &a) || !read_varint(f, &b))
+				goto corrupt;
+			printf("\"task-%" PRIu64 "\" -> \"file-%s\";\n", a, file_name_of(b));
+			break;
+		default:
+			goto corrupt;
+		}
+	}
+
+	printf("}\n");
+	fclose(f);
+	return 0;
+
+corrupt:
+	fprintf(stderr, "vine_graph_tool: truncated or corrupt record\n");
+	printf("}\n");
+	fclose(f);
+	return 1;
+}
+
+/* vim: set noexpandtab tabstop=8: */
@@ -0,0 +1,287 @@
+/*
+Copyright (C) 2026 The University of Notre Dame
+This software is distributed under the GNU General Public License.
+See the file COPYING for details.
+*/
+
+/*
+vine_txn_tool - decode, filter, and summarize binary transaction logs.
+
+The binary form (tune txn-log-binary) begins where the "# VTXB1"
+marker line appears; everything before it is ordinary text and is
+passed through.  Decoding reproduces the exact text lines the manager
+would have written, so existing analytics keep working; --type filters
+records by their event word (TASK, WORKER, TRANSFER, ...) without
+materializing the rest, and --count just tallies events per type.
+*/
+
+#include "cctools.h"
+#include "debug.h"
+#include "getopt_aux.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TXN_BINARY_MARKER "# VTXB1\n"
+
+static char **intern_table = NULL;
+static size_t intern_count = 0;
+static size_t intern_capacity = 0;
+
+static void intern_add(char *s)
+{
+	if (intern_count >= intern_capacity) {
+		intern_capacity = intern_capacity ? intern_capacity * 2 : 4096;
+		intern_table = realloc(intern_table, intern_capacity * sizeof(*intern_table));
+		if (!intern_table) {
+			fprintf(stderr, "vine_txn_tool: out of memory\n");
+			exit(1);
+		}
+	}
+	intern_table[intern_count++] = s;
+}
+
+static int read_varint(FILE *f, uint64_t *value)
+{
+	uint64_t v = 0;
+	int shift = 0;
+	int c;
+	while ((c = getc_unlocked(f)) != EOF) {
+		v |= ((uint64_t)(c & 0x7F)) << shift;
+		if (!(c & 0x80)) {
+			*value = v;
+			return 1;
+		}
+		shift += 7;
+		if (shift > 63)
+			return 0;
+	}
+	return 0;
+}
+
+static void show_help(const char *cmd)
+{
+	printf("Use: %s [options] <transactions-log>\n", cmd);
+	printf("where options are:\n");
+	printf(" -t,--type=<word>   Only emit records whose event word matches (e.g. TASK).\n");
+	printf(" -c,--count         Tally records per event word instead of emitting them.\n");
+	printf(" -v,--version       Show version string.\n");
+	printf(" -h,--help          Show this help screen.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *type_filter = NULL;
+	int count_mode = 0;
+
+	static const struct option long_options[] = {
+			{"type", required_argument, 0, 't'},
+			{"count", no_argument, 0, 'c'},
+			{"version", no_argument, 0, 'v'},
+			{"help", no_argument, 0, 'h'},
+			{0, 0, 0, 0}};
+
+	int ch;
+	while ((ch = getopt_long(argc, argv, "t:cvh", long_options, NULL)) > -1) {
+		switch (ch) {
+		case 't':
+			type_filter = optarg;
+			break;
+		case 'c':
+			count_mode = 1;
+			break;
+		case 'v':
+			cctools_version_print(stdout, argv[0]);
+			return 0;
+		case 'h':
+		default:
+			show_help(argv[0]);
+			return ch == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind >= argc) {
+		show_help(argv[0]);
+		return 1;
+	}
+
+	FILE *f = fopen(argv[optind], "r");
+	if (!f) {
+		fprintf(stderr, "vine_txn_tool: couldn't open %s: %s\n", argv[optind], strerror(errno));
+		return 1;
+	}
+
+	/* pass text through until the binary marker (or EOF, for all-text logs) */
+	char line[65536];
+	int binary = 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (!strcmp(line, TXN_BINARY_MARKER)) {
+			binary = 1;
+			break;
+		}
+		if (!count_mode && !type_filter)
+			fputs(line, stdout);
+	}
+
+	/* tally of event words, for --count */
+	struct tally {
+		char *word;
+		uint64_t count;
+	};
+	struct tally *tallies = NULL;
+	size_t ntallies = 0;
+
+	uint64_t current_time = 0;
+	uint64_t records = 0;
+
+	while (binary) {
+		/*
+		A manager that reopens the same log writes a fresh marker
+		line and restarts its intern table and timestamp base; the
+		marker's first byte cannot begin a record (tag bytes are
+		small integers), so peek for it and resync.
+		*/
+		int first = getc_unlocked(f);
+		if (first == EOF)
+			break;
+		if (first == TXN_BINARY_MARKER[0]) {
+			/* a '#' line is reopened-log header text; a fresh marker
+			line resets the intern table and timestamp base */
+			char header[4096] = {(char)first, 0};
+			if (!fgets(header + 1, sizeof(header) - 1, f))
+				break;
+			if (!strcmp(header, TXN_BINARY_MARKER)) {
+				size_t drop;
+				for (drop = 0; drop < intern_count; drop++)
+					free(intern_table[drop]);
+				intern_count = 0;
+				current_time = 0;
+			}
+			continue;
+		}
+		if (first == '\n') {
+			/* blank separators and stray text between sessions */
+			continue;
+		}
+		ungetc(first, f);
+
+		uint64_t delta, ntokens;
+		if (!read_varint(f, &delta) || !read_varint(f, &ntokens))
+			break;
+		current_time += delta;
+		records++;
+
+		/* token 0 is the pid, token 1 the event word */
+		const char *event_word = NULL;
+		char out[65536];
+		int n = snprintf(out, sizeof(out), "%" PRIu64, current_time);
+
+		uint64_t i;
+		int bad = 0;
+		for (i = 0; i < ntokens && !bad; i++) {
+			uint64_t tag;
+			if (!read_varint(f, &tag)) {
+				bad = 1;
+				break;
+			}
+			const char *token = NULL;
+			char number[32];
+			if (tag == 0) {
+				uint64_t len;
+				if (!read_varint(f, &len) || len >= sizeof(out)) {
+					bad = 1;
+					break;
+				}
+				char *s = malloc(len + 1);
+				if (fread(s, 1, len, f) != len) {
+					free(s);
+					bad = 1;
+					break;
+				}
+				s[len] = 0;
+				intern_add(s);
+				token = s;
+			} else if (tag == 1) {
+				uint64_t z;
+				if (!read_varint(f, &z)) {
+					bad = 1;
+					break;
+				}
+				int64_t value = (z >> 1) ^ -(int64_t)(z & 1);
+				snprintf(number, sizeof(number), "%" PRId64, value);
+				token = number;
+			} else {
+				uint64_t id = tag - 2;
+				if (id >= intern_count) {
+					bad = 1;
+					break;
+				}
+				token = intern_table[id];
+			}
+
+			if (i == 1)
+				event_word = token;
+			if (n < (int)sizeof(out) - 1)
+				n += snprintf(out + n, sizeof(out) - n, " %s", token);
+		}
+		if (bad) {
+			/*
+			Anything that fails to parse -- a truncated tail, or the
+			stray text a reopening manager writes before its marker
+			-- is skipped by scanning forward to the next marker
+			line, where the stream becomes self-describing again.
+			*/
+			fprintf(stderr, "vine_txn_tool: unparseable data after %" PRIu64 " records, scanning for next session\n", records - 1);
+			int resync = 0;
+			char scanline[4096];
+			while (fgets(scanline, sizeof(scanline), f)) {
+				if (!strcmp(scanline, TXN_BINARY_MARKER)) {
+					resync = 1;
+					break;
+				}
+			}
+			if (!resync)
+				break;
+			size_t drop;
+			for (drop = 0; drop < intern_count; drop++)
+				free(intern_table[drop]);
+			intern_count = 0;
+			current_time = 0;
+			continue;
+		}
+
+		if (count_mode) {
+			size_t t;
+			for (t = 0; t < ntallies; t++) {
+				if (!strcmp(tallies[t].word, event_word ? event_word : "?"))
+					break;
+			}
+			if (t == ntallies) {
+				tallies = realloc(tallies, (ntallies + 1) * sizeof(*tallies));
+				tallies[t].word = strdup(event_word ? event_word : "?");
+				tallies[t].count = 0;
+				ntallies++;
+			}
+			tallies[t].count++;
+		} else if (!type_filter || (event_word && !strcmp(event_word, type_filter))) {
+			fputs(out, stdout);
+			putchar('\n');
+		}
+	}
+
+	if (count_mode) {
+		size_t t;
+		for (t = 0; t < ntallies; t++) {
+			printf("%-16s %" PRIu64 "\n", tallies[t].word, tallies[t].count);
+		}
+	}
+
+	fclose(f);
+	return 0;
+}
+
+/* vim: set noexpandtab tabstop=8: */
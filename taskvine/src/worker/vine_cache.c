@@ -358,6 +358,71 @@ int vine_cache_remove(struct vine_cache *c, const char *cachename, struct link *
 	return 1;
 }
 
+/*
+Evict least-recently-used cache entries until total cached bytes fall
+under the given budget.  Files mounted into running sandboxes are
+recognized by their extra hard links and skipped, as are objects still
+being transferred and forever-cached objects, and the manager is told
+of each eviction so its replica table stays truthful.
+*/
+
+int vine_cache_trim(struct vine_cache *c, int64_t budget, struct link *manager)
+{
+	if (budget <= 0)
+		return 0;
+
+	int64_t total = 0;
+	char *cachename;
+	struct vine_cache_file *f;
+
+	HASH_TABLE_ITERATE(c->table, cachename, f)
+	{
+		if (f->status == VINE_CACHE_STATUS_READY)
+			total += f->size;
+	}
+
+	int evicted = 0;
+
+	while (total > budget) {
+		struct vine_cache_file *oldest = 0;
+		char *oldest_name = 0;
+
+		HASH_TABLE_ITERATE(c->table, cachename, f)
+		{
+			if (f->status != VINE_CACHE_STATUS_READY)
+				continue;
+			if (f->cache_level >= VINE_CACHE_LEVEL_FOREVER)
+				continue;
+			if (oldest && f->last_used >= oldest->last_used)
+				continue;
+
+			/* an extra hard link means the file is inside a running sandbox */
+			char *data_path = vine_cache_data_path(c, cachename);
+			struct stat info;
+			int in_use = stat(data_path, &info) == 0 && info.st_nlink > 1;
+			free(data_path);
+			if (in_use)
+				continue;
+
+			oldest = f;
+			oldest_name = cachename;
+		}
+
+		if (!oldest)
+			break;
+
+		debug(D_VINE, "cache: evicting %s (%lld bytes, idle %.0fs) to meet cache budget", oldest_name, (long long)oldest->size, (timestamp_get() - oldest->last_used) / 1000000.0);
+
+		total -= oldest->size;
+		if (manager)
+			vine_worker_send_cache_invalid(manager, oldest_name, "evicted to meet cache size budget");
+		vine_cache_remove(c, oldest_name, manager);
+		evicted++;
+	}
+
+	return evicted;
+}
+
 /*
 Execute a shell command via popen and capture its output.
 On success, return true.
@@ -473,6 +538,11 @@ static int do_worker_transfer(struct vine_cache *c, struct vine_cache_file *f, c
 	stoptime = time(0) + 15;
 	worker_link = link_connect(addr, port_num, stoptime);
 
+	/* Cache ingest ranks below task I/O: pace the fetch if budgeted. */
+	if (worker_link && options->cache_ingest_bps) {
+		link_set_throttle(worker_link, options->cache_ingest_bps);
+	}
+
 	if (worker_link == NULL) {
 		*error_message = string_format("Could not establish connection with worker at: %s:%d", addr, port_num);
 		return 0;
@@ -595,6 +665,10 @@ or VINE_CACHE_STATUS_TRANSFERRED. On failure return VINE_CACHE_STATUS_FAILED.
 
 vine_cache_status_t vine_cache_ensure(struct vine_cache *c, const char *cachename)
 {
+	struct vine_cache_file *lru = hash_table_lookup(c->table, cachename);
+	if (lru)
+		lru->last_used = timestamp_get();
+
 	if (!strcmp(cachename, "0"))
 		return VINE_CACHE_STATUS_READY;
 
@@ -61,6 +61,11 @@ int vine_cache_add_mini_task( struct vine_cache *c, const char *cachename, const
 
 vine_cache_status_t vine_cache_ensure( struct vine_cache *c, const char *cachename);
 int vine_cache_remove( struct vine_cache *c, const char *cachename, struct link *manager );
+
+/* Evict least-recently-used entries until total cached bytes fall under the budget.
+Skips in-use, in-flight, and forever-cached objects, and notifies the manager
+of each eviction.  Returns the number of entries evicted. */
+int vine_cache_trim( struct vine_cache *c, int64_t budget, struct link *manager );
 int vine_cache_contains( struct vine_cache *c, const char *cachename );
 int vine_cache_wait( struct vine_cache *c, struct link *manager );
 
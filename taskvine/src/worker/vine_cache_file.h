@@ -35,6 +35,9 @@ struct vine_cache_file {
 	uint64_t size;                  // summed size of the file or dir tree in bytes
 	time_t mtime;                   // source mtime of original object
 	timestamp_t transfer_time;      // time to transfer (or create) the object
+
+	/* Last time a task asked for this object, for cache eviction. */
+	timestamp_t last_used;
 };
 
 struct vine_cache_file *vine_cache_file_create( vine_cache_type_t type, const char *source, struct vine_task *mini_task);
@@ -70,6 +70,47 @@ if not enough are available.
 void vine_gpus_allocate(int n, int task)
 {
 	int i;
+
+	/*
+	On common boards, GPUs within an aligned power-of-two group
+	(pairs, quads, octets) share NVLink or a PCIe switch, so
+	co-located allocations run faster and scattered singles starve
+	later multi-GPU tasks.  Choose the aligned group with the fewest
+	free GPUs that still fits the request (best fit): singles pack
+	into already-broken groups, and whole groups stay intact for
+	tasks that need them.
+	*/
+	int alignment = 1;
+	while (alignment < n)
+		alignment = alignment << 1;
+
+	if (alignment <= gpu_count) {
+		int best_start = -1;
+		int best_free = gpu_count + 1;
+		int start;
+		for (start = 0; start + alignment <= gpu_count; start += alignment) {
+			int free_count = 0;
+			for (i = start; i < start + alignment; i++) {
+				if (gpu_to_task[i] == 0)
+					free_count++;
+			}
+			if (free_count >= n && free_count < best_free) {
+				best_free = free_count;
+				best_start = start;
+			}
+		}
+
+		if (best_start >= 0) {
+			for (i = best_start; i < best_start + alignment && n > 0; i++) {
+				if (gpu_to_task[i] == 0) {
+					gpu_to_task[i] = task;
+					n--;
+				}
+			}
+		}
+	}
+
+	/* Fall back to any free GPUs if no aligned group could hold the request. */
 	for (i = 0; i < gpu_count && n > 0; i++) {
 		if (gpu_to_task[i] == 0) {
 			gpu_to_task[i] = task;
@@ -352,6 +352,16 @@ int vine_process_execute(struct vine_process *p)
 		return 0;
 
 	} else {
+		/*
+		The worker blocks SIGCHLD for its child-exit descriptor, and
+		the mask survives exec; restore it so the task starts with
+		the default signal environment.
+		*/
+		sigset_t childmask;
+		sigemptyset(&childmask);
+		sigaddset(&childmask, SIGCHLD);
+		sigprocmask(SIG_UNBLOCK, &childmask, 0);
+
 		if (chdir(p->sandbox)) {
 			printf("The sandbox dir is %s", p->sandbox);
 			fatal("could not change directory into %s: %s", p->sandbox, strerror(errno));
@@ -379,6 +389,25 @@ int vine_process_execute(struct vine_process *p)
 			close(pipe_out[0]);
 		}
 
+		/*
+		A phantom worker measures the manager-worker protocol, not
+		the tasks: the child touches each declared output so that
+		retrieval has something to ship, then exits successfully
+		without executing anything -- dispatch, accounting, and
+		retrieval all run at full fidelity while execution costs
+		nothing.
+		*/
+		if (options->phantom_mode) {
+			struct vine_mount *m;
+			LIST_ITERATE(p->task->output_mounts, m)
+			{
+				int fd = open(m->remote_name, O_WRONLY | O_CREAT, 0666);
+				if (fd >= 0)
+					close(fd);
+			}
+			_exit(0);
+		}
+
 		/* Remove undesired things from the environment. */
 		clear_environment();
 
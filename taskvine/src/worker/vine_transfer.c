@@ -9,6 +9,7 @@ See the file COPYING for details.
 
 #include "debug.h"
 #include "host_disk_info.h"
+#include "full_io.h"
 #include "link.h"
 #include "path.h"
 #include "stringtools.h"
@@ -19,6 +20,8 @@ See the file COPYING for details.
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <utime.h>
+#include <zlib.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -92,6 +95,12 @@ static int vine_transfer_put_internal(struct link *lnk, const char *full_name, c
 		if (fd >= 0) {
 			length = info.st_size;
 			send_message(lnk, "file %s %" PRId64 " 0%o %lld\n", relative_name_encoded, length, mode, (long long)info.st_mtime);
+			/*
+			Serving goes through sendfile, straight from the page
+			cache; ask the kernel to stage the whole file so a
+			popular object is resident for the next requester too.
+			*/
+			posix_fadvise(fd, 0, length, POSIX_FADV_WILLNEED);
 			actual = link_stream_from_fd(lnk, fd, length, stoptime);
 			close(fd);
 			if (actual != length)
@@ -161,6 +170,40 @@ send_failure:
 Send a cached object of any type down the wire.
 */
 
+/*
+Serve one byte range of a cached file, so a peer on a high
+bandwidth-delay link can fetch a large file over several concurrent
+connections and keep the pipe full.  The reply is the number of bytes
+to follow (or -1 on error) and then the raw bytes, moved with the
+zero-copy path.
+*/
+
+int vine_transfer_put_range(struct link *lnk, struct vine_cache *cache, const char *filename, int64_t offset, int64_t length, time_t stoptime)
+{
+	char *cached_path = vine_cache_data_path(cache, filename);
+	int result = 0;
+
+	int fd = open(cached_path, O_RDONLY);
+	if (fd >= 0) {
+		struct stat info;
+		if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && offset >= 0 && offset <= info.st_size) {
+			if (length < 0 || offset + length > info.st_size) {
+				length = info.st_size - offset;
+			}
+			link_printf(lnk, stoptime, "%lld\n", (long long)length);
+			result = link_sendfile(lnk, fd, offset, length, stoptime) == length;
+		} else {
+			link_printf(lnk, stoptime, "-1\n");
+		}
+		close(fd);
+	} else {
+		link_printf(lnk, stoptime, "-1\n");
+	}
+
+	free(cached_path);
+	return result;
+}
+
 int vine_transfer_put_any(struct link *lnk, struct vine_cache *cache, const char *filename, vine_transfer_mode_t xfer_mode, time_t stoptime)
 {
 	char *cached_path = vine_cache_data_path(cache, filename);
@@ -246,6 +289,99 @@ Returns 1 on successful transfer of one item.
 Returns 2 on successful receipt of "end" of list.
 */
 
+/*
+Receive a deflate-compressed file sent as length-prefixed chunks ending
+with a zero terminator, inflating straight to disk with no temporary
+file.  Returns true if the inflated size matches the announced one.
+*/
+
+static int vine_transfer_get_file_compressed_internal(struct link *lnk, const char *filename, int64_t length, int mode, int mtime, time_t stoptime)
+{
+	char in[65536];
+	char out[65536];
+	char line[64];
+	z_stream strm;
+	int64_t written = 0;
+	int ok = 1;
+
+	if (!check_disk_space_for_filesize(".", length, 0)) {
+		debug(D_VINE, "Could not put file %s, not enough disk space (%" PRId64 " bytes needed)\n", filename, length);
+		return 0;
+	}
+
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0700);
+	if (fd < 0) {
+		debug(D_VINE, "Could not open %s for writing. (%s)\n", filename, strerror(errno));
+		return 0;
+	}
+
+	memset(&strm, 0, sizeof(strm));
+	if (inflateInit(&strm) != Z_OK) {
+		close(fd);
+		return 0;
+	}
+
+	while (ok) {
+		int chunk;
+		if (!link_readline(lnk, line, sizeof(line), stoptime)) {
+			debug(D_VINE, "filez: readline failed");
+			ok = 0;
+			break;
+		}
+		if (sscanf(line, "%d", &chunk) != 1) {
+			debug(D_VINE, "filez: bad chunk header '%s'", line);
+			ok = 0;
+			break;
+		}
+		if (chunk == 0)
+			break;
+		if (chunk < 0 || chunk > (int)sizeof(in)) {
+			ok = 0;
+			break;
+		}
+		if (link_read(lnk, in, chunk, stoptime) != chunk) {
+			ok = 0;
+			break;
+		}
+
+		strm.next_in = (Bytef *)in;
+		strm.avail_in = chunk;
+		do {
+			strm.next_out = (Bytef *)out;
+			strm.avail_out = sizeof(out);
+			int zr = inflate(&strm, Z_NO_FLUSH);
+			if (zr != Z_OK && zr != Z_STREAM_END) {
+				ok = 0;
+				break;
+			}
+			int produced = sizeof(out) - strm.avail_out;
+			if (produced > 0) {
+				if (full_write(fd, out, produced) != produced) {
+					ok = 0;
+					break;
+				}
+				written += produced;
+			}
+			if (zr == Z_STREAM_END)
+				break;
+		} while (strm.avail_out == 0);
+	}
+
+	inflateEnd(&strm);
+
+	fchmod(fd, mode);
+	close(fd);
+
+	if (ok && written == length) {
+		struct utimbuf times = {.actime = mtime, .modtime = mtime};
+		utime(filename, &times);
+		return 1;
+	}
+
+	unlink(filename);
+	return 0;
+}
+
 int vine_transfer_get_any(struct link *lnk, const char *dirname, int64_t *totalsize, int *mode, int *mtime, time_t stoptime)
 {
 	char line[VINE_LINE_MAX];
@@ -272,6 +408,17 @@ int vine_transfer_get_any(struct link *lnk, const char *dirname, int64_t *totals
 
 		*totalsize += size;
 
+	} else if (sscanf(line, "filez %s %" SCNd64 " %o %d", name_encoded, &size, mode, mtime) == 4) {
+
+		url_decode(name_encoded, name, sizeof(name));
+		*mode &= 0777;
+
+		char *subname = string_format("%s/%s", dirname, name);
+		r = vine_transfer_get_file_compressed_internal(lnk, subname, size, *mode, *mtime, stoptime);
+		free(subname);
+
+		*totalsize += size;
+
 	} else if (sscanf(line, "symlink %s %" SCNd64, name_encoded, &size) == 2) {
 
 		url_decode(name_encoded, name, sizeof(name));
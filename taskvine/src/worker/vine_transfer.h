@@ -19,6 +19,9 @@ typedef enum {
 
 int vine_transfer_put_any( struct link *lnk, struct vine_cache *cache, const char *filename, vine_transfer_mode_t mode, time_t stoptime );
 
+/* Serve one byte range of a cached file, for parallel chunked fetches. */
+int vine_transfer_put_range( struct link *lnk, struct vine_cache *cache, const char *filename, int64_t offset, int64_t length, time_t stoptime );
+
 /* Receive a named file/dir from the connection to a local transfer path. */
 
 int vine_transfer_get_any(struct link *lnk, const char *dirname, int64_t *totalsize, int *mode, int *mtime, time_t stoptime);
@@ -46,6 +46,12 @@ static void vine_transfer_handler(struct link *lnk, struct vine_cache *cache)
 
 	change_process_title("vine_worker [transfer]");
 
+	/* Peer serving is the lowest I/O class: pace it so tasks and
+	cache ingest on this disk keep their share. */
+	if (options->peer_serve_bps) {
+		link_set_throttle(lnk, options->peer_serve_bps);
+	}
+
 	if (options->password) {
 		if (!link_auth_password(lnk, options->password, time(0) + command_timeout)) {
 			debug(D_VINE, "transfer server: could not authenticate peer worker via password!");
@@ -54,7 +60,12 @@ static void vine_transfer_handler(struct link *lnk, struct vine_cache *cache)
 	}
 
 	if (link_readline(lnk, line, sizeof(line), time(0) + command_timeout)) {
-		if (sscanf(line, "get %s", filename_encoded) == 1) {
+		long long offset, length;
+		if (sscanf(line, "getrange %s %lld %lld", filename_encoded, &offset, &length) == 3) {
+			/* one chunk of a parallel ranged fetch */
+			url_decode(filename_encoded, filename, sizeof(filename));
+			vine_transfer_put_range(lnk, cache, filename, offset, length, time(0) + transfer_timeout);
+		} else if (sscanf(line, "get %s", filename_encoded) == 1) {
 			url_decode(filename_encoded, filename, sizeof(filename));
 			vine_transfer_put_any(lnk, cache, filename, VINE_TRANSFER_MODE_ANY, time(0) + transfer_timeout);
 		} else {
@@ -12,6 +12,7 @@ See the file COPYING for details.
 #include "vine_mount.h"
 #include "vine_process.h"
 #include "vine_protocol.h"
+#include "cctools_endian.h"
 #include "vine_resources.h"
 #include "vine_sandbox.h"
 #include "vine_transfer.h"
@@ -58,6 +59,7 @@ See the file COPYING for details.
 
 #include <assert.h>
 #include <dirent.h>
+#include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -226,6 +228,14 @@ should a buffered message not overflow the the window, it is sent. Otherwise,
 we break once a message would overflow the window.
 */
 
+/* A queued asynchronous message: binary frames carry embedded nulls, so the length is explicit. */
+
+struct async_message {
+	char *data;
+	int length;
+	int is_frame;
+};
+
 void deliver_async_messages(struct link *l)
 {
 	int recv_window;
@@ -237,16 +247,20 @@ void deliver_async_messages(struct link *l)
 
 	int messages = list_size(pending_async_messages);
 	int visited;
-	char *message;
+	struct async_message *message;
 
 	for (visited = 0; visited < messages; visited++) {
 		message = list_peek_head(pending_async_messages);
-		int message_size = strlen(message);
-		if (message_size < bytes_available) {
+		if (message->length < bytes_available) {
 			message = list_pop_head(pending_async_messages);
-			bytes_available -= message_size;
-			debug(D_VINE, "tx: %s", message);
-			link_printf(l, time(0) + options->active_timeout, "%s", message);
+			bytes_available -= message->length;
+			if (message->is_frame) {
+				debug(D_VINE, "tx: (binary frame, %d bytes)", message->length);
+			} else {
+				debug(D_VINE, "tx: %s", message->data);
+			}
+			link_putlstring(l, message->data, message->length, time(0) + options->active_timeout);
+			free(message->data);
 			free(message);
 		} else {
 			break;
@@ -259,15 +273,32 @@ void deliver_async_messages(struct link *l)
 void send_async_message(struct link *l, const char *fmt, ...)
 {
 	va_list va;
-	char *message = malloc(VINE_LINE_MAX);
+	struct async_message *message = malloc(sizeof(*message));
+	message->data = malloc(VINE_LINE_MAX);
 	va_start(va, fmt);
-	vsprintf(message, fmt, va);
+	vsprintf(message->data, fmt, va);
 	va_end(va);
+	message->length = strlen(message->data);
+	message->is_frame = 0;
 
 	list_push_tail(pending_async_messages, message);
 	deliver_async_messages(l); // attempt to deliver message, will be delivered later if buffer is full.
 }
 
+/* Buffer an asynchronous binary frame to be sent to the manager */
+
+static void send_async_frame(struct link *l, const char *data, int length)
+{
+	struct async_message *message = malloc(sizeof(*message));
+	message->data = malloc(length);
+	memcpy(message->data, data, length);
+	message->length = length;
+	message->is_frame = 1;
+
+	list_push_tail(pending_async_messages, message);
+	deliver_async_messages(l);
+}
+
 /* Send asynchronous task completion messages for current complete processes */
 
 void send_complete_tasks(struct link *l)
@@ -351,6 +382,7 @@ static int64_t measure_worker_disk()
 	if (!cache_manager)
 		return 0;
 
+
 	char *cache_dir = vine_cache_data_path(cache_manager, ".");
 	path_disk_size_info_get_r(cache_dir, options->max_time_on_measurement, &state, NULL);
 	free(cache_dir);
@@ -492,16 +524,35 @@ void vine_worker_send_cache_update(struct link *manager, const char *cachename,
 		transfer_id = xxstrdup("X");
 	}
 
-	send_async_message(manager,
-			"cache-update %s %d %d %lld %lld %lld %lld %s\n",
-			cachename,
-			type,
-			cache_level,
-			(long long)size,
-			(long long)mtime,
-			(long long)transfer_time,
-			(long long)transfer_start,
-			transfer_id);
+	/*
+	Cache updates are the highest-frequency worker message, one per
+	file per task, so they travel as a fixed-layout binary frame:
+	neither side formats or parses text for them.
+	*/
+	unsigned char frame[2 * VINE_LINE_MAX];
+	int name_length = strlen(cachename);
+	int id_length = strlen(transfer_id);
+	uint64_t nsize = htonll((uint64_t)size);
+	uint64_t nmtime = htonll((uint64_t)mtime);
+	uint64_t ntransfer = htonll((uint64_t)transfer_time);
+	uint64_t nstart = htonll((uint64_t)transfer_start);
+	uint16_t nname = htons(name_length);
+	uint16_t nid = htons(id_length);
+
+	frame[0] = VINE_FRAME_START;
+	frame[1] = VINE_FRAME_CACHE_UPDATE;
+	frame[2] = type;
+	frame[3] = cache_level;
+	memcpy(&frame[4], &nsize, 8);
+	memcpy(&frame[12], &nmtime, 8);
+	memcpy(&frame[20], &ntransfer, 8);
+	memcpy(&frame[28], &nstart, 8);
+	memcpy(&frame[36], &nname, 2);
+	memcpy(&frame[38], &nid, 2);
+	memcpy(&frame[40], cachename, name_length);
+	memcpy(&frame[40 + name_length], transfer_id, id_length);
+
+	send_async_frame(manager, (const char *)frame, 40 + name_length + id_length);
 
 	free(transfer_id);
 }
@@ -1604,10 +1655,18 @@ static void check_libraries_ready(struct link *manager)
 
 /* Start working for the (newly connected) manager on this given link. */
 
+static struct link *process_link = 0;
+
 static void vine_worker_serve_manager(struct link *manager)
 {
 	sigset_t mask;
 
+	if (!process_link) {
+		int pfd = process_event_fd();
+		if (pfd >= 0)
+			process_link = link_attach_to_fd(pfd);
+	}
+
 	debug(D_VINE, "working for manager at %s:%d.\n", current_manager_address->addr, current_manager_address->port);
 
 	sigemptyset(&mask);
@@ -1658,7 +1717,28 @@ static void vine_worker_serve_manager(struct link *manager)
 			sigchld_received_flag = 0;
 		}
 
-		int manager_activity = link_usleep_mask(manager, wait_msec * 1000, &mask, 1, 0);
+		int manager_activity;
+		if (process_link) {
+			/*
+			With the child-exit descriptor in the poll set, a
+			finished task wakes us immediately and the race
+			described above cannot occur at all.
+			*/
+			struct link_info info[2];
+			info[0].link = manager;
+			info[0].events = LINK_READ;
+			info[0].revents = 0;
+			info[1].link = process_link;
+			info[1].events = LINK_READ;
+			info[1].revents = 0;
+			link_poll(info, 2, wait_msec);
+			if (info[1].revents) {
+				process_event_clear();
+			}
+			manager_activity = (info[0].revents & LINK_READ) ? 1 : 0;
+		} else {
+			manager_activity = link_usleep_mask(manager, wait_msec * 1000, &mask, 1, 0);
+		}
 		if (manager_activity < 0)
 			break;
 
@@ -1672,6 +1752,11 @@ static void vine_worker_serve_manager(struct link *manager)
 		ok &= handle_completed_tasks(manager);
 		ok &= vine_cache_wait(cache_manager, manager);
 
+		/* keep the cache within its configured budget */
+		if (options->max_cache_size > 0) {
+			vine_cache_trim(cache_manager, options->max_cache_size, manager);
+		}
+
 		measure_worker_resources();
 
 		if (!enforce_worker_promises(manager)) {
@@ -140,6 +140,10 @@ void vine_worker_options_show_help(const char *cmd, struct vine_worker_options *
 
 	printf(" %-30s Forbid the use of symlinks for cache management.\n", "--disable-symlinks");
 	printf(" %-30s Single-shot mode -- quit immediately after disconnection.\n", "--single-shot");
+	printf(" %-30s Phantom mode -- accept tasks but execute nothing, reporting\n", "--phantom");
+	printf(" %-30s instant success, for protocol throughput testing.\n", "");
+	printf(" %-30s Limit cache ingest transfers to this rate (e.g. 100M). (default: unlimited)\n", "--cache-ingest-rate");
+	printf(" %-30s Limit serving files to peer workers to this rate. (default: unlimited)\n", "--peer-serve-rate");
 	printf(" %-30s Listening port for worker-worker transfers. Either port or port_min:port_max (default: any)\n", "--transfer-port");
 	printf(" %-30s Explicit contact host:port for worker-worker transfers, e.g., when routing is used. (default: :<transfer_port>)\n", "--contact-hostport");
 	printf(" %-30s Maximum number of concurrent worker transfer requests (default=%d)\n", "--max-transfer-procs", options->max_transfer_procs);
@@ -155,11 +159,15 @@ enum {
 	LONG_OPT_CORES,
 	LONG_OPT_MEMORY,
 	LONG_OPT_DISK,
+	LONG_OPT_MAX_CACHE_SIZE,
 	LONG_OPT_DISK_PERCENT,
 	LONG_OPT_GPUS,
 	LONG_OPT_OPTIONS_IDLE_TIMEOUT,
 	LONG_OPT_CONNECT_TIMEOUT,
 	LONG_OPT_SINGLE_SHOT,
+	LONG_OPT_PHANTOM,
+	LONG_OPT_CACHE_INGEST_BPS,
+	LONG_OPT_PEER_SERVE_BPS,
 	LONG_OPT_WALL_TIME,
 	LONG_OPT_MEMORY_THRESHOLD,
 	LONG_OPT_FEATURE,
@@ -191,6 +199,9 @@ static const struct option long_options[] = {{"advertise", no_argument, 0, 'a'},
 		{"min-backoff", required_argument, 0, 'i'},
 		{"max-backoff", required_argument, 0, 'b'},
 		{"single-shot", no_argument, 0, LONG_OPT_SINGLE_SHOT},
+		{"phantom", no_argument, 0, LONG_OPT_PHANTOM},
+		{"cache-ingest-rate", required_argument, 0, LONG_OPT_CACHE_INGEST_BPS},
+		{"peer-serve-rate", required_argument, 0, LONG_OPT_PEER_SERVE_BPS},
 		{"disk-threshold", required_argument, 0, 'z'},
 		{"memory-threshold", required_argument, 0, LONG_OPT_MEMORY_THRESHOLD},
 		{"arch", required_argument, 0, 'A'},
@@ -202,6 +213,7 @@ static const struct option long_options[] = {{"advertise", no_argument, 0, 'a'},
 		{"cores", required_argument, 0, LONG_OPT_CORES},
 		{"memory", required_argument, 0, LONG_OPT_MEMORY},
 		{"disk", required_argument, 0, LONG_OPT_DISK},
+		{"max-cache-size", required_argument, 0, LONG_OPT_MAX_CACHE_SIZE},
 		{"disk-percent", required_argument, 0, LONG_OPT_DISK_PERCENT},
 		{"gpus", required_argument, 0, LONG_OPT_GPUS},
 		{"wall-time", required_argument, 0, LONG_OPT_WALL_TIME},
@@ -403,6 +415,9 @@ void vine_worker_options_get(struct vine_worker_options *options, int argc, char
 				options->disk_total = atoll(optarg);
 			}
 			break;
+		case LONG_OPT_MAX_CACHE_SIZE:
+			options->max_cache_size = atoll(optarg) * MEGA;
+			break;
 		case LONG_OPT_DISK_PERCENT:
 			if (!strncmp(optarg, "all", 3)) {
 				options->disk_percent = 100;
@@ -428,6 +443,15 @@ void vine_worker_options_get(struct vine_worker_options *options, int argc, char
 		case LONG_OPT_SINGLE_SHOT:
 			options->single_shot_mode = 1;
 			break;
+		case LONG_OPT_PHANTOM:
+			options->phantom_mode = 1;
+			break;
+		case LONG_OPT_CACHE_INGEST_BPS:
+			options->cache_ingest_bps = string_metric_parse(optarg);
+			break;
+		case LONG_OPT_PEER_SERVE_BPS:
+			options->peer_serve_bps = string_metric_parse(optarg);
+			break;
 		case 'h':
 			vine_worker_options_show_help(argv[0], options);
 			exit(0);
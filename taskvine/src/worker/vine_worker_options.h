@@ -19,8 +19,12 @@ struct vine_worker_options {
 	/* -1 means not given as a command line option. */
 	int64_t gpus_total;
 
+	/* Evict least-recently-used cache entries beyond this many bytes; zero disables eviction. */
+	int64_t max_cache_size;
+
 	/* In single shot mode, immediately quit when disconnected. Useful for accelerating the test suite. */
 	int single_shot_mode;
+	int phantom_mode; /* accept and account tasks but execute nothing, for protocol throughput testing */
 
 	/* Maximum time to stay connected to a single manager without any work. */
 	int idle_timeout;
@@ -108,6 +112,16 @@ struct vine_worker_options {
 	/* Maximum number of concurrent worker transfer requests made by worker */
 	int max_transfer_procs;
 
+	/*
+	Disk and network budgets per activity class, in bytes per second;
+	zero means unlimited.  Task I/O is never throttled, so the
+	priority order is task I/O first, then cache ingest, then peer
+	serving, enforced by pacing the transfer links of the lower
+	classes.
+	*/
+	uint64_t cache_ingest_bps;
+	uint64_t peer_serve_bps;
+
   /* Explicit contact host (address or hostname) for transfers bewteen workers. */
   char *reported_transfer_host;
   int reported_transfer_port;
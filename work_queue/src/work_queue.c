@@ -12,6 +12,9 @@ See the file COPYING for details.
 #include "cctools.h"
 #include "int_sizes.h"
 #include "link.h"
+#include "link_event.h"
+#include "set.h"
+#include "string_set.h"
 #include "link_auth.h"
 #include "debug.h"
 #include "stringtools.h"
@@ -156,6 +159,9 @@ struct work_queue {
 	struct link      *manager_link;   // incoming tcp connection for workers.
 	struct link_info *poll_table;
 	int poll_table_size;
+	struct link_event_set *event_set; // persistent readiness set for the manager link and every worker link
+	struct hash_table *file_worker_table; // cached_name -> set of workers holding the file, for indexed scheduling
+	int accept_waiting;               // set when the manager link polled ready, so new workers should be accepted
 
 	struct itable *tasks;           // taskid -> task
 	struct itable *task_state_map;  // taskid -> state
@@ -741,6 +747,35 @@ remote transfer or command was successful, and know we know the size
 of the file for the purposes of cache storage management.
 */
 
+/*
+Maintain the file-to-workers index used by the locality scheduler, so
+finding the workers that hold a file does not scan the worker table.
+*/
+
+static void worker_file_index_add(struct work_queue *q, struct work_queue_worker *w, const char *cachename)
+{
+	if(!q->file_worker_table) return;
+	struct set *holders = hash_table_lookup(q->file_worker_table, cachename);
+	if(!holders) {
+		holders = set_create(4);
+		hash_table_insert(q->file_worker_table, cachename, holders);
+	}
+	set_insert(holders, w);
+}
+
+static void worker_file_index_remove(struct work_queue *q, struct work_queue_worker *w, const char *cachename)
+{
+	if(!q->file_worker_table) return;
+	struct set *holders = hash_table_lookup(q->file_worker_table, cachename);
+	if(holders) {
+		set_remove(holders, w);
+		if(set_size(holders) == 0) {
+			hash_table_remove(q->file_worker_table, cachename);
+			set_delete(holders);
+		}
+	}
+}
+
 int process_cache_update( struct work_queue *q, struct work_queue_worker *w, const char *line )
 {
 	char cachename[WORK_QUEUE_LINE_MAX];
@@ -789,6 +824,7 @@ int process_cache_invalid( struct work_queue *q, struct work_queue_worker *w, co
 		
 		struct remote_file_info *remote_info = hash_table_remove(w->current_files,cachename);
 		if(remote_info) remote_file_info_delete(remote_info);
+		worker_file_index_remove(q, w, cachename);
 	}
 	return MSG_PROCESSED;
 }
@@ -1193,6 +1229,7 @@ static void cleanup_worker(struct work_queue *q, struct work_queue_worker *w)
 
 	hash_table_firstkey(w->current_files);
 	while(hash_table_nextkey(w->current_files, &key, (void **) &value)) {
+		worker_file_index_remove(q, w, key);
 		hash_table_remove(w->current_files, key);
 		free(value);
 		hash_table_firstkey(w->current_files);
@@ -1259,6 +1296,8 @@ static void remove_worker(struct work_queue *q, struct work_queue_worker *w, wor
 
 	cleanup_worker(q, w);
 
+	if(w->link)
+		link_event_del(q->event_set, w->link);
 	hash_table_remove(q->worker_table, w->hashkey);
 	hash_table_remove(q->workers_with_available_results, w->hashkey);
 
@@ -1388,6 +1427,7 @@ static void add_worker(struct work_queue *q)
 	link_to_hash_key(link, w->hashkey);
 	sprintf(w->addrport, "%s:%d", addr, port);
 	hash_table_insert(q->worker_table, w->hashkey, w);
+	link_event_add(q->event_set, w->link);
 
 	return;
 }
@@ -1654,6 +1694,7 @@ static work_queue_result_code_t get_output_file( struct work_queue *q, struct wo
 		if (stat(f->payload,&local_info) == 0) {
 			struct remote_file_info *remote_info = remote_file_info_create(f->type,local_info.st_size,local_info.st_mtime);
 			hash_table_insert(w->current_files, f->cached_name, remote_info);
+			worker_file_index_add(q, w, f->cached_name);
 		} else {
 			debug(D_NOTICE, "Cannot stat file %s: %s", f->payload, strerror(errno));
 		}
@@ -1725,6 +1766,7 @@ static void delete_worker_file( struct work_queue *q, struct work_queue_worker *
 	if(!(flags & except_flags)) {
 		send_worker_msg(q,w, "unlink %s\n", filename);
 		hash_table_remove(w->current_files, filename);
+		worker_file_index_remove(q, w, filename);
 	}
 }
 
@@ -2910,6 +2952,17 @@ struct jx * worker_to_jx( struct work_queue *q, struct work_queue_worker *w )
 	jx_insert_integer(j,"total_tasks_running",itable_size(w->current_tasks));
 	jx_insert_integer(j,"total_bytes_transferred",w->total_bytes_transferred);
 	jx_insert_integer(j,"total_transfer_time",w->total_transfer_time);
+
+	/* Per-link transfer counters, so a slow-network worker can be
+	spotted from status output rather than tcpdump. */
+	struct link_stats ls;
+	if(w->link && link_get_stats(w->link, &ls)) {
+		jx_insert_integer(j, "link_bytes_received", ls.bytes_read);
+		jx_insert_integer(j, "link_bytes_sent", ls.bytes_written);
+		jx_insert_integer(j, "link_blocked_write_time", ls.blocked_write_usecs);
+		jx_insert_integer(j, "link_blocked_writes", ls.blocked_writes);
+		jx_insert_double(j, "link_throughput_bps", ls.throughput_bps);
+	}
 	jx_insert_integer(j,"start_time",w->start_time);
 	jx_insert_integer(j,"current_time",timestamp_get());
 
@@ -3035,6 +3088,8 @@ static work_queue_msg_code_t process_http_request( struct work_queue *q, struct
 	return MSG_PROCESSED_DISCONNECT;
 }
 
+static struct jx *status_task_to_jx( struct work_queue *q, struct work_queue_task *t, uint64_t taskid );
+
 static struct jx *construct_status_message( struct work_queue *q, const char *request ) {
 	struct jx *a = jx_array(NULL);
 
@@ -3045,34 +3100,14 @@ static struct jx *construct_status_message( struct work_queue *q, const char *re
 		}
 	} else if(!strcmp(request, "task_status") || !strcmp(request, "tasks")) {
 		struct work_queue_task *t;
-		struct work_queue_worker *w;
 		struct jx *j;
 		uint64_t taskid;
 
 		itable_firstkey(q->tasks);
 		while(itable_nextkey(q->tasks,&taskid,(void**)&t)) {
-			w = itable_lookup(q->worker_task_map, taskid);
-			work_queue_task_state_t state = (uintptr_t) itable_lookup(q->task_state_map, taskid);
-			if(w) {
-				j = task_to_jx(q,t,task_state_str(state),w->hostname);
-				if(j) {
-					// Include detailed information on where the task is running:
-					// address and port, workspace
-					jx_insert_string(j, "address_port", w->addrport);
-
-					// Timestamps on running task related events
-					jx_insert_integer(j, "time_when_submitted", t->time_when_submitted);
-					jx_insert_integer(j, "time_when_commit_start", t->time_when_commit_start);
-					jx_insert_integer(j, "time_when_commit_end", t->time_when_commit_end);
-					jx_insert_integer(j, "current_time", timestamp_get());
-
-					jx_array_insert(a, j);
-				}
-			} else {
-				j = task_to_jx(q,t,task_state_str(state),0);
-				if(j) {
-					jx_array_insert(a, j);
-				}
+			j = status_task_to_jx(q, t, taskid);
+			if(j) {
+				jx_array_insert(a, j);
 			}
 		}
 	} else if(!strcmp(request, "worker_status") || !strcmp(request, "workers")) {
@@ -3102,16 +3137,107 @@ static struct jx *construct_status_message( struct work_queue *q, const char *re
 }
 
 
+/* Serialize one task for a status reply, matching construct_status_message. */
+
+static struct jx *status_task_to_jx( struct work_queue *q, struct work_queue_task *t, uint64_t taskid )
+{
+	struct work_queue_worker *w = itable_lookup(q->worker_task_map, taskid);
+	work_queue_task_state_t state = (uintptr_t) itable_lookup(q->task_state_map, taskid);
+	struct jx *j;
+
+	if(w) {
+		j = task_to_jx(q,t,task_state_str(state),w->hostname);
+		if(j) {
+			// Include detailed information on where the task is running:
+			// address and port, workspace
+			jx_insert_string(j, "address_port", w->addrport);
+
+			// Timestamps on running task related events
+			jx_insert_integer(j, "time_when_submitted", t->time_when_submitted);
+			jx_insert_integer(j, "time_when_commit_start", t->time_when_commit_start);
+			jx_insert_integer(j, "time_when_commit_end", t->time_when_commit_end);
+			jx_insert_integer(j, "current_time", timestamp_get());
+		}
+	} else {
+		j = task_to_jx(q,t,task_state_str(state),0);
+	}
+
+	return j;
+}
+
 static work_queue_msg_code_t process_queue_status( struct work_queue *q, struct work_queue_worker *target, const char *line, time_t stoptime )
 {
 	struct link *l = target->link;
 
-	struct jx *a = construct_status_message(q, line);
 	target->type = WORKER_TYPE_STATUS;
 
 	free(target->hostname);
 	target->hostname = xxstrdup("QUEUE_STATUS");
 
+	/*
+	The task list can run to hundreds of thousands of entries, so
+	stream it one task at a time instead of materializing the whole
+	response tree and text in memory: servicing a status query is
+	then O(1) in queue size.
+	*/
+	if(string_prefix_is(line, "task_status") || string_prefix_is(line, "tasks")) {
+		struct work_queue_task *t;
+		uint64_t taskid;
+		int first = 1;
+
+		/*
+		Optional filtering and pagination: the request may name a
+		state, a category, a starting offset, and a count, with "-"
+		as a wildcard, so dashboards pull just the slice they show
+		instead of every task.  A bare request behaves as before.
+		*/
+		char state_filter[WORK_QUEUE_LINE_MAX] = "-";
+		char category_filter[WORK_QUEUE_LINE_MAX] = "-";
+		long long offset = 0;
+		long long limit = -1;
+		sscanf(line, "%*s %s %s %lld %lld", state_filter, category_filter, &offset, &limit);
+
+		long long skipped = 0;
+		long long emitted = 0;
+
+		link_putliteral(l, "[", stoptime);
+		itable_firstkey(q->tasks);
+		while(itable_nextkey(q->tasks,&taskid,(void**)&t)) {
+			if(limit >= 0 && emitted >= limit)
+				break;
+
+			if(strcmp(state_filter, "-")) {
+				work_queue_task_state_t state = (uintptr_t) itable_lookup(q->task_state_map, taskid);
+				if(strcmp(task_state_str(state), state_filter))
+					continue;
+			}
+			if(strcmp(category_filter, "-")) {
+				const char *category = t->category ? t->category : "default";
+				if(strcmp(category, category_filter))
+					continue;
+			}
+			if(skipped < offset) {
+				skipped++;
+				continue;
+			}
+
+			struct jx *j = status_task_to_jx(q, t, taskid);
+			if(!j)
+				continue;
+			if(!first)
+				link_putliteral(l, ",", stoptime);
+			jx_print_link(j, l, stoptime);
+			jx_delete(j);
+			first = 0;
+			emitted++;
+		}
+		link_putliteral(l, "]", stoptime);
+
+		return MSG_PROCESSED_DISCONNECT;
+	}
+
+	struct jx *a = construct_status_message(q, line);
+
 	if(!a) {
 		debug(D_WQ, "Unknown status request: '%s'", line);
 		return MSG_FAILURE;
@@ -3241,57 +3367,6 @@ static work_queue_result_code_t handle_worker(struct work_queue *q, struct link
 	return WQ_SUCCESS;
 }
 
-static int build_poll_table(struct work_queue *q, struct link *manager)
-{
-	int n = 0;
-	char *key;
-	struct work_queue_worker *w;
-
-	// Allocate a small table, if it hasn't been done yet.
-	if(!q->poll_table) {
-		q->poll_table = malloc(sizeof(*q->poll_table) * q->poll_table_size);
-		if(!q->poll_table) {
-			//if we can't allocate a poll table, we can't do anything else.
-			fatal("allocating memory for poll table failed.");
-		}
-	}
-
-	// The first item in the poll table is the manager link, which accepts new connections.
-	q->poll_table[0].link = q->manager_link;
-	q->poll_table[0].events = LINK_READ;
-	q->poll_table[0].revents = 0;
-	n = 1;
-
-	if(manager) {
-		/* foreman uplink */
-		q->poll_table[1].link = manager;
-		q->poll_table[1].events = LINK_READ;
-		q->poll_table[1].revents = 0;
-		n++;
-	}
-
-	// For every worker in the hash table, add an item to the poll table
-	hash_table_firstkey(q->worker_table);
-	while(hash_table_nextkey(q->worker_table, &key, (void **) &w)) {
-		// If poll table is not large enough, reallocate it
-		if(n >= q->poll_table_size) {
-			q->poll_table_size *= 2;
-			q->poll_table = realloc(q->poll_table, sizeof(*q->poll_table) * q->poll_table_size);
-			if(q->poll_table == NULL) {
-				//if we can't allocate a poll table, we can't do anything else.
-				fatal("reallocating memory for poll table failed.");
-			}
-		}
-
-		q->poll_table[n].link = w->link;
-		q->poll_table[n].events = LINK_READ;
-		q->poll_table[n].revents = 0;
-		n++;
-	}
-
-	return n;
-}
-
 /*
 Send a symbolic link to the remote worker.
 Note that the target of the link is sent
@@ -3504,6 +3579,7 @@ static work_queue_result_code_t send_item_if_not_cached( struct work_queue *q, s
 		if(result == WQ_SUCCESS && tf->flags & WORK_QUEUE_CACHE) {
 			remote_info = remote_file_info_create(tf->type,local_info.st_size,local_info.st_mtime);
 			hash_table_insert(w->current_files, tf->cached_name, remote_info);
+			worker_file_index_add(q, w, tf->cached_name);
 		}
 
 		return result;
@@ -3606,6 +3682,7 @@ static work_queue_result_code_t send_special_if_not_cached( struct work_queue *q
 	if(tf->flags & WORK_QUEUE_CACHE) {
 		struct remote_file_info *remote_info = remote_file_info_create(tf->type,tf->length,time(0));
 		hash_table_insert(w->current_files,tf->cached_name,remote_info);
+		worker_file_index_add(q, w, tf->cached_name);
 	}
 
 	return WQ_SUCCESS;
@@ -4248,6 +4325,70 @@ static struct work_queue_worker *find_worker_by_files(struct work_queue *q, stru
 	struct remote_file_info *remote_info;
 	struct work_queue_file *tf;
 
+	/*
+	First consider only the workers already holding one of the task's
+	cached inputs, found through the file-to-workers index; any
+	eligible one has strictly more cached bytes than workers outside
+	the index, so the full scan below runs only when nothing is
+	cached anywhere.  Candidates are remembered by hash key since the
+	eligibility check can remove a worker.
+	*/
+	if(!in_ramp_down(q)) {
+		struct list *candidate_keys = 0;
+		struct string_set *seen = 0;
+
+		list_first_item(t->input_files);
+		while((tf = list_next_item(t->input_files))) {
+			if(!((tf->type == WORK_QUEUE_FILE || tf->type == WORK_QUEUE_FILE_PIECE) && (tf->flags & WORK_QUEUE_CACHE)))
+				continue;
+			struct set *holders = hash_table_lookup(q->file_worker_table, tf->cached_name);
+			if(!holders)
+				continue;
+			struct work_queue_worker *holder;
+			SET_ITERATE(holders, holder)
+			{
+				if(!candidate_keys) {
+					candidate_keys = list_create();
+					seen = string_set_create(0, 0);
+				}
+				if(string_set_insert(seen, holder->hashkey)) {
+					list_push_tail(candidate_keys, xxstrdup(holder->hashkey));
+				}
+			}
+		}
+
+		if(candidate_keys) {
+			char *candidate_key;
+			while((candidate_key = list_pop_head(candidate_keys))) {
+				w = hash_table_lookup(q->worker_table, candidate_key);
+				free(candidate_key);
+				if(!w)
+					continue;
+				if( check_hand_against_task(q, w, t) ) {
+					task_cached_bytes = 0;
+					list_first_item(t->input_files);
+					while((tf = list_next_item(t->input_files))) {
+						if((tf->type == WORK_QUEUE_FILE || tf->type == WORK_QUEUE_FILE_PIECE) && (tf->flags & WORK_QUEUE_CACHE)) {
+							remote_info = hash_table_lookup(w->current_files, tf->cached_name);
+							if(remote_info)
+								task_cached_bytes += remote_info->size;
+						}
+					}
+					if (!best_worker || task_cached_bytes > most_task_cached_bytes) {
+						best_worker = w;
+						most_task_cached_bytes = task_cached_bytes;
+					}
+				}
+			}
+			list_delete(candidate_keys);
+			string_set_delete(seen);
+
+			if(best_worker) {
+				return best_worker;
+			}
+		}
+	}
+
 	hash_table_firstkey(q->worker_table);
 	while(hash_table_nextkey(q->worker_table, &key, (void **) &w)) {
 		if( check_hand_against_task(q, w, t) ) {
@@ -4816,6 +4957,20 @@ static int abort_slow_workers(struct work_queue *q)
 		timestamp_t runtime = current - t->time_when_commit_start;
 		timestamp_t average_task_time = c->average_task_time;
 
+		/*
+		With enough samples, judge stragglers against the 95th
+		percentile of recent successful runtimes instead of the
+		mean: on bimodal workloads the mean either kills the slow
+		mode's healthy tasks or waits far too long for the fast
+		mode's true stragglers.
+		*/
+		if(c->runtime_sample_count >= 20) {
+			double p95 = category_runtime_percentile(c, 95);
+			if(p95 >= 1) {
+				average_task_time = p95;
+			}
+		}
+
 		/* Not enough samples, skip the task. */
 		if(average_task_time < 1)
 			continue;
@@ -5867,6 +6022,16 @@ struct work_queue *work_queue_ssl_create(int port, const char *key, const char *
 		link_address_local(q->manager_link, address, &q->port);
 	}
 
+	q->file_worker_table = hash_table_create(0, 0);
+	q->event_set = link_event_create();
+	if(!q->event_set) {
+		debug(D_NOTICE, "Could not create work_queue event set.");
+		link_close(q->manager_link);
+		free(q);
+		return 0;
+	}
+	link_event_add(q->event_set, q->manager_link);
+
 	q->ssl_key = key ? strdup(key) : 0;
 	q->ssl_cert = cert ? strdup(cert) : 0;
 
@@ -6241,6 +6406,9 @@ void work_queue_delete(struct work_queue *q)
 		free(q->ssl_cert);
 		free(q->ssl_key);
 
+		hash_table_clear(q->file_worker_table, (void *)set_delete);
+		hash_table_delete(q->file_worker_table);
+		link_event_delete(q->event_set);
 		link_close(q->manager_link);
 		if(q->logfile) {
 			fclose(q->logfile);
@@ -6866,7 +7034,12 @@ static int poll_active_workers(struct work_queue *q, int stoptime, struct link *
 {
 	BEGIN_ACCUM_TIME(q, time_polling);
 
-	int n = build_poll_table(q, foreman_uplink);
+	struct link *ready[256];
+
+	// The foreman uplink is not a permanent member of the set, so watch it just for this wait.
+	if(foreman_uplink) {
+		link_event_add(q->event_set, foreman_uplink);
+	}
 
 	// We poll in at most small time segments (of a second). This lets
 	// promptly dispatch tasks, while avoiding busy waiting.
@@ -6878,24 +7051,22 @@ static int poll_active_workers(struct work_queue *q, int stoptime, struct link *
 	END_ACCUM_TIME(q, time_polling);
 
 	if(msec < 0) {
+		if(foreman_uplink) {
+			link_event_del(q->event_set, foreman_uplink);
+		}
 		return 0;
 	}
 
 	BEGIN_ACCUM_TIME(q, time_polling);
 
-	// Poll all links for activity.
-	link_poll(q->poll_table, n, msec);
+	// Wait on the persistent event set; only ready links come back.
+	int n = link_event_wait(q->event_set, msec, ready, 256);
 	q->link_poll_end = timestamp_get();
 
-	int i, j = 1;
-	// Consider the foreman_uplink passed into the function and disregard if inactive.
+	int i;
 	if(foreman_uplink) {
-		if(q->poll_table[1].revents) {
-			*foreman_uplink_active = 1; //signal that the manager link saw activity
-		} else {
-			*foreman_uplink_active = 0;
-		}
-		j++;
+		*foreman_uplink_active = 0;
+		link_event_del(q->event_set, foreman_uplink);
 	}
 
 	END_ACCUM_TIME(q, time_polling);
@@ -6903,12 +7074,18 @@ static int poll_active_workers(struct work_queue *q, int stoptime, struct link *
 	BEGIN_ACCUM_TIME(q, time_status_msgs);
 
 	int workers_failed = 0;
-	// Then consider all existing active workers
-	for(i = j; i < n; i++) {
-		if(q->poll_table[i].revents) {
-			if(handle_worker(q, q->poll_table[i].link) == WQ_WORKER_FAILURE) {
-				workers_failed++;
-			}
+	q->accept_waiting = 0;
+	for(i = 0; i < n; i++) {
+		if(ready[i] == q->manager_link) {
+			q->accept_waiting = 1;
+			continue;
+		}
+		if(foreman_uplink && ready[i] == foreman_uplink) {
+			*foreman_uplink_active = 1; //signal that the manager link saw activity
+			continue;
+		}
+		if(handle_worker(q, ready[i]) == WQ_WORKER_FAILURE) {
+			workers_failed++;
 		}
 	}
 
@@ -6936,7 +7113,7 @@ static int connect_new_workers(struct work_queue *q, int stoptime, int max_new_w
 	// If the manager link was awake, then accept at most max_new_workers.
 	// Note we are using the information gathered in poll_active_workers, which
 	// is a little ugly.
-	if(q->poll_table[0].revents) {
+	if(q->accept_waiting) {
 		do {
 			add_worker(q);
 			new_workers++;
@@ -8061,6 +8238,9 @@ void work_queue_accumulate_task(struct work_queue *q, struct work_queue_task *t)
 
 	if(t->result == WORK_QUEUE_RESULT_SUCCESS)
 	{
+		/* feed the percentile window used by fast abort */
+		category_runtime_sample(c, t->time_workers_execute_last);
+
 		q->stats->time_workers_execute_good += t->time_workers_execute_last;
 		q->stats->time_send_good            += t->time_when_commit_end - t->time_when_commit_end;
 		q->stats->time_receive_good         += t->time_when_done - t->time_when_retrieval;
@@ -4,6 +4,7 @@
 #include "xxmalloc.h"
 #include "hash_table.h"
 #include "debug.h"
+#include "sha1.h"
 #include "stringtools.h"
 #include "trash.h"
 #include "link.h"
@@ -13,18 +14,23 @@
 #include <sys/types.h>
 #include <sys/fcntl.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
 struct work_queue_cache {
 	struct hash_table *table;
+	struct hash_table *hash_refs; /* content hash -> count of names deduplicated against it */
 	char *cache_dir;
 };
 
 struct cache_file {
 	work_queue_cache_type_t type;
 	char *source;
+	char *content_hash; /* set when deduplicated, for by-hash garbage collection */
 	int64_t expected_size;
 	int64_t actual_size;
 	int mode;
@@ -36,6 +42,7 @@ struct cache_file * cache_file_create( work_queue_cache_type_t type, const char
 	struct cache_file *f = malloc(sizeof(*f));
 	f->type = type;
 	f->source = xxstrdup(source);
+	f->content_hash = 0;
 	f->expected_size = expected_size;
 	f->actual_size = actual_size;
 	f->mode = mode;
@@ -46,6 +53,7 @@ struct cache_file * cache_file_create( work_queue_cache_type_t type, const char
 void cache_file_delete( struct cache_file *f )
 {
 	free(f->source);
+	free(f->content_hash);
 	free(f);
 }
 
@@ -56,6 +64,7 @@ Create the cache manager structure for a given cache directory.
 struct work_queue_cache * work_queue_cache_create( const char *cache_dir )
 {
 	struct work_queue_cache *c = malloc(sizeof(*c));
+	c->hash_refs = hash_table_create(0,0);
 	c->cache_dir = strdup(cache_dir);
 	c->table = hash_table_create(0,0);
 	return c;
@@ -107,6 +116,8 @@ int work_queue_cache_queue( struct work_queue_cache *c, work_queue_cache_type_t
 	return 1;
 }
 
+static void cache_hash_ref(struct work_queue_cache *c, const char *hash, int delta);
+
 /*
 Remove a named item from the cache, regardless of its type.
 */
@@ -120,6 +131,16 @@ int work_queue_cache_remove( struct work_queue_cache *c, const char *cachename )
 	trash_file(cache_path);
 	free(cache_path);
 
+	/* collect the by-hash copy when its last referencing name goes */
+	if(f->content_hash) {
+		cache_hash_ref(c, f->content_hash, -1);
+		if(!hash_table_lookup(c->hash_refs, f->content_hash)) {
+			char *hash_path = string_format("%s/by-hash/%s", c->cache_dir, f->content_hash);
+			trash_file(hash_path);
+			free(hash_path);
+		}
+	}
+
 	cache_file_delete(f);
 	
 	return 1;
@@ -203,6 +224,115 @@ but it is needed in order to send back the necessary update/invalid messages.
 int send_cache_update( struct link *manager, const char *cachename, int64_t size, timestamp_t transfer_time );
 int send_cache_invalid( struct link *manager, const char *cachename, const char *message );
 
+/*
+Content-addressed deduplication: once a file is present in the cache,
+clone it into a by-hash store keyed by its checksum.  If another entry
+with the same content already exists (the same dataset sent under a
+different name, or by a different manager sharing this worker), the
+new name becomes a reflink clone of the single stored copy, so the
+bytes are kept once.  Clones, not hard links: sandboxes link cache
+files in by name, and a task that writes to its input must never
+reach another name's bytes -- a reflink shares extents copy-on-write,
+so the first write diverges the two names.  On filesystems without
+FICLONE the clone fails and the entry simply stays unshared.  Each
+by-hash entry carries a reference count of the names deduplicated
+against it, and is collected when the last of them is removed.
+*/
+
+#ifdef FICLONE
+static int cache_clone(const char *from, const char *to)
+{
+	int src = open(from, O_RDONLY);
+	if (src < 0)
+		return 0;
+	int dst = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0700);
+	if (dst < 0) {
+		close(src);
+		return 0;
+	}
+	int ok = ioctl(dst, FICLONE, src) == 0;
+	close(src);
+	close(dst);
+	if (!ok)
+		unlink(to);
+	return ok;
+}
+#endif
+
+static void cache_hash_ref(struct work_queue_cache *c, const char *hash, int delta)
+{
+	intptr_t count = (intptr_t)hash_table_remove(c->hash_refs, hash);
+	count += delta;
+	if (count > 0) {
+		hash_table_insert(c->hash_refs, hash, (void *)count);
+	}
+}
+
+void work_queue_cache_dedup(struct work_queue_cache *c, const char *cachename, const char *cache_path)
+{
+#ifdef FICLONE
+	struct stat info;
+	unsigned char digest[SHA1_DIGEST_LENGTH];
+
+	if (stat(cache_path, &info) != 0 || !S_ISREG(info.st_mode))
+		return;
+
+	if (!sha1_file(cache_path, digest))
+		return;
+
+	const char *hash = sha1_string(digest);
+	char *hash_dir = string_format("%s/by-hash", c->cache_dir);
+	char *hash_path = string_format("%s/%s", hash_dir, hash);
+
+	int shared = 0;
+	struct stat hash_info;
+	if (stat(hash_path, &hash_info) == 0) {
+		if (hash_info.st_size == info.st_size) {
+			/* same content already stored: clone this name from it */
+			char *tmp_path = string_format("%s.dedup", cache_path);
+			if (cache_clone(hash_path, tmp_path) && rename(tmp_path, cache_path) == 0) {
+				debug(D_WQ, "cache: deduplicated %s against stored copy", cache_path);
+				shared = 1;
+			} else {
+				unlink(tmp_path);
+			}
+			free(tmp_path);
+		}
+	} else {
+		mkdir(hash_dir, 0777);
+		shared = cache_clone(cache_path, hash_path);
+	}
+
+	if (shared) {
+		struct cache_file *f = hash_table_lookup(c->table, cachename);
+		if (f && !f->content_hash) {
+			f->content_hash = xxstrdup(hash);
+			cache_hash_ref(c, hash, 1);
+		}
+	}
+
+	free(hash_dir);
+	free(hash_path);
+#endif
+}
+
+/*
+Prefetch a cache entry that will be produced by a transfer or command,
+so that staging for a queued task overlaps with the computation of the
+tasks already running.  Entries expected to be pushed by the manager
+are left alone, and a present entry costs only a lookup.
+*/
+
+int work_queue_cache_prefetch( struct work_queue_cache *c, const char *cachename, struct link *manager )
+{
+	struct cache_file *f = hash_table_lookup(c->table,cachename);
+	if(!f) return 0;
+	if(f->present) return 1;
+	if(f->type==WORK_QUEUE_CACHE_FILE) return 0;
+	debug(D_WQ,"cache: prefetching %s ahead of task start",cachename);
+	return work_queue_cache_ensure(c,cachename,manager);
+}
+
 int work_queue_cache_ensure( struct work_queue_cache *c, const char *cachename, struct link *manager )
 {
 	struct cache_file *f = hash_table_lookup(c->table,cachename);
@@ -258,6 +388,7 @@ int work_queue_cache_ensure( struct work_queue_cache *c, const char *cachename,
 			f->expected_size = f->actual_size;
 			f->present = 1;
 			debug(D_WQ,"cache: created %s with size %lld in %lld usec",cachename,(long long)f->actual_size,(long long)transfer_time);
+			work_queue_cache_dedup(c, cachename, cache_path);
 			send_cache_update(manager,cachename,f->actual_size,transfer_time);
 			result = 1;
 		} else {
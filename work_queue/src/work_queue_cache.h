@@ -31,6 +31,14 @@ char *work_queue_cache_full_path( struct work_queue_cache *c, const char *cachen
 int work_queue_cache_addfile( struct work_queue_cache *c, int64_t size, const char *cachename );
 int work_queue_cache_queue( struct work_queue_cache *c, work_queue_cache_type_t, const char *source, const char *cachename, int64_t size, int mode );
 int work_queue_cache_ensure( struct work_queue_cache *c, const char *cachename, struct link *manager );
+
+/* Begin materializing a transfer- or command-backed entry ahead of need,
+so staging overlaps with running tasks' computation. */
+int work_queue_cache_prefetch( struct work_queue_cache *c, const char *cachename, struct link *manager );
+
+/* Collapse a present cache file into the content-addressed by-hash store,
+so identical content cached under different names is stored once. */
+void work_queue_cache_dedup( struct work_queue_cache *c, const char *cachename, const char *cache_path );
 int work_queue_cache_remove( struct work_queue_cache *c, const char *cachename );
 
 #endif
@@ -223,6 +223,93 @@ static char * load_input_file(struct work_queue_task *t) {
 	return buf;
 }
 
+/*
+Optional cgroup v2 enforcement: each task runs in its own cgroup under
+the path named by WORK_QUEUE_CGROUP_ROOT (which must be writable and
+delegated to the worker's user).  The task's requested memory becomes
+memory.max, so a memory hog is killed by the kernel inside its own
+group instead of taking down the whole worker; the worker reports the
+breach as resource exhaustion.  When the variable is unset or the
+hierarchy is not writable, nothing changes.
+*/
+
+static char *process_cgroup_path(struct work_queue_process *p)
+{
+	const char *root = getenv("WORK_QUEUE_CGROUP_ROOT");
+	if (!root)
+		return 0;
+	return string_format("%s/wq-task-%d", root, p->task->taskid);
+}
+
+static void process_cgroup_enter(struct work_queue_process *p)
+{
+	char *dir = process_cgroup_path(p);
+	if (!dir)
+		return;
+
+	if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+		free(dir);
+		return;
+	}
+
+	if (p->task->resources_requested->memory > 0) {
+		char *path = string_format("%s/memory.max", dir);
+		FILE *f = fopen(path, "w");
+		if (f) {
+			fprintf(f, "%lld", (long long)p->task->resources_requested->memory * 1024 * 1024);
+			fclose(f);
+		}
+		free(path);
+	}
+
+	if (p->task->resources_requested->cores > 0) {
+		char *path = string_format("%s/cpu.weight", dir);
+		FILE *f = fopen(path, "w");
+		if (f) {
+			fprintf(f, "%lld", (long long)(100 * p->task->resources_requested->cores));
+			fclose(f);
+		}
+		free(path);
+	}
+
+	char *procs = string_format("%s/cgroup.procs", dir);
+	FILE *f = fopen(procs, "w");
+	if (f) {
+		fprintf(f, "%d", (int)getpid());
+		fclose(f);
+	}
+	free(procs);
+	free(dir);
+}
+
+/* After the task exits, check whether the kernel killed it for exceeding memory, and clean up the group. */
+
+int work_queue_process_cgroup_check_oom(struct work_queue_process *p)
+{
+	int oom = 0;
+	char *dir = process_cgroup_path(p);
+	if (!dir)
+		return 0;
+
+	char *events = string_format("%s/memory.events", dir);
+	FILE *f = fopen(events, "r");
+	if (f) {
+		char line[256];
+		while (fgets(line, sizeof(line), f)) {
+			long long count;
+			if (sscanf(line, "oom_kill %lld", &count) == 1 && count > 0) {
+				oom = 1;
+			}
+		}
+		fclose(f);
+	}
+	free(events);
+
+	rmdir(dir);
+	free(dir);
+	return oom;
+}
+
 pid_t work_queue_process_execute(struct work_queue_process *p )
 {
 	// make warning
@@ -265,6 +352,9 @@ pid_t work_queue_process_execute(struct work_queue_process *p )
 		return p->pid;
 
 	} else {
+		/* move this task into its own enforcement cgroup, if configured */
+		process_cgroup_enter(p);
+
 		if(chdir(p->sandbox)) {
 			printf("The sandbox dir is %s", p->sandbox);
 			fatal("could not change directory into %s: %s", p->sandbox, strerror(errno));
@@ -302,6 +392,25 @@ pid_t work_queue_process_execute(struct work_queue_process *p )
 
 		close(p->output_fd);
 
+		/* Phantom workers touch each declared output so retrieval has
+		something to ship, then report instant success without
+		executing, so the manager-worker protocol can be load-tested
+		alone. */
+		if (getenv("WORK_QUEUE_PHANTOM_WORKER")) {
+			struct work_queue_file *f;
+			if (p->task->output_files) {
+				list_first_item(p->task->output_files);
+				while ((f = list_next_item(p->task->output_files))) {
+					if (f->remote_name) {
+						int fd = open(f->remote_name, O_WRONLY | O_CREAT, 0666);
+						if (fd >= 0)
+							close(fd);
+					}
+				}
+			}
+			_exit(0);
+		}
+
 		clear_environment();
 
 		/* overwrite CORES, MEMORY, or DISK variables, if the task used specify_* */
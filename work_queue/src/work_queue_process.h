@@ -51,6 +51,11 @@ struct work_queue_process {
 
 struct work_queue_process * work_queue_process_create( struct work_queue_task *task, int disk_allocation );
 pid_t work_queue_process_execute( struct work_queue_process *p );
+
+/* After exit, report whether the kernel killed the task for exceeding its
+cgroup memory limit, and remove the task's cgroup.  Always zero when cgroup
+enforcement is not configured. */
+int work_queue_process_cgroup_check_oom( struct work_queue_process *p );
 void  work_queue_process_kill( struct work_queue_process *p );
 void  work_queue_process_delete( struct work_queue_process *p );
 void  work_queue_process_compute_disk_needed( struct work_queue_process *p );
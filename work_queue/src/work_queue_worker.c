@@ -86,6 +86,10 @@ typedef enum {
 // Useful for accelerating the test suite.
 static int single_shot_mode = 0;
 
+// In phantom mode, tasks are accepted and accounted but never executed (exported
+// to the process module through WORK_QUEUE_PHANTOM_WORKER), for protocol load tests.
+static int phantom_mode = 0;
+
 // Maximum time to stay connected to a single manager without any work.
 static int idle_timeout = 900;
 
@@ -624,6 +628,12 @@ static void reap_process( struct work_queue_process *p )
 {
 	p->execution_end = timestamp_get();
 
+	/* a kernel OOM kill inside the task's enforcement cgroup is a resource breach, not a worker failure */
+	if(work_queue_process_cgroup_check_oom(p)) {
+		debug(D_WQ,"task %d exceeded its memory limit and was killed by the kernel",p->task->taskid);
+		p->task_status = WORK_QUEUE_RESULT_RESOURCE_EXHAUSTION;
+	}
+
 	cores_allocated  -= p->task->resources_requested->cores;
 	memory_allocated -= p->task->resources_requested->memory;
 	disk_allocated   -= p->task->resources_requested->disk;
@@ -677,7 +687,6 @@ static void report_task_complete( struct link *manager, struct work_queue_proces
 	}
 
 	get_task_tlq_url(p->task);
-	send_stats_update(manager);
 }
 
 /*
@@ -693,6 +702,13 @@ static void report_tasks_complete( struct link *manager )
 		report_task_complete(manager,p);
 	}
 
+	/*
+	One stats update covers the whole batch of results: the dozens of
+	info lines it carries used to be repeated after every task, which
+	dominated message count for short-task workloads.
+	*/
+	send_stats_update(manager);
+
 	work_queue_watcher_send_changes(watcher,manager,time(0)+active_timeout);
 
 	send_manager_message(manager, "end\n");
@@ -1008,6 +1024,22 @@ static int do_task( struct link *manager, int taskid, time_t stoptime )
 	} else {
 		normalize_resources(p);
 		list_push_tail(procs_waiting,p);
+
+		/*
+		Begin fetching this task's remote inputs now: the transfers
+		run in this control thread while already-running tasks
+		compute in their child processes, so stage-in at start time
+		finds them present.
+		*/
+		struct work_queue_file *f;
+		if(task->input_files) {
+			list_first_item(task->input_files);
+			while((f = list_next_item(task->input_files))) {
+				if(f->cached_name) {
+					work_queue_cache_prefetch(global_cache, f->cached_name, manager);
+				}
+			}
+		}
 	}
 
 	work_queue_watcher_add_process(watcher,p);
@@ -2409,6 +2441,8 @@ static void show_help(const char *cmd)
 
 	printf( " %-30s Forbid the use of symlinks for cache management.\n", "--disable-symlinks");
 	printf(" %-30s Single-shot mode -- quit immediately after disconnection.\n", "--single-shot");
+	printf(" %-30s Phantom mode -- accept tasks but execute nothing, for\n", "--phantom");
+	printf(" %-30s protocol throughput testing.\n", "");
 	printf( " %-30s Set the percent chance per minute that the worker will shut down (simulates worker failures, for testing only).\n", "--volatility=<chance>");
 	printf( " %-30s Set the port used to lookup the worker's TLQ URL (-d and -o options also required).\n", "--tlq=<port>");
 	printf( " %-30s Start an arbitrary process when the worker starts up and kill the process when the worker shuts down.\n", "--coprocess <executable>");
@@ -2420,6 +2454,7 @@ enum {LONG_OPT_DEBUG_FILESIZE = 256, LONG_OPT_VOLATILITY, LONG_OPT_BANDWIDTH,
 	  LONG_OPT_DISK, LONG_OPT_GPUS, LONG_OPT_FOREMAN, LONG_OPT_FOREMAN_PORT, LONG_OPT_DISABLE_SYMLINKS,
 	  LONG_OPT_IDLE_TIMEOUT, LONG_OPT_CONNECT_TIMEOUT,
 	  LONG_OPT_SINGLE_SHOT, LONG_OPT_WALL_TIME, LONG_OPT_DISK_ALLOCATION,
+	  LONG_OPT_PHANTOM,
 	  LONG_OPT_MEMORY_THRESHOLD, LONG_OPT_FEATURE, LONG_OPT_TLQ, LONG_OPT_PARENT_DEATH, LONG_OPT_CONN_MODE,
 	  LONG_OPT_USE_SSL, LONG_OPT_PYTHON_FUNCTION, LONG_OPT_FROM_FACTORY, LONG_OPT_COPROCESS,
 	  LONG_OPT_NUM_COPROCESS, LONG_OPT_COPROCESS_CORES,
@@ -2449,6 +2484,7 @@ static const struct option long_options[] = {
 	{"min-backoff",         required_argument,  0,  'i'},
 	{"max-backoff",         required_argument,  0,  'b'},
 	{"single-shot",		    no_argument,        0,  LONG_OPT_SINGLE_SHOT },
+	{"phantom",		    no_argument,        0,  LONG_OPT_PHANTOM },
 	{"disable-symlinks",    no_argument,        0,  LONG_OPT_DISABLE_SYMLINKS},
 	{"disk-threshold",      required_argument,  0,  'z'},
 	{"memory-threshold",    required_argument,  0,  LONG_OPT_MEMORY_THRESHOLD},
@@ -2678,6 +2714,10 @@ int main(int argc, char *argv[])
 		case LONG_OPT_SINGLE_SHOT:
 			single_shot_mode = 1;
 			break;
+		case LONG_OPT_PHANTOM:
+			phantom_mode = 1;
+			setenv("WORK_QUEUE_PHANTOM_WORKER", "1", 1);
+			break;
 		case 'h':
 			show_help(argv[0]);
 			return 0;